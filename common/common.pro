@@ -17,13 +17,17 @@ OTHER_FILES += \
 FRAMEWORKHEADERSINSTALL = \
     maliit/namespace.h \
     maliit/settingdata.h \
+    maliit/keyfilter.h \
 
 HEADERS += \
     $$FRAMEWORKHEADERSINSTALL \
     maliit/namespaceinternal.h \
+    maliit/tracing.h \
 
 SOURCES += \
     maliit/settingdata.cpp \
+    maliit/keyfilter.cpp \
+    maliit/tracing.cpp \
 
 frameworkheaders.path += $$INCLUDEDIR/$$MALIIT_FRAMEWORK_HEADER/maliit
 frameworkheaders.files += $$FRAMEWORKHEADERSINSTALL
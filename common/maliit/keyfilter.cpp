@@ -0,0 +1,99 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "keyfilter.h"
+
+MImKeyFilter::MImKeyFilter()
+    : mRules()
+{
+}
+
+void MImKeyFilter::addKeyRange(int firstKey, int lastKey,
+                               Qt::KeyboardModifiers modifierMask,
+                               Qt::KeyboardModifiers modifiers,
+                               States states)
+{
+    const Rule rule = { qMin(firstKey, lastKey), qMax(firstKey, lastKey),
+                        modifierMask, modifiers & modifierMask, states };
+    mRules.append(rule);
+}
+
+void MImKeyFilter::addKey(int key,
+                          Qt::KeyboardModifiers modifierMask,
+                          Qt::KeyboardModifiers modifiers,
+                          States states)
+{
+    addKeyRange(key, key, modifierMask, modifiers, states);
+}
+
+bool MImKeyFilter::matchesAll() const
+{
+    return mRules.isEmpty();
+}
+
+bool MImKeyFilter::matches(int key, Qt::KeyboardModifiers modifiers, bool composing) const
+{
+    if (mRules.isEmpty()) {
+        return true;
+    }
+
+    const States state = composing ? ComposingState : IdleState;
+
+    Q_FOREACH (const Rule &rule, mRules) {
+        if (key >= rule.firstKey && key <= rule.lastKey
+            && (modifiers & rule.modifierMask) == rule.modifiers
+            && (rule.states == AnyState || (rule.states & state))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void MImKeyFilter::unite(const MImKeyFilter &other)
+{
+    if (mRules.isEmpty()) {
+        return;
+    }
+
+    if (other.mRules.isEmpty()) {
+        mRules.clear();
+        return;
+    }
+
+    Q_FOREACH (const Rule &rule, other.mRules) {
+        if (not mRules.contains(rule)) {
+            mRules.append(rule);
+        }
+    }
+}
+
+bool MImKeyFilter::operator==(const MImKeyFilter &other) const
+{
+    return mRules == other.mRules;
+}
+
+bool MImKeyFilter::operator!=(const MImKeyFilter &other) const
+{
+    return not (*this == other);
+}
+
+bool MImKeyFilter::Rule::operator==(const Rule &other) const
+{
+    return firstKey == other.firstKey
+        && lastKey == other.lastKey
+        && modifierMask == other.modifierMask
+        && modifiers == other.modifiers
+        && states == other.states;
+}
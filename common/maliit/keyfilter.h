@@ -0,0 +1,98 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MALIIT_KEYFILTER_H
+#define MALIIT_KEYFILTER_H
+
+#include <QList>
+#include <QtCore/qnamespace.h>
+
+/*!
+ * \brief Describes which redirected hardware key events an input method handles
+ *
+ * A filter is a list of rules. A key event matches the filter when it matches
+ * any of its rules; events that do not match are passed through to the
+ * application by the server without calling the input method.
+ *
+ * A rule matches keys from \a firstKey to \a lastKey (Qt::Key values) whose
+ * modifiers, masked with the rule's modifier mask, equal the rule's modifiers,
+ * while the server is in one of the rule's states.
+ *
+ * A filter without rules matches every key event, which is also what an input
+ * method that never sets a filter gets.
+ *
+ * \sa MAbstractInputMethodHost::setKeyFilter
+ */
+class MImKeyFilter
+{
+public:
+    enum State {
+        //! Any state
+        AnyState = 0,
+        //! While the input method shows preedit text
+        ComposingState = 0x1,
+        //! While there is no preedit text
+        IdleState = 0x2
+    };
+    Q_DECLARE_FLAGS(States, State)
+
+    MImKeyFilter();
+
+    /*!
+     * \brief Adds a rule matching keys \a firstKey to \a lastKey
+     * \param modifierMask Modifiers the rule looks at
+     * \param modifiers Required state of the modifiers in \a modifierMask
+     * \param states States the rule applies in, AnyState for all
+     */
+    void addKeyRange(int firstKey, int lastKey,
+                     Qt::KeyboardModifiers modifierMask = Qt::NoModifier,
+                     Qt::KeyboardModifiers modifiers = Qt::NoModifier,
+                     States states = AnyState);
+
+    //! Adds a rule matching \a key, see \a addKeyRange
+    void addKey(int key,
+                Qt::KeyboardModifiers modifierMask = Qt::NoModifier,
+                Qt::KeyboardModifiers modifiers = Qt::NoModifier,
+                States states = AnyState);
+
+    //! Returns true if the filter has no rules and matches every key event
+    bool matchesAll() const;
+
+    //! Returns true if a key event for \a key with \a modifiers matches the filter
+    //! \param composing Whether the input method currently shows preedit text
+    bool matches(int key, Qt::KeyboardModifiers modifiers, bool composing) const;
+
+    //! Extends the filter to also match what \a other matches
+    void unite(const MImKeyFilter &other);
+
+    bool operator==(const MImKeyFilter &other) const;
+    bool operator!=(const MImKeyFilter &other) const;
+
+private:
+    struct Rule {
+        int firstKey;
+        int lastKey;
+        Qt::KeyboardModifiers modifierMask;
+        Qt::KeyboardModifiers modifiers;
+        States states;
+
+        bool operator==(const Rule &other) const;
+    };
+
+    QList<Rule> mRules;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(MImKeyFilter::States)
+
+#endif // MALIIT_KEYFILTER_H
@@ -21,6 +21,31 @@ namespace Maliit { namespace Internal {
     //! Name of the input method hints stored in our update map.
     const char* const inputMethodHints = "maliit-inputmethod-hints";
 
+    //! Names of the widget state attributes known to the server, in the
+    //! order of the bits of MImEditorState::Field and MImUpdateEvent::PropertyId.
+    const char* const widgetStateKeys[] = {
+        "focusState",
+        "contentType",
+        "correctionEnabled",
+        "predictionEnabled",
+        "autocapitalizationEnabled",
+        "surroundingText",
+        "anchorPosition",
+        "cursorPosition",
+        "hasSelection",
+        "inputMethodMode",
+        "winId",
+        "cursorRectangle",
+        "hiddenText",
+        "preeditClickPos",
+        inputMethodHints,
+        "visualizationPriority",
+        "toolbarId",
+        "toolbar"
+    };
+
+    const int widgetStateKeyCount = sizeof(widgetStateKeys) / sizeof(widgetStateKeys[0]);
+
 }} // namespace Internal, Maliit
 
 #endif // NAMESPACEINTERNAL_H
@@ -0,0 +1,126 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "maliit/tracing.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QScopedPointer>
+#include <QThread>
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <time.h>
+#endif
+
+namespace
+{
+    const char * const Category = "maliit";
+
+    QFile *traceFile = 0;
+
+    qint64 timestamp()
+    {
+#ifdef Q_OS_UNIX
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return qint64(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+#else
+        QElapsedTimer timer;
+        timer.start();
+        return timer.msecsSinceReference() * 1000;
+#endif
+    }
+
+    QString escaped(const QString &string)
+    {
+        QString result = string;
+        result.replace('\\', "\\\\");
+        result.replace('"', "\\\"");
+        return result;
+    }
+
+    void write(const QByteArray &line)
+    {
+        if (traceFile->write(line) != line.size()) {
+            qWarning() << __PRETTY_FUNCTION__ << "Could not write trace event" << traceFile->errorString();
+        }
+    }
+}
+
+namespace Maliit { namespace Tracing {
+
+bool start(const QString &fileName, const QString &processName)
+{
+    stop();
+
+    // Unbuffered Append keeps each event a single write with O_APPEND
+    QScopedPointer<QFile> file(new QFile(fileName));
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not open trace file" << fileName << file->errorString();
+        return false;
+    }
+
+    traceFile = file.take();
+
+    // the closing bracket is optional in the JSON array format
+    if (traceFile->size() == 0) {
+        write("[\n");
+    }
+
+    write(QString("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%1,\"args\":{\"name\":\"%2\"}},\n")
+          .arg(QCoreApplication::applicationPid())
+          .arg(escaped(processName)).toUtf8());
+
+    return true;
+}
+
+bool startFromEnvironment(const QString &processName)
+{
+    const QByteArray fileName = qgetenv(TraceFileEnvironmentVariable);
+
+    if (fileName.isEmpty()) {
+        return false;
+    }
+
+    return start(QString::fromLocal8Bit(fileName), processName);
+}
+
+void stop()
+{
+    delete traceFile;
+    traceFile = 0;
+}
+
+bool isEnabled()
+{
+    return traceFile != 0;
+}
+
+void event(const char *name)
+{
+    if (!traceFile) {
+        return;
+    }
+
+    write(QString("{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%3,\"pid\":%4,\"tid\":%5},\n")
+          .arg(QString::fromLatin1(name))
+          .arg(Category)
+          .arg(timestamp())
+          .arg(QCoreApplication::applicationPid())
+          .arg(reinterpret_cast<quintptr>(QThread::currentThreadId())).toUtf8());
+}
+
+}} // namespace Tracing, Maliit
@@ -0,0 +1,49 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MALIIT_TRACING_H
+#define MALIIT_TRACING_H
+
+#include <QString>
+
+//! \internal
+namespace Maliit { namespace Tracing {
+
+    //! Name of the environment variable enabling tracing in input contexts
+    const char * const TraceFileEnvironmentVariable = "MALIIT_TRACE_FILE";
+
+    /*!
+     * \brief Starts appending trace events to \a fileName.
+     *
+     * Events are written in the JSON array flavour of the Chrome trace event
+     * format, which chrome://tracing and Perfetto load. Timestamps come from
+     * the monotonic clock, so the server and input contexts can write to the
+     * same file: each event is appended with a single write.
+     * \a processName labels the events of this process.
+     */
+    bool start(const QString &fileName, const QString &processName);
+
+    //! Starts tracing if MALIIT_TRACE_FILE is set
+    bool startFromEnvironment(const QString &processName);
+
+    void stop();
+
+    bool isEnabled();
+
+    //! Records that stage \a name was reached now. Call from the GUI thread only.
+    void event(const char *name);
+
+}} // namespace Tracing, Maliit
+
+#endif // MALIIT_TRACING_H
@@ -16,10 +16,20 @@ CONFIG += staticlib
 PUBLIC_HEADERS += \
     connectionfactory.h \
     minputcontextconnection.h \
+    mimoutboundmessage.h \
+    mimkeyeventbatch.h \
+    mimsurroundingtext.h \
+    mimutf8offsetindex.h \
+    mimeditorstate.h \
 
 PUBLIC_SOURCES += \
     connectionfactory.cpp \
     minputcontextconnection.cpp \
+    mimoutboundmessage.cpp \
+    mimkeyeventbatch.cpp \
+    mimsurroundingtext.cpp \
+    mimutf8offsetindex.cpp \
+    mimeditorstate.cpp \
 
 # Default to building qdbus based connection
 CONFIG += qdbus-dbus-connection
@@ -27,9 +37,11 @@ CONFIG += qdbus-dbus-connection
 wayland {
     QT += gui-private
     PUBLIC_SOURCES += \
-        waylandinputmethodconnection.cpp
+        waylandinputmethodconnection.cpp \
+        waylandkeysyms.cpp
     PUBLIC_HEADERS += \
-        waylandinputmethodconnection.h
+        waylandinputmethodconnection.h \
+        waylandkeysyms.h
 }
 
 include($$TOP_DIR/dbus_interfaces/dbus_interfaces.pri)
@@ -45,7 +57,7 @@ qdbus-dbus-connection {
 
     DBUS_ADAPTORS = server_adaptor context_adaptor
     DBUS_INTERFACES = $$DBUS_SERVER_XML $$DBUS_CONTEXT_XML
-    QDBUSXML2CPP_INTERFACE_HEADER_FLAGS = -i maliit/namespace.h -i maliit/settingdata.h
+    QDBUSXML2CPP_INTERFACE_HEADER_FLAGS = -i maliit/namespace.h -i maliit/settingdata.h -i mimoutboundmessage.h
 
     QT += dbus
 
@@ -60,6 +72,7 @@ qdbus-dbus-connection {
         mimserverconnection.h \
         dbusserverconnection.h \
         inputcontextdbusaddress.h \
+        sharedmemorychannel.h \
 
     PRIVATE_SOURCES += \
         dbuscustomarguments.cpp \
@@ -68,6 +81,7 @@ qdbus-dbus-connection {
         mimserverconnection.cpp \
         dbusserverconnection.cpp \
         inputcontextdbusaddress.cpp \
+        sharedmemorychannel.cpp \
 
     # DBus activation
     enable-dbus-activation {
@@ -23,17 +23,18 @@
 namespace Maliit {
 namespace DBus {
 
-MInputContextConnection *createInputContextConnectionWithDynamicAddress()
+MInputContextConnection *createInputContextConnectionWithDynamicAddress(bool sharedMemoryTransport)
 {
     QSharedPointer<Maliit::Server::DBus::Address> address(new Maliit::Server::DBus::DynamicAddress);
-    return new DBusInputContextConnection(address);
+    return new DBusInputContextConnection(address, sharedMemoryTransport);
 }
 
-MInputContextConnection *createInputContextConnectionWithFixedAddress(const QString &fixedAddress, bool allowAnonymous)
+MInputContextConnection *createInputContextConnectionWithFixedAddress(const QString &fixedAddress, bool allowAnonymous,
+                                                                      bool sharedMemoryTransport)
 {
     Q_UNUSED(allowAnonymous);
     QSharedPointer<Maliit::Server::DBus::Address> address(new Maliit::Server::DBus::FixedAddress(fixedAddress));
-    return new DBusInputContextConnection(address);
+    return new DBusInputContextConnection(address, sharedMemoryTransport);
 }
 
 } // namespace DBus
@@ -20,8 +20,9 @@
 namespace Maliit {
 namespace DBus {
 
-MInputContextConnection *createInputContextConnectionWithDynamicAddress();
-MInputContextConnection *createInputContextConnectionWithFixedAddress(const QString &fixedAddress, bool allowAnonymous);
+MInputContextConnection *createInputContextConnectionWithDynamicAddress(bool sharedMemoryTransport = false);
+MInputContextConnection *createInputContextConnectionWithFixedAddress(const QString &fixedAddress, bool allowAnonymous,
+                                                                      bool sharedMemoryTransport = false);
 
 } // namespace DBus
 
@@ -14,6 +14,7 @@
 #include "dbuscustomarguments.h"
 
 #include  <maliit/settingdata.h>
+#include "mimoutboundmessage.h"
 
 #include <QDBusArgument>
 
@@ -111,3 +112,68 @@ const QDBusArgument &operator>>(const QDBusArgument &arg, Maliit::PreeditTextFor
     return arg;
 }
 
+
+QDBusArgument &operator<<(QDBusArgument &argument, const MImOutboundMessage &message)
+{
+    argument.beginStructure();
+    argument << static_cast<int>(message.type);
+    argument << message.text;
+    argument << message.preeditFormats;
+    argument << message.replacementStart;
+    argument << message.replacementLength;
+    argument << message.cursorPos;
+    argument << message.keyType;
+    argument << message.key;
+    argument << message.modifiers;
+    argument << message.count;
+    argument << message.autoRepeat;
+    argument << static_cast<uchar>(message.requestType);
+    argument << message.extensionId;
+    argument << message.target;
+    argument << message.targetItem;
+    argument << message.attribute;
+    // see comment in MImPluginSettingsEntry marshalling
+    argument << message.value.isValid();
+    if (message.value.isValid())
+        argument << QDBusVariant(message.value);
+    else
+        argument << QDBusVariant(QVariant(0));
+    argument.endStructure();
+
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, MImOutboundMessage &message)
+{
+    int type;
+    uchar requestType;
+    bool valid_value;
+
+    argument.beginStructure();
+    argument >> type;
+    argument >> message.text;
+    argument >> message.preeditFormats;
+    argument >> message.replacementStart;
+    argument >> message.replacementLength;
+    argument >> message.cursorPos;
+    argument >> message.keyType;
+    argument >> message.key;
+    argument >> message.modifiers;
+    argument >> message.count;
+    argument >> message.autoRepeat;
+    argument >> requestType;
+    argument >> message.extensionId;
+    argument >> message.target;
+    argument >> message.targetItem;
+    argument >> message.attribute;
+    argument >> valid_value;
+    argument >> message.value;
+    if (!valid_value)
+        message.value = QVariant();
+    argument.endStructure();
+
+    message.type = static_cast<MImOutboundMessage::Type>(type);
+    message.requestType = static_cast<Maliit::EventRequestType>(requestType);
+
+    return argument;
+}
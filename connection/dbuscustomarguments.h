@@ -16,6 +16,7 @@
 
 class MImPluginSettingsEntry;
 class MImPluginSettingsInfo;
+struct MImOutboundMessage;
 class QDBusArgument;
 class QVariant;
 
@@ -33,4 +34,8 @@ const QDBusArgument &operator>>(const QDBusArgument &argument, MImPluginSettings
 QDBusArgument &operator<<(QDBusArgument &arg, const Maliit::PreeditTextFormat &format);
 const QDBusArgument &operator>>(const QDBusArgument &arg, Maliit::PreeditTextFormat &format);
 
+// MImOutboundMessage marshalling
+QDBusArgument &operator<<(QDBusArgument &argument, const MImOutboundMessage &message);
+const QDBusArgument &operator>>(const QDBusArgument &argument, MImOutboundMessage &message);
+
 #endif // DBUSCUSTOMARGUMENTS_H
@@ -17,10 +17,14 @@
 #include "minputmethodserver1interface_adaptor.h"
 #include "minputmethodcontext1interface_interface.h"
 #include "dbuscustomarguments.h"
+#include "sharedmemorychannel.h"
 
 #include <QDBusConnection>
+#include <QDBusError>
 #include <QDBusMessage>
+#include <QDBusPendingReply>
 #include <QDBusServer>
+#include <QDBusUnixFileDescriptor>
 
 #include <QKeyEvent>
 
@@ -37,14 +41,49 @@ const char * const DBusLocalPath("/org/freedesktop/DBus/Local");
 const char * const DBusLocalInterface("org.freedesktop.DBus.Local");
 const char * const DisconnectedSignal("Disconnected");
 
+// Deadline for queries to the application, so that a busy or hung
+// application cannot stall the input method for the full D-Bus timeout.
+const int ClientQueryTimeout(250); // in ms
+const char * const ConnectionIdProperty("connectionId");
+const char * const GenerationProperty("editorStateGeneration");
+
+bool preeditRectangleFromReply(const QDBusMessage &reply, QRect &rectangle, bool &valid)
+{
+    const QList<QVariant> arguments = reply.arguments();
+    if (reply.type() != QDBusMessage::ReplyMessage || arguments.count() != 5) {
+        return false;
+    }
+
+    valid = arguments.at(0).toBool();
+    rectangle = QRect(arguments.at(1).toInt(), arguments.at(2).toInt(),
+                      arguments.at(3).toInt(), arguments.at(4).toInt());
+    return true;
+}
+
+bool selectionFromReply(const QDBusMessage &reply, QString &selection, bool &valid)
+{
+    const QList<QVariant> arguments = reply.arguments();
+    if (reply.type() != QDBusMessage::ReplyMessage || arguments.count() != 2) {
+        return false;
+    }
+
+    valid = arguments.at(0).toBool();
+    selection = arguments.at(1).toString();
+    return true;
+}
+
 }
 
-DBusInputContextConnection::DBusInputContextConnection(const QSharedPointer<Maliit::Server::DBus::Address> &address)
+DBusInputContextConnection::DBusInputContextConnection(const QSharedPointer<Maliit::Server::DBus::Address> &address,
+                                                       bool sharedMemoryTransport)
     : MInputContextConnection(0)
     , mAddress(address)
     , mServer(mAddress->connect())
     , mConnectionNumbers()
     , mProxys()
+    , mSharedMemoryTransport(sharedMemoryTransport)
+    , mChannels()
+    , mPendingChannels()
     , lastLanguage()
 {
     connect(mServer.data(), SIGNAL(newConnection(QDBusConnection)), this, SLOT(newConnection(QDBusConnection)));
@@ -54,12 +93,16 @@ DBusInputContextConnection::DBusInputContextConnection(const QSharedPointer<Mali
     qDBusRegisterMetaType<QList<MImPluginSettingsInfo> >();
     qDBusRegisterMetaType<Maliit::PreeditTextFormat>();
     qDBusRegisterMetaType<QList<Maliit::PreeditTextFormat> >();
+    qDBusRegisterMetaType<MImOutboundMessage>();
+    qDBusRegisterMetaType<QList<MImOutboundMessage> >();
 
     new Uiserver1Adaptor(this);
 }
 
 DBusInputContextConnection::~DBusInputContextConnection()
 {
+    qDeleteAll(mChannels);
+    qDeleteAll(mPendingChannels);
 }
 
 void
@@ -83,6 +126,11 @@ DBusInputContextConnection::newConnection(const QDBusConnection &connection)
     c.registerObject(QString::fromLatin1(DBusPath), this);
 
     proxy->setLanguage(lastLanguage);
+
+    if (mSharedMemoryTransport
+        && (connection.connectionCapabilities() & QDBusConnection::UnixFileDescriptorPassing)) {
+        openSharedMemoryChannel(connectionNumber, proxy);
+    }
 }
 
 void
@@ -93,6 +141,8 @@ DBusInputContextConnection::onDisconnection()
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.take(connectionNumber);
     mConnections.remove(connectionNumber);
     delete proxy;
+    delete mChannels.take(connectionNumber);
+    delete mPendingChannels.take(connectionNumber);
     handleDisconnection(connectionNumber);
 }
 
@@ -105,10 +155,22 @@ DBusInputContextConnection::sendPreeditString(const QString &string,
     if (activeConnection) {
         MInputContextConnection::sendPreeditString(string, preeditFormats, replacementStart, replacementLength, cursorPos);
 
-        ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
-        if (proxy) {
-            proxy->updatePreedit(string, preeditFormats, replacementStart, replacementLength, cursorPos);
+        Maliit::DBus::SharedMemoryChannel *channel = sharedMemoryChannel(activeConnection);
+        if (channel) {
+            flushOutboundMessages();
+            if (channel->writeUpdatePreedit(string, preeditFormats, replacementStart,
+                                            replacementLength, cursorPos)) {
+                return;
+            }
         }
+
+        MImOutboundMessage message(MImOutboundMessage::UpdatePreedit);
+        message.text = string;
+        message.preeditFormats = preeditFormats;
+        message.replacementStart = replacementStart;
+        message.replacementLength = replacementLength;
+        message.cursorPos = cursorPos;
+        queueOutboundMessage(message);
     }
 }
 
@@ -119,10 +181,20 @@ DBusInputContextConnection::sendCommitString(const QString &string, int replaceS
     if (activeConnection) {
         MInputContextConnection::sendCommitString(string, replaceStart, replaceLength, cursorPos);
 
-        ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
-        if (proxy) {
-            proxy->commitString(string, replaceStart, replaceLength, cursorPos);
+        Maliit::DBus::SharedMemoryChannel *channel = sharedMemoryChannel(activeConnection);
+        if (channel) {
+            flushOutboundMessages();
+            if (channel->writeCommitString(string, replaceStart, replaceLength, cursorPos)) {
+                return;
+            }
         }
+
+        MImOutboundMessage message(MImOutboundMessage::CommitString);
+        message.text = string;
+        message.replacementStart = replaceStart;
+        message.replacementLength = replaceLength;
+        message.cursorPos = cursorPos;
+        queueOutboundMessage(message);
     }
 }
 
@@ -133,26 +205,43 @@ DBusInputContextConnection::sendKeyEvent(const QKeyEvent &keyEvent,
     if (activeConnection) {
         MInputContextConnection::sendKeyEvent(keyEvent, requestType);
 
-        ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
-        if (proxy) {
-            proxy->keyEvent(keyEvent.type(), keyEvent.key(), keyEvent.modifiers(),
-                            keyEvent.text(), keyEvent.isAutoRepeat(), keyEvent.count(), requestType);
+        Maliit::DBus::SharedMemoryChannel *channel = sharedMemoryChannel(activeConnection);
+        if (channel) {
+            flushOutboundMessages();
+            if (channel->writeKeyEvent(keyEvent.type(), keyEvent.key(), keyEvent.modifiers(),
+                                       keyEvent.text(), keyEvent.isAutoRepeat(),
+                                       keyEvent.count(), requestType)) {
+                return;
+            }
         }
+
+        MImOutboundMessage message(MImOutboundMessage::KeyEvent);
+        message.keyType = keyEvent.type();
+        message.key = keyEvent.key();
+        message.modifiers = keyEvent.modifiers();
+        message.text = keyEvent.text();
+        message.autoRepeat = keyEvent.isAutoRepeat();
+        message.count = keyEvent.count();
+        message.requestType = requestType;
+        queueOutboundMessage(message);
     }
 }
 
 void
 DBusInputContextConnection::notifyImInitiatedHiding()
 {
+    flushOutboundMessages();
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
     if (proxy) {
         proxy->imInitiatedHide();
+        addOutOfBandMessage(activeConnection);
     }
 }
 
 void
 DBusInputContextConnection::setGlobalCorrectionEnabled(bool enabled)
 {
+    flushOutboundMessages();
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
     if ((enabled != globalCorrectionEnabled()) && proxy) {
         proxy->setGlobalCorrectionEnabled(enabled);
@@ -163,21 +252,54 @@ DBusInputContextConnection::setGlobalCorrectionEnabled(bool enabled)
 QRect
 DBusInputContextConnection::preeditRectangle(bool &valid)
 {
-    ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
-    if (proxy) {
-        int x, y, width, height;
-        if (proxy->preeditRectangle(x, y, width, height)) {
-            valid = true;
-            return QRect(x, y, width, height);
+    flushOutboundMessages();
+    if (mConnections.contains(activeConnection)) {
+        const QDBusMessage reply = QDBusConnection(mConnections.value(activeConnection))
+            .call(clientQuery("preeditRectangle"), QDBus::Block, ClientQueryTimeout);
+
+        QRect rectangle;
+        bool rectangleValid = false;
+        if (preeditRectangleFromReply(reply, rectangle, rectangleValid)) {
+            setLastPreeditRectangle(rectangle, rectangleValid);
         }
     }
-    valid = false;
-    return QRect();
+
+    // A failed or timed out query answers with the last reply, which is
+    // invalid once the editor state changed after it was received
+    return lastPreeditRectangle(valid);
+}
+
+void
+DBusInputContextConnection::requestPreeditRectangle()
+{
+    sendClientQuery("preeditRectangle", SLOT(preeditRectangleQueryFinished(QDBusPendingCallWatcher*)));
+}
+
+void
+DBusInputContextConnection::preeditRectangleQueryFinished(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+
+    // Ignore late answers from an application that is no longer active
+    // or that describe an editor state which changed meanwhile
+    if (watcher->property(ConnectionIdProperty).toUInt() == activeConnection
+        && watcher->property(GenerationProperty).toULongLong() == editorStateGeneration()) {
+        QRect rectangle;
+        bool rectangleValid = false;
+        if (preeditRectangleFromReply(watcher->reply(), rectangle, rectangleValid)) {
+            setLastPreeditRectangle(rectangle, rectangleValid);
+        }
+    }
+
+    bool valid = false;
+    const QRect rectangle = lastPreeditRectangle(valid);
+    Q_EMIT preeditRectangleReceived(rectangle, valid);
 }
 
 void
 DBusInputContextConnection::setRedirectKeys(bool enabled)
 {
+    flushOutboundMessages();
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
     if ((enabled != redirectKeysEnabled()) && proxy) {
         proxy->setRedirectKeys(enabled);
@@ -188,6 +310,7 @@ DBusInputContextConnection::setRedirectKeys(bool enabled)
 void
 DBusInputContextConnection::setDetectableAutoRepeat(bool enabled)
 {
+    flushOutboundMessages();
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
     if ((enabled != detectableAutoRepeat()) && proxy) {
         proxy->setDetectableAutoRepeat(enabled);
@@ -199,6 +322,7 @@ void
 DBusInputContextConnection::invokeAction(const QString &action,
                                          const QKeySequence &sequence)
 {
+    flushOutboundMessages();
     if (activeConnection) {
         QDBusMessage message = QDBusMessage::createSignal(DBusPath, DBusInterface, "invokeAction");
         QList<QVariant> arguments;
@@ -211,30 +335,63 @@ DBusInputContextConnection::invokeAction(const QString &action,
 void
 DBusInputContextConnection::setSelection(int start, int length)
 {
+    flushOutboundMessages();
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
     if (proxy) {
         proxy->setSelection(start, length);
+        addOutOfBandMessage(activeConnection);
     }
 }
 
 QString
 DBusInputContextConnection::selection(bool &valid)
 {
-    ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
-    if (proxy) {
+    flushOutboundMessages();
+    if (mConnections.contains(activeConnection)) {
+        const QDBusMessage reply = QDBusConnection(mConnections.value(activeConnection))
+            .call(clientQuery("selection"), QDBus::Block, ClientQueryTimeout);
+
+        QString selectionText;
+        bool selectionValid = false;
+        if (selectionFromReply(reply, selectionText, selectionValid)) {
+            setLastSelection(selectionText, selectionValid);
+        }
+    }
+
+    // See preeditRectangle()
+    return lastSelection(valid);
+}
+
+void
+DBusInputContextConnection::requestSelection()
+{
+    sendClientQuery("selection", SLOT(selectionQueryFinished(QDBusPendingCallWatcher*)));
+}
+
+void
+DBusInputContextConnection::selectionQueryFinished(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+
+    // See preeditRectangleQueryFinished()
+    if (watcher->property(ConnectionIdProperty).toUInt() == activeConnection
+        && watcher->property(GenerationProperty).toULongLong() == editorStateGeneration()) {
         QString selectionText;
-        if (proxy->selection(selectionText)) {
-            valid = true;
-            return selectionText;
+        bool selectionValid = false;
+        if (selectionFromReply(watcher->reply(), selectionText, selectionValid)) {
+            setLastSelection(selectionText, selectionValid);
         }
     }
-    valid = false;
-    return QString();
+
+    bool valid = false;
+    const QString selectionText = lastSelection(valid);
+    Q_EMIT selectionReceived(selectionText, valid);
 }
 
 void
 DBusInputContextConnection::setLanguage(const QString &language)
 {
+    flushOutboundMessages();
     lastLanguage = language;
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
     if (proxy) {
@@ -245,15 +402,18 @@ DBusInputContextConnection::setLanguage(const QString &language)
 void
 DBusInputContextConnection::sendActivationLostEvent()
 {
+    flushOutboundMessages();
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
     if (proxy) {
         proxy->activationLostEvent();
+        addOutOfBandMessage(activeConnection);
     }
 }
 
 void
 DBusInputContextConnection::updateInputMethodArea(const QRegion &region)
 {
+    flushOutboundMessages();
     qDebug() << "Updating input method area to" << region;
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
     if (proxy) {
@@ -269,10 +429,13 @@ DBusInputContextConnection::notifyExtendedAttributeChanged(int id,
                                                            const QString &attribute,
                                                            const QVariant &value)
 {
-    ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(activeConnection);
-    if (proxy) {
-        proxy->notifyExtendedAttributeChanged(id, target, targetItem, attribute, QDBusVariant(value));
-    }
+    MImOutboundMessage message(MImOutboundMessage::ExtendedAttributeChanged);
+    message.extensionId = id;
+    message.target = target;
+    message.targetItem = targetItem;
+    message.attribute = attribute;
+    message.value = value;
+    queueOutboundMessage(message);
 }
 
 void
@@ -283,6 +446,8 @@ DBusInputContextConnection::notifyExtendedAttributeChanged(const QList<int> &cli
                                                            const QString &attribute,
                                                            const QVariant &value)
 {
+    flushOutboundMessages();
+
     Q_FOREACH (int clientId, clientIds) {
         ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(clientId);
         if (proxy) {
@@ -294,6 +459,8 @@ DBusInputContextConnection::notifyExtendedAttributeChanged(const QList<int> &cli
 void
 DBusInputContextConnection::pluginSettingsLoaded(int clientId, const QList<MImPluginSettingsInfo> &info)
 {
+    flushOutboundMessages();
+
     ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(clientId);
     if (proxy) {
         proxy->pluginSettingsLoaded(info);
@@ -307,6 +474,149 @@ DBusInputContextConnection::connectionNumber()
     return mConnectionNumbers.value(connection().name());
 }
 
+QDBusMessage
+DBusInputContextConnection::clientQuery(const char *method) const
+{
+    return QDBusMessage::createMethodCall(QString(), QString::fromLatin1(DBusClientPath),
+                                          QString::fromLatin1(DBusClientInterface),
+                                          QString::fromLatin1(method));
+}
+
+void
+DBusInputContextConnection::sendClientQuery(const char *method, const char *finishedSlot)
+{
+    flushOutboundMessages();
+
+    QDBusPendingCall call = QDBusPendingCall::fromError(QDBusError(QDBusError::Disconnected,
+                                                                   QString::fromLatin1("No active connection")));
+
+    if (mConnections.contains(activeConnection)) {
+        call = QDBusConnection(mConnections.value(activeConnection))
+            .asyncCall(clientQuery(method), ClientQueryTimeout);
+    }
+
+    // An already failed call finishes on the next event loop iteration,
+    // answering with the last reply if it is still current.
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+    watcher->setProperty(ConnectionIdProperty, activeConnection);
+    watcher->setProperty(GenerationProperty, editorStateGeneration());
+    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, finishedSlot);
+}
+
+void
+DBusInputContextConnection::sendOutboundMessages(unsigned int connectionId,
+                                                 const QList<MImOutboundMessage> &messages)
+{
+    ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(connectionId);
+    if (!proxy) {
+        return;
+    }
+
+    // A lone message keeps its own, smaller D-Bus message
+    if (messages.count() > 1) {
+        proxy->applyBatch(messages);
+        addOutOfBandMessage(connectionId);
+        return;
+    }
+
+    const MImOutboundMessage &message = messages.first();
+    switch (message.type) {
+    case MImOutboundMessage::CommitString:
+        proxy->commitString(message.text, message.replacementStart,
+                            message.replacementLength, message.cursorPos);
+        break;
+    case MImOutboundMessage::UpdatePreedit:
+        proxy->updatePreedit(message.text, message.preeditFormats, message.replacementStart,
+                             message.replacementLength, message.cursorPos);
+        break;
+    case MImOutboundMessage::KeyEvent:
+        proxy->keyEvent(message.keyType, message.key, message.modifiers, message.text,
+                        message.autoRepeat, message.count, message.requestType);
+        break;
+    case MImOutboundMessage::ExtendedAttributeChanged:
+        proxy->notifyExtendedAttributeChanged(message.extensionId, message.target, message.targetItem,
+                                              message.attribute, QDBusVariant(message.value));
+        // Not ordered against the shared memory channel
+        return;
+    }
+
+    addOutOfBandMessage(connectionId);
+}
+
+void
+DBusInputContextConnection::sendKeyEventsProcessed(unsigned int connectionId, quint32 lastSerial,
+                                                   const QList<uint> &passedThrough)
+{
+    ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(connectionId);
+    if (proxy) {
+        proxy->keyEventsProcessed(lastSerial, passedThrough);
+        addOutOfBandMessage(connectionId);
+    }
+}
+
+void
+DBusInputContextConnection::openSharedMemoryChannel(unsigned int connectionNumber,
+                                                    ComMeegoInputmethodInputcontext1Interface *proxy)
+{
+    Maliit::DBus::SharedMemoryChannel *channel = new Maliit::DBus::SharedMemoryChannel;
+    if (!channel->create()) {
+        delete channel;
+        return;
+    }
+
+    // Messages sent from now on are counted, the client starts counting
+    // when it receives the channel.
+    mPendingChannels.insert(connectionNumber, channel);
+
+    QDBusPendingCall call = proxy->openSharedMemoryChannel(QDBusUnixFileDescriptor(channel->memoryFd()),
+                                                           QDBusUnixFileDescriptor(channel->notifyFd()));
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+    watcher->setProperty(ConnectionIdProperty, connectionNumber);
+    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
+            this, SLOT(sharedMemoryChannelOpened(QDBusPendingCallWatcher*)));
+}
+
+void
+DBusInputContextConnection::sharedMemoryChannelOpened(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+
+    const unsigned int number = watcher->property(ConnectionIdProperty).toUInt();
+    Maliit::DBus::SharedMemoryChannel *channel = mPendingChannels.take(number);
+    if (!channel) {
+        // Client disconnected in the meantime
+        return;
+    }
+
+    QDBusPendingReply<bool> reply = *watcher;
+    if (reply.isError() || !reply.value()) {
+        qDebug() << "Client" << number << "does not use the shared memory channel";
+        delete channel;
+        return;
+    }
+
+    mChannels.insert(number, channel);
+}
+
+Maliit::DBus::SharedMemoryChannel *
+DBusInputContextConnection::sharedMemoryChannel(unsigned int connectionNumber) const
+{
+    return mChannels.value(connectionNumber);
+}
+
+void
+DBusInputContextConnection::addOutOfBandMessage(unsigned int connectionNumber)
+{
+    Maliit::DBus::SharedMemoryChannel *channel = mChannels.value(connectionNumber);
+    if (!channel) {
+        channel = mPendingChannels.value(connectionNumber);
+    }
+
+    if (channel) {
+        channel->addOutOfBandMessage();
+    }
+}
+
 void DBusInputContextConnection::activateContext()
 {
     MInputContextConnection::activateContext(connectionNumber());
@@ -337,6 +647,26 @@ void DBusInputContextConnection::updateWidgetInformation(const QVariantMap &stat
     MInputContextConnection::updateWidgetInformation(connectionNumber(), stateInformation, focusChanged);
 }
 
+void DBusInputContextConnection::updateWidgetInformationDelta(uint baseVersion, uint version,
+                                                              const QVariantMap &changedInformation,
+                                                              const QStringList &removedKeys,
+                                                              int textSpliceStart, int textSpliceLength,
+                                                              const QString &textSpliceText, bool focusChanged)
+{
+    const unsigned int number = connectionNumber();
+
+    if (!MInputContextConnection::updateWidgetInformationDelta(number, baseVersion, version,
+                                                              changedInformation, removedKeys,
+                                                              textSpliceStart, textSpliceLength,
+                                                              textSpliceText, focusChanged)) {
+        // Client and server disagree about the base state, ask for a full one
+        ComMeegoInputmethodInputcontext1Interface *proxy = mProxys.value(number);
+        if (proxy) {
+            proxy->requestWidgetStateSnapshot();
+        }
+    }
+}
+
 void DBusInputContextConnection::reset()
 {
     MInputContextConnection::reset(connectionNumber());
@@ -362,6 +692,11 @@ void DBusInputContextConnection::processKeyEvent(int keyType, int keyCode, int m
     MInputContextConnection::processKeyEvent(connectionNumber(), static_cast<QEvent::Type>(keyType), static_cast<Qt::Key>(keyCode), static_cast<Qt::KeyboardModifier>(modifiers), text, autoRepeat, count, nativeScanCode, nativeModifiers, time);
 }
 
+void DBusInputContextConnection::processKeyEvents(const QByteArray &records)
+{
+    MInputContextConnection::processKeyEvents(connectionNumber(), MImKeyEventBatch(records));
+}
+
 void DBusInputContextConnection::registerAttributeExtension(int id, const QString &fileName)
 {
     MInputContextConnection::registerAttributeExtension(connectionNumber(), id, fileName);
@@ -377,6 +712,11 @@ void DBusInputContextConnection::setExtendedAttribute(int id, const QString &tar
     MInputContextConnection::setExtendedAttribute(connectionNumber(), id, target, targetItem, attribute, value.variant());
 }
 
+void DBusInputContextConnection::setExtendedAttributes(int id, const QString &target, const QString &targetItem, const QVariantMap &attributes)
+{
+    MInputContextConnection::setExtendedAttributes(connectionNumber(), id, target, targetItem, attributes);
+}
+
 void DBusInputContextConnection::loadPluginSettings(const QString &descriptionLanguage)
 {
     MInputContextConnection::loadPluginSettings(connectionNumber(), descriptionLanguage);
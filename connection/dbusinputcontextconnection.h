@@ -20,17 +20,31 @@
 #include "serverdbusaddress.h"
 
 #include <QDBusContext>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
 #include <QDBusVariant>
 #include <QHash>
 
 class ComMeegoInputmethodInputcontext1Interface;
 
+namespace Maliit {
+namespace DBus {
+class SharedMemoryChannel;
+}
+}
+
 class DBusInputContextConnection : public MInputContextConnection,
                                    protected QDBusContext
 {
     Q_OBJECT
 public:
-    explicit DBusInputContextConnection(const QSharedPointer<Maliit::Server::DBus::Address> &address);
+    /*!
+     * \param address Address to listen on for input context connections
+     * \param sharedMemoryTransport If true, offer clients a shared memory channel
+     * for commit, preedit and key event messages
+     */
+    explicit DBusInputContextConnection(const QSharedPointer<Maliit::Server::DBus::Address> &address,
+                                        bool sharedMemoryTransport = false);
     ~DBusInputContextConnection();
 
     //! \reimp
@@ -46,12 +60,14 @@ public:
 
     virtual void setGlobalCorrectionEnabled(bool);
     virtual QRect preeditRectangle(bool &valid);
+    virtual void requestPreeditRectangle();
     virtual void setRedirectKeys(bool enabled);
     virtual void setDetectableAutoRepeat(bool enabled);
     virtual void invokeAction(const QString &action,
                             const QKeySequence &sequence);
     virtual void setSelection(int start, int length);
     virtual QString selection(bool &valid);
+    virtual void requestSelection();
     virtual void setLanguage(const QString &language);
     virtual void sendActivationLostEvent();
     virtual void updateInputMethodArea(const QRegion &region);
@@ -75,22 +91,48 @@ public:
     void mouseClickedOnPreedit(int posX, int posY, int preeditRectX, int preeditRectY, int preeditRectWidth, int preeditRectHeight);
     void setPreedit(const QString &text, int cursorPos);
     void updateWidgetInformation(const QVariantMap &stateInformation, bool focusChanged);
+    void updateWidgetInformationDelta(uint baseVersion, uint version,
+                                      const QVariantMap &changedInformation,
+                                      const QStringList &removedKeys,
+                                      int textSpliceStart, int textSpliceLength,
+                                      const QString &textSpliceText, bool focusChanged);
     void reset();
     void appOrientationAboutToChange(int angle);
     void appOrientationChanged(int angle);
     void setCopyPasteState(bool copyAvailable, bool pasteAvailable);
     void processKeyEvent(int keyType, int keyCode, int modifiers, const QString &text, bool autoRepeat, int count, uint nativeScanCode, uint nativeModifiers, uint time);
+    void processKeyEvents(const QByteArray &records);
     void registerAttributeExtension(int id, const QString &fileName);
     void unregisterAttributeExtension(int id);
     void setExtendedAttribute(int id, const QString &target, const QString &targetItem, const QString &attribute, const QDBusVariant &value);
+    void setExtendedAttributes(int id, const QString &target, const QString &targetItem, const QVariantMap &attributes);
     void loadPluginSettings(const QString &descriptionLanguage);
 
 private Q_SLOTS:
     void newConnection(const QDBusConnection &connection);
     void onDisconnection();
+    void preeditRectangleQueryFinished(QDBusPendingCallWatcher *watcher);
+    void selectionQueryFinished(QDBusPendingCallWatcher *watcher);
+    void sharedMemoryChannelOpened(QDBusPendingCallWatcher *watcher);
+
+protected:
+    //! \reimp
+    virtual void sendOutboundMessages(unsigned int connectionId,
+                                      const QList<MImOutboundMessage> &messages);
+    virtual void sendKeyEventsProcessed(unsigned int connectionId, quint32 lastSerial,
+                                        const QList<uint> &passedThrough);
+    //! \reimp_end
 
 private:
     unsigned int connectionNumber();
+    QDBusMessage clientQuery(const char *method) const;
+    void sendClientQuery(const char *method, const char *finishedSlot);
+    void openSharedMemoryChannel(unsigned int connectionNumber,
+                                 ComMeegoInputmethodInputcontext1Interface *proxy);
+    //! Returns the accepted shared memory channel of \a connectionNumber, or 0
+    Maliit::DBus::SharedMemoryChannel *sharedMemoryChannel(unsigned int connectionNumber) const;
+    //! Keeps ordering between D-Bus and the shared memory channel, see SharedMemoryChannel
+    void addOutOfBandMessage(unsigned int connectionNumber);
 
     const QSharedPointer<Maliit::Server::DBus::Address> mAddress;
     QScopedPointer<QDBusServer> mServer;
@@ -98,6 +140,10 @@ private:
     QHash<unsigned int, ComMeegoInputmethodInputcontext1Interface *> mProxys;
     QHash<unsigned int, QString> mConnections;
 
+    const bool mSharedMemoryTransport;
+    QHash<unsigned int, Maliit::DBus::SharedMemoryChannel *> mChannels;
+    QHash<unsigned int, Maliit::DBus::SharedMemoryChannel *> mPendingChannels;
+
     QString lastLanguage;
 };
 
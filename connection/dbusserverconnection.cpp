@@ -20,8 +20,11 @@
 #include "minputmethodcontext1interface_adaptor.h"
 #include "minputmethodserver1interface_interface.h"
 #include "dbuscustomarguments.h"
+#include "sharedmemorychannel.h"
 
 #include <QDBusConnection>
+#include <QDBusUnixFileDescriptor>
+#include <QSocketNotifier>
 #include <QDebug>
 
 namespace
@@ -33,6 +36,33 @@ namespace
     const char * const DBusLocalInterface("org.freedesktop.DBus.Local");
     const char * const DisconnectedSignal("Disconnected");
     const int ConnectionRetryInterval(6*1000); // in ms
+    const char * const SurroundingTextAttribute("surroundingText");
+
+    //! Finds the smallest range of \a oldText that needs to be replaced to get \a newText
+    void textSplice(const QString &oldText, const QString &newText,
+                    int &start, int &length, QString &replacement)
+    {
+        const int oldLength = oldText.length();
+        const int newLength = newText.length();
+        const QChar *oldData = oldText.constData();
+        const QChar *newData = newText.constData();
+
+        int prefix = 0;
+        while (prefix < oldLength && prefix < newLength
+               && oldData[prefix] == newData[prefix]) {
+            ++prefix;
+        }
+
+        int suffix = 0;
+        while (suffix < oldLength - prefix && suffix < newLength - prefix
+               && oldData[oldLength - suffix - 1] == newData[newLength - suffix - 1]) {
+            ++suffix;
+        }
+
+        start = prefix;
+        length = oldLength - prefix - suffix;
+        replacement = newText.mid(prefix, newLength - prefix - suffix);
+    }
 }
 
 DBusServerConnection::DBusServerConnection(const QSharedPointer<Maliit::InputContext::DBus::Address> &address) :
@@ -41,15 +71,31 @@ DBusServerConnection::DBusServerConnection(const QSharedPointer<Maliit::InputCon
   , mProxy(0)
   , mActive(true)
   , pendingResetCalls()
+  , mWidgetState()
+  , mWidgetStateVersion(0)
+  , mWidgetStateSent(false)
+  , mChannel(0)
+  , mChannelNotifier(0)
+  , mKeyEvents()
+  , mPendingKeyEvents()
+  , mKeyEventSerial(0)
+  , mKeyEventTimer()
 {
     qDBusRegisterMetaType<MImPluginSettingsEntry>();
     qDBusRegisterMetaType<MImPluginSettingsInfo>();
     qDBusRegisterMetaType<QList<MImPluginSettingsInfo> >();
     qDBusRegisterMetaType<Maliit::PreeditTextFormat>();
     qDBusRegisterMetaType<QList<Maliit::PreeditTextFormat> >();
+    qDBusRegisterMetaType<MImOutboundMessage>();
+    qDBusRegisterMetaType<QList<MImOutboundMessage> >();
 
     new Inputcontext1Adaptor(this);
 
+    mKeyEventTimer.setSingleShot(true);
+    mKeyEventTimer.setInterval(0);
+    connect(&mKeyEventTimer, SIGNAL(timeout()),
+            this, SLOT(flushKeyEvents()));
+
     connect(mAddress.data(), SIGNAL(addressReceived(QString)),
             this, SLOT(openDBusConnection(QString)));
     connect(mAddress.data(), SIGNAL(addressFetchError(QString)),
@@ -65,6 +111,7 @@ DBusServerConnection::~DBusServerConnection()
         disconnect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
                    this, SLOT(resetCallFinished(QDBusPendingCallWatcher*)));
     }
+    closeSharedMemoryChannel();
 }
 
 void DBusServerConnection::connectToDBus()
@@ -86,6 +133,8 @@ void DBusServerConnection::openDBusConnection(const QString &addressString)
     }
 
     mProxy = new ComMeegoInputmethodUiserver1Interface(QString(), QString::fromLatin1(IMServerPath), connection, this);
+    mWidgetStateSent = false;
+    closeSharedMemoryChannel();
 
     connection.connect(QString(), QString::fromLatin1(DBusLocalPath), QString::fromLatin1(DBusLocalInterface),
                        QString::fromLatin1(DisconnectedSignal),
@@ -106,6 +155,11 @@ void DBusServerConnection::connectToDBusFailed(const QString &)
 
 void DBusServerConnection::onDisconnection()
 {
+    // Deliver what the server managed to write before it went away
+    readSharedMemoryChannel();
+    closeSharedMemoryChannel();
+    passThroughPendingKeyEvents();
+
     delete mProxy;
     mProxy = 0;
     QDBusConnection::disconnectFromPeer(QString::fromLatin1(IMServerConnection));
@@ -131,6 +185,7 @@ void DBusServerConnection::activateContext()
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->activateContext();
 }
 
@@ -139,6 +194,7 @@ void DBusServerConnection::showInputMethod()
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->showInputMethod();
 }
 
@@ -147,6 +203,7 @@ void DBusServerConnection::hideInputMethod()
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->hideInputMethod();
 }
 
@@ -155,6 +212,7 @@ void DBusServerConnection::mouseClickedOnPreedit(const QPoint &pos, const QRect
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->mouseClickedOnPreedit(pos.x(), pos.y(), preeditRect.x(), preeditRect.y(),
                                   preeditRect.width(), preeditRect.height());
 }
@@ -164,6 +222,7 @@ void DBusServerConnection::setPreedit(const QString &text, int cursorPos)
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->setPreedit(text, cursorPos);
 }
 
@@ -172,7 +231,60 @@ void DBusServerConnection::updateWidgetInformation(const QMap<QString, QVariant>
     if (!mProxy)
         return;
 
-    mProxy->updateWidgetInformation(stateInformation, focusChanged);
+    flushKeyEvents();
+
+    // Focus changes replace most of the state anyway, so send them in full.
+    if (focusChanged || !mWidgetStateSent) {
+        mProxy->updateWidgetInformation(stateInformation, focusChanged);
+        mWidgetState = stateInformation;
+        mWidgetStateVersion = 0;
+        mWidgetStateSent = true;
+        return;
+    }
+
+    QVariantMap changedInformation;
+    QStringList removedKeys;
+    int textSpliceStart = -1;
+    int textSpliceLength = 0;
+    QString textSpliceText;
+
+    for (QMap<QString, QVariant>::const_iterator iter = stateInformation.constBegin();
+         iter != stateInformation.constEnd();
+         ++iter)
+    {
+        QMap<QString, QVariant>::const_iterator old = mWidgetState.constFind(iter.key());
+
+        if (old == mWidgetState.constEnd()) {
+            changedInformation.insert(iter.key(), iter.value());
+        } else if (old.value() != iter.value()) {
+            if (iter.key() == SurroundingTextAttribute) {
+                textSplice(old.value().toString(), iter.value().toString(),
+                           textSpliceStart, textSpliceLength, textSpliceText);
+            } else {
+                changedInformation.insert(iter.key(), iter.value());
+            }
+        }
+    }
+
+    for (QMap<QString, QVariant>::const_iterator iter = mWidgetState.constBegin();
+         iter != mWidgetState.constEnd();
+         ++iter)
+    {
+        if (!stateInformation.contains(iter.key())) {
+            removedKeys.append(iter.key());
+        }
+    }
+
+    if (changedInformation.isEmpty() && removedKeys.isEmpty() && textSpliceStart < 0) {
+        return;
+    }
+
+    mProxy->updateWidgetInformationDelta(mWidgetStateVersion, mWidgetStateVersion + 1,
+                                         changedInformation, removedKeys,
+                                         textSpliceStart, textSpliceLength, textSpliceText,
+                                         focusChanged);
+    mWidgetState = stateInformation;
+    ++mWidgetStateVersion;
 }
 
 void DBusServerConnection::reset(bool requireSynchronization)
@@ -180,6 +292,8 @@ void DBusServerConnection::reset(bool requireSynchronization)
     if (!mProxy)
         return;
 
+    flushKeyEvents();
+
     QDBusPendingCall resetCall = mProxy->reset();
     if (requireSynchronization) {
         QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(resetCall, this);
@@ -194,6 +308,7 @@ void DBusServerConnection::appOrientationAboutToChange(int angle)
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->appOrientationAboutToChange(angle);
 }
 
@@ -202,6 +317,7 @@ void DBusServerConnection::appOrientationChanged(int angle)
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->appOrientationChanged(angle);
 }
 
@@ -210,25 +326,58 @@ void DBusServerConnection::setCopyPasteState(bool copyAvailable, bool pasteAvail
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->setCopyPasteState(copyAvailable, pasteAvailable);
 }
 
 void DBusServerConnection::processKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
                                            Qt::KeyboardModifiers modifiers,
                                            const QString &text, bool autoRepeat, int count,
-                                           quint32 nativeScanCode, quint32 nativeModifiers, unsigned long time)
+                                           quint32 nativeScanCode, quint32 nativeVirtualKey,
+                                           quint32 nativeModifiers, unsigned long time)
 {
     if (!mProxy)
         return;
 
+    if (mKeyEvents.append(++mKeyEventSerial, keyType, keyCode, modifiers, text, autoRepeat, count,
+                          nativeScanCode, nativeVirtualKey, nativeModifiers, time)) {
+        if (!mKeyEventTimer.isActive()) {
+            mKeyEventTimer.start();
+        }
+        return;
+    }
+
+    // Text too long for a record, the server sends such events back itself
+    flushKeyEvents();
     mProxy->processKeyEvent(keyType, keyCode, modifiers, text, autoRepeat, count, nativeScanCode, nativeModifiers, time);
 }
 
+void DBusServerConnection::flushKeyEvents()
+{
+    mKeyEventTimer.stop();
+
+    if (mKeyEvents.isEmpty())
+        return;
+
+    if (!mProxy) {
+        passThroughPendingKeyEvents();
+        return;
+    }
+
+    for (int i = 0; i < mKeyEvents.count(); ++i) {
+        mPendingKeyEvents.append(mKeyEvents.at(i));
+    }
+
+    mProxy->processKeyEvents(mKeyEvents.data());
+    mKeyEvents.clear();
+}
+
 void DBusServerConnection::registerAttributeExtension(int id, const QString &fileName)
 {
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->registerAttributeExtension(id, fileName);
 }
 
@@ -237,6 +386,7 @@ void DBusServerConnection::unregisterAttributeExtension(int id)
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->unregisterAttributeExtension(id);
 }
 
@@ -246,14 +396,26 @@ void DBusServerConnection::setExtendedAttribute(int id, const QString &target, c
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->setExtendedAttribute(id, target, targetItem, attribute, QDBusVariant(value));
 }
 
+void DBusServerConnection::setExtendedAttributes(int id, const QString &target, const QString &targetItem,
+                                                 const QVariantMap &attributes)
+{
+    if (!mProxy)
+        return;
+
+    flushKeyEvents();
+    mProxy->setExtendedAttributes(id, target, targetItem, attributes);
+}
+
 void DBusServerConnection::loadPluginSettings(const QString &descriptionLanguage)
 {
     if (!mProxy)
         return;
 
+    flushKeyEvents();
     mProxy->loadPluginSettings(descriptionLanguage);
 }
 
@@ -263,10 +425,137 @@ void DBusServerConnection::pluginSettingsLoaded(const QList<MImPluginSettingsInf
     pluginSettingsReceived(info);
 }
 
+void DBusServerConnection::activationLostEvent()
+{
+    readSharedMemoryChannel();
+    MImServerConnection::activationLostEvent();
+    handledOutOfBandMessage();
+}
+
+void DBusServerConnection::imInitiatedHide()
+{
+    readSharedMemoryChannel();
+    MImServerConnection::imInitiatedHide();
+    handledOutOfBandMessage();
+}
+
+void DBusServerConnection::commitString(const QString &string, int replacementStart,
+                                        int replacementLength, int cursorPos)
+{
+    readSharedMemoryChannel();
+    MImServerConnection::commitString(string, replacementStart, replacementLength, cursorPos);
+    handledOutOfBandMessage();
+}
+
+void DBusServerConnection::updatePreedit(const QString &string,
+                                         const QList<Maliit::PreeditTextFormat> &preeditFormats,
+                                         int replacementStart, int replacementLength, int cursorPos)
+{
+    readSharedMemoryChannel();
+    MImServerConnection::updatePreedit(string, preeditFormats, replacementStart, replacementLength, cursorPos);
+    handledOutOfBandMessage();
+}
+
 void DBusServerConnection::keyEvent(int type, int key, int modifiers, const QString &text, bool autoRepeat,
                                     int count, uchar requestType)
 {
+    readSharedMemoryChannel();
     keyEvent(type, key, modifiers, text, autoRepeat, count, static_cast<Maliit::EventRequestType>(requestType));
+    handledOutOfBandMessage();
+}
+
+void DBusServerConnection::setSelection(int start, int length)
+{
+    readSharedMemoryChannel();
+    MImServerConnection::setSelection(start, length);
+    handledOutOfBandMessage();
+}
+
+void DBusServerConnection::applyBatch(const QList<MImOutboundMessage> &messages)
+{
+    readSharedMemoryChannel();
+
+    Q_EMIT batchStarted();
+
+    Q_FOREACH (const MImOutboundMessage &message, messages) {
+        switch (message.type) {
+        case MImOutboundMessage::CommitString:
+            MImServerConnection::commitString(message.text, message.replacementStart,
+                                              message.replacementLength, message.cursorPos);
+            break;
+        case MImOutboundMessage::UpdatePreedit:
+            MImServerConnection::updatePreedit(message.text, message.preeditFormats, message.replacementStart,
+                                               message.replacementLength, message.cursorPos);
+            break;
+        case MImOutboundMessage::KeyEvent:
+            MImServerConnection::keyEvent(message.keyType, message.key, message.modifiers, message.text,
+                                          message.autoRepeat, message.count, message.requestType);
+            break;
+        case MImOutboundMessage::ExtendedAttributeChanged:
+            Q_EMIT extendedAttributeChanged(message.extensionId, message.target, message.targetItem,
+                                            message.attribute, message.value);
+            break;
+        default:
+            qWarning() << __PRETTY_FUNCTION__ << "unknown message type" << message.type;
+            break;
+        }
+    }
+
+    Q_EMIT batchFinished();
+
+    handledOutOfBandMessage();
+}
+
+void DBusServerConnection::keyEventsProcessed(uint lastSerial, const QList<uint> &passedThrough)
+{
+    readSharedMemoryChannel();
+
+    QList<uint>::const_iterator passed = passedThrough.constBegin();
+
+    // Serials wrap around, compare their distance
+    while (!mPendingKeyEvents.isEmpty()
+           && static_cast<qint32>(mPendingKeyEvents.first().serial - lastSerial) <= 0) {
+        const MImKeyEventRecord record = mPendingKeyEvents.takeFirst();
+
+        while (passed != passedThrough.constEnd()
+               && static_cast<qint32>(*passed - record.serial) < 0) {
+            ++passed;
+        }
+
+        if (passed != passedThrough.constEnd() && *passed == record.serial) {
+            passThroughKeyEvent(record);
+        }
+    }
+
+    handledOutOfBandMessage();
+}
+
+void DBusServerConnection::passThroughKeyEvent(const MImKeyEventRecord &record)
+{
+    // Merged auto-repeats are delivered one by one again, applications
+    // rarely look at QKeyEvent::count()
+    for (int i = 0; i < record.eventCount(); ++i) {
+        keyEventPassedThrough(record.type, record.key, record.modifiers, record.textString(),
+                              record.isAutoRepeat(), record.eventKeyCount(), record.nativeScanCode,
+                              record.nativeVirtualKey, record.nativeModifiers, record.time);
+    }
+}
+
+void DBusServerConnection::passThroughPendingKeyEvents()
+{
+    mKeyEventTimer.stop();
+
+    for (int i = 0; i < mKeyEvents.count(); ++i) {
+        mPendingKeyEvents.append(mKeyEvents.at(i));
+    }
+    mKeyEvents.clear();
+
+    const QList<MImKeyEventRecord> pending(mPendingKeyEvents);
+    mPendingKeyEvents.clear();
+
+    Q_FOREACH (const MImKeyEventRecord &record, pending) {
+        passThroughKeyEvent(record);
+    }
 }
 
 void DBusServerConnection::notifyExtendedAttributeChanged(int id, const QString &target, const QString &targetItem,
@@ -277,6 +566,9 @@ void DBusServerConnection::notifyExtendedAttributeChanged(int id, const QString
 
 bool DBusServerConnection::preeditRectangle(int &x, int &y, int &width, int &height) const
 {
+    // The query has to see the preedit the server wrote before asking
+    const_cast<DBusServerConnection *>(this)->readSharedMemoryChannel();
+
     bool valid;
     QRect result;
     getPreeditRectangle(result, valid);
@@ -289,6 +581,8 @@ bool DBusServerConnection::preeditRectangle(int &x, int &y, int &width, int &hei
 
 bool DBusServerConnection::selection(QString &selection) const
 {
+    const_cast<DBusServerConnection *>(this)->readSharedMemoryChannel();
+
     bool valid;
     getSelection(selection, valid);
     return valid;
@@ -298,3 +592,85 @@ void DBusServerConnection::updateInputMethodArea(int x, int y, int width, int he
 {
     updateInputMethodArea(QRect(x, y, width, height));
 }
+
+void DBusServerConnection::requestWidgetStateSnapshot()
+{
+    if (!mProxy || !mWidgetStateSent)
+        return;
+
+    mProxy->updateWidgetInformation(mWidgetState, false);
+    mWidgetStateVersion = 0;
+}
+
+bool DBusServerConnection::openSharedMemoryChannel(const QDBusUnixFileDescriptor &memory,
+                                                   const QDBusUnixFileDescriptor &notifier)
+{
+    closeSharedMemoryChannel();
+
+    if (!memory.isValid() || !notifier.isValid())
+        return false;
+
+    Maliit::DBus::SharedMemoryChannel *channel = new Maliit::DBus::SharedMemoryChannel;
+    if (!channel->attach(memory.fileDescriptor(), notifier.fileDescriptor())) {
+        qWarning() << __PRETTY_FUNCTION__ << "could not attach to the shared memory channel";
+        delete channel;
+        return false;
+    }
+
+    mChannel = channel;
+    mChannelNotifier = new QSocketNotifier(mChannel->notifyFd(), QSocketNotifier::Read, this);
+    connect(mChannelNotifier, SIGNAL(activated(int)),
+            this, SLOT(readSharedMemoryChannel()));
+
+    return true;
+}
+
+void DBusServerConnection::readSharedMemoryChannel()
+{
+    if (!mChannel)
+        return;
+
+    mChannel->clearNotification();
+
+    Maliit::DBus::SharedMemoryRecord record;
+    // Signal handlers can end up closing the channel
+    while (mChannel && mChannel->read(record)) {
+        switch (record.type) {
+        case Maliit::DBus::SharedMemoryRecord::CommitString:
+            MImServerConnection::commitString(record.text, record.replacementStart,
+                                              record.replacementLength, record.cursorPos);
+            break;
+        case Maliit::DBus::SharedMemoryRecord::UpdatePreedit:
+            MImServerConnection::updatePreedit(record.text, record.preeditFormats, record.replacementStart,
+                                               record.replacementLength, record.cursorPos);
+            break;
+        case Maliit::DBus::SharedMemoryRecord::KeyEvent:
+            MImServerConnection::keyEvent(record.keyType, record.key, record.modifiers, record.text,
+                                          record.autoRepeat, record.count, record.requestType);
+            break;
+        }
+    }
+
+    // The channel closes itself when it finds corrupted data
+    if (mChannel && !mChannel->isValid()) {
+        closeSharedMemoryChannel();
+    }
+}
+
+void DBusServerConnection::closeSharedMemoryChannel()
+{
+    delete mChannelNotifier;
+    mChannelNotifier = 0;
+    delete mChannel;
+    mChannel = 0;
+}
+
+void DBusServerConnection::handledOutOfBandMessage()
+{
+    if (!mChannel)
+        return;
+
+    mChannel->addOutOfBandMessage();
+    // Records held back for this message can be delivered now
+    readSharedMemoryChannel();
+}
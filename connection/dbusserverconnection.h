@@ -18,11 +18,22 @@
 #include "mimserverconnection.h"
 
 #include "inputcontextdbusaddress.h"
+#include "mimoutboundmessage.h"
+#include "mimkeyeventbatch.h"
 
 #include <QDBusVariant>
 #include <QDBusPendingCallWatcher>
+#include <QTimer>
 
 class ComMeegoInputmethodUiserver1Interface;
+class QDBusUnixFileDescriptor;
+class QSocketNotifier;
+
+namespace Maliit {
+namespace DBus {
+class SharedMemoryChannel;
+}
+}
 
 class DBusServerConnection : public MImServerConnection
 {
@@ -48,18 +59,31 @@ public:
     virtual void processKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
                                  Qt::KeyboardModifiers modifiers,
                                  const QString &text, bool autoRepeat, int count,
-                                 quint32 nativeScanCode, quint32 nativeModifiers, unsigned long time);
+                                 quint32 nativeScanCode, quint32 nativeVirtualKey,
+                                 quint32 nativeModifiers, unsigned long time);
     virtual void registerAttributeExtension(int id, const QString &fileName);
     virtual void unregisterAttributeExtension(int id);
     virtual void setExtendedAttribute(int id, const QString &target, const QString &targetItem,
                                       const QString &attribute, const QVariant &value);
+    virtual void setExtendedAttributes(int id, const QString &target, const QString &targetItem,
+                                       const QVariantMap &attributes);
     virtual void loadPluginSettings(const QString &descriptionLanguage);
     //! reimpl end
 
     //! forwarding methods for InputContextAdaptor
+    //! Messages that can be reordered with the shared memory channel drain it first.
+    void activationLostEvent();
+    void imInitiatedHide();
+    void commitString(const QString &string, int replacementStart,
+                      int replacementLength, int cursorPos);
+    void updatePreedit(const QString &string, const QList<Maliit::PreeditTextFormat> &preeditFormats,
+                       int replacementStart, int replacementLength, int cursorPos);
     using MImServerConnection::keyEvent;
     void keyEvent(int type, int key, int modifiers, const QString &text, bool autoRepeat,
                   int count, uchar requestType);
+    void setSelection(int start, int length);
+    void applyBatch(const QList<MImOutboundMessage> &messages);
+    void keyEventsProcessed(uint lastSerial, const QList<uint> &passedThrough);
 
     void notifyExtendedAttributeChanged(int id,
                                         const QString &target,
@@ -74,18 +98,47 @@ public:
     using MImServerConnection::updateInputMethodArea;
     void updateInputMethodArea(int x, int y, int width, int height);
 
+    void requestWidgetStateSnapshot();
+
+    bool openSharedMemoryChannel(const QDBusUnixFileDescriptor &memory,
+                                 const QDBusUnixFileDescriptor &notifier);
+
 private Q_SLOTS:
     void connectToDBus();
     void openDBusConnection(const QString &addressString);
     void connectToDBusFailed(const QString &errorMessage);
     void onDisconnection();
     void resetCallFinished(QDBusPendingCallWatcher*);
+    void readSharedMemoryChannel();
+    //! Sends the key events batched in this event loop iteration
+    void flushKeyEvents();
 
 private:
+    void closeSharedMemoryChannel();
+    void handledOutOfBandMessage();
+    void passThroughKeyEvent(const MImKeyEventRecord &record);
+    //! Gives unanswered key events back to the application when the server is gone
+    void passThroughPendingKeyEvents();
+
     QSharedPointer<Maliit::InputContext::DBus::Address> mAddress;
     ComMeegoInputmethodUiserver1Interface *mProxy;
     bool mActive;
     QSet<QDBusPendingCallWatcher*> pendingResetCalls;
+
+    //! Widget state as last sent to the server, base for delta updates
+    QMap<QString, QVariant> mWidgetState;
+    unsigned int mWidgetStateVersion;
+    bool mWidgetStateSent;
+
+    Maliit::DBus::SharedMemoryChannel *mChannel;
+    QSocketNotifier *mChannelNotifier;
+
+    //! Redirected key events not sent yet
+    MImKeyEventBatch mKeyEvents;
+    //! Key events sent to the server and not answered yet, oldest first
+    QList<MImKeyEventRecord> mPendingKeyEvents;
+    quint32 mKeyEventSerial;
+    QTimer mKeyEventTimer;
 };
 
 #endif // DBUSSERVERCONNECTION_H
@@ -0,0 +1,625 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "mimeditorstate.h"
+
+#include <maliit/namespaceinternal.h>
+
+#include <QHash>
+#include <QVector>
+
+namespace {
+    const int FieldCount = Maliit::Internal::widgetStateKeyCount;
+
+    Q_STATIC_ASSERT(MImEditorState::ToolbarField == 1 << (FieldCount - 1));
+
+    //! The field named by Maliit::Internal::widgetStateKeys[index]
+    MImEditorState::Field fieldAt(int index)
+    {
+        return static_cast<MImEditorState::Field>(1 << index);
+    }
+
+    //! Attribute names created once and shared by all states
+    struct KeyTable
+    {
+        KeyTable()
+        {
+            keys.reserve(FieldCount);
+            for (int i = 0; i < FieldCount; ++i) {
+                keys.append(QString::fromLatin1(Maliit::Internal::widgetStateKeys[i]));
+                fields.insert(keys.last(), fieldAt(i));
+            }
+        }
+
+        QVector<QString> keys;
+        QHash<QString, MImEditorState::Field> fields;
+    };
+
+    Q_GLOBAL_STATIC(KeyTable, keyTable)
+
+    int fieldIndex(MImEditorState::Field field)
+    {
+        int index = 0;
+        while (index < FieldCount && fieldAt(index) != field) {
+            ++index;
+        }
+        return index;
+    }
+
+    // after transfer by dbus the type can change
+    quint64 toWinId(const QVariant &value, bool *ok)
+    {
+        switch (value.type()) {
+        case QVariant::UInt:
+            *ok = true;
+            return value.toUInt();
+        case QVariant::ULongLong:
+            *ok = true;
+            return value.toULongLong();
+        default:
+            return value.toULongLong(ok);
+        }
+    }
+}
+
+MImEditorState::MImEditorState()
+    : mFields(NoField)
+    , mChangedFields(NoField)
+    , mChangedExtensions()
+    , mFocusState(false)
+    , mContentType(0)
+    , mCorrectionEnabled(false)
+    , mPredictionEnabled(false)
+    , mAutoCapitalizationEnabled(false)
+    , mSurroundingText()
+    , mAnchorPosition(0)
+    , mCursorPosition(0)
+    , mHasSelection(false)
+    , mInputMethodMode(0)
+    , mWinId(0)
+    , mCursorRectangle()
+    , mHiddenText(false)
+    , mPreeditClickPos(0)
+    , mInputMethodHints(0)
+    , mVisualizationPriority(false)
+    , mToolbarId(0)
+    , mToolbar()
+    , mExtensions()
+    , mMap()
+    , mMapValid(true)
+{
+}
+
+MImEditorState::MImEditorState(const QVariantMap &state)
+    : mFields(NoField)
+    , mChangedFields(NoField)
+    , mChangedExtensions()
+    , mFocusState(false)
+    , mContentType(0)
+    , mCorrectionEnabled(false)
+    , mPredictionEnabled(false)
+    , mAutoCapitalizationEnabled(false)
+    , mSurroundingText()
+    , mAnchorPosition(0)
+    , mCursorPosition(0)
+    , mHasSelection(false)
+    , mInputMethodMode(0)
+    , mWinId(0)
+    , mCursorRectangle()
+    , mHiddenText(false)
+    , mPreeditClickPos(0)
+    , mInputMethodHints(0)
+    , mVisualizationPriority(false)
+    , mToolbarId(0)
+    , mToolbar()
+    , mExtensions()
+    , mMap()
+    , mMapValid(true)
+{
+    reset(state);
+    clearChanges();
+}
+
+template <typename T>
+void MImEditorState::set(T &member, const T &value, Field field, bool present)
+{
+    if (bool(mFields & field) == present && member == value) {
+        return;
+    }
+
+    member = value;
+    if (present) {
+        mFields |= field;
+    } else {
+        mFields &= ~field;
+    }
+    mChangedFields |= field;
+    mMapValid = false;
+}
+
+QString MImEditorState::key(Field field)
+{
+    const int index = fieldIndex(field);
+    return index < FieldCount ? keyTable()->keys.at(index) : QString();
+}
+
+MImEditorState::Field MImEditorState::field(const QString &key)
+{
+    return keyTable()->fields.value(key, NoField);
+}
+
+MImEditorState::Fields MImEditorState::fields() const
+{
+    return mFields;
+}
+
+bool MImEditorState::contains(Field field) const
+{
+    return mFields & field;
+}
+
+bool MImEditorState::isEmpty() const
+{
+    return mFields == NoField && mExtensions.isEmpty();
+}
+
+bool MImEditorState::focusState() const
+{
+    return mFocusState;
+}
+
+void MImEditorState::setFocusState(bool focused)
+{
+    set(mFocusState, focused, FocusStateField);
+}
+
+int MImEditorState::contentType() const
+{
+    return mContentType;
+}
+
+void MImEditorState::setContentType(int contentType)
+{
+    set(mContentType, contentType, ContentTypeField);
+}
+
+bool MImEditorState::correctionEnabled() const
+{
+    return mCorrectionEnabled;
+}
+
+void MImEditorState::setCorrectionEnabled(bool enabled)
+{
+    set(mCorrectionEnabled, enabled, CorrectionField);
+}
+
+bool MImEditorState::predictionEnabled() const
+{
+    return mPredictionEnabled;
+}
+
+void MImEditorState::setPredictionEnabled(bool enabled)
+{
+    set(mPredictionEnabled, enabled, PredictionField);
+}
+
+bool MImEditorState::autoCapitalizationEnabled() const
+{
+    return mAutoCapitalizationEnabled;
+}
+
+void MImEditorState::setAutoCapitalizationEnabled(bool enabled)
+{
+    set(mAutoCapitalizationEnabled, enabled, AutoCapitalizationField);
+}
+
+QString MImEditorState::surroundingText() const
+{
+    return mSurroundingText;
+}
+
+void MImEditorState::setSurroundingText(const QString &text)
+{
+    set(mSurroundingText, text, SurroundingTextField);
+}
+
+int MImEditorState::anchorPosition() const
+{
+    return mAnchorPosition;
+}
+
+void MImEditorState::setAnchorPosition(int position)
+{
+    set(mAnchorPosition, position, AnchorPositionField);
+}
+
+int MImEditorState::cursorPosition() const
+{
+    return mCursorPosition;
+}
+
+void MImEditorState::setCursorPosition(int position)
+{
+    set(mCursorPosition, position, CursorPositionField);
+}
+
+bool MImEditorState::hasSelection() const
+{
+    return mHasSelection;
+}
+
+void MImEditorState::setHasSelection(bool hasSelection)
+{
+    set(mHasSelection, hasSelection, HasSelectionField);
+}
+
+int MImEditorState::inputMethodMode() const
+{
+    return mInputMethodMode;
+}
+
+void MImEditorState::setInputMethodMode(int mode)
+{
+    set(mInputMethodMode, mode, InputMethodModeField);
+}
+
+quint64 MImEditorState::winId() const
+{
+    return mWinId;
+}
+
+void MImEditorState::setWinId(quint64 winId)
+{
+    set(mWinId, winId, WinIdField);
+}
+
+QRect MImEditorState::cursorRectangle() const
+{
+    return mCursorRectangle;
+}
+
+void MImEditorState::setCursorRectangle(const QRect &rectangle)
+{
+    set(mCursorRectangle, rectangle, CursorRectangleField);
+}
+
+bool MImEditorState::hiddenText() const
+{
+    return mHiddenText;
+}
+
+void MImEditorState::setHiddenText(bool hidden)
+{
+    set(mHiddenText, hidden, HiddenTextField);
+}
+
+int MImEditorState::preeditClickPos() const
+{
+    return mPreeditClickPos;
+}
+
+void MImEditorState::setPreeditClickPos(int position)
+{
+    set(mPreeditClickPos, position, PreeditClickPosField);
+}
+
+qint64 MImEditorState::inputMethodHints() const
+{
+    return mInputMethodHints;
+}
+
+void MImEditorState::setInputMethodHints(qint64 hints)
+{
+    set(mInputMethodHints, hints, InputMethodHintsField);
+}
+
+bool MImEditorState::visualizationPriority() const
+{
+    return mVisualizationPriority;
+}
+
+void MImEditorState::setVisualizationPriority(bool priority)
+{
+    set(mVisualizationPriority, priority, VisualizationPriorityField);
+}
+
+int MImEditorState::toolbarId() const
+{
+    return mToolbarId;
+}
+
+void MImEditorState::setToolbarId(int id)
+{
+    set(mToolbarId, id, ToolbarIdField);
+}
+
+QString MImEditorState::toolbar() const
+{
+    return mToolbar;
+}
+
+void MImEditorState::setToolbar(const QString &toolbar)
+{
+    set(mToolbar, toolbar, ToolbarField);
+}
+
+QVariantMap MImEditorState::extensions() const
+{
+    return mExtensions;
+}
+
+QVariant MImEditorState::value(const QString &key) const
+{
+    const Field keyField = field(key);
+    if (keyField == NoField) {
+        return mExtensions.value(key);
+    }
+
+    return fieldValue(keyField);
+}
+
+void MImEditorState::setValue(const QString &key, const QVariant &value)
+{
+    const bool mapValid = mMapValid;
+    const Field keyField = field(key);
+
+    if (keyField != NoField) {
+        setField(keyField, value);
+    } else if (mExtensions.value(key) != value) {
+        if (value.isValid()) {
+            mExtensions.insert(key, value);
+        } else {
+            mExtensions.remove(key);
+        }
+        if (not mChangedExtensions.contains(key)) {
+            mChangedExtensions.append(key);
+        }
+    }
+
+    // Keep the map in step instead of building it again
+    if (mapValid) {
+        if (value.isValid()) {
+            mMap.insert(key, value);
+        } else {
+            mMap.remove(key);
+        }
+        mMapValid = true;
+    }
+}
+
+void MImEditorState::remove(const QString &key)
+{
+    setValue(key, QVariant());
+}
+
+void MImEditorState::reset(const QVariantMap &state)
+{
+    Fields present = NoField;
+    QVariantMap extensions;
+
+    for (QVariantMap::const_iterator iter = state.constBegin(); iter != state.constEnd(); ++iter) {
+        const Field keyField = field(iter.key());
+        if (keyField == NoField) {
+            extensions.insert(iter.key(), iter.value());
+        } else {
+            setField(keyField, iter.value());
+            present |= keyField;
+        }
+    }
+
+    // Fields missing from the new state
+    for (int i = 0; i < FieldCount; ++i) {
+        const Field missing = fieldAt(i);
+        if ((mFields & missing) && not (present & missing)) {
+            setField(missing, QVariant());
+        }
+    }
+
+    for (QVariantMap::const_iterator iter = extensions.constBegin(); iter != extensions.constEnd(); ++iter) {
+        if (mExtensions.value(iter.key()) != iter.value()
+            && not mChangedExtensions.contains(iter.key())) {
+            mChangedExtensions.append(iter.key());
+        }
+    }
+    for (QVariantMap::const_iterator iter = mExtensions.constBegin(); iter != mExtensions.constEnd(); ++iter) {
+        if (not extensions.contains(iter.key())
+            && not mChangedExtensions.contains(iter.key())) {
+            mChangedExtensions.append(iter.key());
+        }
+    }
+    mExtensions = extensions;
+
+    mMap = state;
+    mMapValid = true;
+}
+
+MImEditorState::Fields MImEditorState::changedFields() const
+{
+    return mChangedFields;
+}
+
+QStringList MImEditorState::changedExtensions() const
+{
+    return mChangedExtensions;
+}
+
+QStringList MImEditorState::changedKeys() const
+{
+    QStringList keys;
+
+    for (int i = 0; i < FieldCount; ++i) {
+        if (mChangedFields & fieldAt(i)) {
+            keys.append(keyTable()->keys.at(i));
+        }
+    }
+
+    return keys + mChangedExtensions;
+}
+
+bool MImEditorState::hasChanges() const
+{
+    return mChangedFields != NoField || not mChangedExtensions.isEmpty();
+}
+
+void MImEditorState::clearChanges()
+{
+    mChangedFields = NoField;
+    mChangedExtensions.clear();
+}
+
+QVariantMap MImEditorState::toMap() const
+{
+    if (not mMapValid) {
+        mMap = mExtensions;
+        for (int i = 0; i < FieldCount; ++i) {
+            if (mFields & fieldAt(i)) {
+                mMap.insert(keyTable()->keys.at(i), fieldValue(fieldAt(i)));
+            }
+        }
+        mMapValid = true;
+    }
+
+    return mMap;
+}
+
+QVariantMap MImEditorState::toMap(Fields fields) const
+{
+    QVariantMap map;
+
+    for (int i = 0; i < FieldCount; ++i) {
+        if (fields & mFields & fieldAt(i)) {
+            map.insert(keyTable()->keys.at(i), fieldValue(fieldAt(i)));
+        }
+    }
+
+    return map;
+}
+
+void MImEditorState::setField(Field field, const QVariant &value)
+{
+    bool present = value.isValid();
+
+    switch (field) {
+    case FocusStateField:
+        set(mFocusState, value.toBool(), field, present);
+        break;
+    case ContentTypeField: {
+        const int contentType = value.toInt(&present);
+        set(mContentType, contentType, field, present);
+        break;
+    }
+    case CorrectionField:
+        set(mCorrectionEnabled, value.toBool(), field, present);
+        break;
+    case PredictionField:
+        set(mPredictionEnabled, value.toBool(), field, present);
+        break;
+    case AutoCapitalizationField:
+        set(mAutoCapitalizationEnabled, value.toBool(), field, present);
+        break;
+    case SurroundingTextField:
+        set(mSurroundingText, value.toString(), field, present);
+        break;
+    case AnchorPositionField:
+        set(mAnchorPosition, value.toInt(), field, present);
+        break;
+    case CursorPositionField:
+        set(mCursorPosition, value.toInt(), field, present);
+        break;
+    case HasSelectionField:
+        set(mHasSelection, value.toBool(), field, present);
+        break;
+    case InputMethodModeField: {
+        const int mode = value.toInt(&present);
+        set(mInputMethodMode, mode, field, present);
+        break;
+    }
+    case WinIdField: {
+        const quint64 winId = toWinId(value, &present);
+        set(mWinId, winId, field, present);
+        break;
+    }
+    case CursorRectangleField:
+        set(mCursorRectangle, value.toRect(), field, present);
+        break;
+    case HiddenTextField:
+        set(mHiddenText, value.toBool(), field, present);
+        break;
+    case PreeditClickPosField:
+        set(mPreeditClickPos, value.toInt(), field, present);
+        break;
+    case InputMethodHintsField:
+        set(mInputMethodHints, value.toLongLong(), field, present);
+        break;
+    case VisualizationPriorityField:
+        set(mVisualizationPriority, value.toBool(), field, present);
+        break;
+    case ToolbarIdField:
+        set(mToolbarId, value.toInt(), field, present);
+        break;
+    case ToolbarField:
+        set(mToolbar, value.toString(), field, present);
+        break;
+    default:
+        break;
+    }
+}
+
+QVariant MImEditorState::fieldValue(Field field) const
+{
+    if (not (mFields & field)) {
+        return QVariant();
+    }
+
+    switch (field) {
+    case FocusStateField:
+        return mFocusState;
+    case ContentTypeField:
+        return mContentType;
+    case CorrectionField:
+        return mCorrectionEnabled;
+    case PredictionField:
+        return mPredictionEnabled;
+    case AutoCapitalizationField:
+        return mAutoCapitalizationEnabled;
+    case SurroundingTextField:
+        return mSurroundingText;
+    case AnchorPositionField:
+        return mAnchorPosition;
+    case CursorPositionField:
+        return mCursorPosition;
+    case HasSelectionField:
+        return mHasSelection;
+    case InputMethodModeField:
+        return mInputMethodMode;
+    case WinIdField:
+        return static_cast<qulonglong>(mWinId);
+    case CursorRectangleField:
+        return mCursorRectangle;
+    case HiddenTextField:
+        return mHiddenText;
+    case PreeditClickPosField:
+        return mPreeditClickPos;
+    case InputMethodHintsField:
+        return mInputMethodHints;
+    case VisualizationPriorityField:
+        return mVisualizationPriority;
+    case ToolbarIdField:
+        return mToolbarId;
+    case ToolbarField:
+        return mToolbar;
+    default:
+        return QVariant();
+    }
+}
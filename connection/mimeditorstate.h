@@ -0,0 +1,195 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MIMEDITORSTATE_H
+#define MIMEDITORSTATE_H
+
+#include <QRect>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+/*! \internal
+ * \brief Widget state of an editor: typed fields for the attributes the
+ * framework knows about, an extension map for all others.
+ *
+ * Applications send the state as a QVariantMap. It is decoded once, when it
+ * arrives, so that reading an attribute afterwards neither looks up a string
+ * nor converts a QVariant. The attribute names are interned, \a key and
+ * \a field map between a name and its field.
+ *
+ * Every update records which fields and extension attributes changed until
+ * \a clearChanges is called. \a toMap returns the map the state was reset
+ * from as long as no field was changed through a typed setter.
+ */
+class MImEditorState
+{
+public:
+    enum Field {
+        NoField = 0,
+        FocusStateField = 0x1,
+        ContentTypeField = 0x2,
+        CorrectionField = 0x4,
+        PredictionField = 0x8,
+        AutoCapitalizationField = 0x10,
+        SurroundingTextField = 0x20,
+        AnchorPositionField = 0x40,
+        CursorPositionField = 0x80,
+        HasSelectionField = 0x100,
+        InputMethodModeField = 0x200,
+        WinIdField = 0x400,
+        CursorRectangleField = 0x800,
+        HiddenTextField = 0x1000,
+        PreeditClickPosField = 0x2000,
+        InputMethodHintsField = 0x4000,
+        VisualizationPriorityField = 0x8000,
+        ToolbarIdField = 0x10000,
+        ToolbarField = 0x20000,
+        AllFields = 0x3ffff
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    MImEditorState();
+    explicit MImEditorState(const QVariantMap &state);
+
+    //! Attribute name of \a field in widget state maps
+    static QString key(Field field);
+    //! Field of attribute \a key, NoField for extension attributes
+    static Field field(const QString &key);
+
+    //! Fields present in the state
+    Fields fields() const;
+    bool contains(Field field) const;
+    bool isEmpty() const;
+
+    // Fields not present read as false, 0 or empty
+    bool focusState() const;
+    void setFocusState(bool focused);
+
+    int contentType() const;
+    void setContentType(int contentType);
+
+    bool correctionEnabled() const;
+    void setCorrectionEnabled(bool enabled);
+
+    bool predictionEnabled() const;
+    void setPredictionEnabled(bool enabled);
+
+    bool autoCapitalizationEnabled() const;
+    void setAutoCapitalizationEnabled(bool enabled);
+
+    QString surroundingText() const;
+    void setSurroundingText(const QString &text);
+
+    int anchorPosition() const;
+    void setAnchorPosition(int position);
+
+    int cursorPosition() const;
+    void setCursorPosition(int position);
+
+    bool hasSelection() const;
+    void setHasSelection(bool hasSelection);
+
+    int inputMethodMode() const;
+    void setInputMethodMode(int mode);
+
+    quint64 winId() const;
+    void setWinId(quint64 winId);
+
+    QRect cursorRectangle() const;
+    void setCursorRectangle(const QRect &rectangle);
+
+    bool hiddenText() const;
+    void setHiddenText(bool hidden);
+
+    int preeditClickPos() const;
+    void setPreeditClickPos(int position);
+
+    qint64 inputMethodHints() const;
+    void setInputMethodHints(qint64 hints);
+
+    bool visualizationPriority() const;
+    void setVisualizationPriority(bool priority);
+
+    int toolbarId() const;
+    void setToolbarId(int id);
+
+    QString toolbar() const;
+    void setToolbar(const QString &toolbar);
+
+    //! Attributes which are not a field
+    QVariantMap extensions() const;
+
+    //! Value of attribute \a key, invalid if not present
+    QVariant value(const QString &key) const;
+    //! Sets attribute \a key, an invalid \a value removes it
+    void setValue(const QString &key, const QVariant &value);
+    void remove(const QString &key);
+
+    //! Replaces the whole state with \a state, \a state is shared and not copied
+    void reset(const QVariantMap &state);
+
+    //! Fields changed, added or removed since the last clearChanges()
+    Fields changedFields() const;
+    //! Extension attributes changed, added or removed since the last clearChanges()
+    QStringList changedExtensions() const;
+    //! Names of all attributes changed since the last clearChanges()
+    QStringList changedKeys() const;
+    bool hasChanges() const;
+    void clearChanges();
+
+    QVariantMap toMap() const;
+    //! Map of \a fields only, fields not present are left out
+    QVariantMap toMap(Fields fields) const;
+
+private:
+    template <typename T>
+    void set(T &member, const T &value, Field field, bool present = true);
+    void setField(Field field, const QVariant &value);
+    QVariant fieldValue(Field field) const;
+
+    Fields mFields;
+    Fields mChangedFields;
+    QStringList mChangedExtensions;
+
+    bool mFocusState;
+    int mContentType;
+    bool mCorrectionEnabled;
+    bool mPredictionEnabled;
+    bool mAutoCapitalizationEnabled;
+    QString mSurroundingText;
+    int mAnchorPosition;
+    int mCursorPosition;
+    bool mHasSelection;
+    int mInputMethodMode;
+    quint64 mWinId;
+    QRect mCursorRectangle;
+    bool mHiddenText;
+    int mPreeditClickPos;
+    qint64 mInputMethodHints;
+    bool mVisualizationPriority;
+    int mToolbarId;
+    QString mToolbar;
+
+    QVariantMap mExtensions;
+
+    //! Whole state as a map, kept until a typed setter changes a field
+    mutable QVariantMap mMap;
+    mutable bool mMapValid;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(MImEditorState::Fields)
+Q_DECLARE_METATYPE(MImEditorState::Fields)
+
+#endif // MIMEDITORSTATE_H
@@ -0,0 +1,155 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "mimkeyeventbatch.h"
+
+#include <cstring>
+
+namespace {
+    const int RecordSize = sizeof(MImKeyEventRecord);
+
+    bool isRepeatOf(const MImKeyEventRecord &record, const MImKeyEventRecord &repeat)
+    {
+        return record.isAutoRepeat()
+               && record.key == repeat.key
+               && record.modifiers == repeat.modifiers
+               && record.textLength == repeat.textLength
+               && memcmp(record.text, repeat.text, record.textLength * sizeof(quint16)) == 0;
+    }
+}
+
+QString MImKeyEventRecord::textString() const
+{
+    return QString(reinterpret_cast<const QChar *>(text), qMin<int>(textLength, MaxTextLength));
+}
+
+bool MImKeyEventRecord::isAutoRepeat() const
+{
+    return flags & AutoRepeat;
+}
+
+int MImKeyEventRecord::eventCount() const
+{
+    return isAutoRepeat() ? qMax<int>(count, 1) : 1;
+}
+
+int MImKeyEventRecord::eventKeyCount() const
+{
+    return isAutoRepeat() ? 1 : count;
+}
+
+MImKeyEventBatch::MImKeyEventBatch()
+    : mData()
+{
+}
+
+MImKeyEventBatch::MImKeyEventBatch(const QByteArray &data)
+    : mData(data)
+{
+    mData.truncate(count() * RecordSize);
+}
+
+bool MImKeyEventBatch::append(quint32 serial, QEvent::Type type, int key,
+                              Qt::KeyboardModifiers modifiers, const QString &text,
+                              bool autoRepeat, int count, quint32 nativeScanCode,
+                              quint32 nativeVirtualKey, quint32 nativeModifiers, quint32 time)
+{
+    if (text.length() > MImKeyEventRecord::MaxTextLength) {
+        return false;
+    }
+
+    MImKeyEventRecord record;
+    memset(&record, 0, RecordSize);
+    record.serial = serial;
+    record.type = type;
+    record.key = key;
+    record.modifiers = modifiers;
+    record.nativeScanCode = nativeScanCode;
+    record.nativeVirtualKey = nativeVirtualKey;
+    record.nativeModifiers = nativeModifiers;
+    record.time = time;
+    record.count = qBound(0, count, 0xffff);
+    record.flags = autoRepeat ? MImKeyEventRecord::AutoRepeat : 0;
+    record.textLength = text.length();
+    memcpy(record.text, text.constData(), text.length() * sizeof(quint16));
+
+    if (autoRepeat && type == QEvent::KeyPress) {
+        const int last = this->count() - 1;
+
+        if (last >= 1) {
+            const MImKeyEventRecord release = at(last);
+            MImKeyEventRecord press = at(last - 1);
+
+            if (release.type == QEvent::KeyRelease && isRepeatOf(release, record)
+                && press.type == QEvent::KeyPress && isRepeatOf(press, record)) {
+                removeLast();
+                press.count = qMin(press.count + record.count, 0xffff);
+                press.time = time;
+                replace(last - 1, press);
+                return true;
+            }
+        }
+
+        if (last >= 0) {
+            MImKeyEventRecord press = at(last);
+
+            if (press.type == QEvent::KeyPress && isRepeatOf(press, record)) {
+                press.count = qMin(press.count + record.count, 0xffff);
+                press.time = time;
+                replace(last, press);
+                return true;
+            }
+        }
+    }
+
+    mData.append(reinterpret_cast<const char *>(&record), RecordSize);
+    return true;
+}
+
+int MImKeyEventBatch::count() const
+{
+    return mData.size() / RecordSize;
+}
+
+bool MImKeyEventBatch::isEmpty() const
+{
+    return count() == 0;
+}
+
+MImKeyEventRecord MImKeyEventBatch::at(int index) const
+{
+    MImKeyEventRecord record;
+    memcpy(&record, mData.constData() + index * RecordSize, RecordSize);
+    return record;
+}
+
+QByteArray MImKeyEventBatch::data() const
+{
+    return mData;
+}
+
+void MImKeyEventBatch::clear()
+{
+    mData.clear();
+}
+
+void MImKeyEventBatch::replace(int index, const MImKeyEventRecord &record)
+{
+    memcpy(mData.data() + index * RecordSize, &record, RecordSize);
+}
+
+void MImKeyEventBatch::removeLast()
+{
+    mData.chop(RecordSize);
+}
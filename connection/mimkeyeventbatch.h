@@ -0,0 +1,100 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MIMKEYEVENTBATCH_H
+#define MIMKEYEVENTBATCH_H
+
+#include <QByteArray>
+#include <QEvent>
+#include <QString>
+
+/*! \internal
+ * \brief Hardware key event redirected from an application to the server.
+ *
+ * Records have a fixed size and are sent as they are in memory, so
+ * only the text of ordinary key presses fits in.
+ */
+struct MImKeyEventRecord
+{
+    enum {
+        MaxTextLength = 7
+    };
+
+    enum Flag {
+        AutoRepeat = 0x1
+    };
+
+    //! Number given by the application, increasing with every event
+    quint32 serial;
+    qint32 type;
+    qint32 key;
+    quint32 modifiers;
+    quint32 nativeScanCode;
+    quint32 nativeVirtualKey;
+    quint32 nativeModifiers;
+    quint32 time;
+    quint16 count;
+    quint16 flags;
+    quint16 textLength;
+    quint16 text[MaxTextLength];
+
+    QString textString() const;
+    bool isAutoRepeat() const;
+
+    //! Number of key events the record stands for, more than one for merged auto-repeats
+    int eventCount() const;
+    //! QKeyEvent::count() of each of these key events
+    int eventKeyCount() const;
+};
+
+/*! \internal
+ * \brief Key events sent from an application to the server in one message.
+ *
+ * The batch is a byte array of MImKeyEventRecord in host byte order, both
+ * ends of the connection run on the same machine. Auto-repeated presses
+ * of a key are merged into the press before them, raising its count; a
+ * release between two of them is dropped. Receivers deliver a merged
+ * record as MImKeyEventRecord::eventCount() separate presses.
+ */
+class MImKeyEventBatch
+{
+public:
+    MImKeyEventBatch();
+    //! Batch received from the application, an incomplete last record is ignored
+    explicit MImKeyEventBatch(const QByteArray &data);
+
+    /*!
+     * \brief Appends a key event, or merges it into the last one when auto-repeated.
+     * \return false if \a text is too long for a record, the batch is unchanged then
+     */
+    bool append(quint32 serial, QEvent::Type type, int key, Qt::KeyboardModifiers modifiers,
+                const QString &text, bool autoRepeat, int count,
+                quint32 nativeScanCode, quint32 nativeVirtualKey, quint32 nativeModifiers,
+                quint32 time);
+
+    int count() const;
+    bool isEmpty() const;
+    MImKeyEventRecord at(int index) const;
+
+    QByteArray data() const;
+    void clear();
+
+private:
+    void replace(int index, const MImKeyEventRecord &record);
+    void removeLast();
+
+    QByteArray mData;
+};
+
+#endif // MIMKEYEVENTBATCH_H
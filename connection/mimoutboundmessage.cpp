@@ -0,0 +1,36 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "mimoutboundmessage.h"
+
+MImOutboundMessage::MImOutboundMessage(Type type)
+    : type(type)
+    , text()
+    , preeditFormats()
+    , replacementStart(0)
+    , replacementLength(0)
+    , cursorPos(-1)
+    , keyType(0)
+    , key(0)
+    , modifiers(0)
+    , count(0)
+    , autoRepeat(false)
+    , requestType(Maliit::EventRequestBoth)
+    , extensionId(0)
+    , target()
+    , targetItem()
+    , attribute()
+    , value()
+{
+}
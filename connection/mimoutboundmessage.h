@@ -0,0 +1,67 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MIMOUTBOUNDMESSAGE_H
+#define MIMOUTBOUNDMESSAGE_H
+
+#include <maliit/namespace.h>
+
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+
+/*! \internal
+ * \brief Message from the input method server to an application, queued for batching.
+ *
+ * Only the members relevant for \a type are set.
+ */
+struct MImOutboundMessage
+{
+    enum Type {
+        CommitString = 1,
+        UpdatePreedit,
+        KeyEvent,
+        ExtendedAttributeChanged
+    };
+
+    explicit MImOutboundMessage(Type type = CommitString);
+
+    Type type;
+
+    //! Committed or preedit string, or key event text
+    QString text;
+    QList<Maliit::PreeditTextFormat> preeditFormats;
+    int replacementStart;
+    int replacementLength;
+    int cursorPos;
+
+    int keyType;
+    int key;
+    int modifiers;
+    int count;
+    bool autoRepeat;
+    Maliit::EventRequestType requestType;
+
+    int extensionId;
+    QString target;
+    QString targetItem;
+    QString attribute;
+    QVariant value;
+};
+
+Q_DECLARE_METATYPE(MImOutboundMessage)
+Q_DECLARE_METATYPE(QList<MImOutboundMessage>)
+
+#endif // MIMOUTBOUNDMESSAGE_H
@@ -78,8 +78,8 @@ void MImServerConnection::setCopyPasteState(bool copyAvailable, bool pasteAvaila
 void MImServerConnection::processKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
                                           Qt::KeyboardModifiers modifiers,
                                           const QString &text, bool autoRepeat, int count,
-                                          quint32 nativeScanCode, quint32 nativeModifiers,
-                                          unsigned long time)
+                                          quint32 nativeScanCode, quint32 nativeVirtualKey,
+                                          quint32 nativeModifiers, unsigned long time)
 {
     Q_UNUSED(keyType);
     Q_UNUSED(keyCode);
@@ -88,6 +88,7 @@ void MImServerConnection::processKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
     Q_UNUSED(autoRepeat);
     Q_UNUSED(count);
     Q_UNUSED(nativeScanCode);
+    Q_UNUSED(nativeVirtualKey);
     Q_UNUSED(nativeModifiers);
     Q_UNUSED(time);
 }
@@ -113,6 +114,14 @@ void MImServerConnection::setExtendedAttribute(int id, const QString &target, co
     Q_UNUSED(value);
 }
 
+void MImServerConnection::setExtendedAttributes(int id, const QString &target, const QString &targetItem,
+                                                const QVariantMap &attributes)
+{
+    for (QVariantMap::const_iterator i = attributes.constBegin(); i != attributes.constEnd(); ++i) {
+        setExtendedAttribute(id, target, targetItem, i.key(), i.value());
+    }
+}
+
 void MImServerConnection::loadPluginSettings(const QString &descriptionLanguage)
 {
     Q_UNUSED(descriptionLanguage);
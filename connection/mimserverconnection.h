@@ -46,11 +46,15 @@ public:
     virtual void processKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
                                  Qt::KeyboardModifiers modifiers,
                                  const QString &text, bool autoRepeat, int count,
-                                 quint32 nativeScanCode, quint32 nativeModifiers, unsigned long time);
+                                 quint32 nativeScanCode, quint32 nativeVirtualKey,
+                                 quint32 nativeModifiers, unsigned long time);
     virtual void registerAttributeExtension(int id, const QString &fileName);
     virtual void unregisterAttributeExtension(int id);
     virtual void setExtendedAttribute(int id, const QString &target, const QString &targetItem,
                                       const QString &attribute, const QVariant &value);
+    //! Sets several attributes of \a targetItem at once, calls setExtendedAttribute by default
+    virtual void setExtendedAttributes(int id, const QString &target, const QString &targetItem,
+                                       const QVariantMap &attributes);
     virtual void loadPluginSettings(const QString &descriptionLanguage);
 
 public:
@@ -99,6 +103,18 @@ public:
     Q_SIGNAL void updatePreedit(const QString &string, const QList<Maliit::PreeditTextFormat> &preeditFormats,
                                 int replacementStart = 0, int replacementLength = 0, int cursorPos = -1);
 
+    /*!
+     * \brief Returns a redirected hardware key event the input method did not handle.
+     *
+     * Parameters as in the QKeyEvent constructor, \a time is the event's
+     * timestamp. The application delivers the event as if it had never been
+     * redirected.
+     */
+    Q_SIGNAL void keyEventPassedThrough(int type, int key, int modifiers, const QString &text,
+                                        bool autoRepeat, int count, quint32 nativeScanCode,
+                                        quint32 nativeVirtualKey, quint32 nativeModifiers,
+                                        ulong time);
+
     //! \brief Sends a non-printable key event. Parameters as in QKeyEvent constructor
     Q_SIGNAL void keyEvent(int type, int key, int modifiers, const QString &text, bool autoRepeat,
                            int count, Maliit::EventRequestType requestType
@@ -193,6 +209,16 @@ public:
      */
     Q_SIGNAL void pluginSettingsReceived(const QList<MImPluginSettingsInfo> &info);
 
+    /*!
+     * \brief Brackets messages the server sent as one batch.
+     *
+     * The messages in between are emitted without returning to the event loop,
+     * so the application can defer repaints and change notifications until
+     * \a batchFinished.
+     */
+    Q_SIGNAL void batchStarted();
+    Q_SIGNAL void batchFinished();
+
 private:
     Q_DISABLE_COPY(MImServerConnection)
 
@@ -0,0 +1,246 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "mimsurroundingtext.h"
+
+namespace {
+    // Above this the pieces are merged back into one string. Editing at
+    // scattered positions costs one copy of the text per MaxPieces edits.
+    const int MaxPieces = 64;
+}
+
+MImSurroundingText::MImSurroundingText()
+    : mOriginal()
+    , mAdded()
+    , mPieces()
+    , mLength(0)
+    , mCursorPosition(0)
+    , mAnchorPosition(0)
+    , mText()
+    , mTextValid(true)
+{
+}
+
+void MImSurroundingText::reset(const QString &text, int cursorPosition, int anchorPosition)
+{
+    mOriginal = text;
+    mAdded.clear();
+    mPieces.clear();
+    mLength = text.length();
+
+    if (mLength > 0) {
+        const Piece piece = { false, 0, mLength };
+        mPieces.append(piece);
+    }
+
+    mCursorPosition = cursorPosition;
+    mAnchorPosition = anchorPosition;
+
+    mText = text;
+    mTextValid = true;
+}
+
+bool MImSurroundingText::insert(int position, const QString &text)
+{
+    if (position < 0 || position > mLength) {
+        return false;
+    }
+
+    if (text.isEmpty()) {
+        return true;
+    }
+
+    // Find the piece ending at or containing position
+    int index = 0;
+    int offset = position;
+    while (index < mPieces.size() && offset > mPieces.at(index).length) {
+        offset -= mPieces.at(index).length;
+        ++index;
+    }
+
+    if (index < mPieces.size()) {
+        Piece &piece = mPieces[index];
+
+        if (offset == piece.length
+            && piece.added
+            && piece.start + piece.length == mAdded.length()) {
+            // Continues the last insertion
+            mAdded.append(text);
+            piece.length += text.length();
+            mLength += text.length();
+            changed();
+            return true;
+        }
+
+        if (offset == piece.length) {
+            ++index;
+        } else if (offset > 0) {
+            const Piece tail = { piece.added, piece.start + offset, piece.length - offset };
+            piece.length = offset;
+            mPieces.insert(index + 1, tail);
+            ++index;
+        }
+    }
+
+    const Piece inserted = { true, mAdded.length(), text.length() };
+    mAdded.append(text);
+    mPieces.insert(index, inserted);
+    mLength += text.length();
+
+    changed();
+    return true;
+}
+
+bool MImSurroundingText::remove(int position, int length)
+{
+    if (position < 0 || length < 0 || position + length > mLength) {
+        return false;
+    }
+
+    if (length == 0) {
+        return true;
+    }
+
+    // Find the piece containing the first removed character
+    int index = 0;
+    int offset = position;
+    while (index < mPieces.size() && offset >= mPieces.at(index).length) {
+        offset -= mPieces.at(index).length;
+        ++index;
+    }
+
+    int remaining = length;
+    while (remaining > 0 && index < mPieces.size()) {
+        Piece &piece = mPieces[index];
+
+        if (offset == 0 && remaining >= piece.length) {
+            remaining -= piece.length;
+            mPieces.remove(index);
+        } else if (offset == 0) {
+            piece.start += remaining;
+            piece.length -= remaining;
+            remaining = 0;
+        } else if (offset + remaining >= piece.length) {
+            const int removed = piece.length - offset;
+
+            // Deleting what was just typed also gives back the buffer space,
+            // so that typing again continues the same piece.
+            if (piece.added && piece.start + piece.length == mAdded.length()) {
+                mAdded.chop(removed);
+            }
+
+            piece.length = offset;
+            remaining -= removed;
+            offset = 0;
+            ++index;
+        } else {
+            const Piece tail = { piece.added, piece.start + offset + remaining,
+                                 piece.length - offset - remaining };
+            piece.length = offset;
+            mPieces.insert(index + 1, tail);
+            remaining = 0;
+        }
+    }
+
+    mLength -= length;
+
+    changed();
+    return true;
+}
+
+int MImSurroundingText::length() const
+{
+    return mLength;
+}
+
+bool MImSurroundingText::isEmpty() const
+{
+    return mLength == 0;
+}
+
+QString MImSurroundingText::toString() const
+{
+    if (not mTextValid) {
+        mText = mid(0, mLength);
+        mTextValid = true;
+    }
+
+    return mText;
+}
+
+QString MImSurroundingText::mid(int position, int length) const
+{
+    if (mTextValid) {
+        return mText.mid(position, length);
+    }
+
+    position = qBound(0, position, mLength);
+    length = (length < 0) ? mLength - position : qMin(length, mLength - position);
+
+    QString result;
+    result.reserve(length);
+
+    int pieceStart = 0;
+    Q_FOREACH (const Piece &piece, mPieces) {
+        if (result.length() == length) {
+            break;
+        }
+
+        const int pieceEnd = pieceStart + piece.length;
+        if (pieceEnd > position) {
+            const int from = qMax(position - pieceStart, 0);
+            const int count = qMin(piece.length - from, length - result.length());
+            result.append(buffer(piece).midRef(piece.start + from, count));
+        }
+        pieceStart = pieceEnd;
+    }
+
+    return result;
+}
+
+int MImSurroundingText::cursorPosition() const
+{
+    return mCursorPosition;
+}
+
+void MImSurroundingText::setCursorPosition(int position)
+{
+    mCursorPosition = position;
+}
+
+int MImSurroundingText::anchorPosition() const
+{
+    return mAnchorPosition;
+}
+
+void MImSurroundingText::setAnchorPosition(int position)
+{
+    mAnchorPosition = position;
+}
+
+const QString &MImSurroundingText::buffer(const Piece &piece) const
+{
+    return piece.added ? mAdded : mOriginal;
+}
+
+void MImSurroundingText::changed()
+{
+    mText.clear();
+    mTextValid = false;
+
+    if (mPieces.size() > MaxPieces) {
+        const QString text = toString();
+        reset(text, mCursorPosition, mAnchorPosition);
+    }
+}
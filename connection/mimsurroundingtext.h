@@ -0,0 +1,85 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MIMSURROUNDINGTEXT_H
+#define MIMSURROUNDINGTEXT_H
+
+#include <QString>
+#include <QVector>
+
+/*! \internal
+ * \brief Surrounding text of the focused widget with cursor and anchor, editable in place.
+ *
+ * The text is kept as a piece table: the string received from the
+ * application is never modified, inserted text is appended to a second
+ * buffer and the document is described by a list of pieces referring to
+ * either buffer. Inserting or removing text close to the cursor therefore
+ * does not copy the whole text. Typing and then deleting at the same
+ * position grows and shrinks one piece.
+ *
+ * \a toString assembles the text when it is asked for and keeps the result
+ * until the next change, so repeated reads share one implicitly shared
+ * QString. \a mid only assembles the requested range.
+ */
+class MImSurroundingText
+{
+public:
+    MImSurroundingText();
+
+    //! Replaces the whole text, \a text is shared and not copied
+    void reset(const QString &text, int cursorPosition, int anchorPosition);
+
+    //! Inserts \a text at \a position, returns false if \a position is out of range
+    bool insert(int position, const QString &text);
+
+    //! Removes \a length characters at \a position, returns false if out of range
+    bool remove(int position, int length);
+
+    int length() const;
+    bool isEmpty() const;
+
+    QString toString() const;
+    QString mid(int position, int length) const;
+
+    int cursorPosition() const;
+    void setCursorPosition(int position);
+
+    int anchorPosition() const;
+    void setAnchorPosition(int position);
+
+private:
+    struct Piece {
+        bool added;
+        int start;
+        int length;
+    };
+
+    const QString &buffer(const Piece &piece) const;
+    void changed();
+
+    //! Text as received from the application
+    QString mOriginal;
+    //! Text inserted since, only ever appended to
+    QString mAdded;
+    QVector<Piece> mPieces;
+    int mLength;
+
+    int mCursorPosition;
+    int mAnchorPosition;
+
+    mutable QString mText;
+    mutable bool mTextValid;
+};
+
+#endif // MIMSURROUNDINGTEXT_H
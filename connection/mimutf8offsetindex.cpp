@@ -0,0 +1,179 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "mimutf8offsetindex.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const int Stride = 64;
+
+    // Four UTF-16 code units are ASCII when none has a bit above 0x7f set
+    const quint64 NonAsciiMask = Q_UINT64_C(0xff80ff80ff80ff80);
+
+    bool isAscii(const QChar *chars)
+    {
+        quint64 word;
+        memcpy(&word, chars, sizeof(word));
+        return (word & NonAsciiMask) == 0;
+    }
+}
+
+MImUtf8OffsetIndex::MImUtf8OffsetIndex()
+    : mText()
+    , mCheckpoints()
+    , mUtf8Length(0)
+{
+    build();
+}
+
+MImUtf8OffsetIndex::MImUtf8OffsetIndex(const QString &text)
+    : mText(text)
+    , mCheckpoints()
+    , mUtf8Length(0)
+{
+    build();
+}
+
+void MImUtf8OffsetIndex::setText(const QString &text)
+{
+    if (text.constData() == mText.constData() && text.size() == mText.size()) {
+        return;
+    }
+
+    mText = text;
+    build();
+}
+
+QString MImUtf8OffsetIndex::text() const
+{
+    return mText;
+}
+
+int MImUtf8OffsetIndex::utf16Length() const
+{
+    return mText.size();
+}
+
+int MImUtf8OffsetIndex::utf8Length() const
+{
+    return mUtf8Length;
+}
+
+int MImUtf8OffsetIndex::toUtf8(int offset) const
+{
+    offset = qBound(0, offset, mText.size());
+
+    const int block = offset / Stride;
+    int bytes = mCheckpoints.at(block);
+    for (int position = block * Stride; position < offset; ++position) {
+        bytes += width(position);
+    }
+
+    return bytes;
+}
+
+int MImUtf8OffsetIndex::toUtf16(int offset) const
+{
+    offset = qBound(0, offset, mUtf8Length);
+
+    // Last checkpoint not after offset
+    const QVector<int>::const_iterator checkpoint
+        = std::upper_bound(mCheckpoints.constBegin(), mCheckpoints.constEnd(), offset) - 1;
+
+    int position = (checkpoint - mCheckpoints.constBegin()) * Stride;
+    int bytes = *checkpoint;
+    while (position < mText.size()) {
+        const int next = bytes + width(position);
+        if (next > offset) {
+            break;
+        }
+        bytes = next;
+        ++position;
+    }
+
+    return position;
+}
+
+int MImUtf8OffsetIndex::utf8Length(int start, int length) const
+{
+    if (start < 0) {
+        if (length >= 0) {
+            length = qMax(0, length + start);
+        }
+        start = 0;
+    }
+
+    if (start >= mText.size()) {
+        return 0;
+    }
+
+    const int end = (length < 0) ? mText.size() : qMin(start + length, mText.size());
+    return toUtf8(end) - toUtf8(start);
+}
+
+int MImUtf8OffsetIndex::width(int position) const
+{
+    const ushort unit = mText.at(position).unicode();
+
+    if (unit < 0x80) {
+        return 1;
+    } else if (unit < 0x800) {
+        return 2;
+    } else if (QChar::isHighSurrogate(unit)) {
+        const bool paired = position + 1 < mText.size()
+                            && mText.at(position + 1).isLowSurrogate();
+        return paired ? 4 : 3;
+    } else if (QChar::isLowSurrogate(unit)) {
+        const bool paired = position > 0 && mText.at(position - 1).isHighSurrogate();
+        return paired ? 0 : 3;
+    }
+
+    return 3;
+}
+
+void MImUtf8OffsetIndex::build()
+{
+    const int size = mText.size();
+    const QChar *chars = mText.constData();
+
+    mCheckpoints.clear();
+    mCheckpoints.reserve(size / Stride + 1);
+
+    int bytes = 0;
+    for (int blockStart = 0; blockStart <= size; blockStart += Stride) {
+        mCheckpoints.append(bytes);
+
+        const int blockEnd = qMin(blockStart + Stride, size);
+        int position = blockStart;
+
+        while (position + 4 <= blockEnd) {
+            if (isAscii(chars + position)) {
+                bytes += 4;
+                position += 4;
+            } else {
+                for (int end = position + 4; position < end; ++position) {
+                    bytes += width(position);
+                }
+            }
+        }
+
+        for (; position < blockEnd; ++position) {
+            bytes += width(position);
+        }
+    }
+
+    mUtf8Length = bytes;
+}
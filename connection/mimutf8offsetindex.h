@@ -0,0 +1,67 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MIMUTF8OFFSETINDEX_H
+#define MIMUTF8OFFSETINDEX_H
+
+#include <QString>
+#include <QVector>
+
+/*! \internal
+ * \brief Maps offsets in a QString to byte offsets in its UTF-8 encoding and back.
+ *
+ * Protocols like Wayland text input count in UTF-8 bytes while Qt and the
+ * plugins count in UTF-16 code units. The index is built with one pass over
+ * the text and stores the UTF-8 offset of every Stride-th code unit, so each
+ * conversion afterwards only walks at most Stride code units. Runs of ASCII
+ * are skipped four code units at a time.
+ *
+ * A surrogate pair counts as four bytes for its first code unit. Unpaired
+ * surrogates count as three bytes, like the replacement character QString
+ * encodes them as.
+ */
+class MImUtf8OffsetIndex
+{
+public:
+    MImUtf8OffsetIndex();
+    explicit MImUtf8OffsetIndex(const QString &text);
+
+    //! Indexes \a text, does nothing if \a text shares its data with the indexed text
+    void setText(const QString &text);
+    QString text() const;
+
+    int utf16Length() const;
+    int utf8Length() const;
+
+    //! UTF-8 byte offset of UTF-16 \a offset, clamped to the text
+    int toUtf8(int offset) const;
+
+    //! UTF-16 offset of UTF-8 byte \a offset, clamped to the text. An offset
+    //! inside a multi-byte sequence maps to the start of its character.
+    int toUtf16(int offset) const;
+
+    //! Number of UTF-8 bytes of QString::midRef(\a start, \a length)
+    int utf8Length(int start, int length) const;
+
+private:
+    int width(int position) const;
+    void build();
+
+    QString mText;
+    //! UTF-8 offset of every Stride-th code unit
+    QVector<int> mCheckpoints;
+    int mUtf8Length;
+};
+
+#endif // MIMUTF8OFFSETINDEX_H
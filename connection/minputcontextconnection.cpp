@@ -13,44 +13,290 @@
  */
 
 #include "minputcontextconnection.h"
+#include "mimsurroundingtext.h"
 
-#include <QKeyEvent>
+#include <maliit/tracing.h>
 
-namespace {
-    // attribute names for updateWidgetInformation() map
-    const char * const FocusStateAttribute = "focusState";
-    const char * const ContentTypeAttribute = "contentType";
-    const char * const CorrectionAttribute = "correctionEnabled";
-    const char * const PredictionAttribute = "predictionEnabled";
-    const char * const AutoCapitalizationAttribute = "autocapitalizationEnabled";
-    const char * const SurroundingTextAttribute = "surroundingText";
-    const char * const AnchorPositionAttribute = "anchorPosition";
-    const char * const CursorPositionAttribute = "cursorPosition";
-    const char * const HasSelectionAttribute = "hasSelection";
-    const char * const InputMethodModeAttribute = "inputMethodMode";
-    const char * const WinId = "winId";
-    const char * const CursorRectAttribute = "cursorRectangle";
-    const char * const HiddenTextAttribute = "hiddenText";
-    const char * const PreeditClickPosAttribute = "preeditClickPos";
-}
+#include <QHash>
+#include <QKeyEvent>
 
 class MInputContextConnectionPrivate
 {
 public:
     MInputContextConnectionPrivate();
     ~MInputContextConnectionPrivate();
+
+    //! Widget state as last sent by each client, base for delta updates
+    QHash<unsigned int, QMap<QString, QVariant> > clientStates;
+    //! Version of the state in clientStates, 0 for full snapshots
+    QHash<unsigned int, unsigned int> clientStateVersions;
+
+    //! Last known answers to queries sent to the active application
+    QRect preeditRectangle;
+    bool preeditRectangleValid;
+    QString selection;
+    bool selectionValid;
+    //! editorStateGeneration the answers were received at
+    quint64 preeditRectangleGeneration;
+    quint64 selectionGeneration;
+
+    //! Messages waiting to be sent to outboundConnection
+    QList<MImOutboundMessage> outboundMessages;
+    unsigned int outboundConnection;
+    QTimer outboundTimer;
+
+    //! Surrounding text, cursor and anchor of the widget state, edited by the local echo
+    //! of commits and backspaces
+    MImSurroundingText surroundingText;
+    //! Whether surroundingText has local edits not yet written to the widget state
+    bool surroundingTextEdited;
+    //! Increased with every change of the widget state or of surroundingText
+    quint64 editorStateGeneration;
+
+    //! Whether a batch of redirected key events is being processed
+    bool processingKeyEvents;
+    //! Serial of the key event of the batch emitted last
+    quint32 keyEventSerial;
+    //! Serials of the batch the input method passed through
+    QList<uint> passedThroughKeyEvents;
+    //! Key events the input method wants to see
+    MImKeyFilter keyFilter;
+    //! Keys pressed and not released yet, with whether the input method gets them
+    QHash<int, bool> pressedKeys;
+
+    //! Inbound request recorded while requests are held
+    class HeldRequest
+    {
+    public:
+        explicit HeldRequest(unsigned int connectionId) : connectionId(connectionId) {}
+        virtual ~HeldRequest() {}
+
+        //! Handles the request as if it arrived now
+        virtual void release(MInputContextConnection *connection) const = 0;
+
+        const unsigned int connectionId;
+    };
+
+    //! Whether inbound requests are recorded instead of handled, see holdRequests()
+    bool holdingRequests;
+    QList<HeldRequest *> heldRequests;
+
+    void resetSurroundingText(const MImEditorState &state);
+    void applySurroundingText(MImEditorState &state) const;
+
+    bool filterKeyEvent(QEvent::Type type, int key, Qt::KeyboardModifiers modifiers,
+                        bool autoRepeat, bool composing);
 };
 
+namespace {
+    typedef MInputContextConnectionPrivate::HeldRequest HeldRequest;
+
+    // Held calls of the inbound handlers, by the number of arguments after
+    // the connection id. Created through heldCall().
+    template <typename Handler>
+    class HeldCall0 : public HeldRequest
+    {
+    public:
+        HeldCall0(Handler handler, unsigned int connectionId)
+            : HeldRequest(connectionId), handler(handler) {}
+
+        void release(MInputContextConnection *connection) const
+        {
+            (connection->*handler)(connectionId);
+        }
+
+    private:
+        Handler handler;
+    };
+
+    template <typename Handler, typename A1>
+    class HeldCall1 : public HeldRequest
+    {
+    public:
+        HeldCall1(Handler handler, unsigned int connectionId, const A1 &a1)
+            : HeldRequest(connectionId), handler(handler), a1(a1) {}
+
+        void release(MInputContextConnection *connection) const
+        {
+            (connection->*handler)(connectionId, a1);
+        }
+
+    private:
+        Handler handler;
+        A1 a1;
+    };
+
+    template <typename Handler, typename A1, typename A2>
+    class HeldCall2 : public HeldRequest
+    {
+    public:
+        HeldCall2(Handler handler, unsigned int connectionId, const A1 &a1, const A2 &a2)
+            : HeldRequest(connectionId), handler(handler), a1(a1), a2(a2) {}
+
+        void release(MInputContextConnection *connection) const
+        {
+            (connection->*handler)(connectionId, a1, a2);
+        }
+
+    private:
+        Handler handler;
+        A1 a1;
+        A2 a2;
+    };
+
+    template <typename Handler, typename A1, typename A2, typename A3, typename A4>
+    class HeldCall4 : public HeldRequest
+    {
+    public:
+        HeldCall4(Handler handler, unsigned int connectionId,
+                  const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4)
+            : HeldRequest(connectionId), handler(handler), a1(a1), a2(a2), a3(a3), a4(a4) {}
+
+        void release(MInputContextConnection *connection) const
+        {
+            (connection->*handler)(connectionId, a1, a2, a3, a4);
+        }
+
+    private:
+        Handler handler;
+        A1 a1;
+        A2 a2;
+        A3 a3;
+        A4 a4;
+    };
+
+    template <typename Handler, typename A1, typename A2, typename A3, typename A4, typename A5>
+    class HeldCall5 : public HeldRequest
+    {
+    public:
+        HeldCall5(Handler handler, unsigned int connectionId,
+                  const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5)
+            : HeldRequest(connectionId), handler(handler), a1(a1), a2(a2), a3(a3), a4(a4), a5(a5) {}
+
+        void release(MInputContextConnection *connection) const
+        {
+            (connection->*handler)(connectionId, a1, a2, a3, a4, a5);
+        }
+
+    private:
+        Handler handler;
+        A1 a1;
+        A2 a2;
+        A3 a3;
+        A4 a4;
+        A5 a5;
+    };
+
+    template <typename Handler>
+    HeldRequest *heldCall(Handler handler, unsigned int connectionId)
+    {
+        return new HeldCall0<Handler>(handler, connectionId);
+    }
+
+    template <typename Handler, typename A1>
+    HeldRequest *heldCall(Handler handler, unsigned int connectionId, const A1 &a1)
+    {
+        return new HeldCall1<Handler, A1>(handler, connectionId, a1);
+    }
+
+    template <typename Handler, typename A1, typename A2>
+    HeldRequest *heldCall(Handler handler, unsigned int connectionId, const A1 &a1, const A2 &a2)
+    {
+        return new HeldCall2<Handler, A1, A2>(handler, connectionId, a1, a2);
+    }
+
+    template <typename Handler, typename A1, typename A2, typename A3, typename A4>
+    HeldRequest *heldCall(Handler handler, unsigned int connectionId,
+                          const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4)
+    {
+        return new HeldCall4<Handler, A1, A2, A3, A4>(handler, connectionId, a1, a2, a3, a4);
+    }
+
+    template <typename Handler, typename A1, typename A2, typename A3, typename A4, typename A5>
+    HeldRequest *heldCall(Handler handler, unsigned int connectionId,
+                          const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5)
+    {
+        return new HeldCall5<Handler, A1, A2, A3, A4, A5>(handler, connectionId, a1, a2, a3, a4, a5);
+    }
+
+    //! Overloaded by the signal of the same name
+    typedef void (MInputContextConnection::*MouseClickedOnPreeditHandler)(unsigned int,
+                                                                          const QPoint &,
+                                                                          const QRect &);
+}
 
 MInputContextConnectionPrivate::MInputContextConnectionPrivate()
+    : preeditRectangleValid(false)
+    , selectionValid(false)
+    , preeditRectangleGeneration(0)
+    , selectionGeneration(0)
+    , outboundConnection(0)
+    , surroundingTextEdited(false)
+    , editorStateGeneration(0)
+    , processingKeyEvents(false)
+    , keyEventSerial(0)
+    , keyFilter()
+    , pressedKeys()
+    , holdingRequests(false)
 {
-    // nothing
+    outboundTimer.setSingleShot(true);
+    outboundTimer.setInterval(0);
 }
 
 
 MInputContextConnectionPrivate::~MInputContextConnectionPrivate()
 {
-    // nothing
+    qDeleteAll(heldRequests);
+}
+
+/*!
+ * Returns whether the input method gets the key event. A press is checked
+ * against the key filter and its release goes the same way, even if a
+ * commit in between changed the composing state.
+ */
+bool MInputContextConnectionPrivate::filterKeyEvent(QEvent::Type type, int key,
+                                                    Qt::KeyboardModifiers modifiers,
+                                                    bool autoRepeat, bool composing)
+{
+    const QHash<int, bool>::iterator pressed = pressedKeys.find(key);
+
+    if (type == QEvent::KeyRelease) {
+        if (pressed == pressedKeys.end()) {
+            // pressed before the client was active
+            return keyFilter.matches(key, modifiers, composing);
+        }
+
+        const bool handled = pressed.value();
+        if (not autoRepeat) {
+            pressedKeys.erase(pressed);
+        }
+        return handled;
+    }
+
+    if (autoRepeat && pressed != pressedKeys.end()) {
+        return pressed.value();
+    }
+
+    const bool handled = keyFilter.matches(key, modifiers, composing);
+    pressedKeys.insert(key, handled);
+    return handled;
+}
+
+void MInputContextConnectionPrivate::resetSurroundingText(const MImEditorState &state)
+{
+    surroundingText.reset(state.surroundingText(), state.cursorPosition(), state.anchorPosition());
+    surroundingTextEdited = false;
+}
+
+void MInputContextConnectionPrivate::applySurroundingText(MImEditorState &state) const
+{
+    if (not surroundingTextEdited) {
+        return;
+    }
+
+    state.setSurroundingText(surroundingText.toString());
+    state.setCursorPosition(surroundingText.cursorPosition());
+    state.setAnchorPosition(surroundingText.anchorPosition());
 }
 
 
@@ -66,6 +312,9 @@ MInputContextConnection::MInputContextConnection(QObject *parent)
     , mDetectableAutoRepeat(false)
 {
     Q_UNUSED(parent);
+
+    connect(&d->outboundTimer, SIGNAL(timeout()),
+            this, SLOT(flushOutboundMessages()));
 }
 
 
@@ -77,61 +326,53 @@ MInputContextConnection::~MInputContextConnection()
 /* Accessors to widgetState */
 bool MInputContextConnection::focusState(bool &valid)
 {
-    QVariant focusStateVariant = mWidgetState[FocusStateAttribute];
-    valid = focusStateVariant.isValid();
-    return focusStateVariant.toBool();
+    valid = mWidgetState.contains(MImEditorState::FocusStateField);
+    return mWidgetState.focusState();
 }
 
 int MInputContextConnection::contentType(bool &valid)
 {
-    QVariant contentTypeVariant = mWidgetState[ContentTypeAttribute];
-    return contentTypeVariant.toInt(&valid);
+    valid = mWidgetState.contains(MImEditorState::ContentTypeField);
+    return mWidgetState.contentType();
 }
 
 bool MInputContextConnection::correctionEnabled(bool &valid)
 {
-    QVariant correctionVariant = mWidgetState[CorrectionAttribute];
-    valid = correctionVariant.isValid();
-    return correctionVariant.toBool();
+    valid = mWidgetState.contains(MImEditorState::CorrectionField);
+    return mWidgetState.correctionEnabled();
 }
 
 
 bool MInputContextConnection::predictionEnabled(bool &valid)
 {
-    QVariant predictionVariant = mWidgetState[PredictionAttribute];
-    valid = predictionVariant.isValid();
-    return predictionVariant.toBool();
+    valid = mWidgetState.contains(MImEditorState::PredictionField);
+    return mWidgetState.predictionEnabled();
 }
 
 bool MInputContextConnection::autoCapitalizationEnabled(bool &valid)
 {
-    QVariant capitalizationVariant = mWidgetState[AutoCapitalizationAttribute];
-    valid = capitalizationVariant.isValid();
-    return capitalizationVariant.toBool();
+    valid = mWidgetState.contains(MImEditorState::AutoCapitalizationField);
+    return mWidgetState.autoCapitalizationEnabled();
 }
 
 QRect MInputContextConnection::cursorRectangle(bool &valid)
 {
-    QVariant cursorRectVariant = mWidgetState[CursorRectAttribute];
-    valid = cursorRectVariant.isValid();
-    return cursorRectVariant.toRect();
+    valid = mWidgetState.contains(MImEditorState::CursorRectangleField);
+    return mWidgetState.cursorRectangle();
 }
 
 bool MInputContextConnection::hiddenText(bool &valid)
 {
-    QVariant hiddenTextVariant = mWidgetState[HiddenTextAttribute];
-    valid = hiddenTextVariant.isValid();
-    return hiddenTextVariant.toBool();
+    valid = mWidgetState.contains(MImEditorState::HiddenTextField);
+    return mWidgetState.hiddenText();
 }
 
 bool MInputContextConnection::surroundingText(QString &text, int &cursorPosition)
 {
-    QVariant textVariant = mWidgetState[SurroundingTextAttribute];
-    QVariant posVariant = mWidgetState[CursorPositionAttribute];
-
-    if (textVariant.isValid() && posVariant.isValid()) {
-        text = textVariant.toString();
-        cursorPosition = posVariant.toInt();
+    if (mWidgetState.contains(MImEditorState::SurroundingTextField)
+        && mWidgetState.contains(MImEditorState::CursorPositionField)) {
+        text = d->surroundingText.toString();
+        cursorPosition = d->surroundingText.cursorPosition();
         return true;
     }
 
@@ -140,15 +381,14 @@ bool MInputContextConnection::surroundingText(QString &text, int &cursorPosition
 
 bool MInputContextConnection::hasSelection(bool &valid)
 {
-    QVariant selectionVariant = mWidgetState[HasSelectionAttribute];
-    valid = selectionVariant.isValid();
-    return selectionVariant.toBool();
+    valid = mWidgetState.contains(MImEditorState::HasSelectionField);
+    return mWidgetState.hasSelection();
 }
 
 int MInputContextConnection::inputMethodMode(bool &valid)
 {
-    QVariant modeVariant = mWidgetState[InputMethodModeAttribute];
-    return modeVariant.toInt(&valid);
+    valid = mWidgetState.contains(MImEditorState::InputMethodModeField);
+    return mWidgetState.inputMethodMode();
 }
 
 QRect MInputContextConnection::preeditRectangle(bool &valid)
@@ -157,44 +397,46 @@ QRect MInputContextConnection::preeditRectangle(bool &valid)
     return QRect();
 }
 
+void MInputContextConnection::requestPreeditRectangle()
+{
+    bool valid = false;
+    const QRect rectangle = preeditRectangle(valid);
+    Q_EMIT preeditRectangleReceived(rectangle, valid);
+}
+
 WId MInputContextConnection::winId()
 {
 #ifdef Q_WS_WIN
     WId result = 0;
     return result;
 #else
-    QVariant winIdVariant = mWidgetState[WinId];
-    // after transfer by dbus type can change
-    switch (winIdVariant.type()) {
-    case QVariant::UInt:
-        if (sizeof(uint) >= sizeof(WId))
-            return winIdVariant.toUInt();
-        break;
-    case QVariant::ULongLong:
-        if (sizeof(qulonglong) >= sizeof(WId))
-            return winIdVariant.toULongLong();
-        break;
-    default:
-        if (winIdVariant.canConvert<WId>())
-            return winIdVariant.value<WId>();
-    }
-    return 0;
+    return static_cast<WId>(mWidgetState.winId());
 #endif
 }
 
 
 int MInputContextConnection::anchorPosition(bool &valid)
 {
-    QVariant posVariant = mWidgetState[AnchorPositionAttribute];
-    valid = posVariant.isValid();
-    return posVariant.toInt();
+    valid = mWidgetState.contains(MImEditorState::AnchorPositionField);
+    return d->surroundingText.anchorPosition();
+}
+
+MImEditorState MInputContextConnection::editorState() const
+{
+    MImEditorState state(mWidgetState);
+    d->applySurroundingText(state);
+    return state;
+}
+
+quint64 MInputContextConnection::editorStateGeneration() const
+{
+    return d->editorStateGeneration;
 }
 
 int MInputContextConnection::preeditClickPos(bool &valid) const
 {
-    QVariant selectionVariant = mWidgetState[PreeditClickPosAttribute];
-    valid = selectionVariant.isValid();
-    return selectionVariant.toInt();
+    valid = mWidgetState.contains(MImEditorState::PreeditClickPosField);
+    return mWidgetState.preeditClickPos();
 }
 
 /* End accessors to widget state */
@@ -202,15 +444,27 @@ int MInputContextConnection::preeditClickPos(bool &valid) const
 /* Handlers for inbound communication */
 void MInputContextConnection::showInputMethod(unsigned int connectionId)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::showInputMethod, connectionId));
+        return;
+    }
+
     if (activeConnection != connectionId)
         return;
 
+    Maliit::Tracing::event("server showInputMethod");
+
     Q_EMIT showInputMethodRequest();
 }
 
 
 void MInputContextConnection::hideInputMethod(unsigned int connectionId)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::hideInputMethod, connectionId));
+        return;
+    }
+
     // Only allow this call for current active connection.
     if (activeConnection != connectionId)
         return;
@@ -222,6 +476,12 @@ void MInputContextConnection::hideInputMethod(unsigned int connectionId)
 void MInputContextConnection::mouseClickedOnPreedit(unsigned int connectionId,
                                                             const QPoint &pos, const QRect &preeditRect)
 {
+    if (d->holdingRequests) {
+        const MouseClickedOnPreeditHandler handler = &MInputContextConnection::mouseClickedOnPreedit;
+        d->heldRequests.append(heldCall(handler, connectionId, pos, preeditRect));
+        return;
+    }
+
     if (activeConnection != connectionId)
         return;
 
@@ -232,6 +492,12 @@ void MInputContextConnection::mouseClickedOnPreedit(unsigned int connectionId,
 void MInputContextConnection::setPreedit(unsigned int connectionId,
                                                  const QString &text, int cursorPos)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::setPreedit, connectionId,
+                                        text, cursorPos));
+        return;
+    }
+
     if (activeConnection != connectionId)
         return;
 
@@ -243,6 +509,11 @@ void MInputContextConnection::setPreedit(unsigned int connectionId,
 
 void MInputContextConnection::reset(unsigned int connectionId)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::reset, connectionId));
+        return;
+    }
+
     if (activeConnection != connectionId)
         return;
 
@@ -261,12 +532,28 @@ MInputContextConnection::updateWidgetInformation(
     unsigned int connectionId, const QMap<QString, QVariant> &stateInfo,
     bool handleFocusChange)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::updateWidgetInformation, connectionId,
+                                        stateInfo, handleFocusChange));
+        return;
+    }
+
+    // A full snapshot is the new base for delta updates from this client
+    d->clientStates.insert(connectionId, stateInfo);
+    d->clientStateVersions.insert(connectionId, 0);
+
     if (activeConnection != connectionId)
         return;
 
-    QMap<QString, QVariant> oldState = mWidgetState;
+    d->applySurroundingText(mWidgetState);
+    const QMap<QString, QVariant> oldState = mWidgetState.toMap();
 
-    mWidgetState = stateInfo;
+    mWidgetState.clearChanges();
+    mWidgetState.reset(stateInfo);
+    d->resetSurroundingText(mWidgetState);
+    if (mWidgetState.hasChanges()) {
+        ++d->editorStateGeneration;
+    }
 
 #ifndef Q_WS_WIN
     if (handleFocusChange) {
@@ -274,13 +561,115 @@ MInputContextConnection::updateWidgetInformation(
     }
 #endif
 
-    Q_EMIT widgetStateChanged(connectionId, mWidgetState, oldState, handleFocusChange);
+    Q_EMIT widgetStateChanged(connectionId, stateInfo, oldState, handleFocusChange,
+                              mWidgetState.changedFields(), mWidgetState.changedExtensions());
+}
+
+bool
+MInputContextConnection::updateWidgetInformationDelta(
+    unsigned int connectionId, unsigned int baseVersion, unsigned int version,
+    const QMap<QString, QVariant> &changedInformation, const QStringList &removedKeys,
+    int textSpliceStart, int textSpliceLength, const QString &textSpliceText,
+    bool handleFocusChange)
+{
+    // Held full snapshots are not stored yet, the client has to send another one
+    if (d->holdingRequests) {
+        return false;
+    }
+
+    QHash<unsigned int, QMap<QString, QVariant> >::iterator state = d->clientStates.find(connectionId);
+
+    if (state == d->clientStates.end()
+        || d->clientStateVersions.value(connectionId) != baseVersion) {
+        return false;
+    }
+
+    QStringList changedProperties;
+
+    for (QMap<QString, QVariant>::const_iterator iter = changedInformation.constBegin();
+         iter != changedInformation.constEnd();
+         ++iter)
+    {
+        state->insert(iter.key(), iter.value());
+        changedProperties.append(iter.key());
+    }
+
+    Q_FOREACH (const QString &key, removedKeys) {
+        state->remove(key);
+    }
+
+    if (textSpliceStart >= 0) {
+        const QString surroundingTextKey = MImEditorState::key(MImEditorState::SurroundingTextField);
+        QString text = state->take(surroundingTextKey).toString();
+
+        if (textSpliceLength < 0 || textSpliceStart + textSpliceLength > text.length()) {
+            qWarning() << __PRETTY_FUNCTION__ << "Surrounding text splice out of range,"
+                       << "requesting full widget state";
+            d->clientStates.erase(state);
+            d->clientStateVersions.remove(connectionId);
+            return false;
+        }
+
+        text.replace(textSpliceStart, textSpliceLength, textSpliceText);
+        state->insert(surroundingTextKey, text);
+
+        if (not changedProperties.contains(surroundingTextKey)) {
+            changedProperties.append(surroundingTextKey);
+        }
+    }
+
+    d->clientStateVersions.insert(connectionId, version);
+
+    if (activeConnection != connectionId)
+        return true;
+
+    d->applySurroundingText(mWidgetState);
+    const QMap<QString, QVariant> oldState = mWidgetState.toMap();
+
+    mWidgetState.clearChanges();
+    mWidgetState.reset(*state);
+    d->resetSurroundingText(mWidgetState);
+    if (mWidgetState.hasChanges()) {
+        ++d->editorStateGeneration;
+    }
+
+    // Optimistic local changes done in sendCommitString() and sendKeyEvent()
+    // may already match what the client reports now.
+    MImEditorState::Fields changedFields = MImEditorState::NoField;
+    QStringList changedExtensions;
+    const QStringList stateExtensions = mWidgetState.changedExtensions();
+    Q_FOREACH (const QString &property, changedProperties) {
+        const MImEditorState::Field field = MImEditorState::field(property);
+        if (field != MImEditorState::NoField) {
+            changedFields |= field;
+        } else if (stateExtensions.contains(property)) {
+            changedExtensions.append(property);
+        }
+    }
+    changedFields &= mWidgetState.changedFields();
+
+#ifndef Q_WS_WIN
+    if (handleFocusChange) {
+        Q_EMIT focusChanged(winId());
+    }
+#endif
+
+    Q_EMIT widgetStateChanged(connectionId, *state, oldState, handleFocusChange,
+                              changedFields, changedExtensions);
+
+    return true;
 }
 
 void
 MInputContextConnection::receivedAppOrientationAboutToChange(unsigned int connectionId,
                                                                      int angle)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::receivedAppOrientationAboutToChange,
+                                        connectionId, angle));
+        return;
+    }
+
     if (activeConnection != connectionId)
         return;
 
@@ -296,6 +685,12 @@ MInputContextConnection::receivedAppOrientationAboutToChange(unsigned int connec
 void MInputContextConnection::receivedAppOrientationChanged(unsigned int connectionId,
                                                                     int angle)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::receivedAppOrientationChanged,
+                                        connectionId, angle));
+        return;
+    }
+
     if (activeConnection != connectionId)
         return;
 
@@ -310,6 +705,12 @@ void MInputContextConnection::receivedAppOrientationChanged(unsigned int connect
 void MInputContextConnection::setCopyPasteState(unsigned int connectionId,
                                                         bool copyAvailable, bool pasteAvailable)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::setCopyPasteState, connectionId,
+                                        copyAvailable, pasteAvailable));
+        return;
+    }
+
     if (activeConnection != connectionId)
         return;
 
@@ -325,19 +726,93 @@ void MInputContextConnection::processKeyEvent(
     if (activeConnection != connectionId)
         return;
 
+    // Key events are not held, typing must not wait for the input method
+    if (d->holdingRequests
+        || not d->filterKeyEvent(keyType, keyCode, modifiers, autoRepeat, not preedit.isEmpty())) {
+        passThroughKeyEvent(QKeyEvent(keyType, keyCode, modifiers, nativeScanCode, 0,
+                                      nativeModifiers, text, autoRepeat, count));
+        return;
+    }
+
     Q_EMIT receivedKeyEvent(keyType, keyCode,
                             modifiers, text, autoRepeat, count,
                             nativeScanCode, nativeModifiers, time);
 }
 
+void MInputContextConnection::processKeyEvents(unsigned int connectionId,
+                                               const MImKeyEventBatch &batch)
+{
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    QList<uint> passedThrough;
+
+    // Key events are not held, typing must not wait for the input method
+    if (activeConnection != connectionId || d->holdingRequests) {
+        for (int i = 0; i < batch.count(); ++i) {
+            passedThrough.append(batch.at(i).serial);
+        }
+    } else {
+        d->processingKeyEvents = true;
+
+        for (int i = 0; i < batch.count(); ++i) {
+            const MImKeyEventRecord record = batch.at(i);
+            const QEvent::Type type = static_cast<QEvent::Type>(record.type);
+            const Qt::KeyboardModifiers modifiers = static_cast<Qt::KeyboardModifiers>(record.modifiers);
+            d->keyEventSerial = record.serial;
+
+            const bool wanted = d->filterKeyEvent(type, record.key, modifiers, record.isAutoRepeat(),
+                                                  not preedit.isEmpty());
+
+            // Merged auto-repeats reach the input method one by one, as sent
+            for (int n = 0; n < record.eventCount(); ++n) {
+                if (not wanted) {
+                    passThroughKeyEvent(QKeyEvent(type, record.key, modifiers,
+                                                  record.nativeScanCode, record.nativeVirtualKey,
+                                                  record.nativeModifiers,
+                                                  record.textString(), record.isAutoRepeat(),
+                                                  record.eventKeyCount()));
+                    continue;
+                }
+
+                Q_EMIT receivedKeyEvent(type, static_cast<Qt::Key>(record.key), modifiers,
+                                        record.textString(), record.isAutoRepeat(), record.eventKeyCount(),
+                                        record.nativeScanCode, record.nativeModifiers, record.time);
+            }
+        }
+
+        d->processingKeyEvents = false;
+        passedThrough = d->passedThroughKeyEvents;
+        d->passedThroughKeyEvents.clear();
+    }
+
+    // Whatever the input method sent for these events goes out first
+    flushOutboundMessages();
+
+    sendKeyEventsProcessed(connectionId, batch.at(batch.count() - 1).serial, passedThrough);
+}
+
 void MInputContextConnection::registerAttributeExtension(unsigned int connectionId, int id,
                                                          const QString &attributeExtension)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::registerAttributeExtension,
+                                        connectionId, id, attributeExtension));
+        return;
+    }
+
     Q_EMIT attributeExtensionRegistered(connectionId, id, attributeExtension);
 }
 
 void MInputContextConnection::unregisterAttributeExtension(unsigned int connectionId, int id)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::unregisterAttributeExtension,
+                                        connectionId, id));
+        return;
+    }
+
     Q_EMIT attributeExtensionUnregistered(connectionId, id);
 }
 
@@ -345,11 +820,36 @@ void MInputContextConnection::setExtendedAttribute(
     unsigned int connectionId, int id, const QString &target, const QString &targetName,
     const QString &attribute, const QVariant &value)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::setExtendedAttribute, connectionId,
+                                        id, target, targetName, attribute, value));
+        return;
+    }
+
     Q_EMIT extendedAttributeChanged(connectionId, id, target, targetName, attribute, value);
 }
 
+void MInputContextConnection::setExtendedAttributes(
+    unsigned int connectionId, int id, const QString &target, const QString &targetName,
+    const QVariantMap &attributes)
+{
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::setExtendedAttributes, connectionId,
+                                        id, target, targetName, attributes));
+        return;
+    }
+
+    Q_EMIT extendedAttributesChanged(connectionId, id, target, targetName, attributes);
+}
+
 void MInputContextConnection::loadPluginSettings(int connectionId, const QString &descriptionLanguage)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::loadPluginSettings, connectionId,
+                                        descriptionLanguage));
+        return;
+    }
+
     Q_EMIT pluginSettingsRequested(connectionId, descriptionLanguage);
 }
 /* End handlers for inbound communication */
@@ -388,7 +888,7 @@ bool MInputContextConnection::redirectKeysEnabled()
 void MInputContextConnection::sendCommitString(const QString &string, int replaceStart,
                                           int replaceLength, int cursorPos) {
 
-    const int cursorPosition(mWidgetState[CursorPositionAttribute].toInt());
+    const int cursorPosition(d->surroundingText.cursorPosition());
     bool validAnchor(false);
 
     preedit.clear();
@@ -398,11 +898,13 @@ void MInputContextConnection::sendCommitString(const QString &string, int replac
         && anchorPosition(validAnchor) == cursorPosition
         && validAnchor) {
         const int insertPosition(cursorPosition + replaceStart);
-        if (insertPosition >= 0) {
-            mWidgetState[SurroundingTextAttribute]
-                = mWidgetState[SurroundingTextAttribute].toString().insert(insertPosition, string);
-            mWidgetState[CursorPositionAttribute] = cursorPos < 0 ? (insertPosition + string.length()) : cursorPos;
-            mWidgetState[AnchorPositionAttribute] = mWidgetState[CursorPositionAttribute];
+        if (insertPosition >= 0
+            && d->surroundingText.insert(qMin(insertPosition, d->surroundingText.length()), string)) {
+            const int newPosition(cursorPos < 0 ? (insertPosition + string.length()) : cursorPos);
+            d->surroundingText.setCursorPosition(newPosition);
+            d->surroundingText.setAnchorPosition(newPosition);
+            d->surroundingTextEdited = true;
+            ++d->editorStateGeneration;
         }
     }
 }
@@ -414,26 +916,67 @@ void MInputContextConnection::sendKeyEvent(const QKeyEvent &keyEvent,
         && preedit.isEmpty()
         && keyEvent.key() == Qt::Key_Backspace
         && keyEvent.type() == QEvent::KeyPress) {
-        QString surrString(mWidgetState[SurroundingTextAttribute].toString());
-        const int cursorPosition(mWidgetState[CursorPositionAttribute].toInt());
+        const int cursorPosition(d->surroundingText.cursorPosition());
         bool validAnchor(false);
 
-        if (!surrString.isEmpty()
+        if (!d->surroundingText.isEmpty()
             && cursorPosition > 0
             // we don't support selections
             && anchorPosition(validAnchor) == cursorPosition
-            && validAnchor) {
-            mWidgetState[SurroundingTextAttribute] = surrString.remove(cursorPosition - 1, 1);
-            mWidgetState[CursorPositionAttribute] = cursorPosition - 1;
-            mWidgetState[AnchorPositionAttribute] = cursorPosition - 1;
+            && validAnchor
+            && d->surroundingText.remove(cursorPosition - 1, 1)) {
+            d->surroundingText.setCursorPosition(cursorPosition - 1);
+            d->surroundingText.setAnchorPosition(cursorPosition - 1);
+            d->surroundingTextEdited = true;
+            ++d->editorStateGeneration;
         }
     }
 }
+
+void MInputContextConnection::passThroughKeyEvent(const QKeyEvent &keyEvent)
+{
+    if (not d->processingKeyEvents) {
+        sendKeyEvent(keyEvent, Maliit::EventRequestBoth);
+        return;
+    }
+
+    // Local echo only, the application delivers its own event
+    MInputContextConnection::sendKeyEvent(keyEvent, Maliit::EventRequestBoth);
+
+    // Several plugins may pass the same event through
+    if (d->passedThroughKeyEvents.isEmpty()
+        || d->passedThroughKeyEvents.last() != d->keyEventSerial) {
+        d->passedThroughKeyEvents.append(d->keyEventSerial);
+    }
+}
+
+void MInputContextConnection::setKeyFilter(const MImKeyFilter &filter)
+{
+    d->keyFilter = filter;
+}
 /* */
 
 /* */
 void MInputContextConnection::handleDisconnection(unsigned int connectionId)
 {
+    d->clientStates.remove(connectionId);
+    d->clientStateVersions.remove(connectionId);
+
+    QList<HeldRequest *>::iterator request = d->heldRequests.begin();
+    while (request != d->heldRequests.end()) {
+        if ((*request)->connectionId == connectionId) {
+            delete *request;
+            request = d->heldRequests.erase(request);
+        } else {
+            ++request;
+        }
+    }
+
+    if (d->outboundConnection == connectionId) {
+        d->outboundMessages.clear();
+        d->outboundTimer.stop();
+    }
+
     Q_EMIT clientDisconnected(connectionId);
 
     if (activeConnection != connectionId) {
@@ -441,21 +984,37 @@ void MInputContextConnection::handleDisconnection(unsigned int connectionId)
     }
 
     activeConnection = 0;
+    d->pressedKeys.clear();
 
     Q_EMIT activeClientDisconnected();
 }
 
 void MInputContextConnection::activateContext(unsigned int connectionId)
 {
+    if (d->holdingRequests) {
+        d->heldRequests.append(heldCall(&MInputContextConnection::activateContext, connectionId));
+        return;
+    }
+
     if (connectionId == activeConnection) {
         return;
     }
 
+    /* Messages queued for the previously active context go out first */
+    flushOutboundMessages();
+
     /* Notify current/previously active context that it is no longer active */
     sendActivationLostEvent();
 
     activeConnection = connectionId;
 
+    /* Keys held down in the previous application are released there */
+    d->pressedKeys.clear();
+
+    /* Answers of the previous application are meaningless for the new one */
+    setLastPreeditRectangle(QRect(), false);
+    setLastSelection(QString(), false);
+
     /* Notify new input context about state/settings stored in the IM server */
     if (activeConnection) {
         /* Hack: Circumvent if(newValue == oldValue) return; guards */
@@ -474,6 +1033,30 @@ void MInputContextConnection::activateContext(unsigned int connectionId)
 }
 /* */
 
+void MInputContextConnection::holdRequests()
+{
+    d->holdingRequests = true;
+}
+
+void MInputContextConnection::releaseRequests()
+{
+    if (not d->holdingRequests) {
+        return;
+    }
+
+    d->holdingRequests = false;
+
+    const QList<HeldRequest *> requests = d->heldRequests;
+    d->heldRequests.clear();
+
+    Maliit::Tracing::event("server held requests released");
+
+    Q_FOREACH (const HeldRequest *request, requests) {
+        request->release(this);
+        delete request;
+    }
+}
+
 void MInputContextConnection::sendPreeditString(const QString &string,
                                                 const QList<Maliit::PreeditTextFormat> &preeditFormats,
                                                 int replaceStart, int replaceLength,
@@ -513,6 +1096,13 @@ QString MInputContextConnection::selection(bool &valid)
     return QString();
 }
 
+void MInputContextConnection::requestSelection()
+{
+    bool valid = false;
+    const QString text = selection(valid);
+    Q_EMIT selectionReceived(text, valid);
+}
+
 void MInputContextConnection::setLanguage(const QString &language)
 {
     Q_UNUSED(language);
@@ -556,5 +1146,102 @@ void MInputContextConnection::pluginSettingsLoaded(int clientId, const QList<MIm
 
 QVariantMap MInputContextConnection::widgetState() const
 {
-    return mWidgetState;
+    return editorState().toMap();
+}
+
+QRect MInputContextConnection::lastPreeditRectangle(bool &valid) const
+{
+    // An answer received before the editor state changed describes an older state
+    valid = d->preeditRectangleValid
+            && d->preeditRectangleGeneration == d->editorStateGeneration;
+    return d->preeditRectangle;
+}
+
+void MInputContextConnection::setLastPreeditRectangle(const QRect &rectangle, bool valid)
+{
+    d->preeditRectangle = rectangle;
+    d->preeditRectangleValid = valid;
+    d->preeditRectangleGeneration = d->editorStateGeneration;
+}
+
+QString MInputContextConnection::lastSelection(bool &valid) const
+{
+    valid = d->selectionValid
+            && d->selectionGeneration == d->editorStateGeneration;
+    return d->selection;
+}
+
+void MInputContextConnection::setLastSelection(const QString &selection, bool valid)
+{
+    d->selection = selection;
+    d->selectionValid = valid;
+    d->selectionGeneration = d->editorStateGeneration;
+}
+
+void MInputContextConnection::queueOutboundMessage(const MImOutboundMessage &message)
+{
+    if (!activeConnection) {
+        return;
+    }
+
+    if (d->outboundConnection != activeConnection) {
+        flushOutboundMessages();
+        d->outboundConnection = activeConnection;
+    }
+
+    if (message.type == MImOutboundMessage::UpdatePreedit) {
+        // A queued preedit is superseded if nothing touching the text came
+        // after it, unless it also removes surrounding text.
+        for (int i = d->outboundMessages.count() - 1; i >= 0; --i) {
+            const MImOutboundMessage &queued = d->outboundMessages.at(i);
+
+            if (queued.type == MImOutboundMessage::UpdatePreedit) {
+                if (queued.replacementLength == 0) {
+                    d->outboundMessages.removeAt(i);
+                }
+                break;
+            } else if (queued.type != MImOutboundMessage::ExtendedAttributeChanged) {
+                break;
+            }
+        }
+    }
+
+    d->outboundMessages.append(message);
+
+    if (!d->outboundTimer.isActive()) {
+        d->outboundTimer.start();
+    }
+}
+
+void MInputContextConnection::flushOutboundMessages()
+{
+    d->outboundTimer.stop();
+
+    if (d->outboundMessages.isEmpty()) {
+        return;
+    }
+
+    const QList<MImOutboundMessage> messages(d->outboundMessages);
+    d->outboundMessages.clear();
+
+    sendOutboundMessages(d->outboundConnection, messages);
+}
+
+void MInputContextConnection::sendOutboundMessages(unsigned int connectionId,
+                                                   const QList<MImOutboundMessage> &messages)
+{
+    Q_UNUSED(connectionId);
+    Q_UNUSED(messages);
+
+    // empty default implementation
+}
+
+void MInputContextConnection::sendKeyEventsProcessed(unsigned int connectionId, quint32 lastSerial,
+                                                     const QList<uint> &passedThrough)
+{
+    Q_UNUSED(connectionId);
+    Q_UNUSED(lastSerial);
+    Q_UNUSED(passedThrough);
+
+    // empty default implementation
 }
@@ -16,6 +16,11 @@
 #define MINPUTCONTEXTCONNECTION_H
 
 #include <maliit/namespace.h>
+#include <maliit/keyfilter.h>
+
+#include "mimoutboundmessage.h"
+#include "mimkeyeventbatch.h"
+#include "mimeditorstate.h"
 
 #include <QtCore>
 #include <QWindow>
@@ -94,6 +99,14 @@ public:
      */
     virtual QRect preeditRectangle(bool &valid);
 
+    /*!
+     * \brief Requests the preedit rectangle without blocking.
+     *
+     * The answer is delivered through \a preeditRectangleReceived. If the application
+     * does not answer in time, the last known preedit rectangle is delivered instead.
+     */
+    virtual void requestPreeditRectangle();
+
     /*!
      * \brief get cursor rectangle
      */
@@ -149,6 +162,24 @@ public:
                               Maliit::EventRequestType requestType
                               = Maliit::EventRequestBoth);
 
+    /*!
+     * \brief Lets the application handle a redirected hardware key event itself.
+     *
+     * While a batch from \a processKeyEvents is processed, the application is
+     * told to deliver its original event once the batch has been processed.
+     * Otherwise \a keyEvent is sent like with \a sendKeyEvent.
+     */
+    virtual void passThroughKeyEvent(const QKeyEvent &keyEvent);
+
+    /*!
+     * \brief Sets which redirected hardware key events are emitted with \a receivedKeyEvent
+     *
+     * Key events not matching \a filter are passed through to the application
+     * right away, without emitting \a receivedKeyEvent. The default filter
+     * matches every key event.
+     */
+    void setKeyFilter(const MImKeyFilter &filter);
+
     /*!
      * \brief notifies about hiding initiated by the input method server side
      */
@@ -202,11 +233,30 @@ public:
      */
     virtual int preeditClickPos(bool &valid) const;
 
+    /*!
+     * \brief returns the widget state of the active application, including
+     * the local echo of committed text
+     */
+    MImEditorState editorState() const;
+
+    /*!
+     * \brief returns a counter increased with every change of \a editorState
+     */
+    quint64 editorStateGeneration() const;
+
     /*!
      * \brief returns the selecting text
      */
     virtual QString selection(bool &valid);
 
+    /*!
+     * \brief Requests the selected text without blocking.
+     *
+     * The answer is delivered through \a selectionReceived. If the application
+     * does not answer in time, the last known selection is delivered instead.
+     */
+    virtual void requestSelection();
+
     /*!
      * \brief Sets current language of active input method.
      * \param language ICU format locale ID string
@@ -236,9 +286,48 @@ public: // Inbound communication handlers
                                  const QMap<QString, QVariant> &stateInformation,
                                  bool focusChanged);
 
+    /*!
+     * \brief Applies an incremental widget state update sent by the application.
+     *
+     * The update is only applied if \a baseVersion matches the version of the state
+     * last received from \a clientId, either through a previous delta or through
+     * \a updateWidgetInformation (which resets the version to 0).
+     *
+     * \param clientId The connection the update came from
+     * \param baseVersion Version of the client state the delta was computed against
+     * \param version Version of the client state after applying the delta
+     * \param changedInformation Attributes that were added or whose value changed
+     * \param removedKeys Attributes that are no longer part of the state
+     * \param textSpliceStart Start of the replaced part of the surrounding text, or -1
+     * if the surrounding text did not change
+     * \param textSpliceLength Number of characters replaced in the surrounding text
+     * \param textSpliceText Text inserted at \a textSpliceStart
+     * \param focusChanged Whether the focus changed with this update
+     * \return false if the delta does not apply to the stored state and the client
+     * needs to send a full snapshot
+     */
+    bool updateWidgetInformationDelta(unsigned int clientId,
+                                      unsigned int baseVersion, unsigned int version,
+                                      const QMap<QString, QVariant> &changedInformation,
+                                      const QStringList &removedKeys,
+                                      int textSpliceStart, int textSpliceLength,
+                                      const QString &textSpliceText,
+                                      bool focusChanged);
+
     //! ipc method provided to the application, resets the input method
     void reset(unsigned int clientId);
 
+    /*!
+     * \brief Records inbound requests instead of handling them until \a releaseRequests.
+     *
+     * Meant for server startup, so that applications can connect before the
+     * active input method is loaded. Inbound requests are recorded and handled
+     * in order on release. Key events are not recorded but passed through to
+     * the application right away, so typing does not wait for the input method.
+     * Delta updates are refused so that clients send a full snapshot instead.
+     */
+    void holdRequests();
+
     /*!
      * \brief Target application is changing orientation
      */
@@ -260,11 +349,22 @@ public: // Inbound communication handlers
      * \brief Process a key event redirected from hardware keyboard to input method plugin(s).
      *
      * This is called only if one has enabled redirection by calling \a setRedirectKeys.
+     * Events not matching the key filter are passed through without being emitted.
      */
     void processKeyEvent(unsigned int clientId, QEvent::Type keyType, Qt::Key keyCode,
                          Qt::KeyboardModifiers modifiers, const QString &text, bool autoRepeat,
                          int count, quint32 nativeScanCode, quint32 nativeModifiers, unsigned long time);
 
+    /*!
+     * \brief Process hardware key events redirected in one batch.
+     *
+     * Each event matching the key filter is emitted with \a receivedKeyEvent,
+     * the others are passed through. Afterwards the client is told
+     * through \a sendKeyEventsProcessed which of them were passed through. Events
+     * of a client that is not active are all passed through.
+     */
+    void processKeyEvents(unsigned int clientId, const MImKeyEventBatch &batch);
+
     /*!
      * \brief Register an input method attribute extension which is defined in \a fileName with the
      * unique identifier \a id.
@@ -285,6 +385,12 @@ public: // Inbound communication handlers
     void setExtendedAttribute(unsigned int clientId, int id, const QString &target,
                               const QString &targetItem, const QString &attribute, const QVariant &value);
 
+    /*!
+     * \brief Sets several \a attributes for the \a target in the extended attribute which has unique \a id.
+     */
+    void setExtendedAttributes(unsigned int clientId, int id, const QString &target,
+                               const QString &targetItem, const QVariantMap &attributes);
+
     /*!
      * \brief Requests information about plugin/server settings.
      */
@@ -320,6 +426,17 @@ public Q_SLOTS:
      */
     virtual void pluginSettingsLoaded(int clientId, const QList<MImPluginSettingsInfo> &info);
 
+    /*!
+     * \brief Sends the outbound messages queued by \a queueOutboundMessage right away.
+     *
+     * Called automatically at the end of the event loop iteration in which
+     * the first message was queued.
+     */
+    void flushOutboundMessages();
+
+    //! Handles the requests recorded since \a holdRequests in the order they arrived
+    void releaseRequests();
+
 Q_SIGNALS:
     /* Emitted first */
     void contentOrientationAboutToChange(int angle);
@@ -339,13 +456,19 @@ Q_SIGNALS:
     void resetInputMethodRequest();
 
     void copyPasteStateChanged(bool copyAvailable, bool pasteAvailable);
+    //! \a changedFields and \a changedExtensions are the attributes which changed
+    //! from \a oldState to \a newState
     void widgetStateChanged(unsigned int clientId, const QMap<QString, QVariant> &newState,
-                            const QMap<QString, QVariant> &oldState, bool focusChanged);
+                            const QMap<QString, QVariant> &oldState, bool focusChanged,
+                            MImEditorState::Fields changedFields,
+                            const QStringList &changedExtensions);
 
     void attributeExtensionRegistered(unsigned int connectionId, int id, const QString &attributeExtension);
     void attributeExtensionUnregistered(unsigned int connectionId, int id);
     void extendedAttributeChanged(unsigned int connectionId, int id, const QString &target,
                               const QString &targetName,const QString &attribute, const QVariant &value);
+    void extendedAttributesChanged(unsigned int connectionId, int id, const QString &target,
+                                   const QString &targetName, const QVariantMap &attributes);
 
     void pluginSettingsRequested(int connectionId, const QString &descriptionLanguage);
 
@@ -360,6 +483,12 @@ Q_SIGNALS:
                          Qt::KeyboardModifiers modifiers, const QString &text, bool autoRepeat,
                          int count, quint32 nativeScanCode, quint32 nativeModifiers, unsigned long time);
 
+    //! Emitted with the answer to \a requestPreeditRectangle.
+    void preeditRectangleReceived(const QRect &rectangle, bool valid);
+
+    //! Emitted with the answer to \a requestSelection.
+    void selectionReceived(const QString &selection, bool valid);
+
 protected:
     unsigned int activeConnection; // 0 means no active connection
 
@@ -371,6 +500,41 @@ protected:
 
     QVariantMap widgetState() const;
 
+    //! Last preedit rectangle reported by the active application,
+    //! invalid once the editor state changed after it was reported
+    QRect lastPreeditRectangle(bool &valid) const;
+    void setLastPreeditRectangle(const QRect &rectangle, bool valid);
+
+    //! Last selection reported by the active application,
+    //! invalid once the editor state changed after it was reported
+    QString lastSelection(bool &valid) const;
+    void setLastSelection(const QString &selection, bool valid);
+
+    /*!
+     * \brief Queues \a message for the active application.
+     *
+     * Queued messages are handed to \a sendOutboundMessages together.
+     * A preedit update drops a still queued preedit update it supersedes.
+     */
+    void queueOutboundMessage(const MImOutboundMessage &message);
+
+    /*!
+     * \brief Sends \a messages to application \a connectionId in one go.
+     *
+     * Default implementation does nothing.
+     */
+    virtual void sendOutboundMessages(unsigned int connectionId,
+                                      const QList<MImOutboundMessage> &messages);
+
+    /*!
+     * \brief Tells application \a connectionId that its key events up to \a lastSerial
+     * were processed and that it should deliver the ones in \a passedThrough itself.
+     *
+     * Default implementation does nothing.
+     */
+    virtual void sendKeyEventsProcessed(unsigned int connectionId, quint32 lastSerial,
+                                        const QList<uint> &passedThrough);
+
 public:
     void handleDisconnection(unsigned int connectionId);
 
@@ -385,7 +549,7 @@ private:
     int lastOrientation;
 
     /* FIXME: rename with m prefix, and provide protected accessors for derived classes */
-    QMap<QString, QVariant> mWidgetState;
+    MImEditorState mWidgetState;
     bool mGlobalCorrectionEnabled;
     bool mRedirectionEnabled;
     bool mDetectableAutoRepeat;
@@ -0,0 +1,565 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "sharedmemorychannel.h"
+
+#include <QAtomicInteger>
+#include <QDebug>
+
+#include <string.h>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(SYS_memfd_create)
+#define MALIIT_HAVE_SHARED_MEMORY_CHANNEL
+#endif
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#endif
+
+namespace Maliit {
+namespace DBus {
+
+//! Lives at the start of the shared memory, followed by the data area
+struct SharedMemoryChannelHeader
+{
+    quint32 magic;
+    quint32 size;
+    //! Free running byte counters, positions are taken modulo size
+    QBasicAtomicInteger<quint32> writeEnd;
+    QBasicAtomicInteger<quint32> readEnd;
+};
+
+namespace {
+    const quint32 ChannelMagic = 0x4d494d31; // "MIM1"
+    const unsigned int HeaderSize = 64;
+    //! Record type, payload length and sequence
+    const unsigned int RecordHeaderSize = 3 * sizeof(qint32);
+    const int PaddingRecord = 0;
+
+    unsigned int alignedRecordLength(unsigned int payloadLength)
+    {
+        return (RecordHeaderSize + payloadLength + 3) & ~3u;
+    }
+
+    //! True if sequence \a a is after \a b, taking wrap around into account
+    bool sequenceAfter(quint32 a, quint32 b)
+    {
+        return static_cast<qint32>(a - b) > 0;
+    }
+
+    class PayloadWriter
+    {
+    public:
+        explicit PayloadWriter(char *data)
+            : position(data)
+        {}
+
+        void putInt(qint32 value)
+        {
+            memcpy(position, &value, sizeof(value));
+            position += sizeof(value);
+        }
+
+        void putText(const QString &text)
+        {
+            const int length = text.length() * sizeof(QChar);
+            memcpy(position, text.constData(), length);
+            position += length;
+        }
+
+    private:
+        char *position;
+    };
+
+    class PayloadReader
+    {
+    public:
+        PayloadReader(const char *data, unsigned int length)
+            : position(data)
+            , end(data + length)
+        {}
+
+        bool getInt(int &value)
+        {
+            qint32 result;
+            if (end - position < static_cast<int>(sizeof(result))) {
+                return false;
+            }
+            memcpy(&result, position, sizeof(result));
+            position += sizeof(result);
+            value = result;
+            return true;
+        }
+
+        bool getText(QString &text, int length)
+        {
+            if (length < 0 || (end - position) / static_cast<int>(sizeof(QChar)) < length) {
+                return false;
+            }
+            text.resize(length);
+            memcpy(text.data(), position, length * sizeof(QChar));
+            position += length * sizeof(QChar);
+            return true;
+        }
+
+    private:
+        const char *position;
+        const char *end;
+    };
+}
+
+SharedMemoryRecord::SharedMemoryRecord()
+    : type(CommitString)
+    , text()
+    , preeditFormats()
+    , replacementStart(0)
+    , replacementLength(0)
+    , cursorPos(-1)
+    , keyType(0)
+    , key(0)
+    , modifiers(0)
+    , count(0)
+    , autoRepeat(false)
+    , requestType(Maliit::EventRequestBoth)
+{}
+
+SharedMemoryChannel::SharedMemoryChannel()
+    : mMemoryFd(-1)
+    , mNotifyFd(-1)
+    , mMappedSize(0)
+    , mHeader(0)
+    , mData(0)
+    , mSequence(0)
+{}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+    close();
+}
+
+bool SharedMemoryChannel::create(unsigned int size)
+{
+#ifdef MALIIT_HAVE_SHARED_MEMORY_CHANNEL
+    close();
+
+    if (size < 4096 || (size & (size - 1)) != 0) {
+        qWarning() << __PRETTY_FUNCTION__ << "Invalid channel size" << size;
+        return false;
+    }
+
+    mMemoryFd = syscall(SYS_memfd_create, "maliit-channel", MFD_CLOEXEC);
+    if (mMemoryFd < 0) {
+        return false;
+    }
+
+    if (ftruncate(mMemoryFd, HeaderSize + size) != 0 || !map(mMemoryFd, HeaderSize + size)) {
+        close();
+        return false;
+    }
+
+    mNotifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mNotifyFd < 0) {
+        close();
+        return false;
+    }
+
+    mHeader->magic = ChannelMagic;
+    mHeader->size = size;
+    mHeader->writeEnd.storeRelease(0);
+    mHeader->readEnd.storeRelease(0);
+
+    return true;
+#else
+    Q_UNUSED(size);
+    return false;
+#endif
+}
+
+bool SharedMemoryChannel::attach(int memoryFd, int notifyFd)
+{
+#ifdef MALIIT_HAVE_SHARED_MEMORY_CHANNEL
+    close();
+
+    mMemoryFd = fcntl(memoryFd, F_DUPFD_CLOEXEC, 0);
+    mNotifyFd = fcntl(notifyFd, F_DUPFD_CLOEXEC, 0);
+
+    struct stat info;
+    if (mMemoryFd < 0 || mNotifyFd < 0
+        || fstat(mMemoryFd, &info) != 0
+        || info.st_size <= static_cast<off_t>(HeaderSize)
+        || !map(mMemoryFd, info.st_size)) {
+        close();
+        return false;
+    }
+
+    const quint32 size = mHeader->size;
+    if (mHeader->magic != ChannelMagic
+        || size < 4096 || (size & (size - 1)) != 0
+        || HeaderSize + size > mMappedSize) {
+        qWarning() << __PRETTY_FUNCTION__ << "Invalid shared memory channel";
+        close();
+        return false;
+    }
+
+    return true;
+#else
+    Q_UNUSED(memoryFd);
+    Q_UNUSED(notifyFd);
+    return false;
+#endif
+}
+
+bool SharedMemoryChannel::isValid() const
+{
+    return mHeader != 0;
+}
+
+int SharedMemoryChannel::memoryFd() const
+{
+    return mMemoryFd;
+}
+
+int SharedMemoryChannel::notifyFd() const
+{
+    return mNotifyFd;
+}
+
+bool SharedMemoryChannel::writeCommitString(const QString &string, int replacementStart,
+                                            int replacementLength, int cursorPos)
+{
+    const unsigned int payloadLength = 4 * sizeof(qint32) + string.length() * sizeof(QChar);
+    unsigned int previousEnd = 0;
+    unsigned int recordEnd = 0;
+    char *payload = reserve(SharedMemoryRecord::CommitString, payloadLength, &previousEnd, &recordEnd);
+    if (!payload) {
+        return false;
+    }
+
+    PayloadWriter writer(payload);
+    writer.putInt(replacementStart);
+    writer.putInt(replacementLength);
+    writer.putInt(cursorPos);
+    writer.putInt(string.length());
+    writer.putText(string);
+
+    publish(previousEnd, recordEnd);
+    return true;
+}
+
+bool SharedMemoryChannel::writeUpdatePreedit(const QString &string,
+                                             const QList<Maliit::PreeditTextFormat> &preeditFormats,
+                                             int replacementStart, int replacementLength, int cursorPos)
+{
+    const unsigned int payloadLength = 5 * sizeof(qint32)
+                                       + preeditFormats.count() * 3 * sizeof(qint32)
+                                       + string.length() * sizeof(QChar);
+    unsigned int previousEnd = 0;
+    unsigned int recordEnd = 0;
+    char *payload = reserve(SharedMemoryRecord::UpdatePreedit, payloadLength, &previousEnd, &recordEnd);
+    if (!payload) {
+        return false;
+    }
+
+    PayloadWriter writer(payload);
+    writer.putInt(replacementStart);
+    writer.putInt(replacementLength);
+    writer.putInt(cursorPos);
+    writer.putInt(preeditFormats.count());
+    writer.putInt(string.length());
+    Q_FOREACH (const Maliit::PreeditTextFormat &format, preeditFormats) {
+        writer.putInt(format.start);
+        writer.putInt(format.length);
+        writer.putInt(format.preeditFace);
+    }
+    writer.putText(string);
+
+    publish(previousEnd, recordEnd);
+    return true;
+}
+
+bool SharedMemoryChannel::writeKeyEvent(int type, int key, int modifiers, const QString &text,
+                                        bool autoRepeat, int count, Maliit::EventRequestType requestType)
+{
+    const unsigned int payloadLength = 7 * sizeof(qint32) + text.length() * sizeof(QChar);
+    unsigned int previousEnd = 0;
+    unsigned int recordEnd = 0;
+    char *payload = reserve(SharedMemoryRecord::KeyEvent, payloadLength, &previousEnd, &recordEnd);
+    if (!payload) {
+        return false;
+    }
+
+    PayloadWriter writer(payload);
+    writer.putInt(type);
+    writer.putInt(key);
+    writer.putInt(modifiers);
+    writer.putInt(count);
+    writer.putInt(autoRepeat ? 1 : 0);
+    writer.putInt(requestType);
+    writer.putInt(text.length());
+    writer.putText(text);
+
+    publish(previousEnd, recordEnd);
+    return true;
+}
+
+void SharedMemoryChannel::addOutOfBandMessage()
+{
+    ++mSequence;
+}
+
+void SharedMemoryChannel::clearNotification()
+{
+#ifdef MALIIT_HAVE_SHARED_MEMORY_CHANNEL
+    quint64 value;
+    if (mNotifyFd >= 0) {
+        // Non-blocking, fails harmlessly if there is nothing to clear
+        if (::read(mNotifyFd, &value, sizeof(value)) < 0) {
+            return;
+        }
+    }
+#endif
+}
+
+bool SharedMemoryChannel::read(SharedMemoryRecord &record)
+{
+    if (!isValid()) {
+        return false;
+    }
+
+    const quint32 size = mHeader->size;
+    quint32 readEnd = mHeader->readEnd.load();
+
+    Q_FOREVER {
+        if (readEnd == mHeader->writeEnd.loadAcquire()) {
+            return false;
+        }
+
+        const quint32 position = readEnd & (size - 1);
+
+        // Too little space left for a record header, the writer skipped it
+        if (size - position < RecordHeaderSize) {
+            readEnd += size - position;
+            mHeader->readEnd.fetchAndStoreOrdered(readEnd);
+            continue;
+        }
+
+        int type = 0;
+        int payloadLength = 0;
+        int sequence = 0;
+        PayloadReader header(mData + position, RecordHeaderSize);
+
+        if (!header.getInt(type) || !header.getInt(payloadLength) || !header.getInt(sequence)
+            || payloadLength < 0
+            || alignedRecordLength(payloadLength) > size - position) {
+            qWarning() << __PRETTY_FUNCTION__ << "Corrupted shared memory channel";
+            close();
+            return false;
+        }
+
+        // Wait until the D-Bus messages sent before this record are handled
+        if (type != PaddingRecord && sequenceAfter(sequence, mSequence)) {
+            return false;
+        }
+
+        readEnd += alignedRecordLength(payloadLength);
+
+        if (type == PaddingRecord) {
+            mHeader->readEnd.fetchAndStoreOrdered(readEnd);
+            continue;
+        }
+
+        PayloadReader reader(mData + position + RecordHeaderSize, payloadLength);
+        int textLength = 0;
+        bool valid = false;
+
+        record.type = static_cast<SharedMemoryRecord::Type>(type);
+        record.preeditFormats.clear();
+
+        switch (type) {
+        case SharedMemoryRecord::CommitString:
+            valid = reader.getInt(record.replacementStart)
+                    && reader.getInt(record.replacementLength)
+                    && reader.getInt(record.cursorPos)
+                    && reader.getInt(textLength)
+                    && reader.getText(record.text, textLength);
+            break;
+
+        case SharedMemoryRecord::UpdatePreedit: {
+            int formatCount = 0;
+            valid = reader.getInt(record.replacementStart)
+                    && reader.getInt(record.replacementLength)
+                    && reader.getInt(record.cursorPos)
+                    && reader.getInt(formatCount)
+                    && reader.getInt(textLength);
+            for (int i = 0; valid && i < formatCount; ++i) {
+                int face = 0;
+                Maliit::PreeditTextFormat format;
+                valid = reader.getInt(format.start)
+                        && reader.getInt(format.length)
+                        && reader.getInt(face);
+                format.preeditFace = static_cast<Maliit::PreeditFace>(face);
+                record.preeditFormats.append(format);
+            }
+            valid = valid && reader.getText(record.text, textLength);
+        } break;
+
+        case SharedMemoryRecord::KeyEvent: {
+            int autoRepeat = 0;
+            int requestType = 0;
+            valid = reader.getInt(record.keyType)
+                    && reader.getInt(record.key)
+                    && reader.getInt(record.modifiers)
+                    && reader.getInt(record.count)
+                    && reader.getInt(autoRepeat)
+                    && reader.getInt(requestType)
+                    && reader.getInt(textLength)
+                    && reader.getText(record.text, textLength);
+            record.autoRepeat = autoRepeat != 0;
+            record.requestType = static_cast<Maliit::EventRequestType>(requestType);
+        } break;
+
+        default:
+            break;
+        }
+
+        // Publishing the read end with a full barrier pairs with publish(),
+        // so the writer either sees the drained buffer or we see its record.
+        mHeader->readEnd.fetchAndStoreOrdered(readEnd);
+
+        if (!valid) {
+            qWarning() << __PRETTY_FUNCTION__ << "Skipping invalid record of type" << type;
+            continue;
+        }
+
+        return true;
+    }
+}
+
+char *SharedMemoryChannel::reserve(int type, unsigned int payloadLength,
+                                   unsigned int *previousEnd, unsigned int *recordEnd)
+{
+    if (!isValid()) {
+        return 0;
+    }
+
+    const quint32 size = mHeader->size;
+    const quint32 recordLength = alignedRecordLength(payloadLength);
+
+    // Big records would starve the buffer, they are better sent over D-Bus
+    if (recordLength > size / 2) {
+        return 0;
+    }
+
+    const quint32 writeEnd = mHeader->writeEnd.load();
+    const quint32 available = size - (writeEnd - mHeader->readEnd.loadAcquire());
+    quint32 position = writeEnd & (size - 1);
+    quint32 padding = 0;
+
+    // Records are never split, skip the rest of the buffer instead
+    if (size - position < recordLength) {
+        padding = size - position;
+    }
+
+    if (padding + recordLength > available) {
+        return 0;
+    }
+
+    if (padding) {
+        // The reader skips remainders too short for a header on its own
+        if (padding >= RecordHeaderSize) {
+            PayloadWriter writer(mData + position);
+            writer.putInt(PaddingRecord);
+            writer.putInt(padding - RecordHeaderSize);
+            writer.putInt(mSequence);
+        }
+        position = 0;
+    }
+
+    PayloadWriter writer(mData + position);
+    writer.putInt(type);
+    writer.putInt(payloadLength);
+    writer.putInt(mSequence);
+
+    *previousEnd = writeEnd;
+    *recordEnd = writeEnd + padding + recordLength;
+    return mData + position + RecordHeaderSize;
+}
+
+void SharedMemoryChannel::publish(unsigned int previousEnd, unsigned int recordEnd)
+{
+    mHeader->writeEnd.fetchAndStoreOrdered(recordEnd);
+
+    // Only wake up the reader if it had drained the buffer, otherwise it
+    // is still reading and will pick up this record as well.
+    if (mHeader->readEnd.loadAcquire() == previousEnd) {
+#ifdef MALIIT_HAVE_SHARED_MEMORY_CHANNEL
+        const quint64 value = 1;
+        if (::write(mNotifyFd, &value, sizeof(value)) < 0) {
+            qWarning() << __PRETTY_FUNCTION__ << "Could not notify shared memory channel reader";
+        }
+#endif
+    }
+}
+
+bool SharedMemoryChannel::map(int memoryFd, unsigned int size)
+{
+#ifdef MALIIT_HAVE_SHARED_MEMORY_CHANNEL
+    void *memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    mMappedSize = size;
+    mHeader = static_cast<SharedMemoryChannelHeader *>(memory);
+    mData = static_cast<char *>(memory) + HeaderSize;
+    return true;
+#else
+    Q_UNUSED(memoryFd);
+    Q_UNUSED(size);
+    return false;
+#endif
+}
+
+void SharedMemoryChannel::close()
+{
+#ifdef MALIIT_HAVE_SHARED_MEMORY_CHANNEL
+    if (mHeader) {
+        munmap(mHeader, mMappedSize);
+    }
+    if (mMemoryFd >= 0) {
+        ::close(mMemoryFd);
+    }
+    if (mNotifyFd >= 0) {
+        ::close(mNotifyFd);
+    }
+#endif
+
+    mMemoryFd = -1;
+    mNotifyFd = -1;
+    mMappedSize = 0;
+    mHeader = 0;
+    mData = 0;
+}
+
+} // namespace DBus
+} // namespace Maliit
@@ -0,0 +1,146 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MALIIT_DBUS_SHAREDMEMORYCHANNEL_H
+#define MALIIT_DBUS_SHAREDMEMORYCHANNEL_H
+
+#include <maliit/namespace.h>
+
+#include <QList>
+#include <QString>
+
+namespace Maliit {
+namespace DBus {
+
+struct SharedMemoryChannelHeader;
+
+/*! \internal
+ * \brief Record read from a SharedMemoryChannel.
+ *
+ * Only the members relevant for \a type are set.
+ */
+struct SharedMemoryRecord
+{
+    enum Type {
+        CommitString = 1,
+        UpdatePreedit,
+        KeyEvent
+    };
+
+    SharedMemoryRecord();
+
+    Type type;
+    QString text;
+    QList<Maliit::PreeditTextFormat> preeditFormats;
+    int replacementStart;
+    int replacementLength;
+    int cursorPos;
+    int keyType;
+    int key;
+    int modifiers;
+    int count;
+    bool autoRepeat;
+    Maliit::EventRequestType requestType;
+};
+
+/*! \internal
+ * \brief Ring buffer in shared memory for high rate server to input context messages.
+ *
+ * The server creates the channel and hands its memory and notification file
+ * descriptors to the input context over D-Bus. Afterwards commitString,
+ * updatePreedit and keyEvent are written as fixed layout binary records
+ * instead of D-Bus messages. There is exactly one writer (the server) and one
+ * reader (the input context). The reader is woken up through an eventfd,
+ * which is only signalled when the writer finds the buffer drained.
+ *
+ * Writing fails when the record does not fit; callers then fall back to D-Bus.
+ * To keep the original order between both transports, every record carries
+ * the number of order relevant D-Bus messages sent before it. Both sides
+ * count these messages with \a addOutOfBandMessage, and \a read holds back
+ * records until the reader has handled the same number of messages. The
+ * reader must also drain the channel before handling such a message.
+ *
+ * Only available on Linux (memfd and eventfd), elsewhere \a create and
+ * \a attach fail.
+ */
+class SharedMemoryChannel
+{
+public:
+    //! Size of the data area used by \a create, must be a power of two
+    static const unsigned int DefaultSize = 64 * 1024;
+
+    SharedMemoryChannel();
+    ~SharedMemoryChannel();
+
+    //! Creates new shared memory of \a size bytes for writing
+    bool create(unsigned int size = DefaultSize);
+
+    //! Maps shared memory created by the server for reading. The descriptors are duplicated.
+    bool attach(int memoryFd, int notifyFd);
+
+    bool isValid() const;
+
+    int memoryFd() const;
+    int notifyFd() const;
+
+    /*!
+     * \brief Counts an order relevant message sent (writer) or handled (reader) over D-Bus.
+     *
+     * Both sides must start counting at the same point, which is the
+     * D-Bus message handing over the channel.
+     */
+    void addOutOfBandMessage();
+
+    //! \name Writer side
+    //! \{
+    bool writeCommitString(const QString &string, int replacementStart,
+                           int replacementLength, int cursorPos);
+    bool writeUpdatePreedit(const QString &string,
+                            const QList<Maliit::PreeditTextFormat> &preeditFormats,
+                            int replacementStart, int replacementLength, int cursorPos);
+    bool writeKeyEvent(int type, int key, int modifiers, const QString &text,
+                       bool autoRepeat, int count, Maliit::EventRequestType requestType);
+    //! \}
+
+    //! \name Reader side
+    //! \{
+    //! Resets the notification, call when the notification descriptor is readable
+    void clearNotification();
+
+    //! Takes the next record from the channel, returns false if it is empty
+    //! or the next record has to wait for a D-Bus message
+    bool read(SharedMemoryRecord &record);
+    //! \}
+
+private:
+    Q_DISABLE_COPY(SharedMemoryChannel)
+
+    char *reserve(int type, unsigned int payloadLength,
+                  unsigned int *previousEnd, unsigned int *recordEnd);
+    void publish(unsigned int previousEnd, unsigned int recordEnd);
+    bool map(int memoryFd, unsigned int size);
+    void close();
+
+    int mMemoryFd;
+    int mNotifyFd;
+    unsigned int mMappedSize;
+    SharedMemoryChannelHeader *mHeader;
+    char *mData;
+    quint32 mSequence;
+};
+
+} // namespace DBus
+} // namespace Maliit
+
+#endif // MALIIT_DBUS_SHAREDMEMORYCHANNEL_H
@@ -24,23 +24,12 @@
 #include <xkbcommon/xkbcommon.h>
 
 #include "waylandinputmethodconnection.h"
+#include "waylandkeysyms.h"
+#include "mimutf8offsetindex.h"
+#include "mimeditorstate.h"
 
 namespace {
 
-// TODO: Deduplicate it. Those values are used in
-// minputcontextconnection, mimpluginmanager,
-// mattributeextensionmanager and in input context implementations.
-const char * const FocusStateAttribute = "focusState";
-const char * const ContentTypeAttribute = "contentType";
-const char * const CorrectionAttribute = "correctionEnabled";
-const char * const PredictionAttribute = "predictionEnabled";
-const char * const AutoCapitalizationAttribute = "autocapitalizationEnabled";
-const char * const SurroundingTextAttribute = "surroundingText";
-const char * const AnchorPositionAttribute = "anchorPosition";
-const char * const CursorPositionAttribute = "cursorPosition";
-const char * const HasSelectionAttribute = "hasSelection";
-const char * const HiddenTextAttribute = "hiddenText";
-
 typedef QPair<Qt::KeyboardModifiers, const char *> Modifier;
 const Modifier modifiers[] = {
     Modifier(Qt::ShiftModifier, XKB_MOD_NAME_SHIFT),
@@ -76,26 +65,6 @@ xkb_mod_mask_t modifiersFromQt(const Qt::KeyboardModifiers qt_mods)
     return mod_mask;
 }
 
-xkb_keysym_t keyFromQt(int qt_key)
-{
-    switch (qt_key) {
-    case Qt::Key_Backspace:
-        return XKB_KEY_BackSpace;
-    case Qt::Key_Return:
-        return XKB_KEY_Return;
-    case Qt::Key_Left:
-        return XKB_KEY_Left;
-    case Qt::Key_Up:
-        return XKB_KEY_Up;
-    case Qt::Key_Right:
-        return XKB_KEY_Right;
-    case Qt::Key_Down:
-        return XKB_KEY_Down;
-    default:
-        return XKB_KEY_NoSymbol;
-    }
-}
-
 QtWayland::wl_text_input::preedit_style preeditStyleFromMaliit(Maliit::PreeditFace face)
 {
     switch (face) {
@@ -138,8 +107,6 @@ bool matchesFlag(int value,
     return ((value & flag) == flag);
 }
 
-const unsigned int wayland_connection_id(1);
-
 } // unnamed namespace
 
 namespace Maliit {
@@ -153,6 +120,7 @@ public:
     InputMethod(MInputContextConnection *connection, struct wl_registry *registry, int id);
     ~InputMethod();
 
+    //! Context of the active connection, 0 if there is none
     InputMethodContext *context() const;
 
 protected:
@@ -160,19 +128,35 @@ protected:
     void input_method_deactivate(struct ::wl_input_method_context *context) Q_DECL_OVERRIDE;
 
 private:
+    void activate(InputMethodContext *context);
+    unsigned int nextConnectionId();
+
     MInputContextConnection *m_connection;
-    QScopedPointer<InputMethodContext> m_context;
+    //! One context per focused text input, most recently activated last
+    QList<InputMethodContext *> m_contexts;
+    unsigned int m_lastConnectionId;
 };
 
 class InputMethodContext : public QtWayland::wl_input_method_context
 {
 public:
-    InputMethodContext(MInputContextConnection *connection, struct ::wl_input_method_context *object);
+    InputMethodContext(MInputContextConnection *connection, struct ::wl_input_method_context *object,
+                       unsigned int connectionId);
     ~InputMethodContext();
 
+    unsigned int connectionId() const;
     QString selection() const;
     uint32_t serial() const;
 
+    //! Whether the text input committed its state at least once
+    bool hasCommittedState() const;
+
+    //! Sends the whole committed editor state, as needed when the context becomes active
+    void sendState(bool handleFocusChange);
+
+    //! Offset index of the last surrounding text, shared with the connection
+    MImUtf8OffsetIndex &surroundingTextIndex();
+
 protected:
     void input_method_context_commit_state(uint32_t serial) Q_DECL_OVERRIDE;
     void input_method_context_content_type(uint32_t hint, uint32_t purpose) Q_DECL_OVERRIDE;
@@ -183,9 +167,16 @@ protected:
 
 private:
     MInputContextConnection *m_connection;
-    QVariantMap m_stateInfo;
+    unsigned int m_connectionId;
+    MImEditorState m_state;
+    //! State as of the last commit_state, 0 before the first one
+    QVariantMap m_committedState;
+    bool m_stateCommitted;
+    //! Version of the state last sent to the server, base of the next delta
+    unsigned int m_stateVersion;
     uint32_t m_serial;
     QString m_selection;
+    MImUtf8OffsetIndex m_surroundingTextIndex;
 };
 
 }
@@ -195,7 +186,8 @@ struct WaylandInputMethodConnectionPrivate
 {
     Q_DECLARE_PUBLIC(WaylandInputMethodConnection)
 
-    WaylandInputMethodConnectionPrivate(WaylandInputMethodConnection *connection);
+    WaylandInputMethodConnectionPrivate(WaylandInputMethodConnection *connection,
+                                        wl_display *display);
     ~WaylandInputMethodConnectionPrivate();
 
     void handleRegistryGlobal(uint32_t name,
@@ -247,13 +239,13 @@ const wl_registry_listener maliit_registry_listener = {
 
 } // unnamed namespace
 
-WaylandInputMethodConnectionPrivate::WaylandInputMethodConnectionPrivate(WaylandInputMethodConnection *connection)
+WaylandInputMethodConnectionPrivate::WaylandInputMethodConnectionPrivate(WaylandInputMethodConnection *connection,
+                                                                         wl_display *waylandDisplay)
     : q_ptr(connection),
-      display(0),
+      display(waylandDisplay),
       registry(0),
       input_method()
 {
-    display = static_cast<wl_display *>(QGuiApplication::platformNativeInterface()->nativeResourceForIntegration("display"));
     if (!display) {
         qCritical() << Q_FUNC_INFO << "Failed to get a display.";
         return;
@@ -295,7 +287,13 @@ Maliit::Wayland::InputMethodContext *WaylandInputMethodConnectionPrivate::contex
 // MInputContextWestonIMProtocolConnection
 
 WaylandInputMethodConnection::WaylandInputMethodConnection()
-    : d_ptr(new WaylandInputMethodConnectionPrivate(this))
+    : d_ptr(new WaylandInputMethodConnectionPrivate(this,
+                                                    static_cast<wl_display *>(QGuiApplication::platformNativeInterface()->nativeResourceForIntegration("display"))))
+{
+}
+
+WaylandInputMethodConnection::WaylandInputMethodConnection(wl_display *display)
+    : d_ptr(new WaylandInputMethodConnectionPrivate(this, display))
 {
 }
 
@@ -320,17 +318,19 @@ void WaylandInputMethodConnection::sendPreeditString(const QString &string,
                                                replace_start, replace_length,
                                                cursor_pos);
 
+    const MImUtf8OffsetIndex offsets(string);
+
     if (replace_length > 0) {
-        int cursor = widgetState().value(CursorPositionAttribute).toInt();
-        uint32_t index = string.midRef(qMin(cursor + replace_start, cursor), qAbs(replace_start)).toUtf8().size();
-        uint32_t length = string.midRef(cursor + replace_start, replace_length).toUtf8().size();
+        int cursor = widgetState().value(MImEditorState::key(MImEditorState::CursorPositionField)).toInt();
+        uint32_t index = offsets.utf8Length(qMin(cursor + replace_start, cursor), qAbs(replace_start));
+        uint32_t length = offsets.utf8Length(cursor + replace_start, replace_length);
         d->context()->delete_surrounding_text(index, length);
     }
 
     Q_FOREACH (const Maliit::PreeditTextFormat& format, preedit_formats) {
         QtWayland::wl_text_input::preedit_style style = preeditStyleFromMaliit(format.preeditFace);
-        uint32_t index = string.leftRef(format.start).toUtf8().size();
-        uint32_t length = string.leftRef(format.start + format.length).toUtf8().size() - index;
+        uint32_t index = offsets.toUtf8(format.start);
+        uint32_t length = offsets.toUtf8(format.start + format.length) - index;
         qDebug() << Q_FUNC_INFO << "preedit_styling" << index << length;
         d->context()->preedit_styling(index, length, style);
     }
@@ -340,8 +340,8 @@ void WaylandInputMethodConnection::sendPreeditString(const QString &string,
         cursor_pos = string.size() + 1 - cursor_pos;
     }
 
-    qDebug() << Q_FUNC_INFO << "preedit_cursor" << string.leftRef(cursor_pos).toUtf8().size();
-    d->context()->preedit_cursor(string.leftRef(cursor_pos).toUtf8().size());
+    qDebug() << Q_FUNC_INFO << "preedit_cursor" << offsets.toUtf8(cursor_pos);
+    d->context()->preedit_cursor(offsets.toUtf8(cursor_pos));
     qDebug() << Q_FUNC_INFO << "preedit_string" << string;
     d->context()->preedit_string(d->context()->serial(), string, string);
 }
@@ -366,14 +366,16 @@ void WaylandInputMethodConnection::sendCommitString(const QString &string,
         cursor_pos = 0;
     }
 
+    const MImUtf8OffsetIndex offsets(string);
+
     if (replace_length > 0) {
-        int cursor = widgetState().value(CursorPositionAttribute).toInt();
-        uint32_t index = string.midRef(qMin(cursor + replace_start, cursor), qAbs(replace_start)).toUtf8().size();
-        uint32_t length = string.midRef(cursor + replace_start, replace_length).toUtf8().size();
+        int cursor = widgetState().value(MImEditorState::key(MImEditorState::CursorPositionField)).toInt();
+        uint32_t index = offsets.utf8Length(qMin(cursor + replace_start, cursor), qAbs(replace_start));
+        uint32_t length = offsets.utf8Length(cursor + replace_start, replace_length);
         d->context()->delete_surrounding_text(index, length);
     }
 
-    cursor_pos = string.leftRef(cursor_pos).toUtf8().size();
+    cursor_pos = offsets.toUtf8(cursor_pos);
     d->context()->cursor_position(cursor_pos, cursor_pos);
     d->context()->commit_string(d->context()->serial(), string);
 }
@@ -388,10 +390,11 @@ void WaylandInputMethodConnection::sendKeyEvent(const QKeyEvent &keyEvent,
     if (!d->context())
         return;
 
-    xkb_keysym_t sym(keyFromQt(keyEvent.key()));
+    xkb_keysym_t sym(Maliit::Wayland::keysymFromQt(keyEvent.key(), keyEvent.modifiers(),
+                                                   keyEvent.text()));
 
     if (sym == XKB_KEY_NoSymbol) {
-        qWarning() << "No conversion from Qt::Key:" << keyEvent.key() << "to XKB key. Update the keyFromQt() function.";
+        qWarning() << "No conversion from Qt::Key:" << keyEvent.key() << "to XKB key. Update the keysym table in waylandkeysyms.cpp.";
         return;
     }
 
@@ -426,7 +429,7 @@ QString WaylandInputMethodConnection::selection(bool &valid)
 
     qDebug() << Q_FUNC_INFO;
 
-    Maliit::Wayland::InputMethodContext *context = d->input_method->context();
+    Maliit::Wayland::InputMethodContext *context = d->context();
 
     valid = context && !context->selection().isEmpty();
     return context ? context->selection() : QString();
@@ -453,9 +456,12 @@ void WaylandInputMethodConnection::setSelection(int start, int length)
     if (!d->context())
         return;
 
-    QString surrounding = widgetState().value(SurroundingTextAttribute).toString();
-    uint32_t index(surrounding.leftRef(start + length).toUtf8().size());
-    uint32_t anchor(surrounding.leftRef(start).toUtf8().size());
+    // Usually the text indexed when the compositor sent it, then nothing is rebuilt
+    MImUtf8OffsetIndex &offsets(d->context()->surroundingTextIndex());
+    offsets.setText(widgetState().value(MImEditorState::key(MImEditorState::SurroundingTextField)).toString());
+
+    uint32_t index(offsets.toUtf8(start + length));
+    uint32_t anchor(offsets.toUtf8(start));
 
     d->context()->cursor_position(index, anchor);
     d->context()->commit_string(d->context()->serial(), QString());
@@ -467,60 +473,120 @@ namespace Wayland {
 InputMethod::InputMethod(MInputContextConnection *connection, struct wl_registry *registry, int id)
     : QtWayland::wl_input_method(registry, id)
     , m_connection(connection)
-    , m_context()
+    , m_contexts()
+    , m_lastConnectionId(0)
 {
 }
 
 InputMethod::~InputMethod()
 {
+    qDeleteAll(m_contexts);
 }
 
 InputMethodContext *InputMethod::context() const
 {
-    return m_context.data();
+    return m_contexts.isEmpty() ? 0 : m_contexts.last();
 }
 
 void InputMethod::input_method_activate(struct ::wl_input_method *, struct ::wl_input_method_context *id)
 {
     qDebug() << Q_FUNC_INFO;
 
-    m_context.reset(new InputMethodContext(m_connection, id));
-
-    m_context->modifiers_map(modifiersMap());
+    // Text inputs of other seats keep their contexts and connections,
+    // they become active again when the new one is deactivated.
+    InputMethodContext *context = new InputMethodContext(m_connection, id, nextConnectionId());
+    m_contexts.append(context);
 
+    context->modifiers_map(modifiersMap());
+    activate(context);
 }
 
-void InputMethod::input_method_deactivate(struct wl_input_method_context *)
+void InputMethod::input_method_deactivate(struct wl_input_method_context *object)
 {
     qDebug() << Q_FUNC_INFO;
 
-    m_context.reset();
+    InputMethodContext *context = 0;
+    Q_FOREACH (InputMethodContext *candidate, m_contexts) {
+        if (candidate->object() == object) {
+            context = candidate;
+            break;
+        }
+    }
+
+    if (!context) {
+        qWarning() << Q_FUNC_INFO << "Deactivating unknown context";
+        return;
+    }
+
+    const bool wasActive = (context == this->context());
+    const unsigned int connectionId = context->connectionId();
+
+    m_contexts.removeOne(context);
+    delete context;
 
-    m_connection->handleDisconnection(wayland_connection_id);
+    m_connection->handleDisconnection(connectionId);
+
+    if (wasActive && !m_contexts.isEmpty()) {
+        activate(m_contexts.last());
+    }
 }
 
-InputMethodContext::InputMethodContext(MInputContextConnection *connection, struct ::wl_input_method_context *object)
+void InputMethod::activate(InputMethodContext *context)
+{
+    const unsigned int connectionId = context->connectionId();
+
+    m_connection->activateContext(connectionId);
+
+    // Start from the state last committed for this context instead of the
+    // one of the previously active context. A new context has no state yet,
+    // it is sent with the first commit_state.
+    if (context->hasCommittedState()) {
+        context->sendState(true);
+        m_connection->showInputMethod(connectionId);
+    }
+}
+
+unsigned int InputMethod::nextConnectionId()
+{
+    // 0 means no connection in MInputContextConnection
+    do {
+        ++m_lastConnectionId;
+    } while (m_lastConnectionId == 0);
+
+    return m_lastConnectionId;
+}
+
+InputMethodContext::InputMethodContext(MInputContextConnection *connection, struct ::wl_input_method_context *object,
+                                       unsigned int connectionId)
     : QtWayland::wl_input_method_context(object)
     , m_connection(connection)
-    , m_stateInfo()
+    , m_connectionId(connectionId)
+    , m_state()
+    , m_committedState()
+    , m_stateCommitted(false)
+    , m_stateVersion(0)
     , m_serial(0)
     , m_selection()
+    , m_surroundingTextIndex()
 {
-    qDebug() << Q_FUNC_INFO;
+    qDebug() << Q_FUNC_INFO << connectionId;
 
-    m_stateInfo[FocusStateAttribute] = true;
-    m_connection->activateContext(wayland_connection_id);
-    m_connection->showInputMethod(wayland_connection_id);
+    m_state.setFocusState(true);
 }
 
 InputMethodContext::~InputMethodContext()
 {
-    qDebug() << Q_FUNC_INFO;
+    qDebug() << Q_FUNC_INFO << m_connectionId;
 
-    m_stateInfo.clear();
-    m_stateInfo[FocusStateAttribute] = false;
-    m_connection->updateWidgetInformation(wayland_connection_id, m_stateInfo, true);
-    m_connection->hideInputMethod(wayland_connection_id);
+    QVariantMap stateInfo;
+    stateInfo[MImEditorState::key(MImEditorState::FocusStateField)] = false;
+    m_connection->updateWidgetInformation(m_connectionId, stateInfo, true);
+    m_connection->hideInputMethod(m_connectionId);
+}
+
+unsigned int InputMethodContext::connectionId() const
+{
+    return m_connectionId;
 }
 
 QString InputMethodContext::selection() const
@@ -533,23 +599,65 @@ uint32_t InputMethodContext::serial() const
     return m_serial;
 }
 
+bool InputMethodContext::hasCommittedState() const
+{
+    return m_stateCommitted;
+}
+
+MImUtf8OffsetIndex &InputMethodContext::surroundingTextIndex()
+{
+    return m_surroundingTextIndex;
+}
+
+void InputMethodContext::sendState(bool handleFocusChange)
+{
+    m_stateVersion = 0;
+    m_connection->updateWidgetInformation(m_connectionId, m_committedState, handleFocusChange);
+}
+
 void InputMethodContext::input_method_context_commit_state(uint32_t serial)
 {
     qDebug() << Q_FUNC_INFO;
 
     m_serial = serial;
-    m_connection->updateWidgetInformation(wayland_connection_id, m_stateInfo, false);
+
+    const MImEditorState::Fields dirty = m_state.changedFields();
+    m_state.clearChanges();
+    m_committedState = m_state.toMap();
+
+    // The first commit completes the state of a newly activated text input,
+    // updates of inactive contexts are ignored by the connection
+    if (!m_stateCommitted) {
+        m_stateCommitted = true;
+        sendState(true);
+        m_connection->showInputMethod(m_connectionId);
+        return;
+    }
+
+    if (dirty == MImEditorState::NoField) {
+        return;
+    }
+
+    const bool applied = m_connection->updateWidgetInformationDelta(m_connectionId, m_stateVersion,
+                                                                    m_stateVersion + 1,
+                                                                    m_state.toMap(dirty), QStringList(),
+                                                                    -1, 0, QString(), false);
+    if (applied) {
+        ++m_stateVersion;
+    } else {
+        sendState(false);
+    }
 }
 
 void InputMethodContext::input_method_context_content_type(uint32_t hint, uint32_t purpose)
 {
     qDebug() << Q_FUNC_INFO;
 
-    m_stateInfo[ContentTypeAttribute] = contentTypeFromWayland(purpose);
-    m_stateInfo[AutoCapitalizationAttribute] = matchesFlag(hint, QtWayland::wl_text_input::content_hint_auto_capitalization);
-    m_stateInfo[CorrectionAttribute] = matchesFlag(hint, QtWayland::wl_text_input::content_hint_auto_correction);
-    m_stateInfo[PredictionAttribute] = matchesFlag(hint, QtWayland::wl_text_input::content_hint_auto_completion);
-    m_stateInfo[HiddenTextAttribute] = matchesFlag(hint, QtWayland::wl_text_input::content_hint_hidden_text);
+    m_state.setContentType(contentTypeFromWayland(purpose));
+    m_state.setAutoCapitalizationEnabled(matchesFlag(hint, QtWayland::wl_text_input::content_hint_auto_capitalization));
+    m_state.setCorrectionEnabled(matchesFlag(hint, QtWayland::wl_text_input::content_hint_auto_correction));
+    m_state.setPredictionEnabled(matchesFlag(hint, QtWayland::wl_text_input::content_hint_auto_completion));
+    m_state.setHiddenText(matchesFlag(hint, QtWayland::wl_text_input::content_hint_hidden_text));
 }
 
 void InputMethodContext::input_method_context_invoke_action(uint32_t button, uint32_t index)
@@ -566,26 +674,29 @@ void InputMethodContext::input_method_context_reset()
 {
     qDebug() << Q_FUNC_INFO;
 
-    m_connection->reset(wayland_connection_id);
+    m_connection->reset(m_connectionId);
 }
 
 void InputMethodContext::input_method_context_surrounding_text(const QString &text, uint32_t cursor, uint32_t anchor)
 {
     qDebug() << Q_FUNC_INFO;
 
-    const QByteArray &utf8_text(text.toUtf8());
+    m_surroundingTextIndex.setText(text);
+
+    const int cursorPosition = m_surroundingTextIndex.toUtf16(cursor);
+    const int anchorPosition = m_surroundingTextIndex.toUtf16(anchor);
 
-    m_stateInfo[SurroundingTextAttribute] = text;
-    m_stateInfo[CursorPositionAttribute] = QString::fromUtf8(utf8_text.constData(), cursor).size();
-    m_stateInfo[AnchorPositionAttribute] = QString::fromUtf8(utf8_text.constData(), anchor).size();
+    m_state.setSurroundingText(text);
+    m_state.setCursorPosition(cursorPosition);
+    m_state.setAnchorPosition(anchorPosition);
     if (cursor == anchor) {
-        m_stateInfo[HasSelectionAttribute] = false;
+        m_state.setHasSelection(false);
         m_selection.clear();
     } else {
-        m_stateInfo[HasSelectionAttribute] = true;
-        uint32_t begin = qMin(anchor, cursor);
-        uint32_t end = qMax(anchor, cursor);
-        m_selection = QString::fromUtf8(utf8_text.constData() + begin, end - begin);
+        m_state.setHasSelection(true);
+        const int begin = qMin(anchorPosition, cursorPosition);
+        const int end = qMax(anchorPosition, cursorPosition);
+        m_selection = text.mid(begin, end - begin);
     }
 }
 
@@ -21,6 +21,7 @@
 #include <QtCore>
 
 class WaylandInputMethodConnectionPrivate;
+struct wl_display;
 
 /*! \internal
  * \ingroup maliitserver
@@ -34,7 +35,10 @@ class WaylandInputMethodConnection : public MInputContextConnection
     Q_DECLARE_PRIVATE(WaylandInputMethodConnection)
 
 public:
+    //! Connects to the display of the Wayland platform plugin
     explicit WaylandInputMethodConnection();
+    //! Connects to \a display
+    explicit WaylandInputMethodConnection(wl_display *display);
     virtual ~WaylandInputMethodConnection();
 
     virtual void sendPreeditString(const QString &string,
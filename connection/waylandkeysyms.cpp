@@ -0,0 +1,391 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "waylandkeysyms.h"
+
+#include <QVector>
+
+#include <algorithm>
+
+namespace {
+
+struct KeyMapping
+{
+    int key;
+    xkb_keysym_t keysym;
+};
+
+bool operator<(const KeyMapping &mapping, int key)
+{
+    return mapping.key < key;
+}
+
+// Keys without text. Must stay sorted by Qt::Key for the binary search,
+// which ut_waylandkeysyms checks.
+const KeyMapping keyTable[] = {
+    { Qt::Key_Escape, XKB_KEY_Escape },
+    { Qt::Key_Tab, XKB_KEY_Tab },
+    { Qt::Key_Backtab, XKB_KEY_ISO_Left_Tab },
+    { Qt::Key_Backspace, XKB_KEY_BackSpace },
+    { Qt::Key_Return, XKB_KEY_Return },
+    { Qt::Key_Enter, XKB_KEY_KP_Enter },
+    { Qt::Key_Insert, XKB_KEY_Insert },
+    { Qt::Key_Delete, XKB_KEY_Delete },
+    { Qt::Key_Pause, XKB_KEY_Pause },
+    { Qt::Key_Print, XKB_KEY_Print },
+    { Qt::Key_SysReq, XKB_KEY_Sys_Req },
+    { Qt::Key_Clear, XKB_KEY_Clear },
+    { Qt::Key_Home, XKB_KEY_Home },
+    { Qt::Key_End, XKB_KEY_End },
+    { Qt::Key_Left, XKB_KEY_Left },
+    { Qt::Key_Up, XKB_KEY_Up },
+    { Qt::Key_Right, XKB_KEY_Right },
+    { Qt::Key_Down, XKB_KEY_Down },
+    { Qt::Key_PageUp, XKB_KEY_Page_Up },
+    { Qt::Key_PageDown, XKB_KEY_Page_Down },
+    { Qt::Key_Shift, XKB_KEY_Shift_L },
+    { Qt::Key_Control, XKB_KEY_Control_L },
+    { Qt::Key_Meta, XKB_KEY_Meta_L },
+    { Qt::Key_Alt, XKB_KEY_Alt_L },
+    { Qt::Key_CapsLock, XKB_KEY_Caps_Lock },
+    { Qt::Key_NumLock, XKB_KEY_Num_Lock },
+    { Qt::Key_ScrollLock, XKB_KEY_Scroll_Lock },
+    { Qt::Key_F1, XKB_KEY_F1 },
+    { Qt::Key_F2, XKB_KEY_F2 },
+    { Qt::Key_F3, XKB_KEY_F3 },
+    { Qt::Key_F4, XKB_KEY_F4 },
+    { Qt::Key_F5, XKB_KEY_F5 },
+    { Qt::Key_F6, XKB_KEY_F6 },
+    { Qt::Key_F7, XKB_KEY_F7 },
+    { Qt::Key_F8, XKB_KEY_F8 },
+    { Qt::Key_F9, XKB_KEY_F9 },
+    { Qt::Key_F10, XKB_KEY_F10 },
+    { Qt::Key_F11, XKB_KEY_F11 },
+    { Qt::Key_F12, XKB_KEY_F12 },
+    { Qt::Key_F13, XKB_KEY_F13 },
+    { Qt::Key_F14, XKB_KEY_F14 },
+    { Qt::Key_F15, XKB_KEY_F15 },
+    { Qt::Key_F16, XKB_KEY_F16 },
+    { Qt::Key_F17, XKB_KEY_F17 },
+    { Qt::Key_F18, XKB_KEY_F18 },
+    { Qt::Key_F19, XKB_KEY_F19 },
+    { Qt::Key_F20, XKB_KEY_F20 },
+    { Qt::Key_F21, XKB_KEY_F21 },
+    { Qt::Key_F22, XKB_KEY_F22 },
+    { Qt::Key_F23, XKB_KEY_F23 },
+    { Qt::Key_F24, XKB_KEY_F24 },
+    { Qt::Key_F25, XKB_KEY_F25 },
+    { Qt::Key_F26, XKB_KEY_F26 },
+    { Qt::Key_F27, XKB_KEY_F27 },
+    { Qt::Key_F28, XKB_KEY_F28 },
+    { Qt::Key_F29, XKB_KEY_F29 },
+    { Qt::Key_F30, XKB_KEY_F30 },
+    { Qt::Key_F31, XKB_KEY_F31 },
+    { Qt::Key_F32, XKB_KEY_F32 },
+    { Qt::Key_F33, XKB_KEY_F33 },
+    { Qt::Key_F34, XKB_KEY_F34 },
+    { Qt::Key_F35, XKB_KEY_F35 },
+    { Qt::Key_Super_L, XKB_KEY_Super_L },
+    { Qt::Key_Super_R, XKB_KEY_Super_R },
+    { Qt::Key_Menu, XKB_KEY_Menu },
+    { Qt::Key_Hyper_L, XKB_KEY_Hyper_L },
+    { Qt::Key_Hyper_R, XKB_KEY_Hyper_R },
+    { Qt::Key_Help, XKB_KEY_Help },
+    { Qt::Key_Back, XKB_KEY_XF86Back },
+    { Qt::Key_Forward, XKB_KEY_XF86Forward },
+    { Qt::Key_Stop, XKB_KEY_XF86Stop },
+    { Qt::Key_Refresh, XKB_KEY_XF86Refresh },
+    { Qt::Key_VolumeDown, XKB_KEY_XF86AudioLowerVolume },
+    { Qt::Key_VolumeMute, XKB_KEY_XF86AudioMute },
+    { Qt::Key_VolumeUp, XKB_KEY_XF86AudioRaiseVolume },
+    { Qt::Key_MediaPlay, XKB_KEY_XF86AudioPlay },
+    { Qt::Key_MediaStop, XKB_KEY_XF86AudioStop },
+    { Qt::Key_MediaPrevious, XKB_KEY_XF86AudioPrev },
+    { Qt::Key_MediaNext, XKB_KEY_XF86AudioNext },
+    { Qt::Key_MediaRecord, XKB_KEY_XF86AudioRecord },
+    { Qt::Key_MediaPause, XKB_KEY_XF86AudioPause },
+    { Qt::Key_HomePage, XKB_KEY_XF86HomePage },
+    { Qt::Key_Favorites, XKB_KEY_XF86Favorites },
+    { Qt::Key_Search, XKB_KEY_XF86Search },
+    { Qt::Key_Standby, XKB_KEY_XF86Standby },
+    { Qt::Key_OpenUrl, XKB_KEY_XF86OpenURL },
+    { Qt::Key_LaunchMail, XKB_KEY_XF86Mail },
+    { Qt::Key_LaunchMedia, XKB_KEY_XF86AudioMedia },
+    { Qt::Key_MonBrightnessUp, XKB_KEY_XF86MonBrightnessUp },
+    { Qt::Key_MonBrightnessDown, XKB_KEY_XF86MonBrightnessDown },
+    { Qt::Key_KeyboardLightOnOff, XKB_KEY_XF86KbdLightOnOff },
+    { Qt::Key_KeyboardBrightnessUp, XKB_KEY_XF86KbdBrightnessUp },
+    { Qt::Key_KeyboardBrightnessDown, XKB_KEY_XF86KbdBrightnessDown },
+    { Qt::Key_PowerOff, XKB_KEY_XF86PowerOff },
+    { Qt::Key_WakeUp, XKB_KEY_XF86WakeUp },
+    { Qt::Key_Eject, XKB_KEY_XF86Eject },
+    { Qt::Key_ScreenSaver, XKB_KEY_XF86ScreenSaver },
+    { Qt::Key_WWW, XKB_KEY_XF86WWW },
+    { Qt::Key_Memo, XKB_KEY_XF86Memo },
+    { Qt::Key_LightBulb, XKB_KEY_XF86LightBulb },
+    { Qt::Key_Shop, XKB_KEY_XF86Shop },
+    { Qt::Key_History, XKB_KEY_XF86History },
+    { Qt::Key_AddFavorite, XKB_KEY_XF86AddFavorite },
+    { Qt::Key_HotLinks, XKB_KEY_XF86HotLinks },
+    { Qt::Key_BrightnessAdjust, XKB_KEY_XF86BrightnessAdjust },
+    { Qt::Key_Finance, XKB_KEY_XF86Finance },
+    { Qt::Key_Community, XKB_KEY_XF86Community },
+    { Qt::Key_AudioRewind, XKB_KEY_XF86AudioRewind },
+    { Qt::Key_BackForward, XKB_KEY_XF86BackForward },
+    { Qt::Key_ApplicationLeft, XKB_KEY_XF86ApplicationLeft },
+    { Qt::Key_ApplicationRight, XKB_KEY_XF86ApplicationRight },
+    { Qt::Key_Book, XKB_KEY_XF86Book },
+    { Qt::Key_CD, XKB_KEY_XF86CD },
+    { Qt::Key_Calculator, XKB_KEY_XF86Calculator },
+    { Qt::Key_ToDoList, XKB_KEY_XF86ToDoList },
+    { Qt::Key_ClearGrab, XKB_KEY_XF86ClearGrab },
+    { Qt::Key_Close, XKB_KEY_XF86Close },
+    { Qt::Key_Copy, XKB_KEY_XF86Copy },
+    { Qt::Key_Cut, XKB_KEY_XF86Cut },
+    { Qt::Key_Display, XKB_KEY_XF86Display },
+    { Qt::Key_DOS, XKB_KEY_XF86DOS },
+    { Qt::Key_Documents, XKB_KEY_XF86Documents },
+    { Qt::Key_Excel, XKB_KEY_XF86Excel },
+    { Qt::Key_Explorer, XKB_KEY_XF86Explorer },
+    { Qt::Key_Game, XKB_KEY_XF86Game },
+    { Qt::Key_Go, XKB_KEY_XF86Go },
+    { Qt::Key_iTouch, XKB_KEY_XF86iTouch },
+    { Qt::Key_LogOff, XKB_KEY_XF86LogOff },
+    { Qt::Key_Market, XKB_KEY_XF86Market },
+    { Qt::Key_Meeting, XKB_KEY_XF86Meeting },
+    { Qt::Key_MenuKB, XKB_KEY_XF86MenuKB },
+    { Qt::Key_MenuPB, XKB_KEY_XF86MenuPB },
+    { Qt::Key_MySites, XKB_KEY_XF86MySites },
+    { Qt::Key_News, XKB_KEY_XF86News },
+    { Qt::Key_OfficeHome, XKB_KEY_XF86OfficeHome },
+    { Qt::Key_Option, XKB_KEY_XF86Option },
+    { Qt::Key_Paste, XKB_KEY_XF86Paste },
+    { Qt::Key_Phone, XKB_KEY_XF86Phone },
+    { Qt::Key_Calendar, XKB_KEY_XF86Calendar },
+    { Qt::Key_Reply, XKB_KEY_XF86Reply },
+    { Qt::Key_Reload, XKB_KEY_XF86Reload },
+    { Qt::Key_RotateWindows, XKB_KEY_XF86RotateWindows },
+    { Qt::Key_RotationPB, XKB_KEY_XF86RotationPB },
+    { Qt::Key_RotationKB, XKB_KEY_XF86RotationKB },
+    { Qt::Key_Save, XKB_KEY_XF86Save },
+    { Qt::Key_Send, XKB_KEY_XF86Send },
+    { Qt::Key_Spell, XKB_KEY_XF86Spell },
+    { Qt::Key_SplitScreen, XKB_KEY_XF86SplitScreen },
+    { Qt::Key_Support, XKB_KEY_XF86Support },
+    { Qt::Key_TaskPane, XKB_KEY_XF86TaskPane },
+    { Qt::Key_Terminal, XKB_KEY_XF86Terminal },
+    { Qt::Key_Tools, XKB_KEY_XF86Tools },
+    { Qt::Key_Travel, XKB_KEY_XF86Travel },
+    { Qt::Key_Video, XKB_KEY_XF86Video },
+    { Qt::Key_Word, XKB_KEY_XF86Word },
+    { Qt::Key_Xfer, XKB_KEY_XF86Xfer },
+    { Qt::Key_ZoomIn, XKB_KEY_XF86ZoomIn },
+    { Qt::Key_ZoomOut, XKB_KEY_XF86ZoomOut },
+    { Qt::Key_Away, XKB_KEY_XF86Away },
+    { Qt::Key_Messenger, XKB_KEY_XF86Messenger },
+    { Qt::Key_WebCam, XKB_KEY_XF86WebCam },
+    { Qt::Key_MailForward, XKB_KEY_XF86MailForward },
+    { Qt::Key_Pictures, XKB_KEY_XF86Pictures },
+    { Qt::Key_Music, XKB_KEY_XF86Music },
+    { Qt::Key_Battery, XKB_KEY_XF86Battery },
+    { Qt::Key_Bluetooth, XKB_KEY_XF86Bluetooth },
+    { Qt::Key_WLAN, XKB_KEY_XF86WLAN },
+    { Qt::Key_UWB, XKB_KEY_XF86UWB },
+    { Qt::Key_AudioForward, XKB_KEY_XF86AudioForward },
+    { Qt::Key_AudioRepeat, XKB_KEY_XF86AudioRepeat },
+    { Qt::Key_AudioRandomPlay, XKB_KEY_XF86AudioRandomPlay },
+    { Qt::Key_Subtitle, XKB_KEY_XF86Subtitle },
+    { Qt::Key_AudioCycleTrack, XKB_KEY_XF86AudioCycleTrack },
+    { Qt::Key_Time, XKB_KEY_XF86Time },
+    { Qt::Key_Hibernate, XKB_KEY_XF86Hibernate },
+    { Qt::Key_View, XKB_KEY_XF86View },
+    { Qt::Key_TopMenu, XKB_KEY_XF86TopMenu },
+    { Qt::Key_PowerDown, XKB_KEY_XF86PowerDown },
+    { Qt::Key_Suspend, XKB_KEY_XF86Suspend },
+    { Qt::Key_ContrastAdjust, XKB_KEY_XF86ContrastAdjust },
+    { Qt::Key_AltGr, XKB_KEY_ISO_Level3_Shift },
+    { Qt::Key_Multi_key, XKB_KEY_Multi_key },
+    { Qt::Key_Kanji, XKB_KEY_Kanji },
+    { Qt::Key_Muhenkan, XKB_KEY_Muhenkan },
+    { Qt::Key_Henkan, XKB_KEY_Henkan },
+    { Qt::Key_Romaji, XKB_KEY_Romaji },
+    { Qt::Key_Hiragana, XKB_KEY_Hiragana },
+    { Qt::Key_Katakana, XKB_KEY_Katakana },
+    { Qt::Key_Hiragana_Katakana, XKB_KEY_Hiragana_Katakana },
+    { Qt::Key_Zenkaku, XKB_KEY_Zenkaku },
+    { Qt::Key_Hankaku, XKB_KEY_Hankaku },
+    { Qt::Key_Zenkaku_Hankaku, XKB_KEY_Zenkaku_Hankaku },
+    { Qt::Key_Touroku, XKB_KEY_Touroku },
+    { Qt::Key_Massyo, XKB_KEY_Massyo },
+    { Qt::Key_Kana_Lock, XKB_KEY_Kana_Lock },
+    { Qt::Key_Kana_Shift, XKB_KEY_Kana_Shift },
+    { Qt::Key_Eisu_Shift, XKB_KEY_Eisu_Shift },
+    { Qt::Key_Eisu_toggle, XKB_KEY_Eisu_toggle },
+    { Qt::Key_Hangul, XKB_KEY_Hangul },
+    { Qt::Key_Hangul_Start, XKB_KEY_Hangul_Start },
+    { Qt::Key_Hangul_End, XKB_KEY_Hangul_End },
+    { Qt::Key_Hangul_Hanja, XKB_KEY_Hangul_Hanja },
+    { Qt::Key_Hangul_Jamo, XKB_KEY_Hangul_Jamo },
+    { Qt::Key_Hangul_Romaja, XKB_KEY_Hangul_Romaja },
+    { Qt::Key_Codeinput, XKB_KEY_Codeinput },
+    { Qt::Key_Hangul_Jeonja, XKB_KEY_Hangul_Jeonja },
+    { Qt::Key_Hangul_Banja, XKB_KEY_Hangul_Banja },
+    { Qt::Key_Hangul_PreHanja, XKB_KEY_Hangul_PreHanja },
+    { Qt::Key_Hangul_PostHanja, XKB_KEY_Hangul_PostHanja },
+    { Qt::Key_SingleCandidate, XKB_KEY_SingleCandidate },
+    { Qt::Key_MultipleCandidate, XKB_KEY_MultipleCandidate },
+    { Qt::Key_PreviousCandidate, XKB_KEY_PreviousCandidate },
+    { Qt::Key_Hangul_Special, XKB_KEY_Hangul_Special },
+    { Qt::Key_Mode_switch, XKB_KEY_Mode_switch },
+    { Qt::Key_Dead_Grave, XKB_KEY_dead_grave },
+    { Qt::Key_Dead_Acute, XKB_KEY_dead_acute },
+    { Qt::Key_Dead_Circumflex, XKB_KEY_dead_circumflex },
+    { Qt::Key_Dead_Tilde, XKB_KEY_dead_tilde },
+    { Qt::Key_Dead_Macron, XKB_KEY_dead_macron },
+    { Qt::Key_Dead_Breve, XKB_KEY_dead_breve },
+    { Qt::Key_Dead_Abovedot, XKB_KEY_dead_abovedot },
+    { Qt::Key_Dead_Diaeresis, XKB_KEY_dead_diaeresis },
+    { Qt::Key_Dead_Abovering, XKB_KEY_dead_abovering },
+    { Qt::Key_Dead_Doubleacute, XKB_KEY_dead_doubleacute },
+    { Qt::Key_Dead_Caron, XKB_KEY_dead_caron },
+    { Qt::Key_Dead_Cedilla, XKB_KEY_dead_cedilla },
+    { Qt::Key_Dead_Ogonek, XKB_KEY_dead_ogonek },
+    { Qt::Key_Dead_Iota, XKB_KEY_dead_iota },
+    { Qt::Key_Dead_Voiced_Sound, XKB_KEY_dead_voiced_sound },
+    { Qt::Key_Dead_Semivoiced_Sound, XKB_KEY_dead_semivoiced_sound },
+    { Qt::Key_Dead_Belowdot, XKB_KEY_dead_belowdot },
+    { Qt::Key_Dead_Hook, XKB_KEY_dead_hook },
+    { Qt::Key_Dead_Horn, XKB_KEY_dead_horn },
+    { Qt::Key_Select, XKB_KEY_Select },
+    { Qt::Key_Cancel, XKB_KEY_Cancel },
+    { Qt::Key_Execute, XKB_KEY_Execute },
+    { Qt::Key_Sleep, XKB_KEY_XF86Sleep },
+};
+
+const KeyMapping *const keyTableEnd = keyTable + sizeof(keyTable) / sizeof(keyTable[0]);
+
+// Keys with Qt::KeypadModifier
+const KeyMapping keypadTable[] = {
+    { Qt::Key_Asterisk, XKB_KEY_KP_Multiply },
+    { Qt::Key_Plus, XKB_KEY_KP_Add },
+    { Qt::Key_Comma, XKB_KEY_KP_Separator },
+    { Qt::Key_Minus, XKB_KEY_KP_Subtract },
+    { Qt::Key_Period, XKB_KEY_KP_Decimal },
+    { Qt::Key_Slash, XKB_KEY_KP_Divide },
+    { Qt::Key_0, XKB_KEY_KP_0 },
+    { Qt::Key_1, XKB_KEY_KP_1 },
+    { Qt::Key_2, XKB_KEY_KP_2 },
+    { Qt::Key_3, XKB_KEY_KP_3 },
+    { Qt::Key_4, XKB_KEY_KP_4 },
+    { Qt::Key_5, XKB_KEY_KP_5 },
+    { Qt::Key_6, XKB_KEY_KP_6 },
+    { Qt::Key_7, XKB_KEY_KP_7 },
+    { Qt::Key_8, XKB_KEY_KP_8 },
+    { Qt::Key_9, XKB_KEY_KP_9 },
+    { Qt::Key_Equal, XKB_KEY_KP_Equal },
+    { Qt::Key_Enter, XKB_KEY_KP_Enter },
+};
+
+const KeyMapping *const keypadTableEnd = keypadTable + sizeof(keypadTable) / sizeof(keypadTable[0]);
+
+xkb_keysym_t lookup(const KeyMapping *begin, const KeyMapping *end, int key)
+{
+    const KeyMapping *mapping = std::lower_bound(begin, end, key);
+    return (mapping != end && mapping->key == key) ? mapping->keysym : XKB_KEY_NoSymbol;
+}
+
+} // unnamed namespace
+
+namespace Maliit {
+namespace Wayland {
+
+xkb_keysym_t keysymFromQt(int key, Qt::KeyboardModifiers modifiers, const QString &text)
+{
+    if (modifiers & Qt::KeypadModifier) {
+        const xkb_keysym_t keysym = lookup(keypadTable, keypadTableEnd, key);
+        if (keysym != XKB_KEY_NoSymbol) {
+            return keysym;
+        }
+    }
+
+    const xkb_keysym_t keysym = lookup(keyTable, keyTableEnd, key);
+    if (keysym != XKB_KEY_NoSymbol) {
+        return keysym;
+    }
+
+    // Text of a single character, unless it is a control character like
+    // the ones produced together with Qt::ControlModifier
+    const QVector<uint> characters = text.toUcs4();
+    if (characters.size() == 1 && characters.first() >= 0x20) {
+        return keysymFromUtf32(characters.first());
+    }
+
+    // Printable keys are reported with upper case letters
+    if (key > 0 && key < Qt::Key_Escape) {
+        const uint character = (modifiers & Qt::ShiftModifier) ? uint(key) : QChar::toLower(uint(key));
+        return keysymFromUtf32(character);
+    }
+
+    return XKB_KEY_NoSymbol;
+}
+
+xkb_keysym_t keysymFromUtf32(uint ucs4)
+{
+    switch (ucs4) {
+    case 0x08:
+        return XKB_KEY_BackSpace;
+    case 0x09:
+        return XKB_KEY_Tab;
+    case 0x0a:
+        return XKB_KEY_Linefeed;
+    case 0x0d:
+        return XKB_KEY_Return;
+    case 0x1b:
+        return XKB_KEY_Escape;
+    case 0x7f:
+        return XKB_KEY_Delete;
+    default:
+        break;
+    }
+
+    if ((ucs4 >= 0x20 && ucs4 < 0x7f) || (ucs4 >= 0xa0 && ucs4 <= 0xff)) {
+        return ucs4;
+    }
+
+    if (ucs4 < 0x100 || ucs4 > 0x10ffff || QChar::isSurrogate(ucs4)) {
+        return XKB_KEY_NoSymbol;
+    }
+
+    return 0x01000000 | ucs4;
+}
+
+bool keysymTableIsSorted()
+{
+    for (const KeyMapping *mapping = keyTable + 1; mapping != keyTableEnd; ++mapping) {
+        if (not ((mapping - 1)->key < mapping->key)) {
+            return false;
+        }
+    }
+
+    for (const KeyMapping *mapping = keypadTable + 1; mapping != keypadTableEnd; ++mapping) {
+        if (not ((mapping - 1)->key < mapping->key)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace Wayland
+} // namespace Maliit
@@ -0,0 +1,52 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MALIIT_WAYLAND_KEYSYMS_H
+#define MALIIT_WAYLAND_KEYSYMS_H
+
+#include <QString>
+
+#include <xkbcommon/xkbcommon.h>
+
+namespace Maliit {
+namespace Wayland {
+
+/*! \internal
+ * \brief Returns the keysym for a key event sent by a plugin.
+ *
+ * Keys without text, like cursor, function and media keys, are looked up in
+ * a table sorted by Qt::Key. Keys with Qt::KeypadModifier map to the keypad
+ * keysyms. Otherwise the keysym is derived from \a text, or from \a key if
+ * there is no text. Returns XKB_KEY_NoSymbol if nothing matches.
+ */
+xkb_keysym_t keysymFromQt(int key, Qt::KeyboardModifiers modifiers, const QString &text);
+
+/*! \internal
+ * \brief Returns the keysym of Unicode character \a ucs4.
+ *
+ * Follows the xkbcommon convention: Latin-1 characters are their own keysym,
+ * control characters with a key of their own map to that key and all other
+ * characters use the 0x01000000 Unicode keysym range.
+ */
+xkb_keysym_t keysymFromUtf32(uint ucs4);
+
+/*! \internal
+ * \brief Returns whether the Qt::Key table is strictly sorted, for tests.
+ */
+bool keysymTableIsSorted();
+
+} // namespace Wayland
+} // namespace Maliit
+
+#endif // MALIIT_WAYLAND_KEYSYMS_H
@@ -18,6 +18,8 @@
 
 #include "minputcontext.h"
 
+#include <maliit/tracing.h>
+
 #include <QGuiApplication>
 #include <QScreen>
 #include <QKeyEvent>
@@ -35,6 +37,11 @@ namespace
     const int SoftwareInputPanelHideTimer = 100;
     const char * const InputContextName = "MInputContext";
 
+    // Queries the widget state sent to the server is built from
+    const Qt::InputMethodQueries StateQueries = Qt::ImSurroundingText | Qt::ImCursorPosition
+                                                | Qt::ImAnchorPosition | Qt::ImHints
+                                                | Qt::ImCurrentSelection | Qt::ImCursorRectangle;
+
     int orientationAngle(Qt::ScreenOrientation orientation)
     {
         // Maliit uses orientations relative to screen, Qt relative to world
@@ -65,7 +72,9 @@ MInputContext::MInputContext()
       inputPanelState(InputPanelHidden),
       preeditCursorPos(-1),
       redirectKeys(false),
-      currentFocusAcceptsInput(false)
+      currentFocusAcceptsInput(false),
+      inBatch(false),
+      preeditChangedInBatch(false)
 {
     QByteArray debugEnvVar = qgetenv("MALIIT_DEBUG");
     if (!debugEnvVar.isEmpty() && debugEnvVar != "0") {
@@ -73,6 +82,8 @@ MInputContext::MInputContext()
         debug = true;
     }
 
+    Maliit::Tracing::startFromEnvironment(QString("input context %1").arg(QCoreApplication::applicationName()));
+
     QSharedPointer<Maliit::InputContext::DBus::Address> address(new Maliit::InputContext::DBus::DynamicAddress);
     imServer = new DBusServerConnection(address);
 
@@ -107,6 +118,9 @@ void MInputContext::connectInputMethodServer()
     connect(imServer, SIGNAL(keyEvent(int,int,int,QString,bool,int,Maliit::EventRequestType)),
             this, SLOT(keyEvent(int,int,int,QString,bool,int,Maliit::EventRequestType)));
 
+    connect(imServer, SIGNAL(keyEventPassedThrough(int,int,int,QString,bool,int,quint32,quint32,quint32,ulong)),
+            this, SLOT(passThroughKeyEvent(int,int,int,QString,bool,int,quint32,quint32,quint32,ulong)));
+
     connect(imServer, SIGNAL(updateInputMethodArea(QRect)),
             this, SLOT(updateInputMethodArea(QRect)));
 
@@ -131,6 +145,9 @@ void MInputContext::connectInputMethodServer()
 
     connect(imServer, SIGNAL(setLanguage(QString)),
             this, SLOT(setLanguage(QString)));
+
+    connect(imServer, SIGNAL(batchStarted()), this, SLOT(onBatchStarted()));
+    connect(imServer, SIGNAL(batchFinished()), this, SLOT(onBatchFinished()));
 }
 
 
@@ -232,8 +249,6 @@ void MInputContext::update(Qt::InputMethodQueries queries)
 {
     if (debug) qDebug() << InputContextName << "in" << __PRETTY_FUNCTION__;
 
-    Q_UNUSED(queries) // fetching everything
-
     if (queries & Qt::ImPlatformData) {
         updateInputMethodExtensions();
     }
@@ -251,8 +266,9 @@ void MInputContext::update(Qt::InputMethodQueries queries)
             effectiveFocusChange = true;
         }
     }
-    // get the state information of currently focused widget, and pass it to input method server
-    QMap<QString, QVariant> stateInformation = getStateInformation();
+    // get the state information of currently focused widget, and pass it to input method server.
+    // Only the queried properties are fetched again, the others come from the last snapshot.
+    QMap<QString, QVariant> stateInformation = getStateInformation(queries);
     imServer->updateWidgetInformation(stateInformation, effectiveFocusChange);
 }
 
@@ -327,7 +343,8 @@ bool MInputContext::filterEvent(const QEvent *event)
             imServer->processKeyEvent(key->type(), static_cast<Qt::Key>(key->key()),
                                       key->modifiers(), key->text(), key->isAutoRepeat(),
                                       key->count(), key->nativeScanCode(),
-                                      key->nativeModifiers(), 0 /* currentKeyEventTime */);
+                                      key->nativeVirtualKey(), key->nativeModifiers(),
+                                      key->timestamp());
             eaten = true;
         }
         break;
@@ -366,6 +383,7 @@ void MInputContext::showInputPanel()
     } else {
         // note: could do this also if panel was hidden
 
+        Maliit::Tracing::event("client showInputMethod");
         imServer->showInputMethod();
         inputPanelState = InputPanelShown;
     }
@@ -462,7 +480,7 @@ void MInputContext::commitString(const QString &string, int replacementStart,
     }
 
     if (hadPreedit) {
-        Q_EMIT preeditChanged();
+        notifyPreeditChanged();
     }
 }
 
@@ -539,7 +557,7 @@ void MInputContext::updatePreeditInternally(const QString &string,
                   << "Wrong reset/preedit behaviour in active input method plugin?";
     }
 
-    Q_EMIT preeditChanged();
+    notifyPreeditChanged();
 }
 
 void MInputContext::keyEvent(int type, int key, int modifiers, const QString &text,
@@ -556,9 +574,27 @@ void MInputContext::keyEvent(int type, int key, int modifiers, const QString &te
     }
 }
 
+void MInputContext::passThroughKeyEvent(int type, int key, int modifiers, const QString &text,
+                                        bool autoRepeat, int count, quint32 nativeScanCode,
+                                        quint32 nativeVirtualKey, quint32 nativeModifiers,
+                                        ulong time)
+{
+    if (debug) qDebug() << InputContextName << "in" << __PRETTY_FUNCTION__;
+
+    if (qGuiApp->focusWindow() != 0) {
+        // Sent to the window directly, so filterEvent() does not redirect it again
+        QKeyEvent event(static_cast<QEvent::Type>(type), key, static_cast<Qt::KeyboardModifiers>(modifiers),
+                        nativeScanCode, nativeVirtualKey, nativeModifiers, text, autoRepeat, count);
+        event.setTimestamp(time);
+        QGuiApplication::sendEvent(qGuiApp->focusWindow(), &event);
+    }
+}
+
 
 void MInputContext::updateInputMethodArea(const QRect &rect)
 {
+    Maliit::Tracing::event("client updateInputMethodArea");
+
     bool wasVisible = isInputPanelVisible();
 
     if (rect != keyboardRectangle) {
@@ -608,12 +644,38 @@ void MInputContext::onInvokeAction(const QString &action, const QKeySequence &se
     }
 }
 
+void MInputContext::onBatchStarted()
+{
+    inBatch = true;
+}
+
+void MInputContext::onBatchFinished()
+{
+    inBatch = false;
+
+    if (preeditChangedInBatch) {
+        preeditChangedInBatch = false;
+        Q_EMIT preeditChanged();
+    }
+}
+
+void MInputContext::notifyPreeditChanged()
+{
+    // Preedit changes of a batch are reported once, with the final preedit
+    if (inBatch) {
+        preeditChangedInBatch = true;
+    } else {
+        Q_EMIT preeditChanged();
+    }
+}
+
 void MInputContext::onDBusDisconnection()
 {
     if (debug) qDebug() << __PRETTY_FUNCTION__;
 
     active = false;
     redirectKeys = false;
+    sentActionKeyAttributes.clear();
 
     updateInputMethodArea(QRect());
 }
@@ -624,6 +686,7 @@ void MInputContext::onDBusConnection()
 
     // using one attribute extension for everything
     imServer->registerAttributeExtension(0, QString());
+    sentActionKeyAttributes.clear();
 
     // Force activation, since setFocusObject may have been called after
     // onDBusDisconnection set active to false or before the dbus connection.
@@ -683,73 +746,112 @@ void MInputContext::setDetectableAutoRepeat(bool enabled)
     if (debug) qWarning() << "Detectable autorepeat not supported.";
 }
 
-QMap<QString, QVariant> MInputContext::getStateInformation() const
+QMap<QString, QVariant> MInputContext::getStateInformation(Qt::InputMethodQueries queries)
 {
-    QMap<QString, QVariant> stateInformation;
+    QObject *focusObject = qGuiApp->focusObject();
 
-    stateInformation["focusState"] = inputMethodAccepted();
+    if (!inputMethodAccepted() || !focusObject) {
+        stateSnapshot.clear();
+        stateSnapshotObject.clear();
 
-    if (!inputMethodAccepted() || !qGuiApp->focusObject()) {
+        QMap<QString, QVariant> stateInformation;
+        stateInformation["focusState"] = inputMethodAccepted();
         return stateInformation;
     }
 
-    QInputMethodQueryEvent query(Qt::ImQueryAll);
-    QGuiApplication::sendEvent(qGuiApp->focusObject(), &query);
+    // The snapshot only helps for the object it was collected from
+    if (focusObject != stateSnapshotObject.data()) {
+        stateSnapshot.clear();
+        stateSnapshotObject = focusObject;
+        queries = Qt::ImQueryAll;
+    }
 
-    QVariant queryResult;
+    queries &= StateQueries;
 
-    queryResult = query.value(Qt::ImSurroundingText);
-    if (queryResult.isValid()) {
-        stateInformation["surroundingText"] = queryResult.toString();
-    }
+    if (queries) {
+        QInputMethodQueryEvent query(queries);
+        QGuiApplication::sendEvent(focusObject, &query);
 
-    queryResult = query.value(Qt::ImCursorPosition);
-    if (queryResult.isValid()) {
-        stateInformation["cursorPosition"] = queryResult.toInt();
-    }
+        QVariant queryResult;
 
-    queryResult = query.value(Qt::ImAnchorPosition);
-    if (queryResult.isValid()) {
-        stateInformation["anchorPosition"] = queryResult.toInt();
-    }
+        if (queries & Qt::ImSurroundingText) {
+            queryResult = query.value(Qt::ImSurroundingText);
+            if (queryResult.isValid()) {
+                stateSnapshot["surroundingText"] = queryResult.toString();
+            } else {
+                stateSnapshot.remove("surroundingText");
+            }
+        }
+
+        if (queries & Qt::ImCursorPosition) {
+            queryResult = query.value(Qt::ImCursorPosition);
+            if (queryResult.isValid()) {
+                stateSnapshot["cursorPosition"] = queryResult.toInt();
+            } else {
+                stateSnapshot.remove("cursorPosition");
+            }
+        }
+
+        if (queries & Qt::ImAnchorPosition) {
+            queryResult = query.value(Qt::ImAnchorPosition);
+            if (queryResult.isValid()) {
+                stateSnapshot["anchorPosition"] = queryResult.toInt();
+            } else {
+                stateSnapshot.remove("anchorPosition");
+            }
+        }
 
-    queryResult = query.value(Qt::ImHints);
-    Qt::InputMethodHints hints = static_cast<Qt::InputMethodHints>(queryResult.toUInt());
+        if (queries & Qt::ImHints) {
+            queryResult = query.value(Qt::ImHints);
+            Qt::InputMethodHints hints = static_cast<Qt::InputMethodHints>(queryResult.toUInt());
 
-    // content type value
-    // Deprecated, replaced by just transmitting all hints (see below):
-    // FIXME: Remove once MAbstractInputMethod API for this got deprecated/removed.
-    stateInformation["contentType"] = contentType(hints);
+            // content type value
+            // Deprecated, replaced by just transmitting all hints (see below):
+            // FIXME: Remove once MAbstractInputMethod API for this got deprecated/removed.
+            stateSnapshot["contentType"] = contentType(hints);
 
-    stateInformation["autocapitalizationEnabled"] = !(hints & Qt::ImhNoAutoUppercase);
-    stateInformation["hiddenText"] = static_cast<bool>(hints & Qt::ImhHiddenText);
-    stateInformation["predictionEnabled"] = !(hints & Qt::ImhNoPredictiveText);
+            stateSnapshot["autocapitalizationEnabled"] = !(hints & Qt::ImhNoAutoUppercase);
+            stateSnapshot["hiddenText"] = static_cast<bool>(hints & Qt::ImhHiddenText);
+            stateSnapshot["predictionEnabled"] = !(hints & Qt::ImhNoPredictiveText);
 
-    stateInformation["maliit-inputmethod-hints"] = QVariant(static_cast<qint64>(hints));
+            stateSnapshot["maliit-inputmethod-hints"] = QVariant(static_cast<qint64>(hints));
+        }
 
-    // is text selected
-    queryResult = query.value(Qt::ImCurrentSelection);
-    if (queryResult.isValid()) {
-        stateInformation["hasSelection"] = !(queryResult.toString().isEmpty());
+        // is text selected
+        if (queries & Qt::ImCurrentSelection) {
+            queryResult = query.value(Qt::ImCurrentSelection);
+            if (queryResult.isValid()) {
+                stateSnapshot["hasSelection"] = !(queryResult.toString().isEmpty());
+            } else {
+                stateSnapshot.remove("hasSelection");
+            }
+        }
+
+        if (queries & Qt::ImCursorRectangle) {
+            QWindow *window = qGuiApp->focusWindow();
+            queryResult = query.value(Qt::ImCursorRectangle);
+            if (queryResult.isValid() && window) {
+                QRect rect = queryResult.toRect();
+                rect = qGuiApp->inputMethod()->inputItemTransform().mapRect(rect);
+                stateSnapshot["cursorRectangle"] = QRect(window->mapToGlobal(rect.topLeft()), rect.size());
+            } else {
+                stateSnapshot.remove("cursorRectangle");
+            }
+        }
     }
 
+    stateSnapshot["focusState"] = true;
+
     QWindow *window = qGuiApp->focusWindow();
     if (window) {
-        stateInformation["winId"] = static_cast<qulonglong>(window->winId());
-    }
-
-    queryResult = query.value(Qt::ImCursorRectangle);
-    if (queryResult.isValid()) {
-        QRect rect = queryResult.toRect();
-        rect = qGuiApp->inputMethod()->inputItemTransform().mapRect(rect);
-        if (window) {
-            stateInformation["cursorRectangle"] = QRect(window->mapToGlobal(rect.topLeft()), rect.size());
-        }
+        stateSnapshot["winId"] = static_cast<qulonglong>(window->winId());
+    } else {
+        stateSnapshot.remove("winId");
     }
 
-    stateInformation["toolbarId"] = 0; // Global extension id. And bad state parameter name for it.
+    stateSnapshot["toolbarId"] = 0; // Global extension id. And bad state parameter name for it.
 
-    return stateInformation;
+    return stateSnapshot;
 }
 
 void MInputContext::setSelection(int start, int length)
@@ -824,16 +926,33 @@ void MInputContext::updateInputMethodExtensions()
     if (debug) qDebug() << InputContextName << __PRETTY_FUNCTION__;
 
     QVariantMap extensions = qGuiApp->focusObject()->property("__inputMethodExtensions").toMap();
+    QVariantMap attributes;
     QVariant value;
     value = extensions.value("enterKeyIconSource");
-    imServer->setExtendedAttribute(0, "/keys", "actionKey", "icon", QVariant(value.toUrl().toString()));
+    attributes.insert("icon", QVariant(value.toUrl().toString()));
 
     value = extensions.value("enterKeyText");
-    imServer->setExtendedAttribute(0, "/keys", "actionKey", "label", QVariant(value.toString()));
+    attributes.insert("label", QVariant(value.toString()));
 
     value = extensions.value("enterKeyEnabled");
-    imServer->setExtendedAttribute(0, "/keys", "actionKey", "enabled", value.isValid() ? value.toBool() : true);
+    attributes.insert("enabled", value.isValid() ? value.toBool() : true);
 
     value = extensions.value("enterKeyHighlighted");
-    imServer->setExtendedAttribute(0, "/keys", "actionKey", "highlighted", value.isValid() ? value.toBool() : false);
+    attributes.insert("highlighted", value.isValid() ? value.toBool() : false);
+
+    // Only what differs from what the server already has
+    QVariantMap changedAttributes;
+    for (QVariantMap::const_iterator i = attributes.constBegin(); i != attributes.constEnd(); ++i) {
+        QVariantMap::const_iterator sent = sentActionKeyAttributes.constFind(i.key());
+        if (sent == sentActionKeyAttributes.constEnd() || sent.value() != i.value()) {
+            changedAttributes.insert(i.key(), i.value());
+        }
+    }
+
+    if (changedAttributes.isEmpty()) {
+        return;
+    }
+
+    imServer->setExtendedAttributes(0, "/keys", "actionKey", changedAttributes);
+    sentActionKeyAttributes = attributes;
 }
@@ -75,6 +75,9 @@ public Q_SLOTS:
 
     void keyEvent(int type, int key, int modifiers, const QString &text, bool autoRepeat,
                   int count, Maliit::EventRequestType requestType = Maliit::EventRequestBoth);
+    void passThroughKeyEvent(int type, int key, int modifiers, const QString &text, bool autoRepeat,
+                             int count, quint32 nativeScanCode, quint32 nativeVirtualKey,
+                             quint32 nativeModifiers, ulong time);
 
     void updateInputMethodArea(const QRect &rect);
     void setGlobalCorrectionEnabled(bool);
@@ -94,6 +97,9 @@ private Q_SLOTS:
     void onDBusDisconnection();
     void onDBusConnection();
 
+    void onBatchStarted();
+    void onBatchFinished();
+
     // Notify input method plugin about the application's active window prepare to change to a new orientation angle.
     void notifyOrientationAboutToChange(MInputContext::OrientationAngle orientation);
 
@@ -118,13 +124,17 @@ private:
 
     void connectInputMethodServer();
 
+    void notifyPreeditChanged();
+
     void updateInputMethodExtensions();
 
     // returns content type corresponding to specified hints
     Maliit::TextContentType contentType(Qt::InputMethodHints hints) const;
 
     // returns state for currently focused widget, key is attribute name.
-    QMap<QString, QVariant> getStateInformation() const;
+    // Only properties affected by \a queries are queried from the focus object,
+    // the rest is taken from the snapshot of the previous call.
+    QMap<QString, QVariant> getStateInformation(Qt::InputMethodQueries queries = Qt::ImQueryAll);
 
     // Gets cursor start position, relative to widget surrounding text.
     // Parameter valid set to false on failure.
@@ -146,6 +156,13 @@ private:
     bool redirectKeys; // redirect all hw key events to the input method or not
     QLocale inputLocale;
     bool currentFocusAcceptsInput;
+    bool inBatch; // applying messages the server sent as one batch
+    bool preeditChangedInBatch;
+    // action key attributes the server has for the attribute extension, sent by updateInputMethodExtensions
+    QVariantMap sentActionKeyAttributes;
+    // widget state of stateSnapshotObject as last collected by getStateInformation
+    QMap<QString, QVariant> stateSnapshot;
+    QPointer<QObject> stateSnapshotObject;
 };
 
 #endif
@@ -25,6 +25,8 @@
 #endif // HAVE_WAYLAND
 #include "unknownplatform.h"
 
+#include <maliit/tracing.h>
+
 #include <QGuiApplication>
 #include <QtDebug>
 
@@ -87,10 +89,11 @@ QSharedPointer<MInputContextConnection> createConnection(const MImServerConnecti
     } else
 #endif
     if (options.overriddenAddress.isEmpty()) {
-        return QSharedPointer<MInputContextConnection>(Maliit::DBus::createInputContextConnectionWithDynamicAddress());
+        return QSharedPointer<MInputContextConnection>(Maliit::DBus::createInputContextConnectionWithDynamicAddress(options.sharedMemoryTransport));
     } else {
         return QSharedPointer<MInputContextConnection>(Maliit::DBus::createInputContextConnectionWithFixedAddress(options.overriddenAddress,
-                                                                                                                  options.allowAnonymous));
+                                                                                                                  options.allowAnonymous,
+                                                                                                                  options.sharedMemoryTransport));
     }
 }
 
@@ -136,8 +139,13 @@ int main(int argc, char **argv)
 
     QGuiApplication app(argc, argv);
 
+    if (!serverCommonOptions.traceFile.isEmpty()) {
+        Maliit::Tracing::start(serverCommonOptions.traceFile, "maliit-server");
+    }
+
     // Input Context Connection
     QSharedPointer<MInputContextConnection> icConnection(createConnection(connectionOptions));
+    Maliit::Tracing::event("server connection created");
 
     QSharedPointer<Maliit::AbstractPlatform> platform(createPlatform());
 
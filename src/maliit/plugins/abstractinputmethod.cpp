@@ -125,9 +125,9 @@ void MAbstractInputMethod::processKeyEvent(QEvent::Type keyType, Qt::Key keyCode
                                            quint32 /* nativeScanCode */, quint32 /* nativeModifiers */,
                                            unsigned long /*time*/)
 {
-    // default implementation, just sendKeyEvent back
-    inputMethodHost()->sendKeyEvent(QKeyEvent(keyType, keyCode, modifiers, text, autoRepeat,
-                                              count));
+    // default implementation, let the application handle it
+    inputMethodHost()->passThroughKeyEvent(QKeyEvent(keyType, keyCode, modifiers, text, autoRepeat,
+                                                     count));
 }
 
 void MAbstractInputMethod::setState(const QSet<Maliit::HandlerState> &state)
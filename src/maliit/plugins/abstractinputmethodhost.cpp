@@ -14,16 +14,33 @@
 
 #include <maliit/plugins/abstractinputmethodhost.h>
 #include <maliit/plugins/subviewdescription.h>
+#include <maliit/plugins/updateevent_p.h>
+
+#include <QKeyEvent>
+
+namespace {
+    void insertState(QVariantMap &state, MImUpdateEvent::PropertyId property,
+                     const QVariant &value, bool valid)
+    {
+        if (valid) {
+            state.insert(MImUpdateEventPrivate::propertyKey(property), value);
+        }
+    }
+}
 
 class MAbstractInputMethodHostPrivate
 {
 public:
     MAbstractInputMethodHostPrivate();
     ~MAbstractInputMethodHostPrivate();
+
+    //! Last snapshot returned by the default editorState()
+    MImEditorStateSnapshot editorState;
 };
 
 
 MAbstractInputMethodHostPrivate::MAbstractInputMethodHostPrivate()
+    : editorState()
 {
 }
 
@@ -50,6 +67,72 @@ bool MAbstractInputMethodHost::hiddenText(bool &valid)
     return false;
 }
 
+MImEditorStateSnapshot MAbstractInputMethodHost::editorState()
+{
+    QVariantMap state;
+    bool valid = false;
+
+    QString text;
+    int cursor = 0;
+    valid = surroundingText(text, cursor);
+    insertState(state, MImUpdateEvent::SurroundingTextProperty, text, valid);
+    insertState(state, MImUpdateEvent::CursorPositionProperty, cursor, valid);
+
+    const int anchor = anchorPosition(valid);
+    insertState(state, MImUpdateEvent::AnchorPositionProperty, anchor, valid);
+    const bool selected = hasSelection(valid);
+    insertState(state, MImUpdateEvent::HasSelectionProperty, selected, valid);
+    const int type = contentType(valid);
+    insertState(state, MImUpdateEvent::ContentTypeProperty, type, valid);
+    const bool correction = correctionEnabled(valid);
+    insertState(state, MImUpdateEvent::CorrectionProperty, correction, valid);
+    const bool prediction = predictionEnabled(valid);
+    insertState(state, MImUpdateEvent::PredictionProperty, prediction, valid);
+    const bool autoCapitalization = autoCapitalizationEnabled(valid);
+    insertState(state, MImUpdateEvent::AutoCapitalizationProperty, autoCapitalization, valid);
+    const bool hidden = hiddenText(valid);
+    insertState(state, MImUpdateEvent::HiddenTextProperty, hidden, valid);
+    const int mode = inputMethodMode(valid);
+    insertState(state, MImUpdateEvent::InputMethodModeProperty, mode, valid);
+    const QRect rectangle = cursorRectangle(valid);
+    insertState(state, MImUpdateEvent::CursorRectangleProperty, rectangle, valid);
+    valid = false; // not set by the default implementation
+    const int clickPosition = preeditClickPos(valid);
+    insertState(state, MImUpdateEvent::PreeditClickPosProperty, clickPosition, valid);
+
+    // The getters are asked every time, a new generation only if they
+    // report something else than last time
+    if (state != d->editorState.toMap()) {
+        d->editorState = MImEditorStateSnapshot(state, d->editorState.generation() + 1);
+    }
+
+    return d->editorState;
+}
+
+void MAbstractInputMethodHost::requestPreeditRectangle()
+{
+    bool valid = false;
+    const QRect rectangle = preeditRectangle(valid);
+    Q_EMIT preeditRectangleReceived(rectangle, valid);
+}
+
+void MAbstractInputMethodHost::requestSelection()
+{
+    bool valid = false;
+    const QString text = selection(valid);
+    Q_EMIT selectionReceived(text, valid);
+}
+
+void MAbstractInputMethodHost::passThroughKeyEvent(const QKeyEvent &keyEvent)
+{
+    sendKeyEvent(keyEvent, Maliit::EventRequestBoth);
+}
+
+void MAbstractInputMethodHost::setKeyFilter(const MImKeyFilter &filter)
+{
+    Q_UNUSED(filter);
+}
+
 QPixmap MAbstractInputMethodHost::background() const
 {
     return QPixmap();
@@ -22,12 +22,14 @@
 #include <QKeySequence>
 
 #include <maliit/namespace.h>
+#include <maliit/plugins/editorstatesnapshot.h>
 
 class QString;
 class QRegion;
 class QKeyEvent;
 
 class MImPluginDescription;
+class MImKeyFilter;
 class MImSubViewDescription;
 class MAbstractInputMethodHostPrivate;
 
@@ -139,6 +141,12 @@ Q_SIGNALS:
     //! This signal is emitted when input method plugins are loaded or unloaded
     void pluginsChanged();
 
+    //! This signal is emitted with the answer to \a requestPreeditRectangle
+    void preeditRectangleReceived(const QRect &rectangle, bool valid);
+
+    //! This signal is emitted with the answer to \a requestSelection
+    void selectionReceived(const QString &selection, bool valid);
+
 public Q_SLOTS:
     /*!
      * \brief Updates pre-edit string in the application widget
@@ -314,6 +322,64 @@ public:
                                                                           Maliit::SettingEntryType type,
                                                                           const QVariantMap &attributes) = 0;
 
+    // New virtual functions are appended here to keep the vtable layout
+    // of plugins built against earlier versions
+
+    /*!
+     * \brief Requests the preedit rectangle without blocking.
+     *
+     * The answer is delivered through \a preeditRectangleReceived. If the
+     * application does not answer within a short deadline, the last known
+     * value is delivered instead. The default implementation answers
+     * immediately with the result of \a preeditRectangle.
+     */
+    virtual void requestPreeditRectangle();
+
+    /*!
+     * \brief Requests the selected text without blocking.
+     *
+     * The answer is delivered through \a selectionReceived. If the
+     * application does not answer within a short deadline, the last known
+     * value is delivered instead. The default implementation answers
+     * immediately with the result of \a selection.
+     */
+    virtual void requestSelection();
+
+public Q_SLOTS:
+    /*!
+     * \brief Lets the application handle a hardware key event itself
+     *
+     * Call this from MAbstractInputMethod::processKeyEvent for key events the
+     * input method does not handle. The application then delivers its original
+     * event instead of one sent back with \a sendKeyEvent. The default
+     * implementation calls \a sendKeyEvent.
+     * \param keyEvent The event as passed to MAbstractInputMethod::processKeyEvent
+     */
+    virtual void passThroughKeyEvent(const QKeyEvent &keyEvent);
+
+    /*!
+     * \brief Sets which redirected hardware key events the input method handles
+     *
+     * Key events not matching \a filter are passed through to the application
+     * by the server and MAbstractInputMethod::processKeyEvent is not called for
+     * them. A filter without rules, the default, matches every key event.
+     * The default implementation does nothing.
+     * \param filter Rules for the key events to handle
+     */
+    virtual void setKeyFilter(const MImKeyFilter &filter);
+
+public:
+    /*!
+     * \brief Returns the state of the focused editor in one snapshot
+     *
+     * Fetching the snapshot once per update replaces the separate calls for
+     * each property. A snapshot with the same generation as an earlier one
+     * has the same contents. The default implementation assembles the
+     * snapshot from the other getters on every call and increases the
+     * generation when they returned something else than the last time.
+     */
+    virtual MImEditorStateSnapshot editorState();
+
 private:
     Q_DISABLE_COPY(MAbstractInputMethodHost)
     Q_DECLARE_PRIVATE(MAbstractInputMethodHost)
@@ -0,0 +1,149 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2026 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+
+#include <maliit/plugins/editorstatesnapshot.h>
+
+#include "mimeditorstate.h"
+
+class MImEditorStateSnapshotPrivate
+    : public QSharedData
+{
+public:
+    MImEditorStateSnapshotPrivate(const MImEditorState &newState, quint64 newGeneration);
+
+    const MImEditorState state;
+    const quint64 generation;
+};
+
+MImEditorStateSnapshotPrivate::MImEditorStateSnapshotPrivate(const MImEditorState &newState,
+                                                             quint64 newGeneration)
+    : state(newState)
+    , generation(newGeneration)
+{}
+
+MImEditorStateSnapshot::MImEditorStateSnapshot()
+    : d(new MImEditorStateSnapshotPrivate(MImEditorState(), 0))
+{}
+
+MImEditorStateSnapshot::MImEditorStateSnapshot(const QVariantMap &state, quint64 generation)
+    : d(new MImEditorStateSnapshotPrivate(MImEditorState(state), generation))
+{}
+
+MImEditorStateSnapshot::MImEditorStateSnapshot(const MImEditorState &state, quint64 generation)
+    : d(new MImEditorStateSnapshotPrivate(state, generation))
+{}
+
+MImEditorStateSnapshot::MImEditorStateSnapshot(const MImEditorStateSnapshot &other)
+    : d(other.d)
+{}
+
+MImEditorStateSnapshot::~MImEditorStateSnapshot()
+{}
+
+MImEditorStateSnapshot &MImEditorStateSnapshot::operator=(const MImEditorStateSnapshot &other)
+{
+    d = other.d;
+    return *this;
+}
+
+quint64 MImEditorStateSnapshot::generation() const
+{
+    return d->generation;
+}
+
+bool MImEditorStateSnapshot::contains(MImUpdateEvent::PropertyId property) const
+{
+    return d->state.contains(static_cast<MImEditorState::Field>(property));
+}
+
+bool MImEditorStateSnapshot::focusState() const
+{
+    return d->state.focusState();
+}
+
+int MImEditorStateSnapshot::contentType() const
+{
+    return d->state.contentType();
+}
+
+bool MImEditorStateSnapshot::correctionEnabled() const
+{
+    return d->state.correctionEnabled();
+}
+
+bool MImEditorStateSnapshot::predictionEnabled() const
+{
+    return d->state.predictionEnabled();
+}
+
+bool MImEditorStateSnapshot::autoCapitalizationEnabled() const
+{
+    return d->state.autoCapitalizationEnabled();
+}
+
+QString MImEditorStateSnapshot::surroundingText() const
+{
+    return d->state.surroundingText();
+}
+
+int MImEditorStateSnapshot::cursorPosition() const
+{
+    return d->state.cursorPosition();
+}
+
+int MImEditorStateSnapshot::anchorPosition() const
+{
+    return d->state.anchorPosition();
+}
+
+bool MImEditorStateSnapshot::hasSelection() const
+{
+    return d->state.hasSelection();
+}
+
+int MImEditorStateSnapshot::inputMethodMode() const
+{
+    return d->state.inputMethodMode();
+}
+
+QRect MImEditorStateSnapshot::cursorRectangle() const
+{
+    return d->state.cursorRectangle();
+}
+
+bool MImEditorStateSnapshot::hiddenText() const
+{
+    return d->state.hiddenText();
+}
+
+int MImEditorStateSnapshot::preeditClickPos() const
+{
+    return d->state.preeditClickPos();
+}
+
+Qt::InputMethodHints MImEditorStateSnapshot::inputMethodHints() const
+{
+    return static_cast<Qt::InputMethodHints>(d->state.inputMethodHints());
+}
+
+QVariant MImEditorStateSnapshot::value(const QString &key) const
+{
+    return d->state.value(key);
+}
+
+QVariantMap MImEditorStateSnapshot::toMap() const
+{
+    return d->state.toMap();
+}
@@ -0,0 +1,93 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2026 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+
+#ifndef MIMEDITORSTATESNAPSHOT_H
+#define MIMEDITORSTATESNAPSHOT_H
+
+#include <maliit/plugins/updateevent.h>
+
+#include <QRect>
+#include <QSharedDataPointer>
+#include <QString>
+#include <QVariant>
+
+class MImEditorState;
+class MImEditorStateSnapshotPrivate;
+
+/*! \ingroup pluginapi
+ * \brief Immutable snapshot of the focused editor's state.
+ *
+ * Returned by MAbstractInputMethodHost::editorState(). Copies share one
+ * instance of the data, so it is cheap to keep a snapshot around and to pass
+ * it by value. The surrounding text is shared with the framework and not
+ * copied.
+ *
+ * Every change of the editor state, including text committed by the input
+ * method itself, gives a new generation. An input method can compare
+ * \a generation with the one of the snapshot it last looked at to skip an
+ * update when nothing changed.
+ *
+ * Properties the application did not send read as false, 0 or empty, use
+ * \a contains to tell them apart.
+ */
+class MImEditorStateSnapshot
+{
+public:
+    //! Empty snapshot of generation 0
+    MImEditorStateSnapshot();
+
+    //! Snapshot of widget state \a state, as sent by the application
+    MImEditorStateSnapshot(const QVariantMap &state, quint64 generation);
+
+    MImEditorStateSnapshot(const MImEditorStateSnapshot &other);
+    ~MImEditorStateSnapshot();
+    MImEditorStateSnapshot &operator=(const MImEditorStateSnapshot &other);
+
+    //! Increases with every change of the editor state
+    quint64 generation() const;
+
+    //! Returns true if the application sent \a property
+    bool contains(MImUpdateEvent::PropertyId property) const;
+
+    bool focusState() const;
+    int contentType() const;
+    bool correctionEnabled() const;
+    bool predictionEnabled() const;
+    bool autoCapitalizationEnabled() const;
+    QString surroundingText() const;
+    int cursorPosition() const;
+    int anchorPosition() const;
+    bool hasSelection() const;
+    int inputMethodMode() const;
+    QRect cursorRectangle() const;
+    bool hiddenText() const;
+    int preeditClickPos() const;
+    Qt::InputMethodHints inputMethodHints() const;
+
+    //! Returns the property \a key, invalid QVariant if not present
+    QVariant value(const QString &key) const;
+
+    //! Returns the whole state as a widget state map
+    QVariantMap toMap() const;
+
+private:
+    MImEditorStateSnapshot(const MImEditorState &state, quint64 generation);
+
+    QSharedDataPointer<MImEditorStateSnapshotPrivate> d;
+
+    friend class MInputMethodHost;
+};
+
+#endif // MIMEDITORSTATESNAPSHOT_H
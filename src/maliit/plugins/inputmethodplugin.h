@@ -34,6 +34,11 @@ namespace Plugins {
  * functions and instantiate the input method implementation in the
  * createInputMethod() method. Make sure your plugin links against the m im
  * framework library as well.
+ *
+ * The server loads plugin libraries in parallel on worker threads, so
+ * static initializers of the plugin library must not depend on the GUI
+ * thread. The plugin object itself and its input methods are created on
+ * the GUI thread.
  */
 class InputMethodPlugin
 {
@@ -45,6 +50,12 @@ public:
     /*! \brief Creates and returns the MAbstractInputMethod object for
      * this plugin. This function will be only called once and the allocated
      * resources will be owned by the input method server.
+     *
+     * When the server runs with lazy loading enabled and the plugin metadata
+     * contains a manifest (name, supportedStates, subViews), this function is
+     * only called when the plugin is activated for the first time. Plugins
+     * declaring "unloadable" in the manifest must allow it to be called again
+     * after the server deleted an idle input method.
      */
     virtual MAbstractInputMethod *createInputMethod(MAbstractInputMethodHost *host) = 0;
 
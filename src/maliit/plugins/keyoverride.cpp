@@ -19,7 +19,9 @@
 
 MKeyOverridePrivate::MKeyOverridePrivate()
     : highlighted(false),
-      enabled(true)
+      enabled(true),
+      updating(false),
+      changedAttributes(0)
 {
 }
 
@@ -103,7 +105,7 @@ void MKeyOverride::setLabel(const QString &label)
     if (d->label != label) {
         d->label = label;
         Q_EMIT labelChanged(label);
-        Q_EMIT keyAttributesChanged(keyId(), Label);
+        notifyAttributesChanged(Label);
     }
 }
 
@@ -114,7 +116,7 @@ void MKeyOverride::setIcon(const QString &icon)
     if (d->icon != icon) {
         d->icon = icon;
         Q_EMIT iconChanged(icon);
-        Q_EMIT keyAttributesChanged(keyId(), Icon);
+        notifyAttributesChanged(Icon);
     }
 }
 
@@ -125,7 +127,7 @@ void MKeyOverride::setHighlighted(bool highlighted)
     if (d->highlighted != highlighted) {
         d->highlighted = highlighted;
         Q_EMIT highlightedChanged(highlighted);
-        Q_EMIT keyAttributesChanged(keyId(), Highlighted);
+        notifyAttributesChanged(Highlighted);
     }
 }
 
@@ -136,7 +138,39 @@ void MKeyOverride::setEnabled(bool enabled)
     if (d->enabled != enabled) {
         d->enabled = enabled;
         Q_EMIT enabledChanged(enabled);
-        Q_EMIT keyAttributesChanged(keyId(), Enabled);
+        notifyAttributesChanged(Enabled);
     }
 }
 
+void MKeyOverride::setAttributes(const QVariantMap &attributes)
+{
+    Q_D(MKeyOverride);
+
+    d->updating = true;
+    d->changedAttributes = 0;
+
+    for (QVariantMap::const_iterator i = attributes.constBegin(); i != attributes.constEnd(); ++i) {
+        setProperty(i.key().toLatin1().constData(), i.value());
+    }
+
+    d->updating = false;
+
+    const KeyOverrideAttributes changedAttributes(d->changedAttributes);
+    d->changedAttributes = 0;
+
+    if (changedAttributes) {
+        Q_EMIT keyAttributesChanged(keyId(), changedAttributes);
+    }
+}
+
+void MKeyOverride::notifyAttributesChanged(KeyOverrideAttributes changedAttributes)
+{
+    Q_D(MKeyOverride);
+
+    if (d->updating) {
+        d->changedAttributes |= changedAttributes;
+        return;
+    }
+
+    Q_EMIT keyAttributesChanged(keyId(), changedAttributes);
+}
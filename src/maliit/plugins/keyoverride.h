@@ -21,6 +21,7 @@
 #include <QList>
 #include <QString>
 #include <QStringList>
+#include <QVariantMap>
 
 class MKeyOverridePrivate;
 
@@ -83,6 +84,15 @@ public:
     //! Return true if the key is enabled; otherwise return false.
     bool enabled() const;
 
+    /*!
+     * \brief Sets several attributes at once.
+     *
+     * Attribute specific signals are emitted for each changed attribute,
+     * keyAttributesChanged is emitted once afterwards for all of them.
+     * \param attributes Values by property name, e.g. "label" or "enabled"
+     */
+    void setAttributes(const QVariantMap &attributes);
+
 public Q_SLOTS:
     //! Sets text for the key
     void setLabel(const QString &label);
@@ -142,6 +152,8 @@ Q_SIGNALS:
     void enabledChanged(bool enabled);
 
 private:
+    void notifyAttributesChanged(KeyOverrideAttributes changedAttributes);
+
     Q_DECLARE_PRIVATE(MKeyOverride)
 
     MKeyOverridePrivate *const d_ptr;
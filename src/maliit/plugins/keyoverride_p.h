@@ -34,6 +34,11 @@ public:
     QString icon;
     bool highlighted;
     bool enabled;
+
+    //! Whether setAttributes is collecting changes
+    bool updating;
+    //! Attributes changed since setAttributes started, MKeyOverride::KeyOverrideAttributes
+    int changedAttributes;
 };
 
 #endif
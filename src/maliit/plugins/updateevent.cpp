@@ -18,9 +18,37 @@
 #include <maliit/namespace.h>
 #include <maliit/namespaceinternal.h>
 
+#include <QHash>
+#include <QVector>
+
+namespace {
+    const int PropertyCount = Maliit::Internal::widgetStateKeyCount;
+
+    Q_STATIC_ASSERT(MImUpdateEvent::ToolbarProperty == 1 << (PropertyCount - 1));
+
+    //! Attribute names created once and shared by all events
+    struct PropertyTable
+    {
+        PropertyTable()
+        {
+            keys.reserve(PropertyCount);
+            for (int i = 0; i < PropertyCount; ++i) {
+                keys.append(QString::fromLatin1(Maliit::Internal::widgetStateKeys[i]));
+                properties.insert(keys.last(), static_cast<MImUpdateEvent::PropertyId>(1 << i));
+            }
+        }
+
+        QVector<QString> keys;
+        QHash<QString, MImUpdateEvent::PropertyId> properties;
+    };
+
+    Q_GLOBAL_STATIC(PropertyTable, propertyTable)
+}
+
 MImUpdateEventPrivate::MImUpdateEventPrivate()
     : update()
-    , changedProperties()
+    , changedProperties(MImUpdateEvent::NoProperty)
+    , changedExtensions()
     , lastHints(Qt::ImhNone)
 {}
 
@@ -28,10 +56,69 @@ MImUpdateEventPrivate::MImUpdateEventPrivate(const QMap<QString, QVariant> &newU
                                              const QStringList &newChangedProperties,
                                              const Qt::InputMethodHints &newLastHints)
     : update(newUpdate)
+    , changedProperties(MImUpdateEvent::NoProperty)
+    , changedExtensions()
+    , lastHints(newLastHints)
+{
+    Q_FOREACH (const QString &key, newChangedProperties) {
+        const MImUpdateEvent::PropertyId property = propertyId(key);
+        if (property != MImUpdateEvent::NoProperty) {
+            changedProperties |= property;
+        } else {
+            changedExtensions.append(key);
+        }
+    }
+}
+
+MImUpdateEventPrivate::MImUpdateEventPrivate(const QMap<QString, QVariant> &newUpdate,
+                                             MImUpdateEvent::Properties newChangedProperties,
+                                             const QStringList &newChangedExtensions,
+                                             const Qt::InputMethodHints &newLastHints)
+    : update(newUpdate)
     , changedProperties(newChangedProperties)
+    , changedExtensions(newChangedExtensions)
     , lastHints(newLastHints)
 {}
 
+MImUpdateEvent::PropertyId MImUpdateEventPrivate::propertyId(const QString &key)
+{
+    return propertyTable()->properties.value(key, MImUpdateEvent::NoProperty);
+}
+
+QString MImUpdateEventPrivate::propertyKey(MImUpdateEvent::PropertyId property)
+{
+    for (int i = 0; i < PropertyCount; ++i) {
+        if (property == 1 << i) {
+            return propertyTable()->keys.at(i);
+        }
+    }
+
+    return QString();
+}
+
+bool MImUpdateEventPrivate::isChanged(const QString &key) const
+{
+    const MImUpdateEvent::PropertyId property = propertyId(key);
+    if (property != MImUpdateEvent::NoProperty) {
+        return changedProperties & property;
+    }
+
+    return changedExtensions.contains(key);
+}
+
+QStringList MImUpdateEventPrivate::changedKeys() const
+{
+    QStringList keys;
+
+    for (int i = 0; i < PropertyCount; ++i) {
+        if (changedProperties & (1 << i)) {
+            keys.append(propertyTable()->keys.at(i));
+        }
+    }
+
+    return keys + changedExtensions;
+}
+
 bool MImUpdateEventPrivate::isFlagSet(Qt::InputMethodHint hint,
                                       bool *changed) const
 {
@@ -55,7 +142,7 @@ QVariant MImUpdateEventPrivate::extractProperty(const QString &key,
                                                 bool *changed) const
 {
     if (changed) {
-        *changed = changedProperties.contains(key);
+        *changed = isChanged(key);
     }
 
     return update.value(key);
@@ -74,6 +161,14 @@ MImUpdateEvent::MImUpdateEvent(const QMap<QString, QVariant> &update,
                         MImExtensionEvent::Update)
 {}
 
+MImUpdateEvent::MImUpdateEvent(const QMap<QString, QVariant> &update,
+                               Properties changedProperties,
+                               const QStringList &changedExtensions,
+                               const Qt::InputMethodHints &lastHints)
+    : MImExtensionEvent(new MImUpdateEventPrivate(update, changedProperties, changedExtensions, lastHints),
+                        MImExtensionEvent::Update)
+{}
+
 QVariant MImUpdateEvent::value(const QString &key) const
 {
     Q_D(const MImUpdateEvent);
@@ -81,6 +176,24 @@ QVariant MImUpdateEvent::value(const QString &key) const
 }
 
 QStringList MImUpdateEvent::propertiesChanged() const
+{
+    Q_D(const MImUpdateEvent);
+    return d->changedKeys();
+}
+
+bool MImUpdateEvent::changed(PropertyId property) const
+{
+    Q_D(const MImUpdateEvent);
+    return d->changedProperties & property;
+}
+
+bool MImUpdateEvent::changed(const QString &key) const
+{
+    Q_D(const MImUpdateEvent);
+    return d->isChanged(key);
+}
+
+MImUpdateEvent::Properties MImUpdateEvent::changedProperties() const
 {
     Q_D(const MImUpdateEvent);
     return d->changedProperties;
@@ -89,8 +202,12 @@ QStringList MImUpdateEvent::propertiesChanged() const
 Qt::InputMethodHints MImUpdateEvent::hints(bool *changed) const
 {
     Q_D(const MImUpdateEvent);
+    if (changed) {
+        *changed = d->changedProperties & InputMethodHintsProperty;
+    }
+
     return static_cast<Qt::InputMethodHints>(
-        d->extractProperty(Maliit::Internal::inputMethodHints, changed).toLongLong());
+        d->update.value(Maliit::Internal::inputMethodHints).toLongLong());
 }
 
 bool MImUpdateEvent::westernNumericInputEnforced(bool *changed) const
@@ -29,6 +29,31 @@ class MImUpdateEvent
     : public MImExtensionEvent
 {
 public:
+    //! Properties of the widget state known to the framework. Changes of
+    //! these are tracked as bits, see changed().
+    enum PropertyId {
+        NoProperty = 0,
+        FocusStateProperty = 0x1,
+        ContentTypeProperty = 0x2,
+        CorrectionProperty = 0x4,
+        PredictionProperty = 0x8,
+        AutoCapitalizationProperty = 0x10,
+        SurroundingTextProperty = 0x20,
+        AnchorPositionProperty = 0x40,
+        CursorPositionProperty = 0x80,
+        HasSelectionProperty = 0x100,
+        InputMethodModeProperty = 0x200,
+        WinIdProperty = 0x400,
+        CursorRectangleProperty = 0x800,
+        HiddenTextProperty = 0x1000,
+        PreeditClickPosProperty = 0x2000,
+        InputMethodHintsProperty = 0x4000,
+        VisualizationPriorityProperty = 0x8000,
+        ToolbarIdProperty = 0x10000,
+        ToolbarProperty = 0x20000
+    };
+    Q_DECLARE_FLAGS(Properties, PropertyId)
+
     //! C'tor
     //! \param update the map containing all properties.
     //! \param propertiesChanged a string list of changed properties.
@@ -45,12 +70,34 @@ public:
                             const QStringList &propertiesChanged,
                             const Qt::InputMethodHints &lastHints);
 
+    //! C'tor
+    //! \param update the map containing all properties.
+    //! \param changedProperties the known properties that changed.
+    //! \param changedExtensions the names of changed properties which are
+    //!        not a PropertyId.
+    //! \param lastHints the last input method hints, see above.
+    explicit MImUpdateEvent(const QMap<QString, QVariant> &update,
+                            Properties changedProperties,
+                            const QStringList &changedExtensions,
+                            const Qt::InputMethodHints &lastHints);
+
     //! Returns invalid QVariant if key is invalid.
     QVariant value(const QString &key) const;
 
     //! Returns list of keys that have changed, compared to last update event.
+    //! Prefer changed(), which does not build the list.
     QStringList propertiesChanged() const;
 
+    //! Returns whether \a property changed, compared to last update event.
+    bool changed(PropertyId property) const;
+
+    //! Returns whether the property named \a key changed, compared to last
+    //! update event.
+    bool changed(const QString &key) const;
+
+    //! Returns the known properties that changed, compared to last update event.
+    Properties changedProperties() const;
+
     //! Returns the focus widget's input method hints.
     //! \param changed whether this value changed with this event.
     Qt::InputMethodHints hints(bool *changed = 0) const;
@@ -79,4 +126,6 @@ private:
     friend class MImUpdateReceiver; // Allows receiver to copy PIMPL instance.
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(MImUpdateEvent::Properties)
+
 #endif // MIMUPDATEEVENT_H
@@ -16,6 +16,7 @@
 #define MIMUPDATEEVENT_P_H
 
 #include <maliit/plugins/extensionevent_p.h>
+#include <maliit/plugins/updateevent.h>
 
 #include <QtCore>
 
@@ -24,7 +25,9 @@ class MImUpdateEventPrivate
 {
 public:
     QMap<QString, QVariant> update;
-    QStringList changedProperties;
+    MImUpdateEvent::Properties changedProperties;
+    //! Changed properties which are not a PropertyId
+    QStringList changedExtensions;
     Qt::InputMethodHints lastHints;
 
     explicit MImUpdateEventPrivate();
@@ -33,6 +36,19 @@ public:
                                    const QStringList &newChangedProperties,
                                    const Qt::InputMethodHints &newLastHints);
 
+    explicit MImUpdateEventPrivate(const QMap<QString, QVariant> &newUpdate,
+                                   MImUpdateEvent::Properties newChangedProperties,
+                                   const QStringList &newChangedExtensions,
+                                   const Qt::InputMethodHints &newLastHints);
+
+    //! Property id of \a key, NoProperty if it is not a known property
+    static MImUpdateEvent::PropertyId propertyId(const QString &key);
+    //! Attribute name of \a property, empty for NoProperty
+    static QString propertyKey(MImUpdateEvent::PropertyId property);
+
+    bool isChanged(const QString &key) const;
+    QStringList changedKeys() const;
+
     bool isFlagSet(Qt::InputMethodHint hint,
                    bool *changed = 0) const;
 
@@ -48,6 +48,7 @@ void MImUpdateReceiver::process(MImUpdateEvent *ev)
     // properties).
     Q_D(MImUpdateReceiver);
     d->changedProperties = ev->d_func()->changedProperties;
+    d->changedExtensions = ev->d_func()->changedExtensions;
     d->update = ev->d_func()->update;
 
     bool changed = false;
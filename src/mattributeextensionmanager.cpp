@@ -16,6 +16,7 @@
 #include "mattributeextensionmanager.h"
 #include <maliit/plugins/keyoverridedata.h>
 #include <maliit/plugins/keyoverride.h>
+#include "mimeditorstate.h"
 
 #include <QVariant>
 #include <QFileInfo>
@@ -30,9 +31,9 @@ namespace {
     const char * const ToolbarExtensionString("/toolbar");
     const char * const GlobalExtensionString("/");
 
-    const char * const ToolbarIdAttribute = "toolbarId";
-    const char * const ToolbarAttribute = "toolbar";
-    const char * const FocusStateAttribute = "focusState";
+    const QString ToolbarIdAttribute = MImEditorState::key(MImEditorState::ToolbarIdField);
+    const QString ToolbarAttribute = MImEditorState::key(MImEditorState::ToolbarField);
+    const QString FocusStateAttribute = MImEditorState::key(MImEditorState::FocusStateField);
 }
 
 MAttributeExtensionManager::MAttributeExtensionManager()
@@ -149,13 +150,42 @@ void MAttributeExtensionManager::setExtendedAttribute(const MAttributeExtensionI
                                                       const QString &targetItem,
                                                       const QString &attribute,
                                                       const QVariant &value)
+{
+    QVariantMap attributes;
+    attributes.insert(attribute, value);
+
+    setExtendedAttributes(id, target, targetItem, attributes);
+}
+
+void MAttributeExtensionManager::setExtendedAttributes(const MAttributeExtensionId &id,
+                                                       const QString &target,
+                                                       const QString &targetItem,
+                                                       const QVariantMap &attributes)
 {
     if (target == GlobalExtensionString) {
-        Q_EMIT globalAttributeChanged(id, targetItem, attribute, value);
+        for (QVariantMap::const_iterator i = attributes.constBegin(); i != attributes.constEnd(); ++i) {
+            Q_EMIT globalAttributeChanged(id, targetItem, i.key(), i.value());
+        }
         return;
     }
 
-    if (!id.isValid() || attribute.isEmpty() || targetItem.isEmpty() || !value.isValid())
+    if (!id.isValid() || targetItem.isEmpty())
+        return;
+
+    QVariantMap validAttributes;
+    for (QVariantMap::const_iterator i = attributes.constBegin(); i != attributes.constEnd(); ++i) {
+        if (i.key().isEmpty() || !i.value().isValid())
+            continue;
+
+        // Ignore l10n lengthvariants in QStrings for labels, always pick longest variant (first)
+        if (i.key() == "label") {
+            validAttributes.insert(i.key(), i.value().toString().split(QChar(0x9c)).first());
+        } else {
+            validAttributes.insert(i.key(), i.value());
+        }
+    }
+
+    if (validAttributes.isEmpty())
         return;
 
     QSharedPointer<MAttributeExtension> extension = attributeExtension(id);
@@ -171,18 +201,7 @@ void MAttributeExtensionManager::setExtendedAttribute(const MAttributeExtensionI
         QSharedPointer<MKeyOverride> keyOverride = extension->keyOverrideData()->keyOverride(targetItem);
 
         Q_ASSERT(keyOverride);
-        const QByteArray byteArray = attribute.toLatin1();
-        const char * const c_str = byteArray.data();
-
-        // Ignore l10n lengthvariants in QStrings for labels, always pick longest variant (first)
-        if (attribute == "label") {
-            QString label = value.toString();
-            label = label.split(QChar(0x9c)).first();
-            const QVariant newValue(label);
-            keyOverride->setProperty(c_str, newValue);
-        } else {
-            keyOverride->setProperty(c_str, value);
-        }
+        keyOverride->setAttributes(validAttributes);
 
         // Q_EMIT signal to notify the new key override is created.
         if (newKeyOverrideCreated) {
@@ -219,6 +238,16 @@ void MAttributeExtensionManager::handleExtendedAttributeUpdate(unsigned int clie
     }
 }
 
+void MAttributeExtensionManager::handleExtendedAttributesUpdate(unsigned int clientId, int id,
+                                                                const QString &target, const QString &targetName,
+                                                                const QVariantMap &attributes)
+{
+    MAttributeExtensionId globalId(id, QString::number(clientId));
+    if (globalId.isValid() && attributeExtensionIds.contains(globalId)) {
+        setExtendedAttributes(globalId, target, targetName, attributes);
+    }
+}
+
 void MAttributeExtensionManager::handleAttributeExtensionRegistered(unsigned int clientId,
                                                                   int id, const QString &attributeExtension)
 {
@@ -94,6 +94,17 @@ public:
                               const QString &targetItem,
                               const QString &attribute,
                               const QVariant &value);
+
+    /*!
+     *\brief Sets several \a attributes of the \a targetItem in the attribute extension \a target at once.
+     *
+     * A key override changed this way emits MKeyOverride::keyAttributesChanged once for all
+     * of its changed attributes.
+     */
+    void setExtendedAttributes(const MAttributeExtensionId &id,
+                               const QString &target,
+                               const QString &targetItem,
+                               const QVariantMap &attributes);
 public Q_SLOTS:
     /*!
      * \brief Set copy/paste button state: hide it, show copy or show paste
@@ -108,6 +119,9 @@ public Q_SLOTS:
     void handleExtendedAttributeUpdate(unsigned int clientId, int id,
                                        const QString &target, const QString &targetName,
                                        const QString &attribute, const QVariant &value);
+    void handleExtendedAttributesUpdate(unsigned int clientId, int id,
+                                        const QString &target, const QString &targetName,
+                                        const QVariantMap &attributes);
     void handleWidgetStateChanged(unsigned int clientId, const QMap<QString, QVariant> &newState,
                                   const QMap<QString, QVariant> &oldState, bool focusChanged);
 
@@ -0,0 +1,190 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "mimplugincache.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+namespace
+{
+    const int CacheVersion = 1;
+
+    const char * const VersionKey = "version";
+    const char * const DirectoriesKey = "directories";
+    const char * const PluginsKey = "plugins";
+    const char * const ModifiedKey = "modified";
+    const char * const SizeKey = "size";
+    const char * const EntriesKey = "entries";
+    const char * const ManifestKey = "manifest";
+
+    qint64 modificationTime(const QFileInfo &info)
+    {
+        return info.lastModified().toMSecsSinceEpoch();
+    }
+}
+
+MImPluginCache::MImPluginCache(const QString &fileName)
+    : mFileName(fileName),
+      mDirty(false)
+{}
+
+bool MImPluginCache::load()
+{
+    mDirectories.clear();
+    mPlugins.clear();
+    mUsedDirectories.clear();
+    mUsedPlugins.clear();
+    mDirty = false;
+
+    QFile file(mFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject &root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(VersionKey).toInt() != CacheVersion) {
+        qWarning() << __PRETTY_FUNCTION__ << "Ignoring outdated or corrupt plugin cache" << mFileName;
+        return false;
+    }
+
+    const QJsonObject &directories = root.value(DirectoriesKey).toObject();
+    for (QJsonObject::const_iterator i = directories.constBegin(); i != directories.constEnd(); ++i) {
+        const QJsonObject &object = i.value().toObject();
+        DirectoryRecord record;
+        record.modified = static_cast<qint64>(object.value(ModifiedKey).toDouble());
+        Q_FOREACH (const QJsonValue &entry, object.value(EntriesKey).toArray()) {
+            record.entries.append(entry.toString());
+        }
+        mDirectories.insert(i.key(), record);
+    }
+
+    const QJsonObject &plugins = root.value(PluginsKey).toObject();
+    for (QJsonObject::const_iterator i = plugins.constBegin(); i != plugins.constEnd(); ++i) {
+        const QJsonObject &object = i.value().toObject();
+        PluginRecord record;
+        record.modified = static_cast<qint64>(object.value(ModifiedKey).toDouble());
+        record.size = static_cast<qint64>(object.value(SizeKey).toDouble());
+        record.manifest = MImPluginManifest::fromJson(object.value(ManifestKey).toObject());
+        if (record.manifest.isValid()) {
+            mPlugins.insert(i.key(), record);
+        }
+    }
+
+    return true;
+}
+
+bool MImPluginCache::save()
+{
+    // drop records of plugins and directories which are gone
+    if (mUsedDirectories.size() != mDirectories.size()
+        || mUsedPlugins.size() != mPlugins.size()) {
+        mDirty = true;
+    }
+
+    if (!mDirty) {
+        return true;
+    }
+
+    QJsonObject directories;
+    Q_FOREACH (const QString &path, mUsedDirectories) {
+        const DirectoryRecord &record = mDirectories.value(path);
+        QJsonObject object;
+        object.insert(ModifiedKey, static_cast<double>(record.modified));
+        object.insert(EntriesKey, QJsonArray::fromStringList(record.entries));
+        directories.insert(path, object);
+    }
+
+    QJsonObject plugins;
+    Q_FOREACH (const QString &path, mUsedPlugins) {
+        const PluginRecord &record = mPlugins.value(path);
+        QJsonObject object;
+        object.insert(ModifiedKey, static_cast<double>(record.modified));
+        object.insert(SizeKey, static_cast<double>(record.size));
+        object.insert(ManifestKey, record.manifest.toJson());
+        plugins.insert(path, object);
+    }
+
+    QJsonObject root;
+    root.insert(VersionKey, CacheVersion);
+    root.insert(DirectoriesKey, directories);
+    root.insert(PluginsKey, plugins);
+
+    QDir().mkpath(QFileInfo(mFileName).absolutePath());
+
+    QFile file(mFileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not write plugin cache" << mFileName << file.errorString();
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    mDirty = false;
+
+    return true;
+}
+
+QStringList MImPluginCache::entryList(const QDir &dir)
+{
+    const QString path = dir.absolutePath();
+    const QFileInfo info(path);
+    const qint64 modified = modificationTime(info);
+
+    mUsedDirectories.insert(path);
+
+    QHash<QString, DirectoryRecord>::const_iterator cached = mDirectories.constFind(path);
+    if (cached != mDirectories.constEnd() && cached->modified == modified) {
+        return cached->entries;
+    }
+
+    DirectoryRecord record;
+    record.modified = modified;
+    record.entries = dir.entryList(QDir::Files);
+    mDirectories.insert(path, record);
+    mDirty = true;
+
+    return record.entries;
+}
+
+MImPluginManifest MImPluginCache::manifest(const QFileInfo &file)
+{
+    const QString path = file.absoluteFilePath();
+    QHash<QString, PluginRecord>::const_iterator cached = mPlugins.constFind(path);
+
+    if (cached == mPlugins.constEnd()
+        || cached->modified != modificationTime(file)
+        || cached->size != file.size()) {
+        return MImPluginManifest();
+    }
+
+    mUsedPlugins.insert(path);
+    return cached->manifest;
+}
+
+void MImPluginCache::insert(const QFileInfo &file, const MImPluginManifest &manifest)
+{
+    const QString path = file.absoluteFilePath();
+    PluginRecord record;
+    record.modified = modificationTime(file);
+    record.size = file.size();
+    record.manifest = manifest;
+
+    mPlugins.insert(path, record);
+    mUsedPlugins.insert(path);
+    mDirty = true;
+}
@@ -0,0 +1,78 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MIMPLUGINCACHE_H
+#define MIMPLUGINCACHE_H
+
+#include "mimpluginmanifest.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/*! \internal
+ * \brief Remembers plugin directory contents and plugin manifests between server starts.
+ *
+ * Plugin files are identified by their absolute path, modification time and
+ * size; a record is ignored as soon as one of them differs. Directory
+ * listings are reused while the modification time of the directory is
+ * unchanged, which covers adding, removing and renaming plugin files.
+ * Records not looked up since \a load are dropped by \a save.
+ */
+class MImPluginCache
+{
+public:
+    explicit MImPluginCache(const QString &fileName);
+
+    //! Reads the cache file, returns false if it is missing or unusable
+    bool load();
+
+    //! Writes the cache file if anything changed since \a load
+    bool save();
+
+    //! Returns the file names in \a dir, from the cache if the directory did not change
+    QStringList entryList(const QDir &dir);
+
+    //! Returns the cached manifest for \a file, or an invalid one if there is no up to date record
+    MImPluginManifest manifest(const QFileInfo &file);
+
+    //! Records \a manifest for the current version of \a file
+    void insert(const QFileInfo &file, const MImPluginManifest &manifest);
+
+private:
+    Q_DISABLE_COPY(MImPluginCache)
+
+    struct DirectoryRecord {
+        qint64 modified;
+        QStringList entries;
+    };
+
+    struct PluginRecord {
+        qint64 modified;
+        qint64 size;
+        MImPluginManifest manifest;
+    };
+
+    const QString mFileName;
+    QHash<QString, DirectoryRecord> mDirectories;
+    QHash<QString, PluginRecord> mPlugins;
+    QSet<QString> mUsedDirectories;
+    QSet<QString> mUsedPlugins;
+    bool mDirty;
+};
+
+#endif // MIMPLUGINCACHE_H
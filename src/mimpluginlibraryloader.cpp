@@ -0,0 +1,48 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "mimpluginlibraryloader.h"
+
+MImPluginLibraryLoader::MImPluginLibraryLoader(const QString &filePath)
+    : mLoader(filePath)
+    , mFinished()
+    , mWaited(false)
+{
+    // Owned by whoever waits for the result
+    setAutoDelete(false);
+}
+
+void MImPluginLibraryLoader::run()
+{
+    // Only the library is loaded here, plugin constructors run on the thread
+    // calling instance()
+    mLoader.load();
+
+    mFinished.release();
+}
+
+QObject *MImPluginLibraryLoader::instance()
+{
+    if (not mWaited) {
+        mFinished.acquire();
+        mWaited = true;
+    }
+
+    return mLoader.instance();
+}
+
+QString MImPluginLibraryLoader::errorString() const
+{
+    return mLoader.errorString();
+}
@@ -0,0 +1,56 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MIMPLUGINLIBRARYLOADER_H
+#define MIMPLUGINLIBRARYLOADER_H
+
+#include <QPluginLoader>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QString>
+
+class QObject;
+
+/*! \internal
+ * \brief Loads a plugin library on a thread pool thread.
+ *
+ * Loading the library and resolving its symbols do not need the GUI
+ * thread, so the server starts one loader per plugin library and only
+ * waits for them once it registers the plugins. The plugin object is
+ * created by \a instance on the thread calling it, usually the GUI thread.
+ */
+class MImPluginLibraryLoader : public QRunnable
+{
+public:
+    explicit MImPluginLibraryLoader(const QString &filePath);
+
+    //! \reimp
+    virtual void run();
+    //! \reimp_end
+
+    //! Waits for \a run to finish, then creates the plugin object; 0 if loading failed
+    QObject *instance();
+
+    //! Reason loading failed, valid after \a instance returned 0
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(MImPluginLibraryLoader)
+
+    QPluginLoader mLoader;
+    QSemaphore mFinished;
+    bool mWaited;
+};
+
+#endif // MIMPLUGINLIBRARYLOADER_H
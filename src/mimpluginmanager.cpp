@@ -26,12 +26,17 @@
 #include "mimsubviewoverride.h"
 #include "maliit/namespaceinternal.h"
 #include <maliit/settingdata.h>
+#include <maliit/keyfilter.h>
+#include <maliit/tracing.h>
 #include "windowgroup.h"
+#include "mimeditorstate.h"
 
 #include <quick/inputmethodquickplugin.h>
+#include <quick/inputmethodquick.h>
 
 #include <QDir>
 #include <QPluginLoader>
+#include <QStandardPaths>
 #include <QSignalMapper>
 #include <QWeakPointer>
 
@@ -42,12 +47,16 @@ namespace
 {
     const QString DefaultPluginLocation(MALIIT_PLUGINS_DIR);
 
-    const char * const VisualizationAttribute = "visualizationPriority";
-    const char * const FocusStateAttribute = "focusState";
+    const QString VisualizationAttribute = MImEditorState::key(MImEditorState::VisualizationPriorityField);
+    const QString FocusStateAttribute = MImEditorState::key(MImEditorState::FocusStateField);
 
     const QString ConfigRoot           = MALIIT_CONFIG_ROOT;
     const QString MImPluginPaths       = ConfigRoot + "paths";
     const QString MImPluginDisabled    = ConfigRoot + "disabledpluginfiles";
+    const QString MImPluginLazyLoading = ConfigRoot + "lazyloading";
+    const QString MImPluginIdleUnloadTimeout = ConfigRoot + "idleunloadtimeout";
+    const QString MImPluginStandbyCount = ConfigRoot + "standbyplugins";
+    const QString MImPluginCacheFile   = ConfigRoot + "plugincache";
 
     const QString PluginRoot           = MALIIT_CONFIG_ROOT"plugins";
     const QString PluginSettings       = MALIIT_CONFIG_ROOT"pluginsettings";
@@ -55,7 +64,56 @@ namespace
 
     const char * const InputMethodItem = "inputMethod";
     const char * const LoadAll = "loadAll";
-}
+
+    // Inactive plugins kept instantiated next to the active one by default
+    const int DefaultStandbyCount = 0;
+
+    // QThreadPool priorities of plugin library loaders
+    const int ActivePluginLoadPriority = 1;
+    const int PluginLoadPriority = 0;
+
+    bool equalSubViews(const QList<MAbstractInputMethod::MInputMethodSubView> &a,
+                       const QList<MAbstractInputMethod::MInputMethodSubView> &b)
+    {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (int i = 0; i < a.size(); ++i) {
+            if (a.at(i).subViewId != b.at(i).subViewId
+                || a.at(i).subViewTitle != b.at(i).subViewTitle) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    QString DefaultPluginCacheFile()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+               + "/maliit-server/plugins.json";
+    }
+}
+
+// Property ids are the editor state field bits, so that the change bits of
+// the editor state are passed on to update events without converting them.
+Q_STATIC_ASSERT(int(MImUpdateEvent::FocusStateProperty) == int(MImEditorState::FocusStateField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::ContentTypeProperty) == int(MImEditorState::ContentTypeField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::CorrectionProperty) == int(MImEditorState::CorrectionField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::PredictionProperty) == int(MImEditorState::PredictionField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::AutoCapitalizationProperty) == int(MImEditorState::AutoCapitalizationField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::SurroundingTextProperty) == int(MImEditorState::SurroundingTextField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::AnchorPositionProperty) == int(MImEditorState::AnchorPositionField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::CursorPositionProperty) == int(MImEditorState::CursorPositionField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::HasSelectionProperty) == int(MImEditorState::HasSelectionField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::InputMethodModeProperty) == int(MImEditorState::InputMethodModeField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::WinIdProperty) == int(MImEditorState::WinIdField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::CursorRectangleProperty) == int(MImEditorState::CursorRectangleField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::HiddenTextProperty) == int(MImEditorState::HiddenTextField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::PreeditClickPosProperty) == int(MImEditorState::PreeditClickPosField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::InputMethodHintsProperty) == int(MImEditorState::InputMethodHintsField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::VisualizationPriorityProperty) == int(MImEditorState::VisualizationPriorityField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::ToolbarIdProperty) == int(MImEditorState::ToolbarIdField));
+Q_STATIC_ASSERT(int(MImUpdateEvent::ToolbarProperty) == int(MImEditorState::ToolbarField));
 
 MIMPluginManagerPrivate::MIMPluginManagerPrivate(const QSharedPointer<MInputContextConnection> &connection,
                                                  const QSharedPointer<Maliit::AbstractPlatform> &platform,
@@ -69,8 +127,22 @@ MIMPluginManagerPrivate::MIMPluginManagerPrivate(const QSharedPointer<MInputCont
       lastOrientation(0),
       attributeExtensionManager(new MAttributeExtensionManager),
       sharedAttributeExtensionManager(new MSharedAttributeExtensionManager),
-      m_platform(platform)
-{
+      m_platform(platform),
+      lazyLoading(false),
+      stagedLoading(false),
+      widgetStatePending(false),
+      pendingChangedFields(MImEditorState::NoField),
+      pendingFocusChanged(false),
+      pendingFocusLost(false),
+      standbyCount(0),
+      standbyDirection(Maliit::SwitchForward)
+{
+    idleUnloadTimer.setSingleShot(true);
+    widgetStateTimer.setSingleShot(true);
+    widgetStateTimer.setInterval(0);
+    standbyTimer.setSingleShot(true);
+    standbyTimer.setInterval(0);
+
     inputSourceToNameMap[Maliit::Hardware] = "hardware";
     inputSourceToNameMap[Maliit::Accessory] = "accessory";
 }
@@ -79,6 +151,10 @@ MIMPluginManagerPrivate::MIMPluginManagerPrivate(const QSharedPointer<MInputCont
 MIMPluginManagerPrivate::~MIMPluginManagerPrivate()
 {
     qDeleteAll(handlerToPluginConfs);
+
+    Q_FOREACH (const PendingPlugin &pending, pendingPlugins) {
+        delete pending.plugin;
+    }
 }
 
 void MIMPluginManagerPrivate::loadPlugins()
@@ -87,63 +163,164 @@ void MIMPluginManagerPrivate::loadPlugins()
 
     MImOnScreenPlugins::SubView activeSubView = onScreenPlugins.activeSubView();
 
-    // Load active plugin first
-    Q_FOREACH (QString path, paths) {
-        const QDir &dir(path);
+    // Plugin libraries are loaded on a thread pool, registering the plugins
+    // waits for them in the order they were requested, the active plugin
+    // first.
+    PendingPlugin active;
 
-        if (loadPlugin(dir, activeSubView.plugin))
-            break;
+    QStringList activePaths;
+    if (!activeSubView.plugin.isEmpty()) {
+        Q_FOREACH (QString path, paths) {
+            if (QDir(path).exists(activeSubView.plugin)) {
+                activePaths.append(path);
+            }
+        }
     }
 
-    // Load all other plugins
+    // Request active plugin first
+    const bool activeRequested = !activePaths.isEmpty()
+                                 && requestPlugin(QDir(activePaths.first()), activeSubView.plugin,
+                                                  ActivePluginLoadPriority, &pluginLoaderPool, active);
+
+    // Request all other plugins
     Q_FOREACH (QString path, paths) {
         const QDir &dir(path);
 
-        QStringList pluginFiles = dir.entryList(QDir::Files);
+        QStringList pluginFiles = pluginCache ? pluginCache->entryList(dir)
+                                              : dir.entryList(QDir::Files);
         Q_FOREACH (const QString &fileName, pluginFiles) {
             if  (fileName == activeSubView.plugin)
                 continue;
 
-            loadPlugin(dir, fileName);
+            PendingPlugin plugin;
+            if (requestPlugin(dir, fileName, PluginLoadPriority, &pluginLoaderPool, plugin)) {
+                pendingPlugins.append(plugin);
+            }
         } // end Q_FOREACH file in path
     } // end Q_FOREACH path in paths
 
+    // Register active plugin, falling back to the copies in later paths
+    bool activeRegistered = activeRequested && registerPlugin(active);
+    for (int i = 1; !activeRegistered && i < activePaths.count(); ++i) {
+        PendingPlugin fallback;
+        activeRegistered = requestPlugin(QDir(activePaths.at(i)), activeSubView.plugin,
+                                         ActivePluginLoadPriority, &pluginLoaderPool, fallback)
+                           && registerPlugin(fallback);
+    }
+
+    if (stagedLoading && activeRegistered) {
+        Maliit::Tracing::event("MIMPluginManager active plugin registered");
+        // The rest of finishLoadingPlugins() waits for the other plugins
+        onScreenPlugins.updateAvailableSubViews(availablePluginsAndSubViews());
+
+        // Clients are served by the active plugin until the event loop
+        // gets to the other plugins
+        QTimer::singleShot(0, q, SLOT(_q_registerPendingPlugins()));
+        return;
+    }
+
+    registerPendingPlugins();
+    finishLoadingPlugins();
+}
+
+void MIMPluginManagerPrivate::registerPendingPlugins()
+{
+    for (int i = 0; i < pendingPlugins.count(); ++i) {
+        registerPlugin(pendingPlugins[i]);
+    }
+    pendingPlugins.clear();
+}
+
+void MIMPluginManagerPrivate::finishLoadingPlugins()
+{
+    Q_Q(MIMPluginManager);
+
     if (plugins.empty()) {
         qWarning("No plugins were found. Stopping.");
         std::exit(0);
     }
 
+    if (pluginCache) {
+        pluginCache->save();
+    }
+
     const QList<MImOnScreenPlugins::SubView> &availableSubViews = availablePluginsAndSubViews();
     onScreenPlugins.updateAvailableSubViews(availableSubViews);
 
     Q_EMIT q->pluginsChanged();
 }
 
-bool MIMPluginManagerPrivate::loadPlugin(const QDir &dir, const QString &fileName)
+bool MIMPluginManagerPrivate::requestPlugin(const QDir &dir, const QString &fileName, int priority,
+                                            QThreadPool *pool, PendingPlugin &pending)
 {
-    Q_Q(MIMPluginManager);
-
     if (blacklist.contains(fileName)) {
         qWarning() << __PRETTY_FUNCTION__ << fileName << "is on the blacklist, skipped.";
         return false;
     }
 
-    Maliit::Plugins::InputMethodPlugin *plugin = 0;
+    pending.dir = dir;
+    pending.fileName = fileName;
+    pending.manifest = MImPluginManifest();
+    pending.plugin = 0;
+    pending.library.clear();
 
     if (QFileInfo(fileName).suffix() == "qml") {
-        plugin = new Maliit::InputMethodQuickPlugin(dir.filePath(fileName), m_platform);
-        if (!plugin) {
+        pending.plugin = new Maliit::InputMethodQuickPlugin(dir.filePath(fileName), m_platform);
+        if (!pending.plugin) {
             qWarning() << __PRETTY_FUNCTION__
                        << "Could not create a plugin for: " << fileName;
+            return false;
+        } else if (lazyLoading) {
+            // InputMethodQuick always has a single anonymous subview
+            pending.manifest.name = pending.plugin->name();
+            pending.manifest.supportedStates = pending.plugin->supportedStates();
+            pending.manifest.subViews.append(MAbstractInputMethod::MInputMethodSubView());
+            pending.manifest.unloadable = true;
+        }
+        return true;
+    }
+
+    // TODO: skip already loaded plugin ids (fileName)
+    const QFileInfo fileInfo(dir.absoluteFilePath(fileName));
+
+    if (pluginCache) {
+        pending.manifest = pluginCache->manifest(fileInfo);
+    }
+
+    if (lazyLoading && !pending.manifest.isValid()) {
+        // metaData() does not load the library
+        pending.manifest = MImPluginManifest::fromMetaData(QPluginLoader(fileInfo.absoluteFilePath()).metaData());
+        if (pluginCache && pending.manifest.isValid()) {
+            pluginCache->insert(fileInfo, pending.manifest);
         }
+    }
+
+    if (pending.manifest.isValid()) {
+        pending.plugin = new MImManifestPlugin(dir.absoluteFilePath(fileName), pending.manifest);
     } else {
-        // TODO: skip already loaded plugin ids (fileName)
-        QPluginLoader load(dir.absoluteFilePath(fileName));
+        pending.library = QSharedPointer<MImPluginLibraryLoader>(
+            new MImPluginLibraryLoader(fileInfo.absoluteFilePath()));
+        pool->start(pending.library.data(), priority);
+    }
+
+    return true;
+}
+
+bool MIMPluginManagerPrivate::registerPlugin(PendingPlugin &pending)
+{
+    Q_Q(MIMPluginManager);
+
+    const QDir &dir(pending.dir);
+    const QString &fileName(pending.fileName);
+    const MImPluginManifest &manifest(pending.manifest);
+    Maliit::Plugins::InputMethodPlugin *plugin = pending.plugin;
 
-        QObject *pluginInstance = load.instance();
+    if (pending.library) {
+        QObject *pluginInstance = pending.library->instance();
         if (!pluginInstance) {
             qWarning() << __PRETTY_FUNCTION__
-                       << "Error loading plugin from" << dir.absoluteFilePath(fileName) << load.errorString();
+                       << "Error loading plugin from" << dir.absoluteFilePath(fileName)
+                       << pending.library->errorString();
             return false;
         }
 
@@ -165,12 +342,13 @@ bool MIMPluginManagerPrivate::loadPlugin(const QDir &dir, const QString &fileNam
     MInputMethodHost *host = new MInputMethodHost(mICConnection, q, windowGroup,
                                                   fileName, plugin->name());
 
-    MAbstractInputMethod *im = plugin->createInputMethod(host);
+    // plugins with a manifest create their input method on first activation
+    MAbstractInputMethod *im = manifest.isValid() ? 0 : plugin->createInputMethod(host);
 
     QObject::connect(q, SIGNAL(pluginsChanged()), host, SIGNAL(pluginsChanged()));
 
     // only add valid plugin descriptions
-    if (!im) {
+    if (!im && !manifest.isValid()) {
         qWarning() << __PRETTY_FUNCTION__
                    << "Creation of InputMethod failed:" << plugin->name() << dir.absoluteFilePath(fileName);
         delete host;
@@ -178,7 +356,7 @@ bool MIMPluginManagerPrivate::loadPlugin(const QDir &dir, const QString &fileNam
     }
 
     PluginDescription desc = { im, host, PluginState(),
-                               Maliit::SwitchUndefined, fileName, windowGroup };
+                               Maliit::SwitchUndefined, fileName, windowGroup, manifest };
 
     // Connect surface group signals
     QObject::connect(windowGroup.data(), SIGNAL(inputMethodAreaChanged(QRegion)),
@@ -192,13 +370,286 @@ bool MIMPluginManagerPrivate::loadPlugin(const QDir &dir, const QString &fileNam
     return true;
 }
 
-void MIMPluginManagerPrivate::activatePlugin(Maliit::Plugins::InputMethodPlugin *plugin)
+bool MIMPluginManagerPrivate::instantiatePlugin(Maliit::Plugins::InputMethodPlugin *plugin)
+{
+    const Plugins::iterator iterator = plugins.find(plugin);
+    if (iterator == plugins.end()) {
+        return false;
+    }
+
+    if (iterator->inputMethod) {
+        return true;
+    }
+
+    MAbstractInputMethod *im = plugin->createInputMethod(iterator->imHost);
+    if (!im) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Creation of InputMethod failed:" << plugin->name() << iterator->pluginId;
+        return false;
+    }
+
+    iterator->inputMethod = im;
+    iterator->imHost->setInputMethod(im);
+
+    // cached subviews may stem from an older configuration of the plugin,
+    // refresh them for the next start
+    const MImManifestPlugin *manifestPlugin = dynamic_cast<MImManifestPlugin *>(plugin);
+    if (pluginCache && manifestPlugin) {
+        const QList<MAbstractInputMethod::MInputMethodSubView> &currentSubViews = im->subViews(Maliit::OnScreen);
+        if (!equalSubViews(currentSubViews, iterator->manifest.subViews)) {
+            MImPluginManifest manifest = manifestPlugin->manifest();
+            manifest.subViews = currentSubViews;
+            iterator->manifest.subViews = currentSubViews;
+            pluginCache->insert(QFileInfo(manifestPlugin->fileName()), manifest);
+            pluginCache->save();
+        }
+    }
+
+    return true;
+}
+
+void MIMPluginManagerPrivate::unloadPlugin(Maliit::Plugins::InputMethodPlugin *plugin)
+{
+    const Plugins::iterator iterator = plugins.find(plugin);
+    if (iterator == plugins.end()
+        || !iterator->inputMethod
+        || !iterator->manifest.unloadable
+        || activePlugins.contains(plugin)
+        || standbyPlugins.contains(plugin)) {
+        return;
+    }
+
+    MAbstractInputMethod *inputMethod = iterator->inputMethod;
+
+    iterator->inputMethod = 0;
+    iterator->imHost->setInputMethod(0);
+    targets.remove(inputMethod);
+    delete inputMethod;
+}
+
+QList<MAbstractInputMethod::MInputMethodSubView>
+MIMPluginManagerPrivate::subViews(const PluginDescription &description,
+                                  Maliit::HandlerState state) const
+{
+    if (description.inputMethod) {
+        return description.inputMethod->subViews(state);
+    }
+
+    if (state == Maliit::OnScreen) {
+        return description.manifest.subViews;
+    }
+
+    return QList<MAbstractInputMethod::MInputMethodSubView>();
+}
+
+void MIMPluginManagerPrivate::_q_unloadIdlePlugins()
+{
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, plugins.keys()) {
+        unloadPlugin(plugin);
+    }
+}
+
+void MIMPluginManagerPrivate::scheduleStandbyPlugins()
+{
+    if (standbyCount > 0 || !standbyPlugins.isEmpty()) {
+        standbyTimer.start();
+    }
+}
+
+void MIMPluginManagerPrivate::_q_prepareStandbyPlugins()
+{
+    const ActivePlugins previousStandby = standbyPlugins;
+    standbyPlugins.clear();
+
+    Maliit::Plugins::InputMethodPlugin *active = activePlugin(Maliit::OnScreen);
+    const Plugins::const_iterator current = plugins.constFind(active);
+
+    if (current != plugins.constEnd() && standbyCount > 0) {
+        // The plugin the user is most likely to switch to next comes first,
+        // then alternately the next ones in either direction
+        Maliit::SwitchDirection first = standbyDirection;
+
+        // Switching leaves the active plugin only after its last enabled
+        // subview in that direction
+        QStringList enabledSubViews;
+        Q_FOREACH (const MAbstractInputMethod::MInputMethodSubView &subView,
+                   subViews(*current, Maliit::OnScreen)) {
+            if (onScreenPlugins.isSubViewEnabled(MImOnScreenPlugins::SubView(current->pluginId,
+                                                                             subView.subViewId))) {
+                enabledSubViews.append(subView.subViewId);
+            }
+        }
+        const int subViewIndex = enabledSubViews.indexOf(activeSubViewIdOnScreen);
+        if (enabledSubViews.size() > 1 && subViewIndex == 0) {
+            first = Maliit::SwitchBackward;
+        } else if (enabledSubViews.size() > 1 && subViewIndex == enabledSubViews.size() - 1) {
+            first = Maliit::SwitchForward;
+        }
+
+        const Maliit::SwitchDirection directions[2] = {
+            first,
+            first == Maliit::SwitchForward ? Maliit::SwitchBackward : Maliit::SwitchForward
+        };
+        Plugins::const_iterator neighbours[2] = { current, current };
+
+        for (int n = 0; n < 2 * plugins.size() && standbyPlugins.size() < standbyCount; ++n) {
+            Plugins::const_iterator &neighbour = neighbours[n % 2];
+            neighbour = findEnabledPlugin(neighbour, directions[n % 2], Maliit::OnScreen);
+            if (neighbour == plugins.constEnd()) {
+                break;
+            }
+
+            Maliit::Plugins::InputMethodPlugin *plugin = neighbour.key();
+            if (plugin != active && instantiatePlugin(plugin)) {
+                standbyPlugins.insert(plugin);
+            }
+        }
+    }
+
+    // Plugins leaving the standby set may be unloaded again
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, previousStandby) {
+        if (!standbyPlugins.contains(plugin)
+            && !activePlugins.contains(plugin)
+            && plugins.value(plugin).manifest.unloadable
+            && idleUnloadTimer.interval() > 0) {
+            idleUnloadTimer.start();
+            break;
+        }
+    }
+}
+
+void MIMPluginManagerPrivate::_q_registerPendingPlugins()
 {
     Q_Q(MIMPluginManager);
-    if (!plugin || activePlugins.contains(plugin)) {
+
+    // One plugin per event loop iteration, so that clients are not kept
+    // waiting for all of them
+    if (!pendingPlugins.isEmpty()) {
+        PendingPlugin pending = pendingPlugins.takeFirst();
+        registerPlugin(pending);
+    }
+
+    if (!pendingPlugins.isEmpty()) {
+        QTimer::singleShot(0, q, SLOT(_q_registerPendingPlugins()));
+        return;
+    }
+
+    finishLoadingPlugins();
+
+    // Map the handlers whose plugin was not registered yet
+    InputSourceToNameMap::const_iterator end = inputSourceToNameMap.constEnd();
+    for (InputSourceToNameMap::const_iterator i(inputSourceToNameMap.constBegin()); i != end; ++i) {
+        const QString pluginId = MImSettings(PluginRoot + "/" + i.value()).value().toString();
+        if (!handlerToPlugin.contains(i.key()) && !pluginId.isEmpty()) {
+            addHandlerMap(i.key(), pluginId);
+        }
+    }
+
+    registerSettings();
+    q->updateInputSource();
+    scheduleStandbyPlugins();
+
+    Maliit::Tracing::event("MIMPluginManager all plugins registered");
+}
+
+void MIMPluginManagerPrivate::_q_activeInputMethodReady()
+{
+    Q_Q(MIMPluginManager);
+
+    if (q->isActivePluginReady()) {
+        Maliit::Tracing::event("MIMPluginManager active plugin ready");
+        Q_EMIT q->activePluginReady();
+    }
+}
+
+void MIMPluginManagerPrivate::_q_dispatchWidgetState()
+{
+    if (not widgetStatePending) {
         return;
     }
 
+    widgetStateTimer.stop();
+    widgetStatePending = false;
+
+    const QMap<QString, QVariant> oldState = pendingOldWidgetState;
+    const QMap<QString, QVariant> newState = pendingWidgetState;
+    const MImEditorState::Fields changedFields = pendingChangedFields;
+    const QStringList changedExtensions = pendingChangedExtensions;
+    const bool focusChanged = pendingFocusChanged;
+    const bool focusLost = pendingFocusLost;
+
+    pendingOldWidgetState.clear();
+    pendingWidgetState.clear();
+    pendingChangedFields = MImEditorState::NoField;
+    pendingChangedExtensions.clear();
+    pendingFocusChanged = false;
+    pendingFocusLost = false;
+
+    // check visualization change
+    bool oldVisualization = false;
+    bool newVisualization = false;
+
+    QVariant variant = oldState[VisualizationAttribute];
+
+    if (variant.isValid()) {
+        oldVisualization = variant.toBool();
+    }
+
+    variant = newState[VisualizationAttribute];
+    if (variant.isValid()) {
+        newVisualization = variant.toBool();
+    }
+
+    variant = newState[FocusStateAttribute];
+    const bool widgetFocusState = variant.toBool();
+
+    if (focusChanged) {
+        Q_FOREACH (MAbstractInputMethod *target, targets) {
+            // Focus moved from one widget to another within the collected changes
+            if (focusLost && widgetFocusState) {
+                target->handleFocusChange(false);
+            }
+            target->handleFocusChange(widgetFocusState);
+        }
+    }
+
+    // call notification methods if needed
+    if (oldVisualization != newVisualization) {
+        Q_FOREACH (MAbstractInputMethod *target, targets) {
+            target->handleVisualizationPriorityChange(newVisualization);
+        }
+    }
+
+    const Qt::InputMethodHints lastHints = static_cast<Qt::InputMethodHints>(newState.value(Maliit::Internal::inputMethodHints).toLongLong());
+    MImUpdateEvent ev(newState, MImUpdateEvent::Properties(QFlag(changedFields)),
+                      changedExtensions, lastHints);
+    const bool changed = changedFields != MImEditorState::NoField || not changedExtensions.isEmpty();
+
+    // general notification last
+    Q_FOREACH (MAbstractInputMethod *target, targets) {
+        if (changed) {
+            (void) target->imExtensionEvent(&ev);
+        }
+        target->update();
+    }
+
+    // Make sure windows get hidden when no longer focus
+    if (not widgetFocusState) {
+        hideActivePlugins();
+    }
+}
+
+bool MIMPluginManagerPrivate::activatePlugin(Maliit::Plugins::InputMethodPlugin *plugin)
+{
+    Q_Q(MIMPluginManager);
+    if (!plugin || activePlugins.contains(plugin)) {
+        return plugin != 0;
+    }
+
+    if (!instantiatePlugin(plugin)) {
+        return false;
+    }
+
     MAbstractInputMethod *inputMethod = 0;
 
     activePlugins.insert(plugin);
@@ -213,8 +664,19 @@ void MIMPluginManagerPrivate::activatePlugin(Maliit::Plugins::InputMethodPlugin
                      SLOT(_q_setActiveSubView(QString, Maliit::HandlerState)));
 
 
+    // QML input methods load their QML in the background
+    const Maliit::InputMethodQuick *quick = qobject_cast<Maliit::InputMethodQuick *>(inputMethod);
+    if (quick && !quick->isReady()) {
+        QObject::connect(quick, SIGNAL(ready()),
+                         q, SLOT(_q_activeInputMethodReady()),
+                         Qt::UniqueConnection);
+    }
+
     inputMethod->handleAppOrientationChanged(lastOrientation);
     targets.insert(inputMethod);
+    updateKeyFilter();
+
+    return true;
 }
 
 
@@ -227,7 +689,10 @@ void MIMPluginManagerPrivate::addHandlerMap(Maliit::HandlerState state,
             return;
         }
     }
-    qWarning() << __PRETTY_FUNCTION__ << "Could not find plugin:" << pluginId;
+    // plugins registered later are mapped by _q_registerPendingPlugins()
+    if (pendingPlugins.isEmpty()) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not find plugin:" << pluginId;
+    }
 }
 
 
@@ -237,7 +702,7 @@ MImPluginSettingsInfo MIMPluginManagerPrivate::globalSettings() const
 
     Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, plugins.keys()) {
         const MIMPluginManagerPrivate::PluginDescription &descr = plugins[plugin];
-        QList<MAbstractInputMethod::MInputMethodSubView> subviews = descr.inputMethod->subViews();
+        QList<MAbstractInputMethod::MInputMethodSubView> subviews = subViews(descr, Maliit::OnScreen);
 
         Q_FOREACH (const MAbstractInputMethod::MInputMethodSubView &subview, subviews) {
             domain.append(descr.pluginId + ":" + subview.subViewId);
@@ -343,7 +808,9 @@ void MIMPluginManagerPrivate::setActiveHandlers(const QSet<Maliit::HandlerState>
 
     // notify plugins about new states
     Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, activatedPlugins) {
-        plugins.value(plugin).inputMethod->setState(plugins.value(plugin).state);
+        if (MAbstractInputMethod *inputMethod = plugins.value(plugin).inputMethod) {
+            inputMethod->setState(plugins.value(plugin).state);
+        }
     }
 
     // deactivate unnecessary plugins
@@ -353,6 +820,8 @@ void MIMPluginManagerPrivate::setActiveHandlers(const QSet<Maliit::HandlerState>
             deactivatePlugin(plugin);  //activePlugins is modified here
         }
     }
+
+    scheduleStandbyPlugins();
 }
 
 
@@ -380,8 +849,10 @@ void MIMPluginManagerPrivate::deactivatePlugin(Maliit::Plugins::InputMethodPlugi
 
     Q_ASSERT(inputMethod);
 
-    inputMethod->hide();
-    inputMethod->reset();
+    if (inputMethod) {
+        inputMethod->hide();
+        inputMethod->reset();
+    }
 
     // this call disables normal behaviour on inputMethod->hide
     plugins.value(plugin).imHost->setEnabled(false);
@@ -389,6 +860,29 @@ void MIMPluginManagerPrivate::deactivatePlugin(Maliit::Plugins::InputMethodPlugi
     plugins[plugin].state = PluginState();
     QObject::disconnect(inputMethod, 0, q, 0);
     targets.remove(inputMethod);
+    updateKeyFilter();
+
+    if (plugins.value(plugin).manifest.unloadable && idleUnloadTimer.interval() > 0) {
+        idleUnloadTimer.start();
+    }
+}
+
+void MIMPluginManagerPrivate::updateKeyFilter()
+{
+    MImKeyFilter filter;
+    bool first = true;
+
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, activePlugins) {
+        const MImKeyFilter pluginFilter = plugins.value(plugin).imHost->keyFilter();
+        if (first) {
+            filter = pluginFilter;
+            first = false;
+        } else {
+            filter.unite(pluginFilter);
+        }
+    }
+
+    mICConnection->setKeyFilter(filter);
 }
 
 void MIMPluginManagerPrivate::replacePlugin(Maliit::SwitchDirection direction,
@@ -396,6 +890,9 @@ void MIMPluginManagerPrivate::replacePlugin(Maliit::SwitchDirection direction,
                                             Plugins::iterator replacement,
                                             const QString &subViewId)
 {
+    // Input methods get the collected widget state before being switched
+    _q_dispatchWidgetState();
+
     PluginState state;
     if (source)
         state = plugins.value(source).state;
@@ -424,6 +921,9 @@ void MIMPluginManagerPrivate::replacePlugin(Maliit::SwitchDirection direction,
     if (source) {
         plugins[source].lastSwitchDirection = direction;
     }
+    if (direction == Maliit::SwitchForward || direction == Maliit::SwitchBackward) {
+        standbyDirection = direction;
+    }
     QMap<QString, QSharedPointer<MKeyOverride> > keyOverrides =
         attributeExtensionManager->keyOverrides(toolbarId);
     switchedTo->setKeyOverrides(keyOverrides);
@@ -442,12 +942,17 @@ void MIMPluginManagerPrivate::replacePlugin(Maliit::SwitchDirection direction,
         // Save the last active subview
         onScreenPlugins.setActiveSubView(MImOnScreenPlugins::SubView(replacement->pluginId, activeSubViewIdOnScreen));
     }
+
+    scheduleStandbyPlugins();
 }
 
 
 bool MIMPluginManagerPrivate::switchPlugin(Maliit::SwitchDirection direction,
                                            MAbstractInputMethod *initiator)
 {
+    // Input methods get the collected widget state before being switched
+    _q_dispatchWidgetState();
+
     if (direction != Maliit::SwitchForward
         && direction != Maliit::SwitchBackward) {
         return true; //do nothing for this direction
@@ -457,7 +962,7 @@ bool MIMPluginManagerPrivate::switchPlugin(Maliit::SwitchDirection direction,
     Plugins::iterator iterator(plugins.begin());
 
     for (; iterator != plugins.end(); ++iterator) {
-        if (iterator->inputMethod == initiator) {
+        if (initiator && iterator->inputMethod == initiator) {
             break;
         }
     }
@@ -494,11 +999,14 @@ bool MIMPluginManagerPrivate::switchPlugin(const QString &pluginId,
                                            MAbstractInputMethod *initiator,
                                            const QString &subViewId)
 {
+    // Input methods get the collected widget state before being switched
+    _q_dispatchWidgetState();
+
     //Find plugin initiated this switch
     Plugins::iterator iterator(plugins.begin());
 
     for (; iterator != plugins.end(); ++iterator) {
-        if (iterator->inputMethod == initiator) {
+        if (initiator && iterator->inputMethod == initiator) {
             break;
         }
     }
@@ -570,6 +1078,11 @@ bool MIMPluginManagerPrivate::trySwitchPlugin(Maliit::SwitchDirection direction,
         }
     }
 
+    // fail before the source plugin is deactivated
+    if (!instantiatePlugin(newPlugin)) {
+        return false;
+    }
+
     changeHandlerMap(source, newPlugin, newPlugin->supportedStates());
     replacePlugin(direction, source, replacement, subViewId);
 
@@ -728,6 +1241,10 @@ MIMPluginManagerPrivate::surroundingSubViewDescriptions(Maliit::HandlerState sta
     Plugins::const_iterator iterator = plugins.find(plugin);
     Q_ASSERT(iterator != plugins.constEnd());
 
+    if (!iterator->inputMethod) {
+        return result;
+    }
+
     QString pluginId = iterator->pluginId;
     QString subViewId = iterator->inputMethod->activeSubView(state);
     QMap<QString, QString> subViews = availableSubViews(pluginId, state);
@@ -962,6 +1479,8 @@ void MIMPluginManagerPrivate::_q_setActiveSubView(const QString &subViewId,
                 onScreenPlugins.setActiveSubView(MImOnScreenPlugins::SubView(activePluginId, subViewId));
             }
 
+            // the plugin to be switched to next may have changed
+            scheduleStandbyPlugins();
             break;
         }
     }
@@ -969,6 +1488,8 @@ void MIMPluginManagerPrivate::_q_setActiveSubView(const QString &subViewId,
 
 void MIMPluginManagerPrivate::showActivePlugins()
 {
+    Maliit::Tracing::event("MIMPluginManager showActivePlugins");
+
     visible = true;
     ensureActivePluginsVisible(ShowInputMethod);
 }
@@ -977,7 +1498,9 @@ void MIMPluginManagerPrivate::hideActivePlugins()
 {
     visible = false;
     Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, activePlugins) {
-        plugins.value(plugin).inputMethod->hide();
+        if (MAbstractInputMethod *inputMethod = plugins.value(plugin).inputMethod) {
+            inputMethod->hide();
+        }
         plugins.value(plugin).windowGroup->deactivate(Maliit::WindowGroup::HideDelayed);
     }
 }
@@ -989,7 +1512,7 @@ void MIMPluginManagerPrivate::ensureActivePluginsVisible(ShowInputMethodRequest
     for (; iterator != plugins.end(); ++iterator) {
         if (activePlugins.contains(iterator.key())) {
             iterator.value().windowGroup->activate();
-            if (request == ShowInputMethod) {
+            if (request == ShowInputMethod && iterator.value().inputMethod) {
                 iterator.value().inputMethod->show();
             }
         } else {
@@ -1007,11 +1530,9 @@ MIMPluginManagerPrivate::availableSubViews(const QString &plugin,
 
     for (; iterator != plugins.constEnd(); ++iterator) {
         if (plugins.value(iterator.key()).pluginId == plugin) {
-            if (iterator->inputMethod) {
-                Q_FOREACH (const MAbstractInputMethod::MInputMethodSubView &subView,
-                         iterator->inputMethod->subViews(state)) {
-                    subViews.insert(subView.subViewId, subView.subViewTitle);
-                }
+            Q_FOREACH (const MAbstractInputMethod::MInputMethodSubView &subView,
+                     this->subViews(*iterator, state)) {
+                subViews.insert(subView.subViewId, subView.subViewTitle);
             }
             break;
         }
@@ -1026,12 +1547,10 @@ MIMPluginManagerPrivate::availablePluginsAndSubViews(Maliit::HandlerState state)
     Plugins::const_iterator iterator(plugins.constBegin());
 
     for (; iterator != plugins.constEnd(); ++iterator) {
-        if (iterator->inputMethod) {
-            const QString plugin = plugins.value(iterator.key()).pluginId;
-            Q_FOREACH (const MAbstractInputMethod::MInputMethodSubView &subView,
-                     iterator->inputMethod->subViews(state)) {
-                pluginsAndSubViews.append(MImOnScreenPlugins::SubView(plugin, subView.subViewId));
-            }
+        const QString plugin = plugins.value(iterator.key()).pluginId;
+        Q_FOREACH (const MAbstractInputMethod::MInputMethodSubView &subView,
+                 subViews(*iterator, state)) {
+            pluginsAndSubViews.append(MImOnScreenPlugins::SubView(plugin, subView.subViewId));
         }
     }
 
@@ -1042,7 +1561,7 @@ QString MIMPluginManagerPrivate::activeSubView(Maliit::HandlerState state) const
 {
     QString subView;
     Maliit::Plugins::InputMethodPlugin *currentPlugin = activePlugin(state);
-    if (currentPlugin) {
+    if (currentPlugin && plugins.value(currentPlugin).inputMethod) {
         subView = plugins.value(currentPlugin).inputMethod->activeSubView(state);
     }
     return subView;
@@ -1051,6 +1570,9 @@ QString MIMPluginManagerPrivate::activeSubView(Maliit::HandlerState state) const
 void MIMPluginManagerPrivate::setActivePlugin(const QString &pluginId,
                                               Maliit::HandlerState state)
 {
+    // Input methods get the collected widget state before being switched
+    _q_dispatchWidgetState();
+
     if (state == Maliit::OnScreen) {
         const QList<MImOnScreenPlugins::SubView> &subViews = onScreenPlugins.enabledSubViews(pluginId);
         if (subViews.empty()) {
@@ -1090,12 +1612,14 @@ void MIMPluginManagerPrivate::setActivePlugin(const QString &pluginId,
 // actual class
 
 MIMPluginManager::MIMPluginManager(const QSharedPointer<MInputContextConnection>& icConnection,
-                                   const QSharedPointer<Maliit::AbstractPlatform> &platform)
+                                   const QSharedPointer<Maliit::AbstractPlatform> &platform,
+                                   LoadingMode loadingMode)
     : QObject(),
       d_ptr(new MIMPluginManagerPrivate(icConnection, platform, this))
 {
     Q_D(MIMPluginManager);
     d->q_ptr = this;
+    d->stagedLoading = (loadingMode == LoadActivePluginFirst);
 
     // Connect connection to our handlers
     connect(d->mICConnection.data(), SIGNAL(showInputMethodRequest()),
@@ -1128,14 +1652,14 @@ MIMPluginManager::MIMPluginManager(const QSharedPointer<MInputContextConnection>
     connect(d->mICConnection.data(), SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
             this, SLOT(processKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
 
-    connect(d->mICConnection.data(), SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool)),
-            this, SLOT(handleWidgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool)));
+    connect(d->mICConnection.data(), SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)),
+            this, SLOT(handleWidgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)));
 
     // Connect connection and MAttributeExtensionManager
     connect(d->mICConnection.data(), SIGNAL(copyPasteStateChanged(bool,bool)),
             d->attributeExtensionManager.data(), SLOT(setCopyPasteState(bool, bool)));
 
-    connect(d->mICConnection.data(), SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool)),
+    connect(d->mICConnection.data(), SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)),
             d->attributeExtensionManager.data(), SLOT(handleWidgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool)));
 
     connect(d->mICConnection.data(), SIGNAL(attributeExtensionRegistered(uint, int, QString)),
@@ -1147,6 +1671,9 @@ MIMPluginManager::MIMPluginManager(const QSharedPointer<MInputContextConnection>
     connect(d->mICConnection.data(), SIGNAL(extendedAttributeChanged(uint, int, QString, QString, QString, QVariant)),
             d->attributeExtensionManager.data(), SLOT(handleExtendedAttributeUpdate(uint, int, QString, QString, QString, QVariant)));
 
+    connect(d->mICConnection.data(), SIGNAL(extendedAttributesChanged(uint, int, QString, QString, QVariantMap)),
+            d->attributeExtensionManager.data(), SLOT(handleExtendedAttributesUpdate(uint, int, QString, QString, QVariantMap)));
+
     connect(d->attributeExtensionManager.data(), SIGNAL(notifyExtensionAttributeChanged(int, QString, QString, QString, QVariant)),
             d->mICConnection.data(), SLOT(notifyExtendedAttributeChanged(int, QString, QString, QString, QVariant)));
 
@@ -1162,6 +1689,9 @@ MIMPluginManager::MIMPluginManager(const QSharedPointer<MInputContextConnection>
     connect(d->mICConnection.data(), SIGNAL(extendedAttributeChanged(uint, int, QString, QString, QString, QVariant)),
             d->sharedAttributeExtensionManager.data(), SLOT(handleExtendedAttributeUpdate(uint, int, QString, QString, QString, QVariant)));
 
+    connect(d->mICConnection.data(), SIGNAL(extendedAttributesChanged(uint, int, QString, QString, QVariantMap)),
+            d->sharedAttributeExtensionManager.data(), SLOT(handleExtendedAttributesUpdate(uint, int, QString, QString, QVariantMap)));
+
     connect(d->sharedAttributeExtensionManager.data(), SIGNAL(notifyExtensionAttributeChanged(QList<int>, int, QString, QString, QString, QVariant)),
             d->mICConnection.data(), SLOT(notifyExtendedAttributeChanged(QList<int>, int, QString, QString, QString, QVariant)));
 
@@ -1186,12 +1716,33 @@ MIMPluginManager::MIMPluginManager(const QSharedPointer<MInputContextConnection>
 
     d->paths        = MImSettings(MImPluginPaths).value(QStringList(DefaultPluginLocation)).toStringList();
     d->blacklist    = MImSettings(MImPluginDisabled).value().toStringList();
+    d->lazyLoading  = MImSettings(MImPluginLazyLoading).value(false).toBool();
+
+    if (d->lazyLoading) {
+        const QString cacheFile = MImSettings(MImPluginCacheFile).value(DefaultPluginCacheFile()).toString();
+        if (!cacheFile.isEmpty()) {
+            d->pluginCache.reset(new MImPluginCache(cacheFile));
+            d->pluginCache->load();
+        }
+    }
+
+    // in seconds, 0 keeps inactive input methods loaded
+    d->idleUnloadTimer.setInterval(MImSettings(MImPluginIdleUnloadTimeout).value(0).toInt() * 1000);
+    connect(&d->idleUnloadTimer, SIGNAL(timeout()), this, SLOT(_q_unloadIdlePlugins()));
+    connect(&d->widgetStateTimer, SIGNAL(timeout()), this, SLOT(_q_dispatchWidgetState()));
+
+    // 0 instantiates inactive input methods only when switching to them
+    d->standbyCount = qMax(0, MImSettings(MImPluginStandbyCount).value(DefaultStandbyCount).toInt());
+    connect(&d->standbyTimer, SIGNAL(timeout()), this, SLOT(_q_prepareStandbyPlugins()));
 
     d->loadPlugins();
 
     d->loadHandlerMap();
 
-    d->registerSettings();
+    // with staged loading once all plugins are registered
+    if (d->pendingPlugins.isEmpty()) {
+        d->registerSettings();
+    }
 
     connect(&d->onScreenPlugins, SIGNAL(activeSubViewChanged()),
             this, SLOT(_q_onScreenSubViewChanged()));
@@ -1324,6 +1875,7 @@ void MIMPluginManager::setAllSubViewsEnabled(bool enable)
 void MIMPluginManager::setToolbar(const MAttributeExtensionId &id)
 {
     Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
 
     // Record MAttributeExtensionId for switch Plugin
     d->toolbarId = id;
@@ -1349,9 +1901,10 @@ void MIMPluginManager::setToolbar(const MAttributeExtensionId &id)
     const bool callKeyOverrides(!(!focusState && mapEmpty));
 
     Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, d->activePlugins) {
-        if (callKeyOverrides)
+        MAbstractInputMethod *inputMethod = d->plugins.value(plugin).inputMethod;
+        if (callKeyOverrides && inputMethod)
         {
-            d->plugins.value(plugin).inputMethod->setKeyOverrides(keyOverrides);
+            inputMethod->setKeyOverrides(keyOverrides);
         }
     }
 }
@@ -1359,6 +1912,7 @@ void MIMPluginManager::setToolbar(const MAttributeExtensionId &id)
 void MIMPluginManager::showActivePlugins()
 {
     Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
 
     d->showActivePlugins();
 }
@@ -1366,6 +1920,7 @@ void MIMPluginManager::showActivePlugins()
 void MIMPluginManager::hideActivePlugins()
 {
     Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
 
     d->hideActivePlugins();
 }
@@ -1402,12 +1957,17 @@ void MIMPluginManager::updateKeyOverrides()
         d->attributeExtensionManager->keyOverrides(d->toolbarId);
 
     Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, d->activePlugins) {
-        d->plugins.value(plugin).inputMethod->setKeyOverrides(keyOverrides);
+        if (MAbstractInputMethod *inputMethod = d->plugins.value(plugin).inputMethod) {
+            inputMethod->setKeyOverrides(keyOverrides);
+        }
     }
 }
 
 void MIMPluginManager::handleAppOrientationAboutToChange(int angle)
 {
+    Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
+
     Q_FOREACH (MAbstractInputMethod *target, targets()) {
         target->handleAppOrientationAboutToChange(angle);
     }
@@ -1416,6 +1976,7 @@ void MIMPluginManager::handleAppOrientationAboutToChange(int angle)
 void MIMPluginManager::handleAppOrientationChanged(int angle)
 {
     Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
 
     d->lastOrientation = angle;
 
@@ -1437,6 +1998,9 @@ void MIMPluginManager::handleAppFocusChanged(WId id)
 
 void MIMPluginManager::handleClientChange()
 {
+    Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
+
     // notify plugins
     Q_FOREACH (MAbstractInputMethod *target, targets()) {
         target->handleClientChange();
@@ -1446,72 +2010,43 @@ void MIMPluginManager::handleClientChange()
 void MIMPluginManager::handleWidgetStateChanged(unsigned int clientId,
                                                 const QMap<QString, QVariant> &newState,
                                                 const QMap<QString, QVariant> &oldState,
-                                                bool focusChanged)
+                                                bool focusChanged,
+                                                MImEditorState::Fields changedFields,
+                                                const QStringList &changedExtensions)
 {
     Q_UNUSED(clientId);
+    Q_D(MIMPluginManager);
 
-    // check visualization change
-    bool oldVisualization = false;
-    bool newVisualization = false;
-
-    QVariant variant = oldState[VisualizationAttribute];
-
-    if (variant.isValid()) {
-        oldVisualization = variant.toBool();
-    }
-
-    variant = newState[VisualizationAttribute];
-    if (variant.isValid()) {
-        newVisualization = variant.toBool();
+    // A focus change usually comes as several updates in a row. They are
+    // collected and the input methods notified once, when control returns
+    // to the event loop or before the next request which depends on the state.
+    if (not d->widgetStatePending) {
+        d->widgetStatePending = true;
+        d->pendingOldWidgetState = oldState;
+        d->widgetStateTimer.start();
     }
 
-    // update state
-    QStringList changedProperties;
-    for (QMap<QString, QVariant>::const_iterator iter = newState.constBegin();
-         iter != newState.constEnd();
-         ++iter)
-    {
-        if (oldState.value(iter.key()) != iter.value()) {
-            changedProperties.append(iter.key());
+    d->pendingWidgetState = newState;
+    d->pendingChangedFields |= changedFields;
+    Q_FOREACH (const QString &extension, changedExtensions) {
+        if (not d->pendingChangedExtensions.contains(extension)) {
+            d->pendingChangedExtensions.append(extension);
         }
-
     }
 
-    variant = newState[FocusStateAttribute];
-    const bool widgetFocusState = variant.toBool();
-
     if (focusChanged) {
-        Q_FOREACH (MAbstractInputMethod *target, targets()) {
-            target->handleFocusChange(widgetFocusState);
-        }
-    }
-
-    // call notification methods if needed
-    if (oldVisualization != newVisualization) {
-        Q_FOREACH (MAbstractInputMethod *target, targets()) {
-            target->handleVisualizationPriorityChange(newVisualization);
-        }
-    }
-
-    const Qt::InputMethodHints lastHints = static_cast<Qt::InputMethodHints>(newState.value(Maliit::Internal::inputMethodHints).toLongLong());
-    MImUpdateEvent ev(newState, changedProperties, lastHints);
-
-    // general notification last
-    Q_FOREACH (MAbstractInputMethod *target, targets()) {
-        if (not changedProperties.isEmpty()) {
-            (void) target->imExtensionEvent(&ev);
+        d->pendingFocusChanged = true;
+        if (not newState.value(FocusStateAttribute).toBool()) {
+            d->pendingFocusLost = true;
         }
-        target->update();
-    }
-
-    // Make sure windows get hidden when no longer focus
-    if (not widgetFocusState) {
-        hideActivePlugins();
     }
 }
 
 void MIMPluginManager::handleMouseClickOnPreedit(const QPoint &pos, const QRect &preeditRect)
 {
+    Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
+
     Q_FOREACH (MAbstractInputMethod *target, targets()) {
         target->handleMouseClickOnPreedit(pos, preeditRect);
     }
@@ -1519,6 +2054,9 @@ void MIMPluginManager::handleMouseClickOnPreedit(const QPoint &pos, const QRect
 
 void MIMPluginManager::handlePreeditChanged(const QString &text, int cursorPos)
 {
+    Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
+
     Q_FOREACH (MAbstractInputMethod *target, targets()) {
         target->setPreedit(text, cursorPos);
     }
@@ -1526,6 +2064,9 @@ void MIMPluginManager::handlePreeditChanged(const QString &text, int cursorPos)
 
 void MIMPluginManager::resetInputMethods()
 {
+    Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
+
     Q_FOREACH (MAbstractInputMethod *target, targets()) {
         target->reset();
     }
@@ -1536,6 +2077,9 @@ void MIMPluginManager::processKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
                      quint32 nativeScanCode, quint32 nativeModifiers, unsigned long time)
 
 {
+    Q_D(MIMPluginManager);
+    d->_q_dispatchWidgetState();
+
     Q_FOREACH (MAbstractInputMethod *target, targets()) {
         target->processKeyEvent(keyType, keyCode, modifiers, text, autoRepeat, count,
                                 nativeScanCode, nativeModifiers, time);
@@ -1620,6 +2164,28 @@ AbstractPluginSetting *MIMPluginManager::registerPluginSetting(const QString &pl
     return new PluginSetting(key, entry.extension_key, entry.attributes.value(Maliit::SettingEntryAttributes::defaultValue));
 }
 
+void MIMPluginManager::updateKeyFilter()
+{
+    Q_D(MIMPluginManager);
+
+    d->updateKeyFilter();
+}
+
+bool MIMPluginManager::isActivePluginReady() const
+{
+    Q_D(const MIMPluginManager);
+
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, d->activePlugins) {
+        const Maliit::InputMethodQuick *quick
+            = qobject_cast<Maliit::InputMethodQuick *>(d->plugins.value(plugin).inputMethod);
+        if (quick && !quick->isReady()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 PluginSetting::PluginSetting(const QString &shortKey, const QString &fullKey, const QVariant &value) :
     pluginKey(shortKey), setting(fullKey), defaultValue(value)
 {
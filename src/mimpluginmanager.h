@@ -54,11 +54,21 @@ class MIMPluginManager: public QObject
     Q_CLASSINFO("D-Bus Interface", "com.meego.inputmethodpluginmanager1")
 
 public:
+    //! How plugins are loaded on construction
+    enum LoadingMode {
+        //! All plugins are registered before the constructor returns
+        LoadAllPlugins,
+        //! Only the active plugin is registered before the constructor returns,
+        //! the others once the event loop runs
+        LoadActivePluginFirst
+    };
+
     /*!
      * \Brief Constructs object MIMPluginManager
      */
     MIMPluginManager(const QSharedPointer<MInputContextConnection> &icConnection,
-                     const QSharedPointer<Maliit::AbstractPlatform> &platform);
+                     const QSharedPointer<Maliit::AbstractPlatform> &platform,
+                     LoadingMode loadingMode = LoadAllPlugins);
 
     virtual ~MIMPluginManager();
 
@@ -113,6 +123,13 @@ public:
                                                  Maliit::SettingEntryType type,
                                                  const QVariantMap &attributes);
 
+    //! Updates the key filter of the connection after an active plugin changed its filter
+    void updateKeyFilter();
+
+    //! Returns false while the input method of an active plugin is not ready to be
+    //! shown yet, like a QML input method whose QML is still loading
+    bool isActivePluginReady() const;
+
 Q_SIGNALS:
     //! This signal is emitted when input method plugins are loaded, unloaded,
     //! enabled or disabled
@@ -120,6 +137,10 @@ Q_SIGNALS:
 
     void pluginLoaded();
 
+    //! Emitted when the input methods of the active plugins became ready,
+    //! see isActivePluginReady()
+    void activePluginReady();
+
 public Q_SLOTS:
     //! Show active plugins.
     void showActivePlugins();
@@ -146,7 +167,9 @@ private Q_SLOTS:
     void handleClientChange();
 
     void handleWidgetStateChanged(unsigned int clientId, const QMap<QString, QVariant> &newState,
-                                  const QMap<QString, QVariant> &oldState, bool focusChanged);
+                                  const QMap<QString, QVariant> &oldState, bool focusChanged,
+                                  MImEditorState::Fields changedFields,
+                                  const QStringList &changedExtensions);
     void handleMouseClickOnPreedit(const QPoint &pos, const QRect &preeditRect);
     void handlePreeditChanged(const QString &text, int cursorPos);
 
@@ -180,6 +203,11 @@ private:
     Q_PRIVATE_SLOT(d_func(), void _q_syncHandlerMap(int))
     Q_PRIVATE_SLOT(d_func(), void _q_setActiveSubView(const QString &, Maliit::HandlerState))
     Q_PRIVATE_SLOT(d_func(), void _q_onScreenSubViewChanged())
+    Q_PRIVATE_SLOT(d_func(), void _q_unloadIdlePlugins())
+    Q_PRIVATE_SLOT(d_func(), void _q_registerPendingPlugins())
+    Q_PRIVATE_SLOT(d_func(), void _q_activeInputMethodReady())
+    Q_PRIVATE_SLOT(d_func(), void _q_dispatchWidgetState())
+    Q_PRIVATE_SLOT(d_func(), void _q_prepareStandbyPlugins())
 
     friend class Ut_MIMPluginManager;
     friend class Ut_MIMPluginManagerConfig;
@@ -26,6 +26,9 @@
 #include <maliit/plugins/abstractpluginsetting.h>
 #include "windowgroup.h"
 #include "abstractplatform.h"
+#include "mimpluginmanifest.h"
+#include "mimplugincache.h"
+#include "mimpluginlibraryloader.h"
 
 #include <QtCore>
 
@@ -82,6 +85,19 @@ public:
         Maliit::SwitchDirection lastSwitchDirection;
         QString pluginId; // the library filename is used as ID
         QSharedPointer<Maliit::WindowGroup> windowGroup;
+        // only valid for plugins instantiated on demand, inputMethod is 0 until then
+        MImPluginManifest manifest;
+    };
+
+    //! Plugin file found in a plugin directory, waiting to be registered
+    struct PendingPlugin {
+        QDir dir;
+        QString fileName;
+        MImPluginManifest manifest;
+        //! QML plugin or plugin with a manifest, created without loading a library
+        Maliit::Plugins::InputMethodPlugin *plugin;
+        //! Loads the plugin library otherwise
+        QSharedPointer<MImPluginLibraryLoader> library;
     };
 
     typedef QMap<Maliit::Plugins::InputMethodPlugin *, PluginDescription> Plugins;
@@ -95,9 +111,17 @@ public:
 
     void autoDetectEnabledSubViews(const QString &plugin);
 
-    void activatePlugin(Maliit::Plugins::InputMethodPlugin *plugin);
+    bool activatePlugin(Maliit::Plugins::InputMethodPlugin *plugin);
     void loadPlugins();
-    bool loadPlugin(const QDir &dir, const QString &fileName);
+    bool requestPlugin(const QDir &dir, const QString &fileName, int priority,
+                       QThreadPool *pool, PendingPlugin &pending);
+    bool registerPlugin(PendingPlugin &pending);
+    void registerPendingPlugins();
+    void finishLoadingPlugins();
+    bool instantiatePlugin(Maliit::Plugins::InputMethodPlugin *plugin);
+    void unloadPlugin(Maliit::Plugins::InputMethodPlugin *plugin);
+    QList<MAbstractInputMethod::MInputMethodSubView> subViews(const PluginDescription &description,
+                                                              Maliit::HandlerState state) const;
     void addHandlerMap(Maliit::HandlerState state, const QString &pluginName);
     void registerSettings();
     void registerSettings(const MImPluginSettingsInfo &info);
@@ -105,6 +129,8 @@ public:
     void setActiveHandlers(const QSet<Maliit::HandlerState> &states);
     QSet<Maliit::HandlerState> activeHandlers() const;
     void deactivatePlugin(Maliit::Plugins::InputMethodPlugin *plugin);
+    //! Sets the union of the key filters of the active plugins on the connection
+    void updateKeyFilter();
 
     void replacePlugin(Maliit::SwitchDirection direction, Maliit::Plugins::InputMethodPlugin *source,
                        Plugins::iterator replacement, const QString &subViewId);
@@ -159,6 +185,42 @@ public:
      */
     void _q_onScreenSubViewChanged();
 
+    /*!
+     * \brief Deletes the input methods of unloadable plugins which are not active
+     */
+    void _q_unloadIdlePlugins();
+
+    /*!
+     * \brief Registers the plugins left by loadPlugins() with staged loading
+     */
+    void _q_registerPendingPlugins();
+
+    /*!
+     * \brief Called when the QML of an active input method has been loaded
+     */
+    void _q_activeInputMethodReady();
+
+    /*!
+     * \brief Notifies the input methods of the widget state changes collected
+     * by MIMPluginManager::handleWidgetStateChanged(), does nothing if there are none
+     */
+    void _q_dispatchWidgetState();
+
+    /*!
+     * \brief Instantiates the enabled on-screen plugins next to the active one,
+     * up to the configured count, so that switching to them does not wait for
+     * their input method to be created. The plugin reached first from the
+     * active subview comes first.
+     *
+     * Only the input method is created: standby input methods are not
+     * activated and get no setState(), key overrides or windows until a
+     * switch activates them. Without lazy loading or idle unloading all
+     * input methods exist anyway and standby changes nothing.
+     */
+    void _q_prepareStandbyPlugins();
+    //! Runs _q_prepareStandbyPlugins() once control returns to the event loop
+    void scheduleStandbyPlugins();
+
     QMap<QString, QString> availableSubViews(const QString &plugin,
                                              Maliit::HandlerState state
                                               = Maliit::OnScreen) const;
@@ -205,6 +267,42 @@ public:
     QScopedPointer<MSharedAttributeExtensionManager> sharedAttributeExtensionManager;
 
     QSharedPointer<Maliit::AbstractPlatform> m_platform;
+
+    bool lazyLoading;
+    QTimer idleUnloadTimer;
+    // only used with lazy loading
+    QScopedPointer<MImPluginCache> pluginCache;
+
+    //! Only the active plugin is registered by loadPlugins(), see MIMPluginManager::LoadingMode
+    bool stagedLoading;
+    //! Plugins requested by loadPlugins() which are not registered yet
+    QList<PendingPlugin> pendingPlugins;
+    //! Loads plugin libraries. Declared after pendingPlugins, so that it waits
+    //! for their loaders before they are destroyed.
+    QThreadPool pluginLoaderPool;
+
+    //! Whether widget state changes wait for _q_dispatchWidgetState()
+    bool widgetStatePending;
+    //! State before the first and after the last of the collected changes
+    QMap<QString, QVariant> pendingOldWidgetState;
+    QMap<QString, QVariant> pendingWidgetState;
+    //! Union of the attributes changed by the collected changes
+    MImEditorState::Fields pendingChangedFields;
+    QStringList pendingChangedExtensions;
+    bool pendingFocusChanged;
+    //! Whether one of the collected changes took the focus away
+    bool pendingFocusLost;
+    //! Dispatches the collected changes once control returns to the event loop
+    QTimer widgetStateTimer;
+
+    //! Maximum number of inactive plugins in standbyPlugins, 0 disables standby
+    int standbyCount;
+    //! Inactive plugins kept instantiated, they are not unloaded while idle
+    ActivePlugins standbyPlugins;
+    //! Direction of the last switch, its neighbour is prepared first unless
+    //! the active subview is at one end of the enabled subviews of its plugin
+    Maliit::SwitchDirection standbyDirection;
+    QTimer standbyTimer;
 };
 
 #endif
@@ -0,0 +1,178 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "mimpluginmanifest.h"
+
+#include <QJsonArray>
+#include <QDebug>
+
+namespace
+{
+    const char * const MetaDataKey = "MetaData";
+    const char * const NameKey = "name";
+    const char * const SupportedStatesKey = "supportedStates";
+    const char * const SubViewsKey = "subViews";
+    const char * const SubViewIdKey = "id";
+    const char * const SubViewTitleKey = "title";
+    const char * const UnloadableKey = "unloadable";
+
+    bool stateFromString(const QString &name, Maliit::HandlerState *state)
+    {
+        if (name == "OnScreen") {
+            *state = Maliit::OnScreen;
+        } else if (name == "Hardware") {
+            *state = Maliit::Hardware;
+        } else if (name == "Accessory") {
+            *state = Maliit::Accessory;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    QString stateToString(Maliit::HandlerState state)
+    {
+        switch (state) {
+        case Maliit::OnScreen:
+            return "OnScreen";
+        case Maliit::Hardware:
+            return "Hardware";
+        case Maliit::Accessory:
+            return "Accessory";
+        }
+        return QString();
+    }
+}
+
+MImPluginManifest::MImPluginManifest()
+    : unloadable(false)
+{}
+
+MImPluginManifest MImPluginManifest::fromMetaData(const QJsonObject &metaData)
+{
+    return fromJson(metaData.value(MetaDataKey).toObject());
+}
+
+MImPluginManifest MImPluginManifest::fromJson(const QJsonObject &object)
+{
+    MImPluginManifest manifest;
+
+    manifest.name = object.value(NameKey).toString();
+
+    Q_FOREACH (const QJsonValue &value, object.value(SupportedStatesKey).toArray()) {
+        Maliit::HandlerState state;
+        if (stateFromString(value.toString(), &state)) {
+            manifest.supportedStates.insert(state);
+        } else {
+            qWarning() << __PRETTY_FUNCTION__ << "Unknown state" << value.toString();
+        }
+    }
+
+    Q_FOREACH (const QJsonValue &value, object.value(SubViewsKey).toArray()) {
+        const QJsonObject &subViewObject = value.toObject();
+        MAbstractInputMethod::MInputMethodSubView subView;
+        subView.subViewId = subViewObject.value(SubViewIdKey).toString();
+        subView.subViewTitle = subViewObject.value(SubViewTitleKey).toString();
+        manifest.subViews.append(subView);
+    }
+
+    manifest.unloadable = object.value(UnloadableKey).toBool(false);
+
+    return manifest;
+}
+
+QJsonObject MImPluginManifest::toJson() const
+{
+    QJsonObject object;
+    QJsonArray states;
+    QJsonArray subViewArray;
+
+    Q_FOREACH (Maliit::HandlerState state, supportedStates) {
+        states.append(stateToString(state));
+    }
+
+    Q_FOREACH (const MAbstractInputMethod::MInputMethodSubView &subView, subViews) {
+        QJsonObject subViewObject;
+        subViewObject.insert(SubViewIdKey, subView.subViewId);
+        subViewObject.insert(SubViewTitleKey, subView.subViewTitle);
+        subViewArray.append(subViewObject);
+    }
+
+    object.insert(NameKey, name);
+    object.insert(SupportedStatesKey, states);
+    object.insert(SubViewsKey, subViewArray);
+    object.insert(UnloadableKey, unloadable);
+
+    return object;
+}
+
+bool MImPluginManifest::isValid() const
+{
+    return !name.isEmpty() && !supportedStates.isEmpty();
+}
+
+MImManifestPlugin::MImManifestPlugin(const QString &fileName, const MImPluginManifest &manifest)
+    : mLoader(fileName),
+      mManifest(manifest),
+      mPlugin(0)
+{}
+
+MImManifestPlugin::~MImManifestPlugin()
+{}
+
+const MImPluginManifest &MImManifestPlugin::manifest() const
+{
+    return mManifest;
+}
+
+QString MImManifestPlugin::fileName() const
+{
+    return mLoader.fileName();
+}
+
+QString MImManifestPlugin::name() const
+{
+    return mManifest.name;
+}
+
+MAbstractInputMethod *MImManifestPlugin::createInputMethod(MAbstractInputMethodHost *host)
+{
+    if (!mPlugin) {
+        QObject *pluginInstance = mLoader.instance();
+        if (!pluginInstance) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Error loading plugin from" << mLoader.fileName() << mLoader.errorString();
+            return 0;
+        }
+
+        mPlugin = qobject_cast<Maliit::Plugins::InputMethodPlugin *>(pluginInstance);
+        if (!mPlugin) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << pluginInstance->metaObject()->className() << "is not a Maliit::Server::InputMethodPlugin.";
+            return 0;
+        }
+
+        if (mPlugin->name() != mManifest.name) {
+            qWarning() << __PRETTY_FUNCTION__ << "Plugin name" << mPlugin->name()
+                       << "does not match the manifest" << mManifest.name;
+        }
+    }
+
+    return mPlugin->createInputMethod(host);
+}
+
+QSet<Maliit::HandlerState> MImManifestPlugin::supportedStates() const
+{
+    return mManifest.supportedStates;
+}
@@ -0,0 +1,95 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MIMPLUGINMANIFEST_H
+#define MIMPLUGINMANIFEST_H
+
+#include <maliit/namespace.h>
+#include <maliit/plugins/abstractinputmethod.h>
+#include <maliit/plugins/inputmethodplugin.h>
+
+#include <QJsonObject>
+#include <QList>
+#include <QPluginLoader>
+#include <QSet>
+#include <QString>
+
+/*! \internal
+ * \brief What the plugin manager knows about a plugin without creating its input method.
+ *
+ * C++ plugins provide the manifest in the "MetaData" object of their
+ * Q_PLUGIN_METADATA json file, for example:
+ * \code
+ * {
+ *     "name": "ExamplePlugin",
+ *     "supportedStates": [ "OnScreen", "Hardware" ],
+ *     "subViews": [ { "id": "en_gb", "title": "English (UK)" } ],
+ *     "unloadable": true
+ * }
+ * \endcode
+ * \a subViews lists the on screen subviews. Plugins setting \a unloadable
+ * allow createInputMethod to be called again after the server deleted an
+ * idle input method.
+ */
+struct MImPluginManifest
+{
+    MImPluginManifest();
+
+    //! Reads the manifest from the meta data of a QPluginLoader
+    static MImPluginManifest fromMetaData(const QJsonObject &metaData);
+
+    //! Reads a manifest written by \a toJson or found in the plugin meta data
+    static MImPluginManifest fromJson(const QJsonObject &object);
+    QJsonObject toJson() const;
+
+    //! Returns true if the manifest has a name and at least one supported state
+    bool isValid() const;
+
+    QString name;
+    QSet<Maliit::HandlerState> supportedStates;
+    QList<MAbstractInputMethod::MInputMethodSubView> subViews;
+    bool unloadable;
+};
+
+/*! \internal
+ * \brief Stands in for a C++ plugin with a manifest until its input method is needed.
+ *
+ * The plugin library is loaded by the first call to createInputMethod and
+ * stays loaded afterwards. name and supportedStates are answered from the
+ * manifest.
+ */
+class MImManifestPlugin : public Maliit::Plugins::InputMethodPlugin
+{
+public:
+    MImManifestPlugin(const QString &fileName, const MImPluginManifest &manifest);
+    virtual ~MImManifestPlugin();
+
+    const MImPluginManifest &manifest() const;
+    QString fileName() const;
+
+    //! \reimp
+    virtual QString name() const;
+    virtual MAbstractInputMethod *createInputMethod(MAbstractInputMethodHost *host);
+    virtual QSet<Maliit::HandlerState> supportedStates() const;
+    //! \reimp_end
+
+private:
+    Q_DISABLE_COPY(MImManifestPlugin)
+
+    QPluginLoader mLoader;
+    const MImPluginManifest mManifest;
+    Maliit::Plugins::InputMethodPlugin *mPlugin;
+};
+
+#endif // MIMPLUGINMANIFEST_H
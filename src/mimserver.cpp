@@ -17,6 +17,13 @@
 #include "mimpluginmanager.h"
 #include "mimsettings.h"
 
+#include <QTimer>
+
+namespace {
+    // Requests are handled anyway if the active input method does not get ready
+    const int HeldRequestsTimeout = 5000; // in ms
+}
+
 class MImServerPrivate
 {
 public:
@@ -44,7 +51,20 @@ MImServer::MImServer(const QSharedPointer<MInputContextConnection> &icConnection
     Q_D(MImServer);
 
     d->icConnection = icConnection;
-    d->pluginManager = new MIMPluginManager(d->icConnection, platform);
+
+    // Applications connecting while the plugins are loaded are served once
+    // the active input method is ready
+    d->icConnection->holdRequests();
+    d->pluginManager = new MIMPluginManager(d->icConnection, platform,
+                                            MIMPluginManager::LoadActivePluginFirst);
+
+    if (d->pluginManager->isActivePluginReady()) {
+        d->icConnection->releaseRequests();
+    } else {
+        connect(d->pluginManager, SIGNAL(activePluginReady()),
+                d->icConnection.data(), SLOT(releaseRequests()));
+        QTimer::singleShot(HeldRequestsTimeout, d->icConnection.data(), SLOT(releaseRequests()));
+    }
 }
 
 MImServer::~MImServer()
@@ -31,7 +31,8 @@ namespace {
 
     CommandLineParameter AvailableConnectionParameters[] = {
         { "-allow-anonymous",   "Allow anonymous/unauthenticated use of DBus interface"},
-        { "-override-address",  "Override the DBus peer-to-peer address for input-context"}
+        { "-override-address",  "Override the DBus peer-to-peer address for input-context"},
+        { "-shared-memory-transport", "Send commit, preedit and key events to input-context through shared memory"}
     };
 
     struct IgnoredParameter {
@@ -291,7 +292,7 @@ MImServerCommonOptionsParser::MImServerCommonOptionsParser(MImServerCommonOption
 
 MImServerOptionsParserBase::ParsingResult
 MImServerCommonOptionsParser::parseParameter(const char *parameter,
-                                             const char *,
+                                             const char *next,
                                              int *argumentCount)
 {
     *argumentCount = 0;
@@ -302,12 +303,24 @@ MImServerCommonOptionsParser::parseParameter(const char *parameter,
         return Ok;
     }
 
+    if (!strcmp("-trace-file", parameter)) {
+        if (next) {
+            storage->traceFile = QString::fromLocal8Bit(next);
+            *argumentCount = 1;
+        } else {
+            fprintf(stderr, "ERROR: No argument passed to -trace-file\n");
+        }
+
+        return Ok;
+    }
+
     return Invalid;
 }
 
 void MImServerCommonOptionsParser::printAvailableOptions(const char *format)
 {
     fprintf(stderr, format, "-help", "Show usage information");
+    fprintf(stderr, format, "-trace-file FILE", "Append startup and show latency events to FILE (Chrome trace JSON)");
 }
 
 MImServerCommonOptions::MImServerCommonOptions()
@@ -354,6 +367,9 @@ MImServerConnectionOptionsParser::parseParameter(const char *parameter,
                     fprintf(stderr, "ERROR: No argument passed to -override-address\n");
                     *argumentCount = 0;
                 }
+            } else if (!strcmp(parameter, "-shared-memory-transport")) {
+                storage->sharedMemoryTransport = true;
+                *argumentCount = 0;
             } else {
                 fprintf(stderr, "ERROR: connection option %s declared but unhandled\n", parameter);
             }
@@ -378,6 +394,7 @@ void MImServerConnectionOptionsParser::printAvailableOptions(const char *format)
 }
 MImServerConnectionOptions::MImServerConnectionOptions()
     : allowAnonymous(false)
+    , sharedMemoryTransport(false)
 {
     const ParserBasePtr p(new MImServerConnectionOptionsParser(this));
     parsers.append(p);
@@ -40,6 +40,8 @@ public:
     //! Contains true if user asks for help or provided incorrect parameter
     bool allowAnonymous;
     QString overriddenAddress;
+    //! Offer input contexts a shared memory channel for commit, preedit and key events
+    bool sharedMemoryTransport;
 };
 
 
@@ -52,6 +54,8 @@ public:
 
     //! Contains true if user asks for help or provided incorrect parameter
     bool showHelp;
+    //! Chrome trace JSON file receiving show latency events, empty if disabled
+    QString traceFile;
 };
 
 //! \internal_end
@@ -32,9 +32,16 @@ MInputMethodHost::MInputMethodHost(const QSharedPointer<MInputContextConnection>
       enabled(false),
       pluginId(plugin),
       pluginDescription(description),
-      mWindowGroup(windowGroup)
+      mWindowGroup(windowGroup),
+      mKeyFilter(),
+      mEditorState(),
+      preeditRectangleRequested(false),
+      selectionRequested(false)
 {
-    // nothing
+    connect(connection.data(), SIGNAL(preeditRectangleReceived(QRect,bool)),
+            this, SLOT(handlePreeditRectangleReceived(QRect,bool)));
+    connect(connection.data(), SIGNAL(selectionReceived(QString,bool)),
+            this, SLOT(handleSelectionReceived(QString,bool)));
 }
 
 
@@ -54,6 +61,11 @@ void MInputMethodHost::setInputMethod(MAbstractInputMethod *inputMethod)
     this->inputMethod = inputMethod;
 }
 
+MImKeyFilter MInputMethodHost::keyFilter() const
+{
+    return mKeyFilter;
+}
+
 int MInputMethodHost::contentType(bool &valid)
 {
     return connection->contentType(valid);
@@ -89,6 +101,23 @@ QString MInputMethodHost::selection(bool &valid)
     return connection->selection(valid);
 }
 
+MImEditorStateSnapshot MInputMethodHost::editorState()
+{
+    // Built again only after the state changed, copies share the data
+    const quint64 generation = connection->editorStateGeneration();
+    if (generation != mEditorState.generation()) {
+        mEditorState = MImEditorStateSnapshot(connection->editorState(), generation);
+    }
+
+    return mEditorState;
+}
+
+void MInputMethodHost::requestSelection()
+{
+    selectionRequested = true;
+    connection->requestSelection();
+}
+
 void MInputMethodHost::registerWindow (QWindow *window,
                                        Maliit::Position position)
 {
@@ -110,6 +139,12 @@ QRect MInputMethodHost::preeditRectangle(bool &valid)
     return connection->preeditRectangle(valid);
 }
 
+void MInputMethodHost::requestPreeditRectangle()
+{
+    preeditRectangleRequested = true;
+    connection->requestPreeditRectangle();
+}
+
 QRect MInputMethodHost::cursorRectangle(bool &valid)
 {
     return connection->cursorRectangle(valid);
@@ -146,6 +181,26 @@ void MInputMethodHost::sendKeyEvent(const QKeyEvent &keyEvent,
     }
 }
 
+void MInputMethodHost::passThroughKeyEvent(const QKeyEvent &keyEvent)
+{
+    if (enabled) {
+        connection->passThroughKeyEvent(keyEvent);
+    }
+}
+
+void MInputMethodHost::setKeyFilter(const MImKeyFilter &filter)
+{
+    if (filter == mKeyFilter) {
+        return;
+    }
+
+    mKeyFilter = filter;
+
+    if (enabled && pluginManager) {
+        pluginManager->updateKeyFilter();
+    }
+}
+
 void MInputMethodHost::notifyImInitiatedHiding()
 {
     if (enabled) {
@@ -248,3 +303,20 @@ AbstractPluginSetting *MInputMethodHost::registerPluginSetting(const QString &ke
 {
     return pluginManager->registerPluginSetting(pluginId, pluginDescription, key, description, type, attributes);
 }
+
+void MInputMethodHost::handlePreeditRectangleReceived(const QRect &rectangle, bool valid)
+{
+    // The connection is shared by all hosts, answer only the one that asked
+    if (preeditRectangleRequested) {
+        preeditRectangleRequested = false;
+        Q_EMIT preeditRectangleReceived(rectangle, valid);
+    }
+}
+
+void MInputMethodHost::handleSelectionReceived(const QString &selection, bool valid)
+{
+    if (selectionRequested) {
+        selectionRequested = false;
+        Q_EMIT selectionReceived(selection, valid);
+    }
+}
@@ -16,6 +16,7 @@
 #define MINPUTMETHODHOST_H
 
 #include <maliit/plugins/abstractinputmethodhost.h>
+#include <maliit/keyfilter.h>
 
 class MInputContextConnection;
 class MIMPluginManager;
@@ -54,6 +55,9 @@ public:
     //! Multiple calls is (currently) undefined behavior.
     void setInputMethod(MAbstractInputMethod *inputMethod);
 
+    //! Key filter last set by the input method
+    MImKeyFilter keyFilter() const;
+
     // \reimp
     virtual int contentType(bool &valid);
     virtual bool correctionEnabled(bool &valid);
@@ -63,10 +67,13 @@ public:
     virtual bool hasSelection(bool &valid);
     virtual int inputMethodMode(bool &valid);
     virtual QRect preeditRectangle(bool &valid);
+    virtual void requestPreeditRectangle();
     virtual QRect cursorRectangle(bool &valid);
     virtual int anchorPosition(bool &valid);
     virtual bool hiddenText(bool &valid);
     virtual QString selection(bool &valid);
+    virtual MImEditorStateSnapshot editorState();
+    virtual void requestSelection();
     virtual void registerWindow (QWindow *window,
                                  Maliit::Position position);
     virtual void sendPreeditString(const QString &string,
@@ -78,6 +85,8 @@ public:
     virtual void sendKeyEvent(const QKeyEvent &keyEvent,
                               Maliit::EventRequestType requestType
                                = Maliit::EventRequestBoth);
+    virtual void passThroughKeyEvent(const QKeyEvent &keyEvent);
+    virtual void setKeyFilter(const MImKeyFilter &filter);
     virtual void notifyImInitiatedHiding();
     virtual void invokeAction(const QString &action,
                             const QKeySequence &sequence);
@@ -103,6 +112,10 @@ public:
                                                          const QVariantMap &attributes);
     // \reimp_end
 
+private Q_SLOTS:
+    void handlePreeditRectangleReceived(const QRect &rectangle, bool valid);
+    void handleSelectionReceived(const QString &selection, bool valid);
+
 private:
     Q_DISABLE_COPY(MInputMethodHost)
 
@@ -113,6 +126,13 @@ private:
     QString pluginId;
     QString pluginDescription;
     QSharedPointer<Maliit::WindowGroup> mWindowGroup;
+    MImKeyFilter mKeyFilter;
+    //! Snapshot last returned by editorState()
+    MImEditorStateSnapshot mEditorState;
+    //! Whether an answer to requestPreeditRectangle() is outstanding
+    bool preeditRectangleRequested;
+    //! Whether an answer to requestSelection() is outstanding
+    bool selectionRequested;
 };
 
 //! \internal_end
@@ -94,6 +94,18 @@ void MSharedAttributeExtensionManager::handleExtendedAttributeUpdate(unsigned in
     it->data()->setting.set(value);
 }
 
+void MSharedAttributeExtensionManager::handleExtendedAttributesUpdate(unsigned int clientId, int id,
+                                   const QString &target, const QString &targetName,
+                                   const QVariantMap &attributes)
+{
+    if (id != PluginSettings)
+        return;
+
+    for (QVariantMap::const_iterator i = attributes.constBegin(); i != attributes.constEnd(); ++i) {
+        handleExtendedAttributeUpdate(clientId, id, target, targetName, i.key(), i.value());
+    }
+}
+
 void MSharedAttributeExtensionManager::attributeValueChanged()
 {
     MImSettings *value = qobject_cast<MImSettings *>(sender());
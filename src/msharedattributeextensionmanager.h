@@ -55,6 +55,9 @@ public Q_SLOTS:
     void handleExtendedAttributeUpdate(unsigned int clientId, int id,
                                        const QString &target, const QString &targetName,
                                        const QString &attribute, const QVariant &value);
+    void handleExtendedAttributesUpdate(unsigned int clientId, int id,
+                                        const QString &target, const QString &targetName,
+                                        const QVariantMap &attributes);
 
 Q_SIGNALS:
     /*!
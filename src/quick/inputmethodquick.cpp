@@ -16,17 +16,22 @@
 
 #include "keyoverridequick.h"
 #include "maliitquick.h"
+#include "inputmethodquickengine.h"
 
 #include <maliit/plugins/abstractinputmethodhost.h>
 #include <maliit/plugins/keyoverride.h>
 
 #include "abstractplatform.h"
 
+#include <maliit/tracing.h>
+
 #include <QtCore>
 #include <QtGui>
 
+#include <QQmlComponent>
 #include <QQmlContext>
 #include <QQmlEngine>
+#include <QQuickItem>
 #include <QQuickView>
 
 namespace Maliit
@@ -39,7 +44,7 @@ const char * const actionKeyName = "actionKey";
 
 QQuickView *createWindow(MAbstractInputMethodHost *host)
 {
-    QScopedPointer<QQuickView> view(new QQuickView);
+    QScopedPointer<QQuickView> view(new QQuickView(InputMethodQuickEngine::instance()->engine(), 0));
 
     QSurfaceFormat format;
     format.setAlphaBufferSize(8);
@@ -59,7 +64,13 @@ class InputMethodQuickPrivate
 
 public:
     InputMethodQuick *const q_ptr;
+    //! own context below the shared engine's root context, must outlive the surface
+    QScopedPointer<QQmlContext> context;
     QScopedPointer<QQuickView> surface;
+    QPointer<QQmlComponent> component;
+    //! QML file of the component, acquired from the shared engine
+    QUrl componentUrl;
+    bool ready;
     QRect inputMethodArea;
     int appOrientation;
     bool haveFocus;
@@ -90,7 +101,11 @@ public:
                             InputMethodQuick *im,
                             const QSharedPointer<Maliit::AbstractPlatform> &platform)
         : q_ptr(im)
+        , context(new QQmlContext(InputMethodQuickEngine::instance()->engine()->rootContext()))
         , surface(createWindow(host))
+        , component()
+        , componentUrl()
+        , ready(false)
         , appOrientation(0)
         , haveFocus(false)
         , activeState(Maliit::OnScreen)
@@ -112,8 +127,7 @@ public:
         Q_ASSERT(surface);
 
         updateActionKey(MKeyOverride::All);
-        surface->engine()->addImportPath(MALIIT_PLUGINS_DATA_DIR);
-        surface->engine()->rootContext()->setContextProperty("MInputMethodQuick", im);
+        context->setContextProperty("MInputMethodQuick", im);
     }
 
     ~InputMethodQuickPrivate()
@@ -143,13 +157,74 @@ InputMethodQuick::InputMethodQuick(MAbstractInputMethodHost *host,
 {
     Q_D(InputMethodQuick);
 
-    d->surface->setSource(QUrl::fromLocalFile(qmlFileName));
-    
+    // compiling starts here unless another input method uses the same file
+    d->componentUrl = QUrl::fromLocalFile(qmlFileName);
+    d->component = InputMethodQuickEngine::instance()->acquireComponent(d->componentUrl);
+    if (d->component->isLoading()) {
+        connect(d->component.data(), SIGNAL(statusChanged(QQmlComponent::Status)),
+                this, SLOT(onComponentStatusChanged()));
+    } else {
+        onComponentStatusChanged();
+    }
+
     propagateScreenSize();
 }
 
 InputMethodQuick::~InputMethodQuick()
-{}
+{
+    Q_D(InputMethodQuick);
+
+    InputMethodQuickEngine::instance()->releaseComponent(d->componentUrl);
+}
+
+bool InputMethodQuick::isReady() const
+{
+    Q_D(const InputMethodQuick);
+    return d->ready;
+}
+
+void InputMethodQuick::onFrameSwapped()
+{
+    Q_D(InputMethodQuick);
+
+    // only the first frame after show() is of interest
+    disconnect(d->surface.data(), SIGNAL(frameSwapped()), this, SLOT(onFrameSwapped()));
+    Maliit::Tracing::event("QQuickView frameSwapped");
+}
+
+void InputMethodQuick::onComponentStatusChanged()
+{
+    Q_D(InputMethodQuick);
+
+    if (!d->component || d->component->isLoading() || d->ready) {
+        return;
+    }
+
+    disconnect(d->component.data(), 0, this, 0);
+
+    if (d->component->isError()) {
+        qWarning() << __PRETTY_FUNCTION__ << d->component->errors();
+        return;
+    }
+
+    QObject *rootObject = d->component->create(d->context.data());
+    if (!qobject_cast<QQuickItem *>(rootObject)) {
+        qWarning() << __PRETTY_FUNCTION__ << d->component->url()
+                   << "does not have an Item as root element";
+        delete rootObject;
+        return;
+    }
+
+    d->surface->setContent(d->component->url(), d->component.data(), rootObject);
+    d->ready = true;
+
+    Q_EMIT ready();
+
+    // show() was requested while the component was compiled
+    if (d->sipRequested) {
+        show();
+    }
+}
 
 void InputMethodQuick::handleFocusChange(bool focusIn)
 {
@@ -166,10 +241,20 @@ void InputMethodQuick::show()
         return;
     }
 
+    if (!d->ready) {
+        return;
+    }
+
+    Maliit::Tracing::event("InputMethodQuick show");
+
     handleAppOrientationChanged(d->appOrientation);
     
     if (d->activeState == Maliit::OnScreen) {
         d->surface->setGeometry(QRect(QPoint(), QGuiApplication::primaryScreen()->availableSize()));
+        if (Maliit::Tracing::isEnabled()) {
+            connect(d->surface.data(), SIGNAL(frameSwapped()),
+                    this, SLOT(onFrameSwapped()), Qt::UniqueConnection);
+        }
         d->surface->show();
         setActive(true);
     }
@@ -202,9 +287,16 @@ void InputMethodQuick::update()
     bool emitPredictionEnabled = false;
     bool emitHiddenText = false;
 
+    // One snapshot instead of a host call per property
+    const MImEditorStateSnapshot state(inputMethodHost()->editorState());
+
     QString newSurroundingText;
     int newCursorPosition = -1;
-    inputMethodHost()->surroundingText(newSurroundingText, newCursorPosition);
+    if (state.contains(MImUpdateEvent::SurroundingTextProperty)
+        && state.contains(MImUpdateEvent::CursorPositionProperty)) {
+        newSurroundingText = state.surroundingText();
+        newCursorPosition = state.cursorPosition();
+    }
 
     if (newSurroundingText != d->m_surroundingText) {
         d->m_surroundingText = newSurroundingText;
@@ -222,57 +314,41 @@ void InputMethodQuick::update()
         emitCursorPosition = true;
     }
 
-    bool valid;
-    int newAnchorPosition = inputMethodHost()->anchorPosition(valid);
-    if (!valid) {
-        newAnchorPosition = -1;
-    }
+    const int newAnchorPosition = state.contains(MImUpdateEvent::AnchorPositionProperty)
+                                  ? state.anchorPosition() : -1;
     if (newAnchorPosition != d->m_anchorPosition) {
         d->m_anchorPosition = newAnchorPosition;
         emitAnchorPosition = true;
     }
 
-    bool newHasSelection = inputMethodHost()->hasSelection(valid);
-    if (!valid) {
-        newHasSelection = false;
-    }
+    const bool newHasSelection = state.hasSelection();
     if (newHasSelection != d->m_hasSelection) {
         d->m_hasSelection = newHasSelection;
         emitSelection = true;
     }
 
-    int newContentType = inputMethodHost()->contentType(valid);
-    if (!valid) {
-        newContentType = MaliitQuick::FreeTextContentType;
-    }
-
+    const int newContentType = state.contains(MImUpdateEvent::ContentTypeProperty)
+                               ? state.contentType() : int(MaliitQuick::FreeTextContentType);
     if (newContentType != d->m_contentType) {
         d->m_contentType = newContentType;
         emitContentType = true;
     }
 
-    bool newAutoCapitalizationEnabled = inputMethodHost()->autoCapitalizationEnabled(valid);
-    if (!valid) {
-        newAutoCapitalizationEnabled = true;
-    }
+    const bool newAutoCapitalizationEnabled = state.contains(MImUpdateEvent::AutoCapitalizationProperty)
+                                              ? state.autoCapitalizationEnabled() : true;
     if (newAutoCapitalizationEnabled != d->m_autoCapitalizationEnabled) {
         d->m_autoCapitalizationEnabled = newAutoCapitalizationEnabled;
         emitAutoCapitalization = true;
     }
 
-    bool newPredictionEnabled = inputMethodHost()->predictionEnabled(valid);
-    if (!valid) {
-        newPredictionEnabled = true;
-    }
+    const bool newPredictionEnabled = state.contains(MImUpdateEvent::PredictionProperty)
+                                      ? state.predictionEnabled() : true;
     if (newPredictionEnabled != d->m_predictionEnabled) {
         d->m_predictionEnabled = newPredictionEnabled;
         emitPredictionEnabled = true;
     }
 
-    bool newHiddenText = inputMethodHost()->hiddenText(valid);
-    if (!valid) {
-        newHiddenText = false;
-    }
+    const bool newHiddenText = state.hiddenText();
     if (newHiddenText != d->m_hiddenText) {
         d->m_hiddenText = newHiddenText;
         emitHiddenText = true;
@@ -589,20 +665,24 @@ bool InputMethodQuick::surroundingTextValid()
 QString InputMethodQuick::surroundingText()
 {
     // Note: fetching value instead of using member variable for allowing connection side to
-    // modify text when sending commit.
-    QString text;
-    int position;
-    inputMethodHost()->surroundingText(text, position);
-    return text;
+    // modify text when sending commit. The snapshot is only built again after such a change.
+    const MImEditorStateSnapshot state(inputMethodHost()->editorState());
+    if (not state.contains(MImUpdateEvent::SurroundingTextProperty)
+        || not state.contains(MImUpdateEvent::CursorPositionProperty)) {
+        return QString();
+    }
+    return state.surroundingText();
 }
 
 int InputMethodQuick::cursorPosition()
 {
     // see ::surroundingText()
-    QString text;
-    int position;
-    inputMethodHost()->surroundingText(text, position);
-    return position;
+    const MImEditorStateSnapshot state(inputMethodHost()->editorState());
+    if (not state.contains(MImUpdateEvent::SurroundingTextProperty)
+        || not state.contains(MImUpdateEvent::CursorPositionProperty)) {
+        return -1;
+    }
+    return state.cursorPosition();
 }
 
 int InputMethodQuick::anchorPosition()
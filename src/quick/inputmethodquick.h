@@ -99,6 +99,10 @@ public:
     QList<MAbstractInputMethod::MInputMethodSubView> subViews(Maliit::HandlerState state) const;
     //! \reimp_end
 
+    //! Returns true once the QML file is compiled and its objects are created.
+    //! Until then show() only records the request.
+    bool isReady() const;
+
     //! Propagates screen size to QML components.
     void propagateScreenSize();
 
@@ -143,6 +147,9 @@ public:
     bool hiddenText();
 
 Q_SIGNALS:
+    //! Emitted when the QML objects have been created, see isReady().
+    void ready();
+
     //! Emitted when screen height changes.
     void screenHeightChanged(int height);
 
@@ -222,6 +229,12 @@ private:
 private Q_SLOTS:
     //! Propagates change to QML.
     void onSentActionKeyAttributesChanged(const QString &keyId, const MKeyOverride::KeyOverrideAttributes changedAttributes);
+
+    //! Creates the QML objects once the shared component is compiled.
+    void onComponentStatusChanged();
+
+    //! Records the first frame shown after show() when tracing.
+    void onFrameSwapped();
 };
 
 } // namespace Maliit
@@ -0,0 +1,79 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "inputmethodquickengine.h"
+
+#include <QDebug>
+#include <QQmlComponent>
+#include <QQmlEngine>
+
+namespace Maliit
+{
+
+InputMethodQuickEngine *InputMethodQuickEngine::instance()
+{
+    // never deleted, QML objects of input methods may outlive any other owner
+    static InputMethodQuickEngine *engine = new InputMethodQuickEngine;
+    return engine;
+}
+
+InputMethodQuickEngine::InputMethodQuickEngine()
+    : mEngine(new QQmlEngine)
+{
+    mEngine->addImportPath(MALIIT_PLUGINS_DATA_DIR);
+}
+
+InputMethodQuickEngine::~InputMethodQuickEngine()
+{}
+
+QQmlEngine *InputMethodQuickEngine::engine() const
+{
+    return mEngine.data();
+}
+
+QQmlComponent *InputMethodQuickEngine::acquireComponent(const QUrl &url)
+{
+    QHash<QUrl, SharedComponent>::iterator shared = mComponents.find(url);
+
+    if (shared == mComponents.end()) {
+        const SharedComponent created = {
+            new QQmlComponent(mEngine.data(), url, QQmlComponent::Asynchronous, mEngine.data()), 0
+        };
+        shared = mComponents.insert(url, created);
+    }
+
+    ++shared->users;
+    return shared->component.data();
+}
+
+void InputMethodQuickEngine::releaseComponent(const QUrl &url)
+{
+    QHash<QUrl, SharedComponent>::iterator shared = mComponents.find(url);
+    if (shared == mComponents.end()) {
+        qWarning() << __PRETTY_FUNCTION__ << url << "was not acquired";
+        return;
+    }
+
+    if (--shared->users > 0) {
+        return;
+    }
+
+    // the views of deleted input methods may still refer to it until they are gone
+    if (shared->component) {
+        shared->component->deleteLater();
+    }
+    mComponents.erase(shared);
+}
+
+} // namespace Maliit
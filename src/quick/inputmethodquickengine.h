@@ -0,0 +1,76 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2011 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef MALIIT_INPUT_METHOD_QUICK_ENGINE_H
+#define MALIIT_INPUT_METHOD_QUICK_ENGINE_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QScopedPointer>
+#include <QUrl>
+
+class QQmlComponent;
+class QQmlEngine;
+
+namespace Maliit
+{
+
+//! \internal
+//! \brief QML engine and compiled components shared by all QML based input methods.
+//!
+//! Every Maliit::InputMethodQuick creates its objects in its own context
+//! below the root context of the shared engine, so they do not see each
+//! other's context properties. Components are compiled asynchronously and
+//! shared by the input methods using the same QML file, they are dropped
+//! once the last of them is deleted, for example when its plugin is
+//! unloaded. Compiled QML is additionally cached on disk by the engine
+//! (Qt 5.8 and later, see QML_DISK_CACHE_PATH).
+//!
+//! The engine is created on first use and lives until the process exits.
+class InputMethodQuickEngine
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    static InputMethodQuickEngine *instance();
+
+    QQmlEngine *engine() const;
+
+    //! Returns the component for \a url. It is compiled asynchronously on
+    //! first use, check QQmlComponent::isLoading before creating objects.
+    //! Every call must be matched by a call to releaseComponent().
+    QQmlComponent *acquireComponent(const QUrl &url);
+
+    //! Deletes the component for \a url once it is released as often as acquired
+    void releaseComponent(const QUrl &url);
+
+private:
+    InputMethodQuickEngine();
+    virtual ~InputMethodQuickEngine();
+    Q_DISABLE_COPY(InputMethodQuickEngine)
+
+    struct SharedComponent {
+        QPointer<QQmlComponent> component;
+        int users;
+    };
+
+    const QScopedPointer<QQmlEngine> mEngine;
+    QHash<QUrl, SharedComponent> mComponents;
+};
+
+} // namespace Maliit
+
+#endif // MALIIT_INPUT_METHOD_QUICK_ENGINE_H
@@ -17,6 +17,7 @@ PLUGIN_HEADERS_PUBLIC = \
         maliit/plugins/extensionevent.h \
         maliit/plugins/updateevent.h \
         maliit/plugins/updatereceiver.h \
+        maliit/plugins/editorstatesnapshot.h \
         maliit/plugins/plugindescription.h \
         maliit/plugins/subviewdescription.h \
         maliit/plugins/abstractpluginsetting.h \
@@ -30,6 +31,7 @@ PLUGIN_SOURCES += \
         maliit/plugins/extensionevent.cpp \
         maliit/plugins/updateevent.cpp \
         maliit/plugins/updatereceiver.cpp \
+        maliit/plugins/editorstatesnapshot.cpp \
         maliit/plugins/plugindescription.cpp \
         maliit/plugins/subviewdescription.cpp \
 
@@ -48,6 +50,9 @@ SERVER_SOURCES += \
 SERVER_HEADERS_PRIVATE += \
         mimpluginmanager.h \
         mimpluginmanager_p.h \
+        mimpluginmanifest.h \
+        mimplugincache.h \
+        mimpluginlibraryloader.h \
         minputmethodhost.h \
         mattributeextensionid.h \
         mattributeextensionmanager.h \
@@ -63,6 +68,9 @@ SERVER_HEADERS_PRIVATE += \
 
 SERVER_SOURCES += \
         mimpluginmanager.cpp \
+        mimpluginmanifest.cpp \
+        mimplugincache.cpp \
+        mimpluginlibraryloader.cpp \
         minputmethodhost.cpp \
         mattributeextensionid.cpp \
         mattributeextensionmanager.cpp \
@@ -98,12 +106,14 @@ QUICK_HEADERS_PRIVATE += \
         quick/maliitquick.h \
         quick/inputmethodquick.h \
         quick/inputmethodquickplugin.h \
+        quick/inputmethodquickengine.h \
         quick/keyoverridequick.h \
         quick/keyoverridequick_p.h \
 
 QUICK_SOURCES += \
         quick/inputmethodquick.cpp \
         quick/inputmethodquickplugin.cpp \
+        quick/inputmethodquickengine.cpp \
         quick/keyoverridequick.cpp \
 
 !nohwkeyboard {
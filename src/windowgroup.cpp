@@ -16,6 +16,8 @@
 #include "abstractplatform.h"
 #include "windowgroup.h"
 
+#include <maliit/tracing.h>
+
 namespace Maliit
 {
 
@@ -147,6 +149,7 @@ void WindowGroup::updateInputMethodArea()
 
     if (new_area != m_last_im_area) {
         m_last_im_area = new_area;
+        Maliit::Tracing::event("WindowGroup inputMethodAreaChanged");
         Q_EMIT inputMethodAreaChanged(m_last_im_area);
     }
 }
@@ -0,0 +1,347 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "bench_keystrokelatency.h"
+#include "core-utils.h"
+
+#include <connectionfactory.h>
+#include <dbusserverconnection.h>
+#include <inputcontextdbusaddress.h>
+#include <mimserver.h>
+#include <mimsettings.h>
+#include <unknownplatform.h>
+
+#include <QEventLoop>
+#include <QJsonDocument>
+
+#include <algorithm>
+
+namespace {
+    const QString ConfigRoot        = MALIIT_CONFIG_ROOT;
+    const QString MImPluginPaths    = ConfigRoot + "paths";
+    const QString MImPluginDisabled = ConfigRoot + "disabledpluginfiles";
+    const QString EnabledPluginsKey = MALIIT_CONFIG_ROOT"onscreen/enabled";
+    const QString ActivePluginKey   = MALIIT_CONFIG_ROOT"onscreen/active";
+
+    const QString EchoPlugin = "libechoimplugin.so:echo";
+
+    const QStringList OtherTestPlugins = QStringList()
+                                         << "libdummyimplugin.so"
+                                         << "libdummyimplugin2.so"
+                                         << "libdummyimplugin3.so"
+                                         << "libdummyplugin.so";
+
+    const int DefaultIterations = 200;
+    const int ReplyTimeout = 5000; // in ms
+    const int ConnectionTimeout = 10000; // in ms
+
+    int iterationsFromEnvironment()
+    {
+        bool ok = false;
+        const int iterations = qgetenv("MALIIT_BENCHMARK_ITERATIONS").toInt(&ok);
+        return (ok && iterations > 0) ? iterations : DefaultIterations;
+    }
+
+    //! Nearest rank percentile of sorted \a samples
+    qint64 percentile(const QList<qint64> &samples, int percent)
+    {
+        const int rank = (samples.size() * percent + 99) / 100;
+        return samples.at(qBound(0, rank - 1, samples.size() - 1));
+    }
+
+    double toMicroseconds(qint64 nsecs)
+    {
+        return nsecs / 1000.0;
+    }
+
+    QVariantMap widgetState(const QString &surroundingText, int cursorPosition)
+    {
+        QVariantMap state;
+        state["focusState"] = true;
+        state["contentType"] = Maliit::FreeTextContentType;
+        state["surroundingText"] = surroundingText;
+        state["cursorPosition"] = cursorPosition;
+        state["anchorPosition"] = cursorPosition;
+        state["hasSelection"] = false;
+        return state;
+    }
+}
+
+void Bench_KeystrokeLatency::initTestCase()
+{
+    MImSettings::setPreferredSettingsType(MImSettings::TemporarySettings);
+
+    MImSettings(MImPluginPaths).set(MaliitTestUtils::getTestPluginPath());
+    MImSettings(MImPluginDisabled).set(OtherTestPlugins);
+    MImSettings(EnabledPluginsKey).set(QStringList() << EchoPlugin);
+    MImSettings(ActivePluginKey).set(EchoPlugin);
+
+    iterations = iterationsFromEnvironment();
+    replies = 0;
+    expectedReplies = 0;
+    lastReplyTime = 0;
+    replyLoop = 0;
+
+    const bool sharedMemory = qgetenv("MALIIT_BENCHMARK_SHARED_MEMORY") == "1";
+    transport = sharedMemory ? "sharedmemory" : "dbus";
+
+    const QString outputFile = QString::fromLocal8Bit(qgetenv("MALIIT_BENCHMARK_OUTPUT"));
+    if (outputFile.isEmpty()) {
+        QVERIFY(output.open(stdout, QIODevice::WriteOnly));
+    } else {
+        output.setFileName(outputFile);
+        QVERIFY2(output.open(QIODevice::WriteOnly | QIODevice::Append),
+                 qPrintable(output.errorString()));
+    }
+
+    QVERIFY(socketDir.isValid());
+    const QString address = "unix:path=" + socketDir.path() + "/maliit-server";
+
+    QSharedPointer<MInputContextConnection> icConnection(
+        Maliit::DBus::createInputContextConnectionWithFixedAddress(address, false, sharedMemory));
+    server = QSharedPointer<MImServer>(
+        new MImServer(icConnection, QSharedPointer<Maliit::AbstractPlatform>(new Maliit::UnknownPlatform)));
+
+    QSharedPointer<Maliit::InputContext::DBus::Address> clientAddress(
+        new Maliit::InputContext::DBus::FixedAddress(address));
+    client = new DBusServerConnection(clientAddress);
+
+    QSignalSpy connectedSpy(client, SIGNAL(connected()));
+    QVERIFY(connectedSpy.wait(ConnectionTimeout));
+
+    connect(client, SIGNAL(commitString(QString,int,int,int)),
+            this, SLOT(onCommitString(QString)));
+    connect(client, SIGNAL(updatePreedit(QString,QList<Maliit::PreeditTextFormat>,int,int,int)),
+            this, SLOT(onUpdatePreedit(QString)));
+
+    client->activateContext();
+    client->updateWidgetInformation(widgetState(QString(), 0), true);
+
+    clock.start();
+
+    // Warm up the whole path once before measuring.
+    QVERIFY(sendKeyAndWait("a") >= 0);
+}
+
+void Bench_KeystrokeLatency::cleanupTestCase()
+{
+    delete client;
+    client = 0;
+    server.clear();
+    output.close();
+}
+
+void Bench_KeystrokeLatency::onCommitString(const QString &string)
+{
+    lastReplyTime = clock.nsecsElapsed();
+    lastReply = string;
+    ++replies;
+
+    const bool done = expectedReply.isNull() ? replies >= expectedReplies
+                                             : string == expectedReply;
+    if (replyLoop && done) {
+        replyLoop->quit();
+    }
+}
+
+void Bench_KeystrokeLatency::onUpdatePreedit(const QString &string)
+{
+    onCommitString(string);
+}
+
+bool Bench_KeystrokeLatency::waitForReplies(int count)
+{
+    if (replies >= count) {
+        return true;
+    }
+
+    QEventLoop loop;
+    QTimer::singleShot(ReplyTimeout, &loop, SLOT(quit()));
+
+    expectedReplies = count;
+    replyLoop = &loop;
+    loop.exec();
+    replyLoop = 0;
+
+    return replies >= count;
+}
+
+bool Bench_KeystrokeLatency::waitForReply(const QString &reply)
+{
+    if (lastReply == reply) {
+        return true;
+    }
+
+    QEventLoop loop;
+    QTimer::singleShot(ReplyTimeout, &loop, SLOT(quit()));
+
+    expectedReply = reply;
+    replyLoop = &loop;
+    loop.exec();
+    replyLoop = 0;
+    expectedReply = QString();
+
+    return lastReply == reply;
+}
+
+qint64 Bench_KeystrokeLatency::sendKeyAndWait(const QString &text)
+{
+    const int expected = replies + 1;
+    const qint64 start = clock.nsecsElapsed();
+
+    client->processKeyEvent(QEvent::KeyPress, Qt::Key_A, Qt::NoModifier, text,
+                            false, 1, 0, 0, 0, 0);
+    if (!waitForReplies(expected)) {
+        return -1;
+    }
+    const qint64 end = lastReplyTime;
+
+    client->processKeyEvent(QEvent::KeyRelease, Qt::Key_A, Qt::NoModifier, text,
+                            false, 1, 0, 0, 0, 0);
+    return end - start;
+}
+
+void Bench_KeystrokeLatency::writeResult(const QJsonObject &result)
+{
+    QJsonObject line(result);
+    line["transport"] = transport;
+    output.write(QJsonDocument(line).toJson(QJsonDocument::Compact));
+    output.write("\n");
+    output.flush();
+}
+
+QJsonObject Bench_KeystrokeLatency::latencyResult(const QString &name, QList<qint64> samples) const
+{
+    std::sort(samples.begin(), samples.end());
+
+    qint64 total = 0;
+    Q_FOREACH (qint64 sample, samples) {
+        total += sample;
+    }
+
+    QJsonObject result;
+    result["benchmark"] = name;
+    result["samples"] = samples.size();
+    result["unit"] = QString("us");
+    result["min"] = toMicroseconds(samples.first());
+    result["mean"] = toMicroseconds(total / samples.size());
+    result["p50"] = toMicroseconds(percentile(samples, 50));
+    result["p90"] = toMicroseconds(percentile(samples, 90));
+    result["p99"] = toMicroseconds(percentile(samples, 99));
+    result["max"] = toMicroseconds(samples.last());
+    return result;
+}
+
+void Bench_KeystrokeLatency::benchKeystrokeLatency()
+{
+    QList<qint64> samples;
+
+    for (int i = 0; i < iterations; ++i) {
+        const qint64 latency = sendKeyAndWait(QString(QChar('a' + i % 26)));
+        QVERIFY2(latency >= 0, "no commitString received for key press");
+        QCOMPARE(lastReply, QString(QChar('a' + i % 26)));
+        samples.append(latency);
+    }
+
+    writeResult(latencyResult("keystroke_latency", samples));
+}
+
+void Bench_KeystrokeLatency::benchWidgetInformationThroughput_data()
+{
+    QTest::addColumn<int>("textLength");
+
+    QTest::newRow("empty") << 0;
+    QTest::newRow("64") << 64;
+    QTest::newRow("1k") << 1024;
+    QTest::newRow("16k") << 16 * 1024;
+    QTest::newRow("64k") << 64 * 1024;
+}
+
+void Bench_KeystrokeLatency::benchWidgetInformationThroughput()
+{
+    QFETCH(int, textLength);
+
+    QString text(textLength, QChar('x'));
+    client->updateWidgetInformation(widgetState(text, 0), false);
+    QVERIFY(sendKeyAndWait("a") >= 0);
+
+    const qint64 start = clock.nsecsElapsed();
+
+    // Change one character per update so every update carries the text.
+    for (int i = 0; i < iterations; ++i) {
+        const int position = textLength > 0 ? i % textLength : 0;
+        if (textLength > 0) {
+            text[position] = QChar('a' + i % 26);
+        }
+        client->updateWidgetInformation(widgetState(text, position), false);
+    }
+
+    // D-Bus keeps the order of calls, so the echo of this key press arrives
+    // only after the server has handled all updates above.
+    QVERIFY(sendKeyAndWait("a") >= 0);
+    const qint64 elapsed = lastReplyTime - start;
+
+    QJsonObject result;
+    result["benchmark"] = QString("widget_information_throughput");
+    result["textLength"] = textLength;
+    result["updates"] = iterations;
+    result["elapsedUs"] = toMicroseconds(elapsed);
+    result["updatesPerSecond"] = iterations * 1e9 / qMax<qint64>(elapsed, 1);
+    writeResult(result);
+}
+
+void Bench_KeystrokeLatency::benchPreeditLatency()
+{
+    QList<qint64> samples;
+
+    for (int i = 0; i < iterations; ++i) {
+        const QString preedit = QString("preedit%1").arg(i);
+        const int expected = replies + 1;
+        const qint64 start = clock.nsecsElapsed();
+
+        client->setPreedit(preedit, preedit.length());
+        QVERIFY2(waitForReplies(expected), "no updatePreedit received");
+        QCOMPARE(lastReply, preedit);
+        samples.append(lastReplyTime - start);
+    }
+
+    writeResult(latencyResult("preedit_latency", samples));
+}
+
+void Bench_KeystrokeLatency::benchPreeditRate()
+{
+    const int firstReply = replies;
+    const QString last = QString("preedit%1").arg(iterations - 1);
+    const qint64 start = clock.nsecsElapsed();
+
+    for (int i = 0; i < iterations; ++i) {
+        const QString preedit = QString("preedit%1").arg(i);
+        client->setPreedit(preedit, preedit.length());
+    }
+
+    // Superseded preedits are dropped by the server when they are sent in one
+    // batch, so only the last one is sure to arrive.
+    QVERIFY2(waitForReply(last), "last updatePreedit not received");
+    const qint64 elapsed = lastReplyTime - start;
+
+    QJsonObject result;
+    result["benchmark"] = QString("preedit_rate");
+    result["updates"] = iterations;
+    result["replies"] = replies - firstReply;
+    result["elapsedUs"] = toMicroseconds(elapsed);
+    result["updatesPerSecond"] = iterations * 1e9 / qMax<qint64>(elapsed, 1);
+    writeResult(result);
+}
+
+QTEST_MAIN(Bench_KeystrokeLatency)
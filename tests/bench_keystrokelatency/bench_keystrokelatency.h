@@ -0,0 +1,86 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef BENCH_KEYSTROKELATENCY_H
+#define BENCH_KEYSTROKELATENCY_H
+
+#include <QtTest/QtTest>
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <maliit/namespace.h>
+
+class DBusServerConnection;
+class MImServer;
+class QEventLoop;
+
+/*!
+ * \brief End to end benchmark of the server with a headless client.
+ *
+ * Runs MImServer on a fixed D-Bus address in this process and talks to it
+ * through DBusServerConnection, the transport used by the input context.
+ * The only loaded plugin is EchoImPlugin, which answers key presses with
+ * commitString and preedit requests with updatePreedit, so each reply marks
+ * the end of one round trip.
+ *
+ * Results are written as one JSON object per line to the file named by
+ * MALIIT_BENCHMARK_OUTPUT, or to standard output. MALIIT_BENCHMARK_ITERATIONS
+ * overrides the number of samples per measurement and setting
+ * MALIIT_BENCHMARK_SHARED_MEMORY to 1 enables the shared memory transport.
+ */
+class Bench_KeystrokeLatency : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchKeystrokeLatency();
+    void benchWidgetInformationThroughput_data();
+    void benchWidgetInformationThroughput();
+    void benchPreeditLatency();
+    void benchPreeditRate();
+
+    void onCommitString(const QString &string);
+    void onUpdatePreedit(const QString &string);
+
+private:
+    bool waitForReplies(int count);
+    bool waitForReply(const QString &reply);
+    qint64 sendKeyAndWait(const QString &text);
+    void writeResult(const QJsonObject &result);
+    QJsonObject latencyResult(const QString &name, QList<qint64> samples) const;
+
+    QTemporaryDir socketDir;
+    QSharedPointer<MImServer> server;
+    DBusServerConnection *client;
+    QElapsedTimer clock;
+    QFile output;
+    QString transport;
+    int iterations;
+
+    int replies;
+    int expectedReplies;
+    //! Reply waitForReply() waits for, null when waiting for a count
+    QString expectedReply;
+    qint64 lastReplyTime;
+    QString lastReply;
+    QEventLoop *replyLoop;
+};
+
+#endif // BENCH_KEYSTROKELATENCY_H
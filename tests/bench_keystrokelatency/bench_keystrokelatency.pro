@@ -0,0 +1,15 @@
+include(../common_top.pri)
+
+QT += gui dbus
+
+# Input
+HEADERS += \
+    bench_keystrokelatency.h \
+
+SOURCES += \
+    bench_keystrokelatency.cpp \
+
+include($$TOP_DIR/src/libmaliit-plugins.pri)
+include($$TOP_DIR/connection/libmaliit-connection.pri)
+
+include(../common_check.pri)
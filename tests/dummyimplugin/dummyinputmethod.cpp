@@ -3,6 +3,7 @@
 #include <QTimer>
 
 #include <maliit/plugins/abstractinputmethodhost.h>
+#include <maliit/plugins/updateevent.h>
 
 DummyInputMethod::DummyInputMethod(MAbstractInputMethodHost *host)
     : MAbstractInputMethod(host),
@@ -10,7 +11,8 @@ DummyInputMethod::DummyInputMethod(MAbstractInputMethodHost *host)
       switchContextCallCount(0),
       directionParam(Maliit::SwitchUndefined),
       enableAnimationParam(false),
-      pluginsChangedSignalCount(0)
+      pluginsChangedSignalCount(0),
+      updateCount(0)
 {
     MAbstractInputMethod::MInputMethodSubView sv1;
     sv1.subViewId = "dummyimsv1";
@@ -59,6 +61,26 @@ void DummyInputMethod::onPluginsChange()
     ++pluginsChangedSignalCount;
 }
 
+void DummyInputMethod::update()
+{
+    ++updateCount;
+}
+
+void DummyInputMethod::handleFocusChange(bool focusIn)
+{
+    focusChanges.append(focusIn);
+}
+
+bool DummyInputMethod::imExtensionEvent(MImExtensionEvent *event)
+{
+    if (event->type() == MImExtensionEvent::Update) {
+        changedProperties = static_cast<MImUpdateEvent *>(event)->propertiesChanged();
+        return true;
+    }
+
+    return false;
+}
+
 void DummyInputMethod::switchContext(Maliit::SwitchDirection direction, bool enableAnimation)
 {
     ++switchContextCallCount;
@@ -3,6 +3,7 @@
 
 #include <maliit/plugins/abstractinputmethod.h>
 #include <QSet>
+#include <QStringList>
 
 class DummyInputMethod : public MAbstractInputMethod
 {
@@ -21,6 +22,9 @@ public:
     virtual void setActiveSubView(const QString &,
                                   Maliit::HandlerState state = Maliit::OnScreen);
     virtual QString activeSubView(Maliit::HandlerState state = Maliit::OnScreen) const;
+    virtual void update();
+    virtual void handleFocusChange(bool focusIn);
+    virtual bool imExtensionEvent(MImExtensionEvent *event);
     //! \reimp_end
 
 public:
@@ -33,6 +37,10 @@ public:
 
     int pluginsChangedSignalCount;
 
+    int updateCount;
+    QList<bool> focusChanges;
+    QStringList changedProperties;
+
 public Q_SLOTS:
     void switchMe();
     void switchMe(const QString &name);
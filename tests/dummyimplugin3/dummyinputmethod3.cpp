@@ -15,6 +15,7 @@ void DummyInputMethod3::addSubView(const QString &id, const QString &title)
 DummyInputMethod3::DummyInputMethod3(MAbstractInputMethodHost *host)
     : MAbstractInputMethod(host),
       setStateCount(0),
+      setKeyOverridesCount(0),
       switchContextCallCount(0),
       directionParam(Maliit::SwitchUndefined),
       enableAnimationParam(false)
@@ -92,6 +93,12 @@ void DummyInputMethod3::show()
     Q_EMIT showCalled();
 }
 
+void DummyInputMethod3::setKeyOverrides(const QMap<QString, QSharedPointer<MKeyOverride> > &overrides)
+{
+    Q_UNUSED(overrides);
+    ++setKeyOverridesCount;
+}
+
 void DummyInputMethod3::handleSettingChanged()
 {
     localSettingValue = setting->value();
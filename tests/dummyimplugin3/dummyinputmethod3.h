@@ -22,12 +22,15 @@ public:
                                   Maliit::HandlerState state = Maliit::OnScreen);
     virtual QString activeSubView(Maliit::HandlerState state = Maliit::OnScreen) const;
     virtual void show();
+    virtual void setKeyOverrides(const QMap<QString, QSharedPointer<MKeyOverride> > &overrides);
     //! \reimp_end
 
 public:
     int setStateCount;
     QSet<Maliit::HandlerState> setStateParam;
 
+    int setKeyOverridesCount;
+
     int switchContextCallCount;
     Maliit::SwitchDirection directionParam;
     bool enableAnimationParam;
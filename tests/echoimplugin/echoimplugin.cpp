@@ -0,0 +1,26 @@
+#include "echoimplugin.h"
+#include "echoinputmethod.h"
+
+EchoImPlugin::EchoImPlugin()
+{
+}
+
+QString EchoImPlugin::name() const
+{
+    return "EchoImPlugin";
+}
+
+MAbstractInputMethod *
+EchoImPlugin::createInputMethod(MAbstractInputMethodHost *host)
+{
+    return new EchoInputMethod(host);
+}
+
+QSet<Maliit::HandlerState> EchoImPlugin::supportedStates() const
+{
+    return QSet<Maliit::HandlerState>() << Maliit::OnScreen << Maliit::Hardware;
+}
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+Q_EXPORT_PLUGIN2(echoimplugin, EchoImPlugin)
+#endif
@@ -0,0 +1,31 @@
+#ifndef ECHOIMPLUGIN_H
+#define ECHOIMPLUGIN_H
+
+#include <QObject>
+
+#include <maliit/plugins/inputmethodplugin.h>
+
+//! Deterministic echo input method plugin for bench_keystrokelatency
+class EchoImPlugin: public QObject,
+    public Maliit::Plugins::InputMethodPlugin
+{
+    Q_OBJECT
+    Q_INTERFACES(Maliit::Plugins::InputMethodPlugin)
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    Q_PLUGIN_METADATA(IID  "org.maliit.tests.echoimplugin"
+                      FILE "echoimplugin.json")
+#endif
+
+public:
+    EchoImPlugin();
+
+    //! \reimp
+    virtual QString name() const;
+
+    virtual MAbstractInputMethod *createInputMethod(MAbstractInputMethodHost *host);
+
+    virtual QSet<Maliit::HandlerState> supportedStates() const;
+    //! \reimp_end
+};
+
+#endif
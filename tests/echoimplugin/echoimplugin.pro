@@ -0,0 +1,40 @@
+include(../../config.pri)
+
+TOP_DIR = ../..
+
+TEMPLATE = lib
+TARGET = ../plugins/echoimplugin
+DEPENDPATH += .
+
+include($$TOP_DIR/common/libmaliit-common.pri)
+include($$TOP_DIR/src/libmaliit-plugins.pri)
+
+CONFIG += plugin
+
+HEADERS += \
+    echoimplugin.h \
+    echoinputmethod.h \
+
+SOURCES += \
+    echoimplugin.cpp \
+    echoinputmethod.cpp \
+
+OTHER_FILES += echoimplugin.json
+
+target.path += $$MALIIT_TEST_LIBDIR/plugins
+
+INSTALLS += target
+
+QMAKE_CLEAN += ../plugins/libechoimplugin.so
+
+QMAKE_EXTRA_TARGETS += check
+check.target = check
+check.command = $$system(true)
+
+QMAKE_EXTRA_TARGETS += check-xml
+check-xml.target = check-xml
+check-xml.command = $$system(true)
+
+QMAKE_EXTRA_TARGETS += memcheck
+memcheck.target = memcheck
+memcheck.command = $$system(true)
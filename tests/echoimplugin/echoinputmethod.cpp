@@ -0,0 +1,63 @@
+#include "echoinputmethod.h"
+
+#include <maliit/plugins/abstractinputmethodhost.h>
+
+namespace {
+    const char * const EchoSubViewId = "echo";
+}
+
+EchoInputMethod::EchoInputMethod(MAbstractInputMethodHost *host)
+    : MAbstractInputMethod(host)
+{
+}
+
+void EchoInputMethod::setPreedit(const QString &preeditString, int cursorPos)
+{
+    QList<Maliit::PreeditTextFormat> formats;
+    formats << Maliit::PreeditTextFormat(0, preeditString.length(), Maliit::PreeditDefault);
+
+    inputMethodHost()->sendPreeditString(preeditString, formats, 0, 0, cursorPos);
+}
+
+void EchoInputMethod::processKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
+                                      Qt::KeyboardModifiers modifiers, const QString &text,
+                                      bool autoRepeat, int count, quint32 nativeScanCode,
+                                      quint32 nativeModifiers, unsigned long time)
+{
+    Q_UNUSED(keyCode);
+    Q_UNUSED(modifiers);
+    Q_UNUSED(autoRepeat);
+    Q_UNUSED(count);
+    Q_UNUSED(nativeScanCode);
+    Q_UNUSED(nativeModifiers);
+    Q_UNUSED(time);
+
+    if (keyType == QEvent::KeyPress && !text.isEmpty()) {
+        inputMethodHost()->sendCommitString(text);
+    }
+}
+
+QList<MAbstractInputMethod::MInputMethodSubView>
+EchoInputMethod::subViews(Maliit::HandlerState state) const
+{
+    QList<MAbstractInputMethod::MInputMethodSubView> svs;
+    if (state == Maliit::OnScreen) {
+        MAbstractInputMethod::MInputMethodSubView sv;
+        sv.subViewId = EchoSubViewId;
+        sv.subViewTitle = EchoSubViewId;
+        svs.append(sv);
+    }
+    return svs;
+}
+
+void EchoInputMethod::setActiveSubView(const QString &, Maliit::HandlerState)
+{
+}
+
+QString EchoInputMethod::activeSubView(Maliit::HandlerState state) const
+{
+    if (state == Maliit::OnScreen)
+        return EchoSubViewId;
+    else
+        return QString();
+}
@@ -0,0 +1,33 @@
+#ifndef ECHOINPUTMETHOD_H
+#define ECHOINPUTMETHOD_H
+
+#include <maliit/plugins/abstractinputmethod.h>
+
+/*!
+ * \brief Input method answering every request with a fixed reply.
+ *
+ * Key presses carrying text are committed as they are and preedit set by the
+ * application is sent back unchanged. The replies do not depend on timing or
+ * earlier input, which makes the plugin usable as a reference keyboard for
+ * measuring the round trip through server and connection.
+ */
+class EchoInputMethod: public MAbstractInputMethod
+{
+public:
+    explicit EchoInputMethod(MAbstractInputMethodHost *host);
+
+    //! \reimp
+    virtual void setPreedit(const QString &preeditString, int cursorPos);
+    virtual void processKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
+                                 Qt::KeyboardModifiers modifiers, const QString &text,
+                                 bool autoRepeat, int count, quint32 nativeScanCode,
+                                 quint32 nativeModifiers, unsigned long time);
+    virtual QList<MAbstractInputMethod::MInputMethodSubView> subViews(Maliit::HandlerState state
+                                                                   = Maliit::OnScreen) const;
+    virtual void setActiveSubView(const QString &,
+                                  Maliit::HandlerState state = Maliit::OnScreen);
+    virtual QString activeSubView(Maliit::HandlerState state = Maliit::OnScreen) const;
+    //! \reimp_end
+};
+
+#endif
@@ -0,0 +1,169 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+#ifndef WAYLANDCLIENT_STUB_H
+#define WAYLANDCLIENT_STUB_H
+
+#include <wayland-client.h>
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+
+/**
+ * Replaces the proxy functions of libwayland-client, so that Wayland
+ * clients can be tested without a compositor. Include this file in
+ * exactly one source file of the test.
+ *
+ * No proxy is backed by a connection. Requests are recorded in
+ * gWaylandRequests, new objects in gWaylandObjects. Events are sent by
+ * calling the listener recorded for a proxy in gWaylandListeners.
+ */
+struct WaylandRequestStub
+{
+    wl_proxy *proxy;
+    uint32_t opcode;
+};
+
+struct WaylandListenerStub
+{
+    const void *implementation;
+    void *data;
+};
+
+QList<WaylandRequestStub> gWaylandRequests;
+QList<QPair<wl_proxy *, const wl_interface *> > gWaylandObjects;
+QHash<wl_proxy *, WaylandListenerStub> gWaylandListeners;
+
+namespace {
+    char gWaylandProxyStorage[1024];
+    int gWaylandProxyCount = 0;
+
+    void recordWaylandRequest(wl_proxy *proxy, uint32_t opcode)
+    {
+        WaylandRequestStub request = { proxy, opcode };
+        gWaylandRequests.append(request);
+    }
+}
+
+//! Returns a proxy that is distinct from all other ones
+wl_proxy *newWaylandProxy(const wl_interface *interface = 0)
+{
+    Q_ASSERT(gWaylandProxyCount < int(sizeof(gWaylandProxyStorage)));
+    wl_proxy *proxy = reinterpret_cast<wl_proxy *>(&gWaylandProxyStorage[gWaylandProxyCount++]);
+    gWaylandObjects.append(qMakePair(proxy, interface));
+    return proxy;
+}
+
+//! Returns the last proxy created for \a interface, 0 if there is none
+wl_proxy *lastWaylandObject(const wl_interface *interface)
+{
+    for (int i = gWaylandObjects.count() - 1; i >= 0; --i) {
+        if (gWaylandObjects.at(i).second == interface) {
+            return gWaylandObjects.at(i).first;
+        }
+    }
+    return 0;
+}
+
+//! Returns the listener of \a proxy as the listener struct of its interface
+template <typename Listener>
+const Listener *waylandListener(wl_proxy *proxy)
+{
+    return static_cast<const Listener *>(gWaylandListeners.value(proxy).implementation);
+}
+
+//! Returns the data passed together with the listener of \a proxy
+void *waylandListenerData(wl_proxy *proxy)
+{
+    return gWaylandListeners.value(proxy).data;
+}
+
+//! Forgets all proxies, listeners and requests
+void resetWaylandStub()
+{
+    gWaylandRequests.clear();
+    gWaylandObjects.clear();
+    gWaylandListeners.clear();
+    gWaylandProxyCount = 0;
+}
+
+extern "C" {
+
+void wl_proxy_marshal(struct wl_proxy *proxy, uint32_t opcode, ...)
+{
+    recordWaylandRequest(proxy, opcode);
+}
+
+struct wl_proxy *wl_proxy_marshal_constructor(struct wl_proxy *proxy, uint32_t opcode,
+                                              const struct wl_interface *interface, ...)
+{
+    recordWaylandRequest(proxy, opcode);
+    return newWaylandProxy(interface);
+}
+
+struct wl_proxy *wl_proxy_marshal_constructor_versioned(struct wl_proxy *proxy, uint32_t opcode,
+                                                        const struct wl_interface *interface,
+                                                        uint32_t version, ...)
+{
+    Q_UNUSED(version);
+    recordWaylandRequest(proxy, opcode);
+    return newWaylandProxy(interface);
+}
+
+struct wl_proxy *wl_proxy_marshal_flags(struct wl_proxy *proxy, uint32_t opcode,
+                                        const struct wl_interface *interface,
+                                        uint32_t version, uint32_t flags, ...)
+{
+    Q_UNUSED(version);
+    Q_UNUSED(flags);
+    recordWaylandRequest(proxy, opcode);
+    return interface ? newWaylandProxy(interface) : 0;
+}
+
+int wl_proxy_add_listener(struct wl_proxy *proxy, void (**implementation)(void), void *data)
+{
+    WaylandListenerStub listener = { implementation, data };
+    gWaylandListeners.insert(proxy, listener);
+    return 0;
+}
+
+const void *wl_proxy_get_listener(struct wl_proxy *proxy)
+{
+    return gWaylandListeners.value(proxy).implementation;
+}
+
+void wl_proxy_set_user_data(struct wl_proxy *proxy, void *user_data)
+{
+    gWaylandListeners[proxy].data = user_data;
+}
+
+void *wl_proxy_get_user_data(struct wl_proxy *proxy)
+{
+    return gWaylandListeners.value(proxy).data;
+}
+
+uint32_t wl_proxy_get_version(struct wl_proxy *proxy)
+{
+    Q_UNUSED(proxy);
+    return 1;
+}
+
+void wl_proxy_destroy(struct wl_proxy *proxy)
+{
+    gWaylandListeners.remove(proxy);
+}
+
+}
+
+#endif // WAYLANDCLIENT_STUB_H
@@ -9,6 +9,7 @@ SUBDIRS += \
           dummyimplugin2 \
           dummyimplugin3 \
           dummyplugin \
+          echoimplugin \
           sanitychecks \
           ut_mattributeextensionmanager \
           ut_mkeyoverride \
@@ -17,11 +18,26 @@ SUBDIRS += \
           ut_mimonscreenplugins \
           ut_minputmethodquickplugin \
           ut_mimserveroptions \
+          ut_minputcontextconnection \
+          ut_sharedmemorychannel \
+          ut_mimsurroundingtext \
+          ut_mimutf8offsetindex \
+          ut_mimkeyeventbatch \
+          ut_mimkeyfilter \
+          ut_mimeditorstate \
+          ut_mimupdateevent \
 
 SUBDIRS += \
           ut_mimpluginmanager \
           ut_mimpluginmanagerconfig \
           ft_mimpluginmanager \
+          bench_keystrokelatency \
+
+wayland {
+    SUBDIRS += \
+          ut_waylandkeysyms \
+          ut_waylandinputmethodconnection \
+}
 
 QMAKE_EXTRA_TARGETS += check
 check.target = check
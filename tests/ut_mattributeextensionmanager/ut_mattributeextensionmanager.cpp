@@ -19,6 +19,7 @@
 
 #include <mattributeextensionmanager.h>
 #include <mattributeextensionid.h>
+#include <maliit/plugins/keyoverride.h>
 #include <QCoreApplication>
 #include <QSignalSpy>
 #include <QDebug>
@@ -106,4 +107,46 @@ void Ut_MAttributeExtensionManager::testSetExtendedAttribute()
     QVERIFY(subject->keyOverrides(idList.at(1)).value("testKey")->icon().isEmpty());
 }
 
+void Ut_MAttributeExtensionManager::testSetExtendedAttributes()
+{
+    qRegisterMetaType<MKeyOverride::KeyOverrideAttributes>("MKeyOverride::KeyOverrideAttributes");
+
+    MAttributeExtensionId id(1, "Ut_MAttributeExtensionManager");
+    subject->registerAttributeExtension(id, "");
+
+    QSignalSpy createdSpy(subject, SIGNAL(keyOverrideCreated()));
+    QVERIFY(createdSpy.isValid());
+
+    QVariantMap attributes;
+    attributes.insert("label", QString("testLabel"));
+    attributes.insert("icon", QString("testIcon"));
+    attributes.insert("highlighted", true);
+    subject->setExtendedAttributes(id, "/keys", "testKey", attributes);
+
+    QCOMPARE(createdSpy.count(), 1);
+    QSharedPointer<MKeyOverride> keyOverride = subject->keyOverrides(id).value("testKey");
+    QVERIFY(keyOverride);
+    QCOMPARE(keyOverride->label(), QString("testLabel"));
+    QCOMPARE(keyOverride->icon(), QString("testIcon"));
+    QCOMPARE(keyOverride->highlighted(), true);
+
+    QSignalSpy changedSpy(keyOverride.data(), SIGNAL(keyAttributesChanged(QString, MKeyOverride::KeyOverrideAttributes)));
+    QVERIFY(changedSpy.isValid());
+
+    attributes.clear();
+    attributes.insert("label", QString("otherLabel"));
+    attributes.insert("enabled", false);
+    // Invalid values are skipped
+    attributes.insert("icon", QVariant());
+    subject->setExtendedAttributes(id, "/keys", "testKey", attributes);
+
+    QCOMPARE(createdSpy.count(), 1);
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(changedSpy.first().last().value<MKeyOverride::KeyOverrideAttributes>(),
+             MKeyOverride::KeyOverrideAttributes(MKeyOverride::Label | MKeyOverride::Enabled));
+    QCOMPARE(keyOverride->label(), QString("otherLabel"));
+    QCOMPARE(keyOverride->icon(), QString("testIcon"));
+    QCOMPARE(keyOverride->enabled(), false);
+}
+
 QTEST_MAIN(Ut_MAttributeExtensionManager);
@@ -0,0 +1,217 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_mimeditorstate.h"
+
+#include <mimeditorstate.h>
+
+namespace {
+    QVariantMap sampleState()
+    {
+        QVariantMap state;
+        state["focusState"] = true;
+        state["contentType"] = 2;
+        state["surroundingText"] = QString("hello");
+        state["cursorPosition"] = 3;
+        state["anchorPosition"] = 1;
+        state["winId"] = 42u;
+        state["cursorRectangle"] = QRect(1, 2, 3, 4);
+        state["toolbarId"] = 7;
+        state["custom"] = QString("value");
+        return state;
+    }
+}
+
+void Ut_MImEditorState::initTestCase()
+{
+}
+
+void Ut_MImEditorState::cleanupTestCase()
+{
+}
+
+void Ut_MImEditorState::init()
+{
+}
+
+void Ut_MImEditorState::cleanup()
+{
+}
+
+void Ut_MImEditorState::testKeys()
+{
+    for (int bit = MImEditorState::FocusStateField; bit & MImEditorState::AllFields; bit <<= 1) {
+        const MImEditorState::Field field = static_cast<MImEditorState::Field>(bit);
+        QVERIFY(not MImEditorState::key(field).isEmpty());
+        QCOMPARE(MImEditorState::field(MImEditorState::key(field)), field);
+    }
+
+    QCOMPARE(MImEditorState::key(MImEditorState::FocusStateField), QString("focusState"));
+    QCOMPARE(MImEditorState::key(MImEditorState::AutoCapitalizationField),
+             QString("autocapitalizationEnabled"));
+    QCOMPARE(MImEditorState::field("custom"), MImEditorState::NoField);
+}
+
+void Ut_MImEditorState::testReset()
+{
+    MImEditorState state;
+    QVERIFY(state.isEmpty());
+    QVERIFY(not state.focusState());
+
+    const QVariantMap map = sampleState();
+    state.reset(map);
+
+    QVERIFY(not state.isEmpty());
+    QVERIFY(state.focusState());
+    QCOMPARE(state.contentType(), 2);
+    QCOMPARE(state.surroundingText(), QString("hello"));
+    QCOMPARE(state.cursorPosition(), 3);
+    QCOMPARE(state.anchorPosition(), 1);
+    QCOMPARE(state.winId(), Q_UINT64_C(42));
+    QCOMPARE(state.cursorRectangle(), QRect(1, 2, 3, 4));
+    QCOMPARE(state.toolbarId(), 7);
+
+    QVERIFY(state.contains(MImEditorState::FocusStateField));
+    QVERIFY(not state.contains(MImEditorState::HasSelectionField));
+    QVERIFY(not state.hasSelection());
+
+    QCOMPARE(state.value("cursorPosition"), QVariant(3));
+    QCOMPARE(state.value("custom"), QVariant(QString("value")));
+    QVERIFY(not state.value("hasSelection").isValid());
+
+    // The map from the application is handed out again
+    QCOMPARE(state.toMap(), map);
+}
+
+void Ut_MImEditorState::testResetChanges()
+{
+    MImEditorState state(sampleState());
+    QVERIFY(state.hasChanges());
+    state.clearChanges();
+    QVERIFY(not state.hasChanges());
+
+    QVariantMap map = sampleState();
+    state.reset(map);
+    QVERIFY(not state.hasChanges());
+
+    map["cursorPosition"] = 4;
+    map.remove("toolbarId");
+    map["hasSelection"] = true;
+    state.reset(map);
+
+    QCOMPARE(state.changedFields(),
+             MImEditorState::Fields(MImEditorState::CursorPositionField
+                                    | MImEditorState::ToolbarIdField
+                                    | MImEditorState::HasSelectionField));
+    QVERIFY(state.changedExtensions().isEmpty());
+    QVERIFY(not state.contains(MImEditorState::ToolbarIdField));
+
+    QStringList keys = state.changedKeys();
+    keys.sort();
+    QCOMPARE(keys, QStringList() << "cursorPosition" << "hasSelection" << "toolbarId");
+}
+
+void Ut_MImEditorState::testExtensions()
+{
+    MImEditorState state(sampleState());
+    state.clearChanges();
+
+    QVariantMap map = sampleState();
+    map["custom"] = QString("other");
+    map["added"] = 1;
+    state.reset(map);
+
+    QCOMPARE(state.changedFields(), MImEditorState::Fields(MImEditorState::NoField));
+    QStringList changed = state.changedExtensions();
+    changed.sort();
+    QCOMPARE(changed, QStringList() << "added" << "custom");
+    QCOMPARE(state.extensions().size(), 2);
+
+    state.clearChanges();
+    map.remove("added");
+    state.reset(map);
+    QCOMPARE(state.changedExtensions(), QStringList() << "added");
+    QVERIFY(not state.value("added").isValid());
+}
+
+void Ut_MImEditorState::testSetters()
+{
+    MImEditorState state(sampleState());
+    state.clearChanges();
+
+    state.setCursorPosition(3);
+    QVERIFY(not state.hasChanges());
+
+    state.setCursorPosition(5);
+    state.setPredictionEnabled(true);
+    QCOMPARE(state.changedFields(),
+             MImEditorState::Fields(MImEditorState::CursorPositionField
+                                    | MImEditorState::PredictionField));
+
+    const QVariantMap map = state.toMap();
+    QCOMPARE(map.value("cursorPosition"), QVariant(5));
+    QCOMPARE(map.value("predictionEnabled"), QVariant(true));
+    QCOMPARE(map.value("custom"), QVariant(QString("value")));
+}
+
+void Ut_MImEditorState::testSetValueKeepsMap()
+{
+    MImEditorState state(sampleState());
+    state.clearChanges();
+
+    state.setValue("surroundingText", QString("world"));
+    state.setValue("custom", QString("other"));
+    state.remove("toolbarId");
+
+    QCOMPARE(state.surroundingText(), QString("world"));
+    QVERIFY(not state.contains(MImEditorState::ToolbarIdField));
+
+    QStringList keys = state.changedKeys();
+    keys.sort();
+    QCOMPARE(keys, QStringList() << "custom" << "surroundingText" << "toolbarId");
+
+    QVariantMap expected = sampleState();
+    expected["surroundingText"] = QString("world");
+    expected["custom"] = QString("other");
+    expected.remove("toolbarId");
+    QCOMPARE(state.toMap(), expected);
+}
+
+void Ut_MImEditorState::testInvalidValue()
+{
+    QVariantMap map;
+    map["contentType"] = QString("not a number");
+    map["winId"] = QVariant();
+
+    MImEditorState state(map);
+    QVERIFY(not state.contains(MImEditorState::ContentTypeField));
+    QVERIFY(not state.contains(MImEditorState::WinIdField));
+    QCOMPARE(state.contentType(), 0);
+    QCOMPARE(state.winId(), Q_UINT64_C(0));
+}
+
+void Ut_MImEditorState::testToMapFields()
+{
+    MImEditorState state(sampleState());
+
+    const QVariantMap map = state.toMap(MImEditorState::CursorPositionField
+                                        | MImEditorState::HasSelectionField
+                                        | MImEditorState::ToolbarIdField);
+
+    QCOMPARE(map.size(), 2);
+    QCOMPARE(map.value("cursorPosition"), QVariant(3));
+    QCOMPARE(map.value("toolbarId"), QVariant(7));
+}
+
+QTEST_MAIN(Ut_MImEditorState)
@@ -0,0 +1,42 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef UT_MIMEDITORSTATE_H
+#define UT_MIMEDITORSTATE_H
+
+#include <QtTest/QtTest>
+#include <QObject>
+
+class Ut_MImEditorState : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void init();
+    void cleanup();
+
+    void testKeys();
+    void testReset();
+    void testResetChanges();
+    void testExtensions();
+    void testSetters();
+    void testSetValueKeepsMap();
+    void testInvalidValue();
+    void testToMapFields();
+};
+
+#endif // UT_MIMEDITORSTATE_H
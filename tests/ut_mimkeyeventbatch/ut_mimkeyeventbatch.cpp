@@ -0,0 +1,156 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_mimkeyeventbatch.h"
+
+#include <mimkeyeventbatch.h>
+
+namespace {
+    bool appendKey(MImKeyEventBatch &batch, quint32 serial, QEvent::Type type, Qt::Key key,
+                   const QString &text, bool autoRepeat)
+    {
+        return batch.append(serial, type, key, Qt::NoModifier, text, autoRepeat, 1, 0, 0, 0, serial * 10);
+    }
+}
+
+void Ut_MImKeyEventBatch::initTestCase()
+{
+}
+
+void Ut_MImKeyEventBatch::cleanupTestCase()
+{
+}
+
+void Ut_MImKeyEventBatch::init()
+{
+}
+
+void Ut_MImKeyEventBatch::cleanup()
+{
+}
+
+void Ut_MImKeyEventBatch::testRoundTrip()
+{
+    MImKeyEventBatch batch;
+    QVERIFY(batch.isEmpty());
+
+    QVERIFY(batch.append(7, QEvent::KeyPress, Qt::Key_A, Qt::ShiftModifier, "A", false, 1, 38, 0x41, 1, 1000));
+    QVERIFY(batch.append(8, QEvent::KeyRelease, Qt::Key_Escape, Qt::NoModifier, QString(), false, 1, 9, 0xff1b, 0, 1010));
+    QCOMPARE(batch.count(), 2);
+    QCOMPARE(batch.data().size(), 2 * int(sizeof(MImKeyEventRecord)));
+
+    const MImKeyEventBatch received(batch.data());
+    QCOMPARE(received.count(), 2);
+
+    const MImKeyEventRecord press = received.at(0);
+    QCOMPARE(press.serial, quint32(7));
+    QCOMPARE(press.type, qint32(QEvent::KeyPress));
+    QCOMPARE(press.key, qint32(Qt::Key_A));
+    QCOMPARE(press.modifiers, quint32(Qt::ShiftModifier));
+    QCOMPARE(press.textString(), QString("A"));
+    QCOMPARE(press.count, quint16(1));
+    QCOMPARE(press.nativeScanCode, quint32(38));
+    QCOMPARE(press.nativeVirtualKey, quint32(0x41));
+    QCOMPARE(press.nativeModifiers, quint32(1));
+    QCOMPARE(press.time, quint32(1000));
+    QVERIFY(not press.isAutoRepeat());
+
+    const MImKeyEventRecord release = received.at(1);
+    QCOMPARE(release.serial, quint32(8));
+    QCOMPARE(release.type, qint32(QEvent::KeyRelease));
+    QCOMPARE(release.textString(), QString());
+
+    batch.clear();
+    QVERIFY(batch.isEmpty());
+}
+
+void Ut_MImKeyEventBatch::testTextTooLong()
+{
+    MImKeyEventBatch batch;
+
+    const QString longest(MImKeyEventRecord::MaxTextLength, QChar('x'));
+    QVERIFY(appendKey(batch, 1, QEvent::KeyPress, Qt::Key_X, longest, false));
+    QCOMPARE(batch.at(0).textString(), longest);
+
+    QVERIFY(not appendKey(batch, 2, QEvent::KeyPress, Qt::Key_X, longest + "x", false));
+    QCOMPARE(batch.count(), 1);
+}
+
+void Ut_MImKeyEventBatch::testIncompleteRecord()
+{
+    MImKeyEventBatch batch;
+    appendKey(batch, 1, QEvent::KeyPress, Qt::Key_A, "a", false);
+    appendKey(batch, 2, QEvent::KeyRelease, Qt::Key_A, "a", false);
+
+    const MImKeyEventBatch received(batch.data().left(batch.data().size() - 1));
+    QCOMPARE(received.count(), 1);
+    QCOMPARE(received.data().size(), int(sizeof(MImKeyEventRecord)));
+}
+
+void Ut_MImKeyEventBatch::testAutoRepeatMerged()
+{
+    MImKeyEventBatch batch;
+    appendKey(batch, 1, QEvent::KeyPress, Qt::Key_A, "a", false);
+    appendKey(batch, 2, QEvent::KeyPress, Qt::Key_A, "a", true);
+    appendKey(batch, 3, QEvent::KeyPress, Qt::Key_A, "a", true);
+    appendKey(batch, 4, QEvent::KeyPress, Qt::Key_A, "a", true);
+
+    // The first press is not a repeat and stays on its own
+    QCOMPARE(batch.count(), 2);
+    QCOMPARE(batch.at(0).count, quint16(1));
+    QVERIFY(batch.at(1).isAutoRepeat());
+    QCOMPARE(batch.at(1).serial, quint32(2));
+    QCOMPARE(batch.at(1).count, quint16(3));
+    QCOMPARE(batch.at(1).time, quint32(40));
+
+    // Receivers deliver the merged presses one by one
+    QCOMPARE(batch.at(0).eventCount(), 1);
+    QCOMPARE(batch.at(1).eventCount(), 3);
+    QCOMPARE(batch.at(1).eventKeyCount(), 1);
+
+    appendKey(batch, 5, QEvent::KeyRelease, Qt::Key_A, "a", false);
+    QCOMPARE(batch.count(), 3);
+}
+
+void Ut_MImKeyEventBatch::testAutoRepeatReleaseDropped()
+{
+    MImKeyEventBatch batch;
+    appendKey(batch, 1, QEvent::KeyPress, Qt::Key_A, "a", true);
+    appendKey(batch, 2, QEvent::KeyRelease, Qt::Key_A, "a", true);
+    appendKey(batch, 3, QEvent::KeyPress, Qt::Key_A, "a", true);
+    appendKey(batch, 4, QEvent::KeyRelease, Qt::Key_A, "a", true);
+    appendKey(batch, 5, QEvent::KeyPress, Qt::Key_A, "a", true);
+
+    QCOMPARE(batch.count(), 1);
+    QCOMPARE(batch.at(0).type, qint32(QEvent::KeyPress));
+    QCOMPARE(batch.at(0).count, quint16(3));
+
+    // A release not followed by another repeat is kept
+    appendKey(batch, 6, QEvent::KeyRelease, Qt::Key_A, "a", true);
+    QCOMPARE(batch.count(), 2);
+}
+
+void Ut_MImKeyEventBatch::testDifferentKeysKept()
+{
+    MImKeyEventBatch batch;
+    appendKey(batch, 1, QEvent::KeyPress, Qt::Key_A, "a", true);
+    appendKey(batch, 2, QEvent::KeyPress, Qt::Key_B, "b", true);
+    QVERIFY(batch.append(3, QEvent::KeyPress, Qt::Key_B, Qt::ShiftModifier, "B", true, 1, 0, 0, 0, 30));
+
+    QCOMPARE(batch.count(), 3);
+    QCOMPARE(batch.at(0).count, quint16(1));
+    QCOMPARE(batch.at(1).count, quint16(1));
+}
+
+QTEST_MAIN(Ut_MImKeyEventBatch)
@@ -0,0 +1,40 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef UT_MIMKEYEVENTBATCH_H
+#define UT_MIMKEYEVENTBATCH_H
+
+#include <QtTest/QtTest>
+#include <QObject>
+
+class Ut_MImKeyEventBatch : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void init();
+    void cleanup();
+
+    void testRoundTrip();
+    void testTextTooLong();
+    void testIncompleteRecord();
+    void testAutoRepeatMerged();
+    void testAutoRepeatReleaseDropped();
+    void testDifferentKeysKept();
+};
+
+#endif // UT_MIMKEYEVENTBATCH_H
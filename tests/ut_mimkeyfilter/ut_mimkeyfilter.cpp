@@ -0,0 +1,144 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_mimkeyfilter.h"
+
+#include <maliit/keyfilter.h>
+
+void Ut_MImKeyFilter::initTestCase()
+{
+}
+
+void Ut_MImKeyFilter::cleanupTestCase()
+{
+}
+
+void Ut_MImKeyFilter::init()
+{
+}
+
+void Ut_MImKeyFilter::cleanup()
+{
+}
+
+void Ut_MImKeyFilter::testEmptyMatchesAll()
+{
+    MImKeyFilter filter;
+
+    QVERIFY(filter.matchesAll());
+    QVERIFY(filter.matches(Qt::Key_A, Qt::NoModifier, false));
+    QVERIFY(filter.matches(Qt::Key_F1, Qt::ControlModifier, true));
+}
+
+void Ut_MImKeyFilter::testKeyRange()
+{
+    MImKeyFilter filter;
+    filter.addKeyRange(Qt::Key_A, Qt::Key_Z);
+    filter.addKey(Qt::Key_Backspace);
+
+    QVERIFY(not filter.matchesAll());
+    QVERIFY(filter.matches(Qt::Key_A, Qt::NoModifier, false));
+    QVERIFY(filter.matches(Qt::Key_M, Qt::NoModifier, false));
+    QVERIFY(filter.matches(Qt::Key_Z, Qt::NoModifier, false));
+    QVERIFY(filter.matches(Qt::Key_Backspace, Qt::NoModifier, false));
+    QVERIFY(not filter.matches(Qt::Key_1, Qt::NoModifier, false));
+    QVERIFY(not filter.matches(Qt::Key_Escape, Qt::NoModifier, false));
+
+    // Without a modifier mask the modifiers do not matter
+    QVERIFY(filter.matches(Qt::Key_A, Qt::ShiftModifier | Qt::ControlModifier, false));
+
+    // Reversed bounds describe the same range
+    MImKeyFilter reversed;
+    reversed.addKeyRange(Qt::Key_Z, Qt::Key_A);
+    QVERIFY(reversed.matches(Qt::Key_M, Qt::NoModifier, false));
+}
+
+void Ut_MImKeyFilter::testModifierMask()
+{
+    MImKeyFilter filter;
+    // Letters without Control or Alt, Shift may be held
+    filter.addKeyRange(Qt::Key_A, Qt::Key_Z,
+                       Qt::ControlModifier | Qt::AltModifier, Qt::NoModifier);
+    // Control+Space
+    filter.addKey(Qt::Key_Space, Qt::ControlModifier, Qt::ControlModifier);
+
+    QVERIFY(filter.matches(Qt::Key_A, Qt::NoModifier, false));
+    QVERIFY(filter.matches(Qt::Key_A, Qt::ShiftModifier, false));
+    QVERIFY(not filter.matches(Qt::Key_A, Qt::ControlModifier, false));
+    QVERIFY(not filter.matches(Qt::Key_A, Qt::AltModifier | Qt::ShiftModifier, false));
+
+    QVERIFY(filter.matches(Qt::Key_Space, Qt::ControlModifier, false));
+    QVERIFY(filter.matches(Qt::Key_Space, Qt::ControlModifier | Qt::ShiftModifier, false));
+    QVERIFY(not filter.matches(Qt::Key_Space, Qt::NoModifier, false));
+}
+
+void Ut_MImKeyFilter::testStates()
+{
+    MImKeyFilter filter;
+    filter.addKeyRange(Qt::Key_A, Qt::Key_Z);
+    // Only needed to confirm or cancel the preedit
+    filter.addKey(Qt::Key_Return, Qt::NoModifier, Qt::NoModifier, MImKeyFilter::ComposingState);
+    filter.addKey(Qt::Key_Escape, Qt::NoModifier, Qt::NoModifier, MImKeyFilter::ComposingState);
+    filter.addKey(Qt::Key_Tab, Qt::NoModifier, Qt::NoModifier, MImKeyFilter::IdleState);
+
+    QVERIFY(filter.matches(Qt::Key_Q, Qt::NoModifier, false));
+    QVERIFY(filter.matches(Qt::Key_Q, Qt::NoModifier, true));
+
+    QVERIFY(filter.matches(Qt::Key_Return, Qt::NoModifier, true));
+    QVERIFY(not filter.matches(Qt::Key_Return, Qt::NoModifier, false));
+    QVERIFY(filter.matches(Qt::Key_Escape, Qt::NoModifier, true));
+    QVERIFY(not filter.matches(Qt::Key_Escape, Qt::NoModifier, false));
+
+    QVERIFY(filter.matches(Qt::Key_Tab, Qt::NoModifier, false));
+    QVERIFY(not filter.matches(Qt::Key_Tab, Qt::NoModifier, true));
+}
+
+void Ut_MImKeyFilter::testUnite()
+{
+    MImKeyFilter letters;
+    letters.addKeyRange(Qt::Key_A, Qt::Key_Z);
+
+    MImKeyFilter digits;
+    digits.addKeyRange(Qt::Key_0, Qt::Key_9);
+    digits.addKeyRange(Qt::Key_A, Qt::Key_Z);
+
+    letters.unite(digits);
+
+    QVERIFY(letters.matches(Qt::Key_B, Qt::NoModifier, false));
+    QVERIFY(letters.matches(Qt::Key_5, Qt::NoModifier, false));
+    QVERIFY(not letters.matches(Qt::Key_Escape, Qt::NoModifier, false));
+
+    // Rules both filters have are kept once
+    MImKeyFilter expected;
+    expected.addKeyRange(Qt::Key_A, Qt::Key_Z);
+    expected.addKeyRange(Qt::Key_0, Qt::Key_9);
+    QVERIFY(letters == expected);
+}
+
+void Ut_MImKeyFilter::testUniteWithEmpty()
+{
+    MImKeyFilter letters;
+    letters.addKeyRange(Qt::Key_A, Qt::Key_Z);
+
+    MImKeyFilter all;
+    MImKeyFilter united(letters);
+    united.unite(all);
+    QVERIFY(united.matchesAll());
+
+    all.unite(letters);
+    QVERIFY(all.matchesAll());
+    QVERIFY(all != letters);
+}
+
+QTEST_MAIN(Ut_MImKeyFilter)
@@ -0,0 +1,12 @@
+include(../common_top.pri)
+
+# Input
+HEADERS += \
+    ut_mimkeyfilter.h \
+
+SOURCES += \
+    ut_mimkeyfilter.cpp \
+
+include($$TOP_DIR/common/libmaliit-common.pri)
+
+include(../common_check.pri)
@@ -7,6 +7,7 @@
 
 #include "minputcontextconnection.h"
 #include "mimsettingsqsettings.h"
+#include "mimplugincache.h"
 
 #include "core-utils.h"
 
@@ -17,9 +18,11 @@
 #include <QTimer>
 #include <QEventLoop>
 #include <QStringList>
+#include <QTemporaryDir>
 #include <mimpluginmanager.h>
 #include <mimpluginmanager_p.h>
 #include <maliit/plugins/inputmethodplugin.h>
+#include <maliit/plugins/updateevent.h>
 #include <unknownplatform.h>
 
 #include "mattributeextensionmanager.h"
@@ -33,6 +36,9 @@ namespace {
     const QString ConfigRoot          = MALIIT_CONFIG_ROOT;
     const QString MImPluginPaths    = ConfigRoot + "paths";
     const QString MImPluginDisabled = ConfigRoot + "disabledpluginfiles";
+    const QString MImPluginLazyLoading = ConfigRoot + "lazyloading";
+    const QString MImPluginCacheFile = ConfigRoot + "plugincache";
+    const QString MImPluginStandbyCount = ConfigRoot + "standbyplugins";
 
     const QString PluginRoot          = MALIIT_CONFIG_ROOT"plugins/";
 
@@ -58,6 +64,18 @@ namespace {
 
     const QStringList DefaultActivePlugin = QStringList() << pluginId + ":" + "dummyimsv1";
     const QStringList DefaultBlackList = QStringList() << "libdummyimplugin2.so" << "libmeego-keyboard.so";
+
+    const unsigned int ClientId = 1;
+
+    QVariantMap widgetState(bool focused, int cursorPosition)
+    {
+        QVariantMap state;
+        state["focusState"] = focused;
+        state["surroundingText"] = QString("hello world");
+        state["cursorPosition"] = cursorPosition;
+        state["anchorPosition"] = cursorPosition;
+        return state;
+    }
 }
 
 class MInputContextTestConnection : public MInputContextConnection
@@ -907,4 +925,416 @@ void Ut_MIMPluginManager::testPluginSettingsUpdate()
     QCOMPARE(connection->notifyExtendedAttributeChanged_value, original_value);
 }
 
+void Ut_MIMPluginManager::recreateManager(MIMPluginManager::LoadingMode loadingMode)
+{
+    delete manager;
+
+    QSharedPointer<MInputContextTestConnection> icConnection(new MInputContextTestConnection);
+    manager = new MIMPluginManager(icConnection, QSharedPointer<Maliit::AbstractPlatform>(new Maliit::UnknownPlatform),
+                                   loadingMode);
+    connection = icConnection.data();
+    subject = manager->d_ptr;
+}
+
+void Ut_MIMPluginManager::testLazyLoading()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    MImSettings lazyLoadingSetting(MImPluginLazyLoading);
+    MImSettings cacheFileSetting(MImPluginCacheFile);
+    lazyLoadingSetting.set(true);
+    cacheFileSetting.set(cacheDir.path() + "/plugins.json");
+
+    recreateManager();
+
+    lazyLoadingSetting.unset();
+    cacheFileSetting.unset();
+
+    Maliit::Plugins::InputMethodPlugin *plugin3 = 0;
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, subject->plugins.keys()) {
+        if (plugin->name() == pluginName3) {
+            plugin3 = plugin;
+        }
+    }
+
+    // DummyImPlugin3 has a manifest and is known without creating its input method
+    QVERIFY(plugin3 != 0);
+    QVERIFY(dynamic_cast<DummyImPlugin3 *>(plugin3) == 0);
+    QVERIFY(subject->plugins[plugin3].inputMethod == 0);
+    QCOMPARE(plugin3->supportedStates(), QSet<Maliit::HandlerState>()
+             << Maliit::OnScreen << Maliit::Hardware << Maliit::Accessory);
+
+    const QMap<QString, QString> subViews = subject->availableSubViews(pluginId3);
+    QCOMPARE(subViews.size(), 5);
+    QVERIFY(subViews.contains("dummyim3sv1"));
+    QVERIFY(subViews.contains("dummyim3sv2"));
+
+    QVERIFY(subject->activatePlugin(plugin3));
+    QPointer<MAbstractInputMethod> inputMethod3 = subject->plugins[plugin3].inputMethod;
+    QVERIFY(dynamic_cast<DummyInputMethod3 *>(inputMethod3.data()) != 0);
+    QVERIFY(subject->targets.contains(inputMethod3.data()));
+
+    // active plugins are never unloaded
+    subject->_q_unloadIdlePlugins();
+    QVERIFY(!inputMethod3.isNull());
+
+    subject->deactivatePlugin(plugin3);
+    subject->_q_unloadIdlePlugins();
+    QVERIFY(inputMethod3.isNull());
+    QVERIFY(subject->plugins[plugin3].inputMethod == 0);
+    QCOMPARE(subject->availableSubViews(pluginId3).size(), 5);
+
+    // and created again when needed
+    QVERIFY(subject->activatePlugin(plugin3));
+    QVERIFY(dynamic_cast<DummyInputMethod3 *>(subject->plugins[plugin3].inputMethod) != 0);
+}
+
+void Ut_MIMPluginManager::testPluginCache()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    const QString cacheFile = cacheDir.path() + "/plugins.json";
+
+    MImSettings lazyLoadingSetting(MImPluginLazyLoading);
+    MImSettings cacheFileSetting(MImPluginCacheFile);
+    lazyLoadingSetting.set(true);
+    cacheFileSetting.set(cacheFile);
+
+    // first start: DummyImPlugin has no manifest and is loaded
+    recreateManager();
+    QVERIFY(QFile::exists(cacheFile));
+
+    bool dummyImPluginLoaded = false;
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, subject->plugins.keys()) {
+        if (dynamic_cast<DummyImPlugin *>(plugin)) {
+            dummyImPluginLoaded = true;
+        }
+    }
+    QVERIFY(dummyImPluginLoaded);
+
+    // second start: DummyImPlugin3 is registered from the cache, DummyImPlugin
+    // still has no manifest and is loaded again
+    recreateManager();
+
+    lazyLoadingSetting.unset();
+    cacheFileSetting.unset();
+
+    QCOMPARE(subject->plugins.size(), 2);
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, subject->plugins.keys()) {
+        if (plugin->name() == pluginName) {
+            QVERIFY(dynamic_cast<DummyImPlugin *>(plugin) != 0);
+            QVERIFY(subject->plugins[plugin].inputMethod != 0);
+        } else {
+            QVERIFY(dynamic_cast<MImManifestPlugin *>(plugin) != 0);
+        }
+    }
+
+    QCOMPARE(manager->loadedPluginsNames().toSet(), QSet<QString>() << pluginId << pluginId3);
+    QVERIFY(subject->availableSubViews(pluginId).contains("dummyimsv1"));
+    QVERIFY(subject->availableSubViews(pluginId3).contains("dummyim3sv1"));
+
+    // the active plugin is still created right away
+    QCOMPARE(subject->activePlugins.size(), 1);
+    Maliit::Plugins::InputMethodPlugin *plugin = *subject->activePlugins.begin();
+    QCOMPARE(plugin->name(), pluginName);
+    QVERIFY(dynamic_cast<DummyInputMethod *>(subject->plugins[plugin].inputMethod) != 0);
+
+    QStringList domain;
+    Q_FOREACH (const MImPluginSettingsEntry &entry, subject->globalSettings().entries) {
+        domain = entry.attributes.value(Maliit::SettingEntryAttributes::valueDomain).toStringList();
+    }
+    QVERIFY(domain.contains(pluginId3 + ":dummyim3sv2"));
+}
+
+void Ut_MIMPluginManager::testPluginCacheInvalidation()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString cacheFile = dir.path() + "/plugins.json";
+    const QString pluginFile = dir.path() + "/libexampleplugin.so";
+
+    QFile file(pluginFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("version 1");
+    file.close();
+
+    MImPluginManifest manifest;
+    manifest.name = "ExamplePlugin";
+    manifest.supportedStates << Maliit::OnScreen;
+
+    MImPluginCache cache(cacheFile);
+    QVERIFY(!cache.load());
+    QCOMPARE(cache.entryList(QDir(dir.path())), QStringList() << "libexampleplugin.so");
+    cache.insert(QFileInfo(pluginFile), manifest);
+    QVERIFY(cache.save());
+
+    MImPluginCache reloaded(cacheFile);
+    QVERIFY(reloaded.load());
+    QCOMPARE(reloaded.manifest(QFileInfo(pluginFile)).name, manifest.name);
+
+    // a changed file invalidates its record
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("version 2, larger");
+    file.close();
+    QVERIFY(!reloaded.manifest(QFileInfo(pluginFile)).isValid());
+}
+
+void Ut_MIMPluginManager::testStagedLoading()
+{
+    recreateManager(MIMPluginManager::LoadActivePluginFirst);
+
+    // Only the active plugin is registered by the constructor
+    QCOMPARE(subject->plugins.size(), 1);
+    QCOMPARE(subject->activePlugins.size(), 1);
+    QCOMPARE((*subject->activePlugins.begin())->name(), pluginName);
+    QVERIFY(!subject->pendingPlugins.isEmpty());
+    QVERIFY(manager->isActivePluginReady());
+
+    DummyInputMethod *inputMethod = dynamic_cast<DummyInputMethod *>(
+        subject->plugins[*subject->activePlugins.begin()].inputMethod);
+    QVERIFY(inputMethod != 0);
+    QCOMPARE(inputMethod->pluginsChangedSignalCount, 0);
+
+    QSignalSpy pluginsChangedSpy(manager, SIGNAL(pluginsChanged()));
+
+    // the others once the event loop runs, one per iteration
+    QTRY_VERIFY(subject->pendingPlugins.isEmpty());
+    QTRY_VERIFY(!pluginsChangedSpy.isEmpty());
+
+    // loading is finished only once
+    QCoreApplication::processEvents();
+    QCOMPARE(pluginsChangedSpy.count(), 1);
+    QCOMPARE(inputMethod->pluginsChangedSignalCount, 1);
+    QCOMPARE(subject->plugins.size(), 2);
+    QVERIFY(subject->pendingPlugins.isEmpty());
+    QCOMPARE(subject->activePlugins.size(), 1);
+    QCOMPARE((*subject->activePlugins.begin())->name(), pluginName);
+    QVERIFY(manager->loadedPluginsNames().contains(pluginName3));
+}
+
+void Ut_MIMPluginManager::testStandbyPlugins()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    MImSettings lazyLoadingSetting(MImPluginLazyLoading);
+    MImSettings cacheFileSetting(MImPluginCacheFile);
+    MImSettings standbySetting(MImPluginStandbyCount);
+    lazyLoadingSetting.set(true);
+    cacheFileSetting.set(cacheDir.path() + "/plugins.json");
+
+    // by default inactive plugins are only created when switching to them
+    standbySetting.unset();
+    recreateManager();
+    QCoreApplication::processEvents();
+
+    Maliit::Plugins::InputMethodPlugin *plugin3 = 0;
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, subject->plugins.keys()) {
+        if (plugin->name() == pluginName3) {
+            plugin3 = plugin;
+        }
+    }
+    QVERIFY(plugin3 != 0);
+    QVERIFY(subject->plugins[plugin3].inputMethod == 0);
+
+    standbySetting.set(1);
+    recreateManager();
+
+    lazyLoadingSetting.unset();
+    cacheFileSetting.unset();
+    standbySetting.unset();
+
+    plugin3 = 0;
+    Q_FOREACH (Maliit::Plugins::InputMethodPlugin *plugin, subject->plugins.keys()) {
+        if (plugin->name() == pluginName3) {
+            plugin3 = plugin;
+        }
+    }
+    QVERIFY(plugin3 != 0);
+    QVERIFY(subject->plugins[plugin3].inputMethod == 0);
+
+    // the neighbour of the active plugin is created once the event loop runs
+    QCoreApplication::processEvents();
+    QPointer<MAbstractInputMethod> inputMethod3 = subject->plugins[plugin3].inputMethod;
+    QVERIFY(dynamic_cast<DummyInputMethod3 *>(inputMethod3.data()) != 0);
+    QVERIFY(!subject->activePlugins.contains(plugin3));
+    QVERIFY(!subject->targets.contains(inputMethod3.data()));
+
+    // but not set up before it is activated
+    DummyInputMethod3 *dummy3 = static_cast<DummyInputMethod3 *>(inputMethod3.data());
+    QCOMPARE(dummy3->setStateCount, 0);
+    QCOMPARE(dummy3->setKeyOverridesCount, 0);
+
+    // and kept while idle
+    subject->_q_unloadIdlePlugins();
+    QVERIFY(!inputMethod3.isNull());
+
+    // switching to it uses the same input method
+    QCOMPARE(subject->activePlugins.size(), 1);
+    Maliit::Plugins::InputMethodPlugin *plugin = *subject->activePlugins.begin();
+    QVERIFY(subject->switchPlugin(pluginId3, subject->plugins[plugin].inputMethod));
+    QVERIFY(subject->activePlugins.contains(plugin3));
+    QVERIFY(subject->plugins[plugin3].inputMethod == inputMethod3.data());
+    QCOMPARE(dummy3->setStateCount, 1);
+    QCOMPARE(dummy3->setKeyOverridesCount, 1);
+}
+
+void Ut_MIMPluginManager::testWidgetStateCoalesced()
+{
+    DummyInputMethod *inputMethod
+        = dynamic_cast<DummyInputMethod *>(subject->plugins[*subject->activePlugins.begin()].inputMethod);
+    QVERIFY(inputMethod != 0);
+
+    connection->activateContext(ClientId);
+    QCoreApplication::processEvents();
+    inputMethod->updateCount = 0;
+    inputMethod->focusChanges.clear();
+
+    // What a client sends when a widget gets the focus
+    QVariantMap state = widgetState(true, 0);
+    connection->updateWidgetInformation(ClientId, state, true);
+    state["cursorPosition"] = 5;
+    connection->updateWidgetInformation(ClientId, state, false);
+    state["hasSelection"] = false;
+    connection->updateWidgetInformation(ClientId, state, false);
+
+    QCOMPARE(inputMethod->updateCount, 0);
+    QCoreApplication::processEvents();
+
+    QCOMPARE(inputMethod->updateCount, 1);
+    QCOMPARE(inputMethod->focusChanges, QList<bool>() << true);
+    QVERIFY(inputMethod->changedProperties.contains("focusState"));
+    QVERIFY(inputMethod->changedProperties.contains("cursorPosition"));
+    QVERIFY(inputMethod->changedProperties.contains("hasSelection"));
+
+    // Nothing left to dispatch
+    QCoreApplication::processEvents();
+    QCOMPARE(inputMethod->updateCount, 1);
+}
+
+void Ut_MIMPluginManager::testWidgetStateFocusMoved()
+{
+    DummyInputMethod *inputMethod
+        = dynamic_cast<DummyInputMethod *>(subject->plugins[*subject->activePlugins.begin()].inputMethod);
+    QVERIFY(inputMethod != 0);
+
+    connection->activateContext(ClientId);
+    connection->updateWidgetInformation(ClientId, widgetState(true, 0), true);
+    QCoreApplication::processEvents();
+    inputMethod->updateCount = 0;
+    inputMethod->focusChanges.clear();
+
+    // Focus out of one widget and into another is still reported as both
+    connection->updateWidgetInformation(ClientId, widgetState(false, 0), true);
+    connection->updateWidgetInformation(ClientId, widgetState(true, 3), true);
+    QCoreApplication::processEvents();
+
+    QCOMPARE(inputMethod->focusChanges, QList<bool>() << false << true);
+    QCOMPARE(inputMethod->updateCount, 1);
+}
+
+void Ut_MIMPluginManager::testWidgetStateDispatchedBeforeShow()
+{
+    DummyInputMethod *inputMethod
+        = dynamic_cast<DummyInputMethod *>(subject->plugins[*subject->activePlugins.begin()].inputMethod);
+    QVERIFY(inputMethod != 0);
+
+    connection->activateContext(ClientId);
+    QCoreApplication::processEvents();
+    inputMethod->updateCount = 0;
+
+    connection->updateWidgetInformation(ClientId, widgetState(true, 0), true);
+    manager->showActivePlugins();
+
+    // The input method knows the state when it is shown
+    QCOMPARE(inputMethod->updateCount, 1);
+    QCoreApplication::processEvents();
+    QCOMPARE(inputMethod->updateCount, 1);
+}
+
+void Ut_MIMPluginManager::testWidgetStateDispatchedBeforeSwitch()
+{
+    Maliit::Plugins::InputMethodPlugin *plugin = *subject->activePlugins.begin();
+    DummyInputMethod *inputMethod = dynamic_cast<DummyInputMethod *>(subject->plugins[plugin].inputMethod);
+    QVERIFY(inputMethod != 0);
+
+    connection->activateContext(ClientId);
+    QCoreApplication::processEvents();
+    inputMethod->updateCount = 0;
+
+    connection->updateWidgetInformation(ClientId, widgetState(true, 0), true);
+    QVERIFY(subject->widgetStatePending);
+    QVERIFY(subject->switchPlugin(pluginId3, inputMethod));
+
+    // The input method knew the state before it was switched away from
+    QVERIFY(not subject->widgetStatePending);
+    QCOMPARE(inputMethod->updateCount, 1);
+    QVERIFY(*subject->activePlugins.begin() != plugin);
+
+    QCoreApplication::processEvents();
+    QCOMPARE(inputMethod->updateCount, 1);
+}
+
+void Ut_MIMPluginManager::testWidgetStatePropertyIds()
+{
+    // Change bits of the editor state are passed to update events as property ids
+    for (int bit = MImEditorState::FocusStateField; bit & MImEditorState::AllFields; bit <<= 1) {
+        const MImEditorState::Field field = static_cast<MImEditorState::Field>(bit);
+        const MImUpdateEvent ev(QVariantMap(), MImUpdateEvent::Properties(QFlag(bit)),
+                                QStringList(), Qt::ImhNone);
+
+        QCOMPARE(ev.propertiesChanged(), QStringList() << MImEditorState::key(field));
+    }
+}
+
+void Ut_MIMPluginManager::testDefaultEditorState()
+{
+    MInputMethodHost *host = subject->plugins[*subject->activePlugins.begin()].imHost;
+    QVERIFY(host != 0);
+
+    connection->activateContext(ClientId);
+    connection->updateWidgetInformation(ClientId, widgetState(true, 1), true);
+
+    // The implementation for hosts which do not provide their own snapshots
+    const MImEditorStateSnapshot first = host->MAbstractInputMethodHost::editorState();
+    QCOMPARE(first.surroundingText(), QString("hello world"));
+    QCOMPARE(first.cursorPosition(), 1);
+
+    // the same generation as long as the getters return the same
+    QCOMPARE(host->MAbstractInputMethodHost::editorState().generation(), first.generation());
+
+    connection->updateWidgetInformation(ClientId, widgetState(true, 3), false);
+
+    const MImEditorStateSnapshot second = host->MAbstractInputMethodHost::editorState();
+    QCOMPARE(second.cursorPosition(), 3);
+    QVERIFY(second.generation() > first.generation());
+    QCOMPARE(first.cursorPosition(), 1);
+}
+
+void Ut_MIMPluginManager::testQueryAnswerDeliveredToRequester()
+{
+    QList<MInputMethodHost *> hosts;
+    Q_FOREACH (const MIMPluginManagerPrivate::PluginDescription &description, subject->plugins) {
+        if (description.imHost) {
+            hosts.append(description.imHost);
+        }
+    }
+    QVERIFY(hosts.count() >= 2);
+
+    QSignalSpy requesterSpy(hosts.at(0), SIGNAL(selectionReceived(QString,bool)));
+    QSignalSpy otherSpy(hosts.at(1), SIGNAL(selectionReceived(QString,bool)));
+    QSignalSpy rectangleSpy(hosts.at(0), SIGNAL(preeditRectangleReceived(QRect,bool)));
+
+    hosts.at(0)->requestSelection();
+    QCOMPARE(requesterSpy.count(), 1);
+    QCOMPARE(otherSpy.count(), 0);
+    QCOMPARE(rectangleSpy.count(), 0);
+
+    // Answers to the other host do not reach the first one again
+    hosts.at(1)->requestSelection();
+    QCOMPARE(requesterSpy.count(), 1);
+    QCOMPARE(otherSpy.count(), 1);
+}
+
 QTEST_MAIN(Ut_MIMPluginManager)
@@ -2,11 +2,11 @@
 #define UT_MIMPLUGINLOADER_H
 
 #include "mimserveroptions.h"
+#include "mimpluginmanager.h"
 
 #include <QtTest/QtTest>
 #include <QObject>
 
-class MIMPluginManager;
 class MIMPluginManagerPrivate;
 class MInputContextTestConnection;
 class QDBusInterface;
@@ -52,8 +52,22 @@ private Q_SLOTS:
     void testPluginSettingsList();
     void testPluginSettingsUpdate();
 
+    void testLazyLoading();
+    void testPluginCache();
+    void testPluginCacheInvalidation();
+    void testStagedLoading();
+    void testStandbyPlugins();
+    void testWidgetStateCoalesced();
+    void testWidgetStateFocusMoved();
+    void testWidgetStateDispatchedBeforeShow();
+    void testWidgetStateDispatchedBeforeSwitch();
+    void testWidgetStatePropertyIds();
+    void testDefaultEditorState();
+    void testQueryAnswerDeliveredToRequester();
+
 private:
     void handleMessages();
+    void recreateManager(MIMPluginManager::LoadingMode loadingMode = MIMPluginManager::LoadAllPlugins);
 
     QString pluginPath;
     MIMPluginManager *manager;
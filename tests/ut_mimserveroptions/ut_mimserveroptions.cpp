@@ -37,6 +37,8 @@ namespace {
     Args Nothing           = { 0, { 0 } };
     Args ProgramNameOnly   = { 1, { "name" } };
     Args BypassedParameter = { 1, { "name", "-help" } };
+    Args TraceFile         = { 3, { "", "-trace-file", "/tmp/trace.json" } };
+    Args TraceFileMissing  = { 2, { "", "-trace-file" } };
 
     Args Ignored = { 15, { "", "-style", "STYLE", "-session", "SESSION",
                            "-graphicssystem", "GRAPHICSSYSTEM",
@@ -47,7 +49,8 @@ namespace {
     bool operator==(const MImServerCommonOptions &x,
                     const MImServerCommonOptions &y)
     {
-        return (x.showHelp == y.showHelp);
+        return (x.showHelp == y.showHelp
+                && x.traceFile == y.traceFile);
     }
 }
 
@@ -94,6 +97,13 @@ void Ut_MImServerOptions::testCommonOptions_data()
     QTest::newRow("program name only") << ProgramNameOnly << helpDisabled << true;
 
     QTest::newRow("ignored") << Ignored << helpDisabled << true;
+
+    MImServerCommonOptions traceEnabled;
+    traceEnabled.traceFile = "/tmp/trace.json";
+
+    QTest::newRow("trace file") << TraceFile << traceEnabled << true;
+
+    QTest::newRow("trace file missing") << TraceFileMissing << helpDisabled << true;
 }
 
 void Ut_MImServerOptions::testCommonOptions()
@@ -0,0 +1,171 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_mimsurroundingtext.h"
+
+#include <mimsurroundingtext.h>
+
+void Ut_MImSurroundingText::initTestCase()
+{
+}
+
+void Ut_MImSurroundingText::cleanupTestCase()
+{
+}
+
+void Ut_MImSurroundingText::init()
+{
+}
+
+void Ut_MImSurroundingText::cleanup()
+{
+}
+
+void Ut_MImSurroundingText::testReset()
+{
+    MImSurroundingText text;
+    QVERIFY(text.isEmpty());
+    QCOMPARE(text.toString(), QString());
+
+    const QString original("hello world");
+    text.reset(original, 5, 3);
+
+    QCOMPARE(text.length(), original.length());
+    QCOMPARE(text.cursorPosition(), 5);
+    QCOMPARE(text.anchorPosition(), 3);
+    // The string from the application is shared, not copied
+    QVERIFY(text.toString().constData() == original.constData());
+}
+
+void Ut_MImSurroundingText::testInsert()
+{
+    MImSurroundingText text;
+    text.reset("hello world", 5, 5);
+
+    QVERIFY(text.insert(5, ","));
+    QCOMPARE(text.toString(), QString("hello, world"));
+
+    QVERIFY(text.insert(0, ">"));
+    QCOMPARE(text.toString(), QString(">hello, world"));
+
+    QVERIFY(text.insert(text.length(), "!"));
+    QCOMPARE(text.toString(), QString(">hello, world!"));
+    QCOMPARE(text.length(), 14);
+
+    QVERIFY(text.insert(3, ""));
+    QCOMPARE(text.toString(), QString(">hello, world!"));
+
+    MImSurroundingText empty;
+    QVERIFY(empty.insert(0, "a"));
+    QCOMPARE(empty.toString(), QString("a"));
+}
+
+void Ut_MImSurroundingText::testTypingAndBackspace()
+{
+    MImSurroundingText text;
+    text.reset("ab", 1, 1);
+
+    QVERIFY(text.insert(1, "x"));
+    QVERIFY(text.insert(2, "y"));
+    QVERIFY(text.insert(3, "z"));
+    QCOMPARE(text.toString(), QString("axyzb"));
+
+    QVERIFY(text.remove(3, 1));
+    QVERIFY(text.remove(2, 1));
+    QCOMPARE(text.toString(), QString("axb"));
+
+    QVERIFY(text.insert(2, "q"));
+    QCOMPARE(text.toString(), QString("axqb"));
+
+    QVERIFY(text.remove(0, 1));
+    QCOMPARE(text.toString(), QString("xqb"));
+}
+
+void Ut_MImSurroundingText::testRemoveAcrossPieces()
+{
+    MImSurroundingText text;
+    text.reset("0123456789", 0, 0);
+
+    QVERIFY(text.insert(3, "abc"));
+    QVERIFY(text.insert(8, "def"));
+    QCOMPARE(text.toString(), QString("012abc34def56789"));
+
+    QVERIFY(text.remove(2, 10));
+    QCOMPARE(text.toString(), QString("016789"));
+
+    QVERIFY(text.remove(0, text.length()));
+    QVERIFY(text.isEmpty());
+    QCOMPARE(text.toString(), QString());
+}
+
+void Ut_MImSurroundingText::testOutOfRange()
+{
+    MImSurroundingText text;
+    text.reset("abc", 0, 0);
+
+    QVERIFY(not text.insert(-1, "x"));
+    QVERIFY(not text.insert(4, "x"));
+    QVERIFY(not text.remove(-1, 1));
+    QVERIFY(not text.remove(2, 2));
+    QVERIFY(not text.remove(0, -1));
+    QCOMPARE(text.toString(), QString("abc"));
+}
+
+void Ut_MImSurroundingText::testMid()
+{
+    MImSurroundingText text;
+    text.reset("0123456789", 0, 0);
+    QVERIFY(text.insert(5, "abc"));
+
+    QCOMPARE(text.mid(3, 4), QString("34ab"));
+    QCOMPARE(text.mid(6, 10), QString("bc56789"));
+    QCOMPARE(text.mid(0, -1), QString("01234abc56789"));
+
+    // Same result once the text has been assembled
+    QCOMPARE(text.toString(), QString("01234abc56789"));
+    QCOMPARE(text.mid(3, 4), QString("34ab"));
+}
+
+void Ut_MImSurroundingText::testScatteredEdits()
+{
+    QString expected(1000, QChar('.'));
+    MImSurroundingText text;
+    text.reset(expected, 0, 0);
+
+    // Deterministic pseudo random edits, enough to merge pieces several times
+    quint32 seed = 1;
+    for (int i = 0; i < 500; ++i) {
+        seed = seed * 1103515245 + 12345;
+        const int position = (seed >> 8) % (expected.length() + 1);
+
+        if (i % 3 == 2 && position < expected.length()) {
+            const int length = qMin<int>(seed % 5 + 1, expected.length() - position);
+            QVERIFY(text.remove(position, length));
+            expected.remove(position, length);
+        } else {
+            const QString inserted = QString::number(i);
+            QVERIFY(text.insert(position, inserted));
+            expected.insert(position, inserted);
+        }
+
+        QCOMPARE(text.length(), expected.length());
+        if (i % 50 == 0) {
+            QCOMPARE(text.toString(), expected);
+        }
+    }
+
+    QCOMPARE(text.toString(), expected);
+}
+
+QTEST_MAIN(Ut_MImSurroundingText)
@@ -0,0 +1,41 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef UT_MIMSURROUNDINGTEXT_H
+#define UT_MIMSURROUNDINGTEXT_H
+
+#include <QtTest/QtTest>
+#include <QObject>
+
+class Ut_MImSurroundingText : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void init();
+    void cleanup();
+
+    void testReset();
+    void testInsert();
+    void testTypingAndBackspace();
+    void testRemoveAcrossPieces();
+    void testOutOfRange();
+    void testMid();
+    void testScatteredEdits();
+};
+
+#endif // UT_MIMSURROUNDINGTEXT_H
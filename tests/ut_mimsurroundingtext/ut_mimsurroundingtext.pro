@@ -0,0 +1,12 @@
+include(../common_top.pri)
+
+# Input
+HEADERS += \
+    ut_mimsurroundingtext.h \
+
+SOURCES += \
+    ut_mimsurroundingtext.cpp \
+
+include($$TOP_DIR/connection/libmaliit-connection.pri)
+
+include(../common_check.pri)
@@ -0,0 +1,122 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_mimupdateevent.h"
+
+#include <maliit/plugins/updateevent.h>
+#include <maliit/plugins/updatereceiver.h>
+#include <maliit/namespace.h>
+#include <maliit/namespaceinternal.h>
+
+void Ut_MImUpdateEvent::initTestCase()
+{
+}
+
+void Ut_MImUpdateEvent::cleanupTestCase()
+{
+}
+
+void Ut_MImUpdateEvent::init()
+{
+}
+
+void Ut_MImUpdateEvent::cleanup()
+{
+}
+
+void Ut_MImUpdateEvent::testChangedFromStringList()
+{
+    QVariantMap state;
+    state["cursorPosition"] = 3;
+    state["custom"] = true;
+
+    const QStringList changed = QStringList() << "cursorPosition" << "custom";
+    MImUpdateEvent ev(state, changed);
+
+    QVERIFY(ev.changed(MImUpdateEvent::CursorPositionProperty));
+    QVERIFY(not ev.changed(MImUpdateEvent::SurroundingTextProperty));
+    QVERIFY(ev.changed(QString("cursorPosition")));
+    QVERIFY(ev.changed(QString("custom")));
+    QVERIFY(not ev.changed(QString("other")));
+    QCOMPARE(ev.changedProperties(),
+             MImUpdateEvent::Properties(MImUpdateEvent::CursorPositionProperty));
+    QCOMPARE(ev.propertiesChanged(), changed);
+}
+
+void Ut_MImUpdateEvent::testChangedFromProperties()
+{
+    QVariantMap state;
+    state["surroundingText"] = QString("text");
+    state["focusState"] = true;
+    state[Maliit::InputMethodQuery::translucentInputMethod] = true;
+
+    MImUpdateEvent ev(state,
+                      MImUpdateEvent::SurroundingTextProperty | MImUpdateEvent::FocusStateProperty,
+                      QStringList() << Maliit::InputMethodQuery::translucentInputMethod,
+                      Qt::ImhNone);
+
+    QVERIFY(ev.changed(MImUpdateEvent::SurroundingTextProperty));
+    QVERIFY(ev.changed(MImUpdateEvent::FocusStateProperty));
+    QVERIFY(not ev.changed(MImUpdateEvent::CursorPositionProperty));
+    QVERIFY(ev.changed(QString("surroundingText")));
+
+    bool changed = false;
+    QVERIFY(ev.translucentInputMethod(&changed));
+    QVERIFY(changed);
+
+    QCOMPARE(ev.propertiesChanged(),
+             QStringList() << "focusState" << "surroundingText"
+                           << Maliit::InputMethodQuery::translucentInputMethod);
+}
+
+void Ut_MImUpdateEvent::testHints()
+{
+    QVariantMap state;
+    state[Maliit::Internal::inputMethodHints] = static_cast<qint64>(Qt::ImhPreferNumbers);
+
+    MImUpdateEvent ev(state, MImUpdateEvent::InputMethodHintsProperty, QStringList(), Qt::ImhNone);
+
+    bool changed = false;
+    QCOMPARE(ev.hints(&changed), Qt::InputMethodHints(Qt::ImhPreferNumbers));
+    QVERIFY(changed);
+
+    changed = false;
+    QVERIFY(ev.preferNumbers(&changed));
+    QVERIFY(changed);
+
+    MImUpdateEvent unchanged(state, MImUpdateEvent::NoProperty, QStringList(), Qt::ImhPreferNumbers);
+    unchanged.hints(&changed);
+    QVERIFY(not changed);
+    unchanged.preferNumbers(&changed);
+    QVERIFY(not changed);
+}
+
+void Ut_MImUpdateEvent::testReceiver()
+{
+    QVariantMap state;
+    state[Maliit::InputMethodQuery::westernNumericInputEnforced] = true;
+
+    MImUpdateEvent ev(state, MImUpdateEvent::NoProperty,
+                      QStringList() << Maliit::InputMethodQuery::westernNumericInputEnforced,
+                      Qt::ImhNone);
+
+    MImUpdateReceiver receiver;
+    QSignalSpy spy(&receiver, SIGNAL(westernNumericInputEnforcedChanged(bool)));
+    receiver.process(&ev);
+
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(receiver.westernNumericInputEnforced());
+}
+
+QTEST_MAIN(Ut_MImUpdateEvent)
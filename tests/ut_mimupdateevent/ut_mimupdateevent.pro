@@ -0,0 +1,12 @@
+include(../common_top.pri)
+
+include(../../src/libmaliit-plugins.pri)
+
+# Input
+HEADERS += \
+    ut_mimupdateevent.h \
+
+SOURCES += \
+    ut_mimupdateevent.cpp \
+
+include(../common_check.pri)
@@ -0,0 +1,115 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_mimutf8offsetindex.h"
+
+#include <mimutf8offsetindex.h>
+
+void Ut_MImUtf8OffsetIndex::initTestCase()
+{
+}
+
+void Ut_MImUtf8OffsetIndex::cleanupTestCase()
+{
+}
+
+void Ut_MImUtf8OffsetIndex::init()
+{
+}
+
+void Ut_MImUtf8OffsetIndex::cleanup()
+{
+}
+
+void Ut_MImUtf8OffsetIndex::testEmpty()
+{
+    MImUtf8OffsetIndex index;
+    QCOMPARE(index.utf16Length(), 0);
+    QCOMPARE(index.utf8Length(), 0);
+    QCOMPARE(index.toUtf8(0), 0);
+    QCOMPARE(index.toUtf16(0), 0);
+}
+
+void Ut_MImUtf8OffsetIndex::testOffsets_data()
+{
+    QTest::addColumn<QString>("text");
+
+    const QString mixed = QString::fromUtf8("a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80z");
+
+    QTest::newRow("ascii") << QString("hello world");
+    QTest::newRow("mixed") << mixed;
+    QTest::newRow("long ascii") << QString(1000, QChar('x'));
+    QTest::newRow("long mixed") << mixed.repeated(100);
+    QTest::newRow("ascii then mixed") << QString(130, QChar('x')) + mixed.repeated(20);
+}
+
+void Ut_MImUtf8OffsetIndex::testOffsets()
+{
+    QFETCH(QString, text);
+
+    const MImUtf8OffsetIndex index(text);
+    QCOMPARE(index.utf16Length(), text.size());
+    QCOMPARE(index.utf8Length(), text.toUtf8().size());
+
+    for (int position = 0; position <= text.size(); ++position) {
+        // Positions between the halves of a surrogate pair are not characters
+        if (position > 0 && position < text.size() && text.at(position).isLowSurrogate()) {
+            continue;
+        }
+
+        const int bytes = text.leftRef(position).toUtf8().size();
+        QCOMPARE(index.toUtf8(position), bytes);
+        QCOMPARE(index.toUtf16(bytes), position);
+    }
+}
+
+void Ut_MImUtf8OffsetIndex::testClamping()
+{
+    const QString text = QString::fromUtf8("a\xc3\xa9z");
+    const MImUtf8OffsetIndex index(text);
+
+    QCOMPARE(index.toUtf8(-1), 0);
+    QCOMPARE(index.toUtf8(10), 4);
+    QCOMPARE(index.toUtf16(-1), 0);
+    QCOMPARE(index.toUtf16(10), 3);
+    // Inside the two byte sequence of U+00E9
+    QCOMPARE(index.toUtf16(2), 1);
+}
+
+void Ut_MImUtf8OffsetIndex::testMidLength()
+{
+    const QString text = QString::fromUtf8("a\xc3\xa9\xe2\x82\xacz");
+    const MImUtf8OffsetIndex index(text);
+
+    QCOMPARE(index.utf8Length(1, 2), text.midRef(1, 2).toUtf8().size());
+    QCOMPARE(index.utf8Length(2, -1), text.midRef(2, -1).toUtf8().size());
+    QCOMPARE(index.utf8Length(-1, 2), text.midRef(-1, 2).toUtf8().size());
+    QCOMPARE(index.utf8Length(3, 10), text.midRef(3, 10).toUtf8().size());
+    QCOMPARE(index.utf8Length(10, 1), 0);
+}
+
+void Ut_MImUtf8OffsetIndex::testSetTextShared()
+{
+    const QString text("hello");
+    MImUtf8OffsetIndex index(text);
+
+    index.setText(text);
+    QVERIFY(index.text().constData() == text.constData());
+
+    index.setText(QString::fromUtf8("h\xc3\xa9llo"));
+    QCOMPARE(index.utf8Length(), 6);
+    QCOMPARE(index.toUtf8(2), 3);
+}
+
+QTEST_MAIN(Ut_MImUtf8OffsetIndex)
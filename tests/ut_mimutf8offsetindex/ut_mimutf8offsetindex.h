@@ -0,0 +1,40 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef UT_MIMUTF8OFFSETINDEX_H
+#define UT_MIMUTF8OFFSETINDEX_H
+
+#include <QtTest/QtTest>
+#include <QObject>
+
+class Ut_MImUtf8OffsetIndex : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void init();
+    void cleanup();
+
+    void testEmpty();
+    void testOffsets_data();
+    void testOffsets();
+    void testClamping();
+    void testMidLength();
+    void testSetTextShared();
+};
+
+#endif // UT_MIMUTF8OFFSETINDEX_H
@@ -0,0 +1,12 @@
+include(../common_top.pri)
+
+# Input
+HEADERS += \
+    ut_mimutf8offsetindex.h \
+
+SOURCES += \
+    ut_mimutf8offsetindex.cpp \
+
+include($$TOP_DIR/connection/libmaliit-connection.pri)
+
+include(../common_check.pri)
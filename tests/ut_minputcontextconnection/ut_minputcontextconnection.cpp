@@ -0,0 +1,721 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_minputcontextconnection.h"
+
+#include <minputcontextconnection.h>
+
+#include <QSignalSpy>
+#include <QKeyEvent>
+
+namespace {
+    const unsigned int ClientId = 1;
+    const unsigned int OtherClientId = 2;
+
+    QVariantMap initialState()
+    {
+        QVariantMap state;
+        state["focusState"] = true;
+        state["surroundingText"] = QString("hello world");
+        state["cursorPosition"] = 5;
+        state["anchorPosition"] = 5;
+        state["hiddenText"] = false;
+        return state;
+    }
+
+    MImOutboundMessage preeditMessage(const QString &text, int replacementLength = 0)
+    {
+        MImOutboundMessage message(MImOutboundMessage::UpdatePreedit);
+        message.text = text;
+        message.replacementLength = replacementLength;
+        return message;
+    }
+
+    MImOutboundMessage commitMessage(const QString &text)
+    {
+        MImOutboundMessage message(MImOutboundMessage::CommitString);
+        message.text = text;
+        return message;
+    }
+
+    class BatchingConnection : public MInputContextConnection
+    {
+    public:
+        using MInputContextConnection::queueOutboundMessage;
+
+        QList<unsigned int> batchConnections;
+        QList<QList<MImOutboundMessage> > batches;
+
+        QList<unsigned int> processedConnections;
+        QList<quint32> processedSerials;
+        QList<QList<uint> > passedThrough;
+        //! Number of outbound batches sent before each key event answer
+        QList<int> batchesBeforeProcessed;
+
+    protected:
+        virtual void sendOutboundMessages(unsigned int connectionId,
+                                          const QList<MImOutboundMessage> &messages)
+        {
+            batchConnections.append(connectionId);
+            batches.append(messages);
+        }
+
+        virtual void sendKeyEventsProcessed(unsigned int connectionId, quint32 lastSerial,
+                                            const QList<uint> &passedThroughSerials)
+        {
+            processedConnections.append(connectionId);
+            processedSerials.append(lastSerial);
+            passedThrough.append(passedThroughSerials);
+            batchesBeforeProcessed.append(batches.count());
+        }
+    };
+
+    //! Answers queries like an application, or lets them time out
+    class QueryConnection : public MInputContextConnection
+    {
+    public:
+        QueryConnection()
+            : clientAnswers(true)
+        {}
+
+        bool clientAnswers;
+        QRect clientRectangle;
+        QString clientSelection;
+
+        virtual QRect preeditRectangle(bool &valid)
+        {
+            if (clientAnswers) {
+                setLastPreeditRectangle(clientRectangle, true);
+            }
+            return lastPreeditRectangle(valid);
+        }
+
+        virtual QString selection(bool &valid)
+        {
+            if (clientAnswers) {
+                setLastSelection(clientSelection, true);
+            }
+            return lastSelection(valid);
+        }
+    };
+
+    MImKeyEventBatch keyEventBatch()
+    {
+        MImKeyEventBatch batch;
+        batch.append(1, QEvent::KeyPress, Qt::Key_A, Qt::NoModifier, "a", false, 1, 38, 0, 0, 100);
+        batch.append(2, QEvent::KeyRelease, Qt::Key_A, Qt::NoModifier, "a", false, 1, 38, 0, 0, 110);
+        batch.append(3, QEvent::KeyPress, Qt::Key_Escape, Qt::NoModifier, QString(), false, 1, 9, 0, 0, 120);
+        batch.append(4, QEvent::KeyRelease, Qt::Key_Escape, Qt::NoModifier, QString(), false, 1, 9, 0, 0, 130);
+        return batch;
+    }
+}
+
+void Ut_MInputContextConnection::initTestCase()
+{
+    qRegisterMetaType<MImEditorState::Fields>("MImEditorState::Fields");
+}
+
+void Ut_MInputContextConnection::cleanupTestCase()
+{
+}
+
+void Ut_MInputContextConnection::handleKeyEvent(QEvent::Type keyType, Qt::Key keyCode,
+                                                Qt::KeyboardModifiers modifiers, const QString &text,
+                                                bool autoRepeat, int count, quint32 nativeScanCode,
+                                                quint32 nativeModifiers, unsigned long time)
+{
+    Q_UNUSED(nativeScanCode);
+    Q_UNUSED(nativeModifiers);
+    Q_UNUSED(time);
+
+    receivedKeys.append(keyCode);
+
+    BatchingConnection *connection = static_cast<BatchingConnection *>(keyEventConnection);
+
+    // Commits printable keys, lets the application have the others
+    if (text.isEmpty()) {
+        connection->passThroughKeyEvent(QKeyEvent(keyType, keyCode, modifiers, text, autoRepeat, count));
+    } else if (keyType == QEvent::KeyPress) {
+        connection->queueOutboundMessage(commitMessage(text));
+    }
+}
+
+void Ut_MInputContextConnection::init()
+{
+    subject = new MInputContextConnection;
+    subject->activateContext(ClientId);
+    subject->updateWidgetInformation(ClientId, initialState(), true);
+
+    keyEventConnection = 0;
+    receivedKeys.clear();
+}
+
+void Ut_MInputContextConnection::cleanup()
+{
+    delete subject;
+    subject = 0;
+}
+
+void Ut_MInputContextConnection::testDeltaUpdate()
+{
+    QSignalSpy spy(subject, SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)));
+
+    QVariantMap changed;
+    changed["cursorPosition"] = 6;
+    changed["anchorPosition"] = 6;
+    changed["hasSelection"] = false;
+
+    QVERIFY(subject->updateWidgetInformationDelta(ClientId, 0, 1, changed,
+                                                  QStringList() << "hiddenText",
+                                                  -1, 0, QString(), false));
+    QCOMPARE(spy.count(), 1);
+
+    const QVariantMap newState = spy.first().at(1).toMap();
+    QCOMPARE(newState.value("cursorPosition").toInt(), 6);
+    QCOMPARE(newState.value("hasSelection").toBool(), false);
+    QVERIFY(not newState.contains("hiddenText"));
+    QCOMPARE(newState.value("surroundingText").toString(), QString("hello world"));
+
+    QCOMPARE(spy.first().at(4).value<MImEditorState::Fields>(),
+             MImEditorState::AnchorPositionField | MImEditorState::CursorPositionField
+             | MImEditorState::HasSelectionField);
+    QCOMPARE(spy.first().at(5).toStringList(), QStringList());
+
+    bool valid = false;
+    QCOMPARE(subject->anchorPosition(valid), 6);
+    QVERIFY(valid);
+}
+
+void Ut_MInputContextConnection::testDeltaTextSplice()
+{
+    QSignalSpy spy(subject, SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)));
+
+    QVariantMap changed;
+    changed["cursorPosition"] = 7;
+    QVERIFY(subject->updateWidgetInformationDelta(ClientId, 0, 1, changed, QStringList(),
+                                                  5, 1, QString(", "), false));
+
+    QString text;
+    int cursor = 0;
+    QVERIFY(subject->surroundingText(text, cursor));
+    QCOMPARE(text, QString("hello, world"));
+    QCOMPARE(cursor, 7);
+    QVERIFY(spy.first().at(4).value<MImEditorState::Fields>() & MImEditorState::SurroundingTextField);
+
+    // Deltas chain on top of each other
+    QVERIFY(subject->updateWidgetInformationDelta(ClientId, 1, 2, QVariantMap(), QStringList(),
+                                                  12, 0, QString("!"), false));
+    QVERIFY(subject->surroundingText(text, cursor));
+    QCOMPARE(text, QString("hello, world!"));
+}
+
+void Ut_MInputContextConnection::testDeltaVersionMismatch()
+{
+    QSignalSpy spy(subject, SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)));
+
+    QVariantMap changed;
+    changed["cursorPosition"] = 1;
+    QVERIFY(not subject->updateWidgetInformationDelta(ClientId, 3, 4, changed, QStringList(),
+                                                      -1, 0, QString(), false));
+    QCOMPARE(spy.count(), 0);
+
+    // A full snapshot resets the version
+    subject->updateWidgetInformation(ClientId, initialState(), false);
+    QVERIFY(subject->updateWidgetInformationDelta(ClientId, 0, 1, changed, QStringList(),
+                                                  -1, 0, QString(), false));
+}
+
+void Ut_MInputContextConnection::testDeltaSpliceOutOfRange()
+{
+    QVERIFY(not subject->updateWidgetInformationDelta(ClientId, 0, 1, QVariantMap(), QStringList(),
+                                                      10, 5, QString("x"), false));
+
+    // The base state was dropped, so even a matching version needs a snapshot first
+    QVERIFY(not subject->updateWidgetInformationDelta(ClientId, 0, 1, QVariantMap(), QStringList(),
+                                                      -1, 0, QString(), false));
+}
+
+void Ut_MInputContextConnection::testDeltaInactiveClient()
+{
+    QSignalSpy spy(subject, SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)));
+
+    subject->updateWidgetInformation(OtherClientId, initialState(), false);
+
+    QVariantMap changed;
+    changed["cursorPosition"] = 2;
+    QVERIFY(subject->updateWidgetInformationDelta(OtherClientId, 0, 1, changed, QStringList(),
+                                                  -1, 0, QString(), false));
+    QCOMPARE(spy.count(), 0);
+
+    QString text;
+    int cursor = 0;
+    QVERIFY(subject->surroundingText(text, cursor));
+    QCOMPARE(cursor, 5);
+}
+
+void Ut_MInputContextConnection::testLocalEcho()
+{
+    subject->sendCommitString("XY");
+
+    QString text;
+    int cursorPosition = -1;
+    QVERIFY(subject->surroundingText(text, cursorPosition));
+    QCOMPARE(text, QString("helloXY world"));
+    QCOMPARE(cursorPosition, 7);
+
+    bool valid = false;
+    QCOMPARE(subject->anchorPosition(valid), 7);
+    QVERIFY(valid);
+
+    QKeyEvent backspace(QEvent::KeyPress, Qt::Key_Backspace, Qt::NoModifier);
+    subject->sendKeyEvent(backspace);
+
+    QVERIFY(subject->surroundingText(text, cursorPosition));
+    QCOMPARE(text, QString("helloX world"));
+    QCOMPARE(cursorPosition, 6);
+
+    const QVariantMap state = subject->widgetState();
+    QCOMPARE(state.value("surroundingText").toString(), QString("helloX world"));
+    QCOMPARE(state.value("cursorPosition").toInt(), 6);
+    QCOMPARE(state.value("anchorPosition").toInt(), 6);
+}
+
+void Ut_MInputContextConnection::testLocalEchoConfirmedByDelta()
+{
+    QSignalSpy spy(subject, SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)));
+
+    subject->sendCommitString("X");
+
+    // The application reports what was already echoed locally
+    QVariantMap changed;
+    changed["cursorPosition"] = 6;
+    changed["anchorPosition"] = 6;
+
+    QVERIFY(subject->updateWidgetInformationDelta(ClientId, 0, 1, changed, QStringList(),
+                                                  5, 0, QString("X"), false));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(4).value<MImEditorState::Fields>(),
+             MImEditorState::Fields(MImEditorState::NoField));
+    QCOMPARE(spy.first().at(5).toStringList(), QStringList());
+
+    QString text;
+    int cursorPosition = -1;
+    QVERIFY(subject->surroundingText(text, cursorPosition));
+    QCOMPARE(text, QString("helloX world"));
+    QCOMPARE(cursorPosition, 6);
+}
+
+void Ut_MInputContextConnection::testEditorStateGeneration()
+{
+    const quint64 initial = subject->editorStateGeneration();
+    QVERIFY(initial > 0);
+    QCOMPARE(subject->editorState().surroundingText(), QString("hello world"));
+
+    // The same state again is no change
+    subject->updateWidgetInformation(ClientId, initialState(), false);
+    QCOMPARE(subject->editorStateGeneration(), initial);
+
+    subject->sendCommitString("X");
+    QCOMPARE(subject->editorStateGeneration(), initial + 1);
+    QCOMPARE(subject->editorState().surroundingText(), QString("helloX world"));
+    QCOMPARE(subject->editorState().cursorPosition(), 6);
+
+    // Confirms the local echo, nothing changes
+    QVariantMap changed;
+    changed["cursorPosition"] = 6;
+    changed["anchorPosition"] = 6;
+    QVERIFY(subject->updateWidgetInformationDelta(ClientId, 0, 1, changed, QStringList(),
+                                                  5, 0, QString("X"), false));
+    QCOMPARE(subject->editorStateGeneration(), initial + 1);
+
+    changed.clear();
+    changed["hasSelection"] = true;
+    QVERIFY(subject->updateWidgetInformationDelta(ClientId, 1, 2, changed, QStringList(),
+                                                  -1, 0, QString(), false));
+    QCOMPARE(subject->editorStateGeneration(), initial + 2);
+    QVERIFY(subject->editorState().hasSelection());
+}
+
+void Ut_MInputContextConnection::testQueryTimeout()
+{
+    QueryConnection connection;
+    connection.activateContext(ClientId);
+    connection.updateWidgetInformation(ClientId, initialState(), true);
+    connection.clientRectangle = QRect(1, 2, 3, 4);
+    connection.clientSelection = "hello";
+
+    bool valid = false;
+    QCOMPARE(connection.preeditRectangle(valid), QRect(1, 2, 3, 4));
+    QVERIFY(valid);
+    QCOMPARE(connection.selection(valid), QString("hello"));
+    QVERIFY(valid);
+
+    // The last answers still describe the current state
+    connection.clientAnswers = false;
+    QCOMPARE(connection.preeditRectangle(valid), QRect(1, 2, 3, 4));
+    QVERIFY(valid);
+
+    QVariantMap state(initialState());
+    state["cursorPosition"] = 7;
+    state["anchorPosition"] = 7;
+    connection.updateWidgetInformation(ClientId, state, false);
+
+    connection.preeditRectangle(valid);
+    QVERIFY(!valid);
+
+    QSignalSpy selectionSpy(&connection, SIGNAL(selectionReceived(QString,bool)));
+    connection.requestSelection();
+    QCOMPARE(selectionSpy.count(), 1);
+    QCOMPARE(selectionSpy.first().at(1).toBool(), false);
+
+    // Answers after the state change are valid again
+    connection.clientAnswers = true;
+    connection.selection(valid);
+    QVERIFY(valid);
+
+    connection.clientAnswers = false;
+    connection.activateContext(OtherClientId);
+    connection.selection(valid);
+    QVERIFY(!valid);
+}
+
+void Ut_MInputContextConnection::testOutboundBatch()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+
+    connection.queueOutboundMessage(preeditMessage("a"));
+    connection.queueOutboundMessage(commitMessage("ab"));
+    connection.queueOutboundMessage(preeditMessage("c"));
+    connection.queueOutboundMessage(preeditMessage("cd"));
+    QCOMPARE(connection.batches.count(), 0);
+
+    // Sent at the end of the event loop iteration
+    QTRY_COMPARE(connection.batches.count(), 1);
+    QCOMPARE(connection.batchConnections.first(), ClientId);
+
+    const QList<MImOutboundMessage> batch = connection.batches.first();
+    QCOMPARE(batch.count(), 3);
+    QCOMPARE(batch.at(0).text, QString("a"));
+    QCOMPARE(batch.at(1).type, MImOutboundMessage::CommitString);
+    QCOMPARE(batch.at(2).text, QString("cd"));
+
+    connection.flushOutboundMessages();
+    QCOMPARE(connection.batches.count(), 1);
+}
+
+void Ut_MInputContextConnection::testOutboundPreeditReplacementKept()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+
+    connection.queueOutboundMessage(preeditMessage("a", 2));
+    connection.queueOutboundMessage(preeditMessage("b"));
+    connection.flushOutboundMessages();
+
+    QCOMPARE(connection.batches.count(), 1);
+    QCOMPARE(connection.batches.first().count(), 2);
+}
+
+void Ut_MInputContextConnection::testOutboundFlushOnActivation()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+
+    connection.queueOutboundMessage(commitMessage("a"));
+    connection.activateContext(OtherClientId);
+
+    QCOMPARE(connection.batches.count(), 1);
+    QCOMPARE(connection.batchConnections.first(), ClientId);
+}
+
+void Ut_MInputContextConnection::testOutboundDroppedOnDisconnection()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+
+    connection.queueOutboundMessage(commitMessage("a"));
+    connection.handleDisconnection(ClientId);
+    connection.flushOutboundMessages();
+
+    QCOMPARE(connection.batches.count(), 0);
+}
+
+void Ut_MInputContextConnection::testKeyEventBatch()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+    keyEventConnection = &connection;
+
+    connect(&connection, SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
+            this, SLOT(handleKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
+
+    connection.processKeyEvents(ClientId, keyEventBatch());
+
+    QCOMPARE(receivedKeys, QList<int>() << Qt::Key_A << Qt::Key_A << Qt::Key_Escape << Qt::Key_Escape);
+
+    QCOMPARE(connection.processedConnections, QList<unsigned int>() << ClientId);
+    QCOMPARE(connection.processedSerials, QList<quint32>() << 4);
+    QCOMPARE(connection.passedThrough.first(), QList<uint>() << 3 << 4);
+
+    // The commit reaches the application before it replays the escape key
+    QCOMPARE(connection.batchesBeforeProcessed.first(), 1);
+    QCOMPARE(connection.batches.first().first().text, QString("a"));
+}
+
+void Ut_MInputContextConnection::testKeyEventBatchAutoRepeat()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+    keyEventConnection = &connection;
+
+    connect(&connection, SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
+            this, SLOT(handleKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
+
+    const int Repeats = 5;
+    MImKeyEventBatch batch;
+    batch.append(1, QEvent::KeyPress, Qt::Key_A, Qt::NoModifier, "a", false, 1, 38, 0, 0, 100);
+    for (int i = 0; i < Repeats; ++i) {
+        batch.append(2 + i, QEvent::KeyPress, Qt::Key_A, Qt::NoModifier, "a", true, 1, 38, 0, 0, 110 + i);
+    }
+    batch.append(2 + Repeats, QEvent::KeyRelease, Qt::Key_A, Qt::NoModifier, "a", false, 1, 38, 0, 0, 200);
+    QVERIFY(batch.count() < Repeats + 2);
+
+    connection.processKeyEvents(ClientId, batch);
+
+    // Every auto-repeat is delivered, each one commits its text
+    QCOMPARE(receivedKeys.count(), 1 + Repeats + 1);
+    QCOMPARE(connection.batches.count(), 1);
+    QCOMPARE(connection.batches.first().count(), 1 + Repeats);
+}
+
+void Ut_MInputContextConnection::testKeyEventBatchInactiveClient()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+    keyEventConnection = &connection;
+
+    connect(&connection, SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
+            this, SLOT(handleKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
+
+    connection.processKeyEvents(OtherClientId, keyEventBatch());
+
+    QVERIFY(receivedKeys.isEmpty());
+    QCOMPARE(connection.processedConnections, QList<unsigned int>() << OtherClientId);
+    QCOMPARE(connection.passedThrough.first(), QList<uint>() << 1 << 2 << 3 << 4);
+}
+
+void Ut_MInputContextConnection::testKeyEventBatchFiltered()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+    keyEventConnection = &connection;
+
+    MImKeyFilter filter;
+    filter.addKeyRange(Qt::Key_A, Qt::Key_Z);
+    filter.addKey(Qt::Key_Escape, Qt::NoModifier, Qt::NoModifier, MImKeyFilter::ComposingState);
+    connection.setKeyFilter(filter);
+
+    connect(&connection, SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
+            this, SLOT(handleKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
+
+    connection.processKeyEvents(ClientId, keyEventBatch());
+
+    // Escape is passed through without reaching the input method
+    QCOMPARE(receivedKeys, QList<int>() << Qt::Key_A << Qt::Key_A);
+    QCOMPARE(connection.processedSerials, QList<quint32>() << 4);
+    QCOMPARE(connection.passedThrough.first(), QList<uint>() << 3 << 4);
+    QCOMPARE(connection.batches.first().first().text, QString("a"));
+}
+
+void Ut_MInputContextConnection::testKeyEventBatchFilteredWhileComposing()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+    keyEventConnection = &connection;
+
+    MImKeyFilter filter;
+    filter.addKey(Qt::Key_Escape, Qt::NoModifier, Qt::NoModifier, MImKeyFilter::ComposingState);
+    connection.setKeyFilter(filter);
+    connection.sendPreeditString("a", QList<Maliit::PreeditTextFormat>());
+
+    connect(&connection, SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
+            this, SLOT(handleKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
+
+    connection.processKeyEvents(ClientId, keyEventBatch());
+
+    QCOMPARE(receivedKeys, QList<int>() << Qt::Key_Escape << Qt::Key_Escape);
+    QCOMPARE(connection.passedThrough.first(), QList<uint>() << 1 << 2 << 3 << 4);
+}
+
+void Ut_MInputContextConnection::testKeyFilterReleaseFollowsPress()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+    keyEventConnection = &connection;
+
+    MImKeyFilter filter;
+    filter.addKeyRange(Qt::Key_A, Qt::Key_Z, Qt::NoModifier, Qt::NoModifier, MImKeyFilter::ComposingState);
+    connection.setKeyFilter(filter);
+    connection.sendPreeditString("a", QList<Maliit::PreeditTextFormat>());
+
+    connect(&connection, SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
+            this, SLOT(handleKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
+
+    MImKeyEventBatch press;
+    press.append(1, QEvent::KeyPress, Qt::Key_B, Qt::NoModifier, "b", false, 1, 56, 0, 0, 100);
+    connection.processKeyEvents(ClientId, press);
+
+    // the commit ends composing before the key is released
+    connection.sendCommitString("ab");
+
+    MImKeyEventBatch release;
+    release.append(2, QEvent::KeyRelease, Qt::Key_B, Qt::NoModifier, "b", false, 1, 56, 0, 0, 110);
+    connection.processKeyEvents(ClientId, release);
+
+    // the release goes to the input method like its press
+    QCOMPARE(receivedKeys, QList<int>() << Qt::Key_B << Qt::Key_B);
+    QCOMPARE(connection.passedThrough, QList<QList<uint> >() << QList<uint>() << QList<uint>());
+
+    // the next press is checked against the new state
+    MImKeyEventBatch next;
+    next.append(3, QEvent::KeyPress, Qt::Key_B, Qt::NoModifier, "b", false, 1, 56, 0, 0, 120);
+    next.append(4, QEvent::KeyRelease, Qt::Key_B, Qt::NoModifier, "b", false, 1, 56, 0, 0, 130);
+    connection.processKeyEvents(ClientId, next);
+
+    QCOMPARE(receivedKeys.size(), 2);
+    QCOMPARE(connection.passedThrough.last(), QList<uint>() << 3 << 4);
+}
+
+void Ut_MInputContextConnection::testKeyFilterClearedOnActivation()
+{
+    BatchingConnection connection;
+    connection.activateContext(ClientId);
+    keyEventConnection = &connection;
+
+    MImKeyFilter filter;
+    filter.addKeyRange(Qt::Key_A, Qt::Key_Z, Qt::NoModifier, Qt::NoModifier, MImKeyFilter::ComposingState);
+    connection.setKeyFilter(filter);
+    connection.sendPreeditString("a", QList<Maliit::PreeditTextFormat>());
+
+    connect(&connection, SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
+            this, SLOT(handleKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
+
+    MImKeyEventBatch press;
+    press.append(1, QEvent::KeyPress, Qt::Key_B, Qt::NoModifier, "b", false, 1, 56, 0, 0, 100);
+    connection.processKeyEvents(ClientId, press);
+    QCOMPARE(receivedKeys, QList<int>() << Qt::Key_B);
+
+    // The other application only sees the release, which follows the key filter
+    connection.activateContext(OtherClientId);
+    connection.sendCommitString("ab");
+
+    MImKeyEventBatch release;
+    release.append(1, QEvent::KeyRelease, Qt::Key_B, Qt::NoModifier, "b", false, 1, 56, 0, 0, 110);
+    connection.processKeyEvents(OtherClientId, release);
+
+    QCOMPARE(receivedKeys, QList<int>() << Qt::Key_B);
+    QCOMPARE(connection.passedThrough.last(), QList<uint>() << 1);
+}
+
+void Ut_MInputContextConnection::testHeldRequests()
+{
+    BatchingConnection connection;
+    keyEventConnection = &connection;
+    QSignalSpy activatedSpy(&connection, SIGNAL(clientActivated(uint)));
+    QSignalSpy stateSpy(&connection, SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)));
+    QSignalSpy showSpy(&connection, SIGNAL(showInputMethodRequest()));
+    QSignalSpy preeditSpy(&connection, SIGNAL(preeditChanged(QString,int)));
+    QSignalSpy resetSpy(&connection, SIGNAL(resetInputMethodRequest()));
+
+    connect(&connection, SIGNAL(receivedKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)),
+            this, SLOT(handleKeyEvent(QEvent::Type,Qt::Key,Qt::KeyboardModifiers,QString,bool,int,quint32,quint32,ulong)));
+
+    connection.holdRequests();
+
+    connection.activateContext(ClientId);
+    connection.updateWidgetInformation(ClientId, initialState(), true);
+    connection.showInputMethod(ClientId);
+
+    QCOMPARE(activatedSpy.count(), 0);
+    QCOMPARE(stateSpy.count(), 0);
+    QCOMPARE(showSpy.count(), 0);
+
+    // Deltas need a stored snapshot, the client is asked for a full one
+    QVariantMap changed;
+    changed["cursorPosition"] = 6;
+    QVERIFY(not connection.updateWidgetInformationDelta(ClientId, 0, 1, changed, QStringList(),
+                                                        -1, 0, QString(), false));
+
+    // The other requests wait as well
+    connection.setPreedit(ClientId, "hel", 3);
+    connection.reset(ClientId);
+
+    QCOMPARE(preeditSpy.count(), 0);
+    QCOMPARE(resetSpy.count(), 0);
+
+    // while key events go back to the application right away
+    connection.processKeyEvents(ClientId, keyEventBatch());
+
+    QVERIFY(receivedKeys.isEmpty());
+    QCOMPARE(connection.processedSerials, QList<quint32>() << 4);
+    QCOMPARE(connection.passedThrough.first(), QList<uint>() << 1 << 2 << 3 << 4);
+
+    connection.releaseRequests();
+
+    QCOMPARE(activatedSpy.count(), 1);
+    QCOMPARE(stateSpy.count(), 1);
+    QCOMPARE(stateSpy.first().at(3).toBool(), true);
+    QCOMPARE(showSpy.count(), 1);
+    QCOMPARE(preeditSpy.count(), 1);
+    QCOMPARE(preeditSpy.first().at(0).toString(), QString("hel"));
+    QVERIFY(receivedKeys.isEmpty());
+    QCOMPARE(connection.processedSerials, QList<quint32>() << 4);
+    QCOMPARE(resetSpy.count(), 1);
+
+    QString text;
+    int cursor = 0;
+    QVERIFY(connection.surroundingText(text, cursor));
+    QCOMPARE(text, QString("hello world"));
+
+    // Handled right away from now on
+    QVERIFY(connection.updateWidgetInformationDelta(ClientId, 0, 1, changed, QStringList(),
+                                                    -1, 0, QString(), false));
+    QCOMPARE(stateSpy.count(), 2);
+
+    connection.releaseRequests();
+    QCOMPARE(showSpy.count(), 1);
+}
+
+void Ut_MInputContextConnection::testHeldRequestsDroppedOnDisconnection()
+{
+    BatchingConnection connection;
+    QSignalSpy activatedSpy(&connection, SIGNAL(clientActivated(uint)));
+    QSignalSpy showSpy(&connection, SIGNAL(showInputMethodRequest()));
+
+    connection.holdRequests();
+
+    connection.activateContext(ClientId);
+    connection.showInputMethod(ClientId);
+    connection.activateContext(OtherClientId);
+    connection.handleDisconnection(OtherClientId);
+
+    connection.releaseRequests();
+
+    QCOMPARE(activatedSpy.count(), 1);
+    QCOMPARE(activatedSpy.first().at(0).toUInt(), ClientId);
+    QCOMPARE(showSpy.count(), 1);
+}
+
+QTEST_MAIN(Ut_MInputContextConnection)
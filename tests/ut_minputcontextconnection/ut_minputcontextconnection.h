@@ -0,0 +1,72 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef UT_MINPUTCONTEXTCONNECTION_H
+#define UT_MINPUTCONTEXTCONNECTION_H
+
+#include <QtTest/QtTest>
+#include <QObject>
+
+class MInputContextConnection;
+
+class Ut_MInputContextConnection : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void handleKeyEvent(QEvent::Type keyType, Qt::Key keyCode, Qt::KeyboardModifiers modifiers,
+                        const QString &text, bool autoRepeat, int count, quint32 nativeScanCode,
+                        quint32 nativeModifiers, unsigned long time);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void init();
+    void cleanup();
+
+    void testDeltaUpdate();
+    void testDeltaTextSplice();
+    void testDeltaVersionMismatch();
+    void testDeltaSpliceOutOfRange();
+    void testDeltaInactiveClient();
+
+    void testLocalEcho();
+    void testLocalEchoConfirmedByDelta();
+    void testEditorStateGeneration();
+    void testQueryTimeout();
+
+    void testOutboundBatch();
+    void testOutboundPreeditReplacementKept();
+    void testOutboundFlushOnActivation();
+    void testOutboundDroppedOnDisconnection();
+
+    void testKeyEventBatch();
+    void testKeyEventBatchAutoRepeat();
+    void testKeyEventBatchInactiveClient();
+    void testKeyEventBatchFiltered();
+    void testKeyEventBatchFilteredWhileComposing();
+    void testKeyFilterReleaseFollowsPress();
+    void testKeyFilterClearedOnActivation();
+
+    void testHeldRequests();
+    void testHeldRequestsDroppedOnDisconnection();
+
+private:
+    MInputContextConnection *subject;
+    MInputContextConnection *keyEventConnection;
+    QList<int> receivedKeys;
+};
+
+#endif // UT_MINPUTCONTEXTCONNECTION_H
@@ -0,0 +1,14 @@
+include(../common_top.pri)
+
+QT += gui
+
+# Input
+HEADERS += \
+    ut_minputcontextconnection.h \
+
+SOURCES += \
+    ut_minputcontextconnection.cpp \
+
+include($$TOP_DIR/connection/libmaliit-connection.pri)
+
+include(../common_check.pri)
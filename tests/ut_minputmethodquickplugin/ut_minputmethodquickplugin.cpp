@@ -18,9 +18,11 @@
 
 #include <quick/inputmethodquickplugin.h>
 #include <quick/inputmethodquick.h>
+#include <quick/inputmethodquickengine.h>
 #include <minputmethodhost.h>
 #include <QtCore>
 #include <QtGui>
+#include <QQmlComponent>
 
 class MIndicatorServiceClient
 {};
@@ -83,8 +85,15 @@ void Ut_MInputMethodQuickPlugin::testQmlSetup()
     QVERIFY(plugin != 0);
 
     MaliitTestUtils::TestInputMethodHost host(pluginId, plugin->name());
-    Maliit::InputMethodQuick *testee = static_cast<Maliit::InputMethodQuick *>(
-        plugin->createInputMethod(&host));
+    QScopedPointer<Maliit::InputMethodQuick> testee(static_cast<Maliit::InputMethodQuick *>(
+        plugin->createInputMethod(&host)));
+
+    // the QML file is compiled asynchronously
+    if (not testee->isReady()) {
+        QSignalSpy readySpy(testee.data(), SIGNAL(ready()));
+        QVERIFY(readySpy.wait());
+    }
+    QVERIFY(testee->isReady());
 
     QVERIFY(not testee->inputMethodArea().isEmpty());
     QCOMPARE(testee->inputMethodArea(),
@@ -97,4 +106,54 @@ void Ut_MInputMethodQuickPlugin::testQmlSetup()
     QCOMPARE(host.sendPreeditCount, 1);
 }
 
+void Ut_MInputMethodQuickPlugin::testSharedEngine()
+{
+    const QDir pluginDir = MaliitTestUtils::isTestingInSandbox() ?
+                QDir(IN_TREE_TEST_PLUGIN_DIR"/qml") : QDir(MALIIT_TEST_PLUGINS_DIR"/examples/qml");
+    const QString pluginPath = pluginDir.absoluteFilePath("helloworld/helloworld.qml");
+    QVERIFY(pluginDir.exists(pluginPath));
+
+    Maliit::InputMethodQuickPlugin plugin(pluginPath,
+                                          QSharedPointer<Maliit::AbstractPlatform>(new Maliit::UnknownPlatform));
+
+    Maliit::InputMethodQuickEngine *engine = Maliit::InputMethodQuickEngine::instance();
+    const QUrl url = QUrl::fromLocalFile(pluginPath);
+    QPointer<QQmlComponent> component = engine->acquireComponent(url);
+    QVERIFY(!component.isNull());
+    if (component->isLoading()) {
+        QSignalSpy statusSpy(component, SIGNAL(statusChanged(QQmlComponent::Status)));
+        QVERIFY(statusSpy.wait());
+    }
+    QVERIFY(component->isReady());
+
+    // input methods created later reuse the compiled component and are ready at once
+    MaliitTestUtils::TestInputMethodHost host1("helloworld", plugin.name());
+    MaliitTestUtils::TestInputMethodHost host2("helloworld", plugin.name());
+    QScopedPointer<Maliit::InputMethodQuick> first(static_cast<Maliit::InputMethodQuick *>(
+        plugin.createInputMethod(&host1)));
+    QScopedPointer<Maliit::InputMethodQuick> second(static_cast<Maliit::InputMethodQuick *>(
+        plugin.createInputMethod(&host2)));
+
+    QVERIFY(first->isReady());
+    QVERIFY(second->isReady());
+    QCOMPARE(engine->acquireComponent(url), component.data());
+    engine->releaseComponent(url);
+
+    // each input method sees its own MInputMethodQuick context property
+    QCOMPARE(host1.lastCommit, QString("Maliit"));
+    QCOMPARE(host1.sendCommitCount, 1);
+    QCOMPARE(host2.lastCommit, QString("Maliit"));
+    QCOMPARE(host2.sendCommitCount, 1);
+
+    // the component is dropped with the last input method using it
+    engine->releaseComponent(url);
+    first.reset();
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+    QVERIFY(!component.isNull());
+
+    second.reset();
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+    QVERIFY(component.isNull());
+}
+
 QTEST_MAIN(Ut_MInputMethodQuickPlugin)
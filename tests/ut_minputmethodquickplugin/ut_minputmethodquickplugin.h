@@ -35,6 +35,8 @@ private Q_SLOTS:
     void testQmlSetup_data();
     void testQmlSetup();
 
+    void testSharedEngine();
+
 private:
     QApplication *app;
 };
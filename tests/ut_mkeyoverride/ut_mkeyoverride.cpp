@@ -75,5 +75,38 @@ void Ut_MKeyOverride::testSetProperty()
     spy.clear();
 }
 
+void Ut_MKeyOverride::testSetAttributes()
+{
+    QSignalSpy spy(subject, SIGNAL(keyAttributesChanged(QString, MKeyOverride::KeyOverrideAttributes)));
+    QVERIFY(spy.isValid());
+    QSignalSpy labelSpy(subject, SIGNAL(labelChanged(QString)));
+    QVERIFY(labelSpy.isValid());
+
+    QVariantMap attributes;
+    attributes.insert("label", QString("some text"));
+    attributes.insert("icon", QString("some icon"));
+    attributes.insert("enabled", true);
+    subject->setAttributes(attributes);
+
+    // enabled is true already
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().toString(), keyId);
+    QCOMPARE(spy.first().last().value<MKeyOverride::KeyOverrideAttributes>(),
+             MKeyOverride::KeyOverrideAttributes(MKeyOverride::Label | MKeyOverride::Icon));
+    QCOMPARE(labelSpy.count(), 1);
+    QCOMPARE(subject->label(), QString("some text"));
+    QCOMPARE(subject->icon(), QString("some icon"));
+    spy.clear();
+
+    subject->setAttributes(attributes);
+    QCOMPARE(spy.count(), 0);
+
+    // Single changes are still reported one by one afterwards
+    subject->setHighlighted(true);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().last().value<MKeyOverride::KeyOverrideAttributes>(),
+             MKeyOverride::KeyOverrideAttributes(MKeyOverride::Highlighted));
+}
+
 QTEST_MAIN(Ut_MKeyOverride)
 
@@ -18,6 +18,7 @@ private Q_SLOTS:
     void cleanup();
 
     void testSetProperty();
+    void testSetAttributes();
 
 private:
     MKeyOverride *subject;
@@ -0,0 +1,188 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+
+#include "ut_sharedmemorychannel.h"
+
+#include <sharedmemorychannel.h>
+
+using Maliit::DBus::SharedMemoryChannel;
+using Maliit::DBus::SharedMemoryRecord;
+
+namespace {
+    const unsigned int ChannelSize = 4096;
+}
+
+void Ut_SharedMemoryChannel::initTestCase()
+{
+}
+
+void Ut_SharedMemoryChannel::cleanupTestCase()
+{
+}
+
+void Ut_SharedMemoryChannel::init()
+{
+    writer = new SharedMemoryChannel;
+    reader = new SharedMemoryChannel;
+
+    if (!writer->create(ChannelSize)) {
+        QSKIP("Shared memory channel is not supported on this platform");
+    }
+
+    QVERIFY(reader->attach(writer->memoryFd(), writer->notifyFd()));
+    QVERIFY(reader->isValid());
+}
+
+void Ut_SharedMemoryChannel::cleanup()
+{
+    delete reader;
+    reader = 0;
+    delete writer;
+    writer = 0;
+}
+
+void Ut_SharedMemoryChannel::testCommitString()
+{
+    SharedMemoryRecord record;
+    QVERIFY(!reader->read(record));
+
+    QVERIFY(writer->writeCommitString("hello", 1, 2, 3));
+
+    QVERIFY(reader->read(record));
+    QCOMPARE(record.type, SharedMemoryRecord::CommitString);
+    QCOMPARE(record.text, QString("hello"));
+    QCOMPARE(record.replacementStart, 1);
+    QCOMPARE(record.replacementLength, 2);
+    QCOMPARE(record.cursorPos, 3);
+
+    QVERIFY(!reader->read(record));
+}
+
+void Ut_SharedMemoryChannel::testUpdatePreedit()
+{
+    QList<Maliit::PreeditTextFormat> formats;
+    formats << Maliit::PreeditTextFormat(0, 2, Maliit::PreeditDefault)
+            << Maliit::PreeditTextFormat(2, 3, Maliit::PreeditNoCandidates);
+
+    QVERIFY(writer->writeUpdatePreedit("preedit", formats, 0, 0, 4));
+
+    SharedMemoryRecord record;
+    QVERIFY(reader->read(record));
+    QCOMPARE(record.type, SharedMemoryRecord::UpdatePreedit);
+    QCOMPARE(record.text, QString("preedit"));
+    QCOMPARE(record.cursorPos, 4);
+    QCOMPARE(record.preeditFormats.count(), 2);
+    QCOMPARE(record.preeditFormats.at(1).start, 2);
+    QCOMPARE(record.preeditFormats.at(1).length, 3);
+    QCOMPARE(record.preeditFormats.at(1).preeditFace, Maliit::PreeditNoCandidates);
+}
+
+void Ut_SharedMemoryChannel::testKeyEvent()
+{
+    QVERIFY(writer->writeKeyEvent(QEvent::KeyPress, Qt::Key_A, Qt::ShiftModifier, "A",
+                                  true, 2, Maliit::EventRequestSignalOnly));
+
+    SharedMemoryRecord record;
+    QVERIFY(reader->read(record));
+    QCOMPARE(record.type, SharedMemoryRecord::KeyEvent);
+    QCOMPARE(record.keyType, static_cast<int>(QEvent::KeyPress));
+    QCOMPARE(record.key, static_cast<int>(Qt::Key_A));
+    QCOMPARE(record.modifiers, static_cast<int>(Qt::ShiftModifier));
+    QCOMPARE(record.text, QString("A"));
+    QCOMPARE(record.autoRepeat, true);
+    QCOMPARE(record.count, 2);
+    QCOMPARE(record.requestType, Maliit::EventRequestSignalOnly);
+}
+
+void Ut_SharedMemoryChannel::testOutOfBandOrdering()
+{
+    QVERIFY(writer->writeCommitString("a", 0, 0, -1));
+    writer->addOutOfBandMessage();
+    QVERIFY(writer->writeCommitString("b", 0, 0, -1));
+
+    SharedMemoryRecord record;
+    QVERIFY(reader->read(record));
+    QCOMPARE(record.text, QString("a"));
+
+    // "b" was written after a D-Bus message the reader has not handled yet
+    QVERIFY(!reader->read(record));
+
+    reader->addOutOfBandMessage();
+    QVERIFY(reader->read(record));
+    QCOMPARE(record.text, QString("b"));
+}
+
+void Ut_SharedMemoryChannel::testWrapAround()
+{
+    SharedMemoryRecord record;
+
+    for (int i = 0; i < 1000; ++i) {
+        const QString text(i % 37, QChar('a' + i % 26));
+        QVERIFY(writer->writeCommitString(text, i, 0, -1));
+        QVERIFY(writer->writeKeyEvent(QEvent::KeyRelease, Qt::Key_B, 0, text,
+                                      false, 1, Maliit::EventRequestBoth));
+
+        QVERIFY(reader->read(record));
+        QCOMPARE(record.type, SharedMemoryRecord::CommitString);
+        QCOMPARE(record.text, text);
+        QCOMPARE(record.replacementStart, i);
+
+        QVERIFY(reader->read(record));
+        QCOMPARE(record.type, SharedMemoryRecord::KeyEvent);
+        QCOMPARE(record.text, text);
+    }
+
+    QVERIFY(!reader->read(record));
+    QVERIFY(reader->isValid());
+}
+
+void Ut_SharedMemoryChannel::testFullBuffer()
+{
+    const QString text(100, QChar('x'));
+    int written = 0;
+    while (writer->writeCommitString(text, 0, 0, -1)) {
+        ++written;
+        QVERIFY(written < 100);
+    }
+    QVERIFY(written > 0);
+
+    SharedMemoryRecord record;
+    QVERIFY(reader->read(record));
+
+    // Reading made space again
+    QVERIFY(writer->writeCommitString(text, 0, 0, -1));
+
+    int read = 1;
+    while (reader->read(record)) {
+        QCOMPARE(record.text, text);
+        ++read;
+    }
+    QCOMPARE(read, written + 1);
+}
+
+void Ut_SharedMemoryChannel::testRecordTooLarge()
+{
+    const QString text(ChannelSize, QChar('x'));
+    QVERIFY(!writer->writeCommitString(text, 0, 0, -1));
+
+    // The channel stays usable for smaller records
+    QVERIFY(writer->writeCommitString("small", 0, 0, -1));
+
+    SharedMemoryRecord record;
+    QVERIFY(reader->read(record));
+    QCOMPARE(record.text, QString("small"));
+}
+
+QTEST_MAIN(Ut_SharedMemoryChannel)
@@ -0,0 +1,52 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+
+#ifndef UT_SHAREDMEMORYCHANNEL_H
+#define UT_SHAREDMEMORYCHANNEL_H
+
+#include <QtTest/QtTest>
+#include <QObject>
+
+namespace Maliit {
+namespace DBus {
+class SharedMemoryChannel;
+}
+}
+
+class Ut_SharedMemoryChannel : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void init();
+    void cleanup();
+
+    void testCommitString();
+    void testUpdatePreedit();
+    void testKeyEvent();
+    void testOutOfBandOrdering();
+    void testWrapAround();
+    void testFullBuffer();
+    void testRecordTooLarge();
+
+private:
+    Maliit::DBus::SharedMemoryChannel *writer;
+    Maliit::DBus::SharedMemoryChannel *reader;
+};
+
+#endif // UT_SHAREDMEMORYCHANNEL_H
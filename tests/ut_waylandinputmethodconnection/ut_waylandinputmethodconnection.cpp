@@ -0,0 +1,173 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_waylandinputmethodconnection.h"
+
+#include "waylandclient_stub.h"
+
+#include <waylandinputmethodconnection.h>
+#include <mimeditorstate.h>
+
+#include <QSignalSpy>
+
+namespace {
+    wl_input_method_context *contextObject(wl_proxy *context)
+    {
+        return reinterpret_cast<wl_input_method_context *>(context);
+    }
+
+    const wl_input_method_context_listener *contextListener(wl_proxy *context)
+    {
+        return waylandListener<wl_input_method_context_listener>(context);
+    }
+
+    QString surroundingText(const WaylandInputMethodConnection *connection)
+    {
+        return connection->editorState().surroundingText();
+    }
+}
+
+void Ut_WaylandInputMethodConnection::initTestCase()
+{
+    qRegisterMetaType<MImEditorState::Fields>("MImEditorState::Fields");
+}
+
+void Ut_WaylandInputMethodConnection::cleanupTestCase()
+{
+}
+
+void Ut_WaylandInputMethodConnection::init()
+{
+    resetWaylandStub();
+
+    wl_display *display = reinterpret_cast<wl_display *>(newWaylandProxy(&wl_display_interface));
+    subject = new WaylandInputMethodConnection(display);
+
+    // The compositor announces the input method global
+    wl_proxy *registry = lastWaylandObject(&wl_registry_interface);
+    QVERIFY(registry);
+    waylandListener<wl_registry_listener>(registry)->global(waylandListenerData(registry),
+                                                            reinterpret_cast<wl_registry *>(registry),
+                                                            1, "wl_input_method", 1);
+
+    inputMethod = lastWaylandObject(&wl_input_method_interface);
+    QVERIFY(inputMethod);
+}
+
+void Ut_WaylandInputMethodConnection::cleanup()
+{
+    delete subject;
+    subject = 0;
+    inputMethod = 0;
+}
+
+wl_proxy *Ut_WaylandInputMethodConnection::activate()
+{
+    wl_proxy *context = newWaylandProxy(&wl_input_method_context_interface);
+    waylandListener<wl_input_method_listener>(inputMethod)->activate(waylandListenerData(inputMethod),
+                                                                     reinterpret_cast<wl_input_method *>(inputMethod),
+                                                                     contextObject(context));
+    return context;
+}
+
+void Ut_WaylandInputMethodConnection::deactivate(wl_proxy *context)
+{
+    waylandListener<wl_input_method_listener>(inputMethod)->deactivate(waylandListenerData(inputMethod),
+                                                                       reinterpret_cast<wl_input_method *>(inputMethod),
+                                                                       contextObject(context));
+}
+
+void Ut_WaylandInputMethodConnection::commitState(wl_proxy *context, const char *text, quint32 serial)
+{
+    const uint32_t cursor = qstrlen(text);
+    contextListener(context)->surrounding_text(waylandListenerData(context), contextObject(context),
+                                               text, cursor, cursor);
+    contextListener(context)->commit_state(waylandListenerData(context), contextObject(context),
+                                           serial);
+}
+
+QSet<wl_proxy *> Ut_WaylandInputMethodConnection::requestTargets()
+{
+    QSet<wl_proxy *> targets;
+    Q_FOREACH (const WaylandRequestStub &request, gWaylandRequests) {
+        targets.insert(request.proxy);
+    }
+    gWaylandRequests.clear();
+    return targets;
+}
+
+void Ut_WaylandInputMethodConnection::testStateSentAfterCommit()
+{
+    QSignalSpy shown(subject, SIGNAL(showInputMethodRequest()));
+    QSignalSpy stateChanged(subject, SIGNAL(widgetStateChanged(uint,QMap<QString,QVariant>,QMap<QString,QVariant>,bool,MImEditorState::Fields,QStringList)));
+
+    // Nothing reaches the input method before the text input committed its state
+    wl_proxy *context = activate();
+    QCOMPARE(shown.count(), 0);
+    QCOMPARE(stateChanged.count(), 0);
+
+    commitState(context, "hello", 1);
+    QCOMPARE(shown.count(), 1);
+    QCOMPARE(stateChanged.count(), 1);
+    QCOMPARE(stateChanged.first().at(3).toBool(), true);
+    QCOMPARE(surroundingText(subject), QString("hello"));
+    QVERIFY(subject->editorState().focusState());
+}
+
+void Ut_WaylandInputMethodConnection::testEventsToActiveContext()
+{
+    wl_proxy *first = activate();
+    commitState(first, "first", 1);
+    wl_proxy *second = activate();
+    commitState(second, "second", 1);
+    QCOMPARE(surroundingText(subject), QString("second"));
+
+    requestTargets();
+    subject->sendCommitString("a");
+    subject->sendPreeditString("b", QList<Maliit::PreeditTextFormat>());
+    subject->setLanguage("en");
+    QCOMPARE(requestTargets(), QSet<wl_proxy *>() << second);
+
+    // The remaining context becomes active again with its own state
+    deactivate(second);
+    QCOMPARE(surroundingText(subject), QString("first"));
+
+    requestTargets();
+    subject->sendCommitString("c");
+    subject->setLanguage("en");
+    QCOMPARE(requestTargets(), QSet<wl_proxy *>() << first);
+}
+
+void Ut_WaylandInputMethodConnection::testInactiveContextCommit()
+{
+    QSignalSpy shown(subject, SIGNAL(showInputMethodRequest()));
+
+    wl_proxy *first = activate();
+    wl_proxy *second = activate();
+    commitState(second, "second", 1);
+    QCOMPARE(shown.count(), 1);
+
+    // Commits of the inactive context neither change the state nor show
+    commitState(first, "first", 1);
+    commitState(first, "first again", 2);
+    QCOMPARE(surroundingText(subject), QString("second"));
+    QCOMPARE(shown.count(), 1);
+
+    // The last committed state is sent once the context is active again
+    deactivate(second);
+    QCOMPARE(surroundingText(subject), QString("first again"));
+    QCOMPARE(shown.count(), 2);
+}
+
+QTEST_MAIN(Ut_WaylandInputMethodConnection)
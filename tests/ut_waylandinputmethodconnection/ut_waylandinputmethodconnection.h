@@ -0,0 +1,50 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#ifndef UT_WAYLANDINPUTMETHODCONNECTION_H
+#define UT_WAYLANDINPUTMETHODCONNECTION_H
+
+#include <QtTest/QtTest>
+#include <QObject>
+
+class WaylandInputMethodConnection;
+struct wl_proxy;
+
+class Ut_WaylandInputMethodConnection : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void init();
+    void cleanup();
+
+    void testStateSentAfterCommit();
+    void testEventsToActiveContext();
+    void testInactiveContextCommit();
+
+private:
+    wl_proxy *activate();
+    void deactivate(wl_proxy *context);
+    void commitState(wl_proxy *context, const char *text, quint32 serial);
+    //! Proxies the requests since the last call were sent to
+    QSet<wl_proxy *> requestTargets();
+
+    WaylandInputMethodConnection *subject;
+    wl_proxy *inputMethod;
+};
+
+#endif // UT_WAYLANDINPUTMETHODCONNECTION_H
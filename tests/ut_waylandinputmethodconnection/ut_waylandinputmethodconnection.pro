@@ -0,0 +1,19 @@
+include(../common_top.pri)
+
+QT += gui gui-private
+
+INCLUDEPATH += ../stubs \
+
+# Input
+HEADERS += \
+    ut_waylandinputmethodconnection.h \
+    ../stubs/waylandclient_stub.h \
+
+SOURCES += \
+    ut_waylandinputmethodconnection.cpp \
+
+include($$TOP_DIR/connection/libmaliit-connection.pri)
+# The Wayland connection uses the protocol code, link it after the connection library
+include($$TOP_DIR/weston-protocols/libmaliit-weston-protocols.pri)
+
+include(../common_check.pri)
@@ -0,0 +1,146 @@
+/* * This file is part of Maliit framework *
+ *
+ * Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * and appearing in the file LICENSE.LGPL included in the packaging
+ * of this file.
+ */
+
+#include "ut_waylandkeysyms.h"
+
+#include <waylandkeysyms.h>
+
+using Maliit::Wayland::keysymFromQt;
+using Maliit::Wayland::keysymFromUtf32;
+
+namespace {
+    struct KeyRange
+    {
+        int first;
+        int last;
+    };
+
+    // Ranges of Qt::Key which all have a keysym
+    const KeyRange CoveredRanges[] = {
+        { Qt::Key_Escape, Qt::Key_Clear },
+        { Qt::Key_Home, Qt::Key_PageDown },
+        { Qt::Key_Shift, Qt::Key_ScrollLock },
+        { Qt::Key_F1, Qt::Key_Help },
+        { Qt::Key_Back, Qt::Key_Refresh },
+        { Qt::Key_VolumeDown, Qt::Key_VolumeUp },
+        { Qt::Key_MediaPlay, Qt::Key_MediaPause },
+        { Qt::Key_HomePage, Qt::Key_OpenUrl },
+        { Qt::Key_LaunchMail, Qt::Key_LaunchMedia },
+        { Qt::Key_MonBrightnessUp, Qt::Key_ContrastAdjust },
+        { Qt::Key_Multi_key, Qt::Key_Hangul_Special },
+        { Qt::Key_Dead_Grave, Qt::Key_Dead_Horn },
+    };
+}
+
+void Ut_WaylandKeysyms::initTestCase()
+{
+}
+
+void Ut_WaylandKeysyms::cleanupTestCase()
+{
+}
+
+void Ut_WaylandKeysyms::init()
+{
+}
+
+void Ut_WaylandKeysyms::cleanup()
+{
+}
+
+void Ut_WaylandKeysyms::testTableSorted()
+{
+    QVERIFY(Maliit::Wayland::keysymTableIsSorted());
+}
+
+void Ut_WaylandKeysyms::testCoverage()
+{
+    for (unsigned int range = 0; range < sizeof(CoveredRanges) / sizeof(CoveredRanges[0]); ++range) {
+        for (int key = CoveredRanges[range].first; key <= CoveredRanges[range].last; ++key) {
+            QVERIFY2(keysymFromQt(key, Qt::NoModifier, QString()) != XKB_KEY_NoSymbol,
+                     qPrintable(QString("No keysym for Qt::Key 0x%1").arg(key, 0, 16)));
+        }
+    }
+
+    QVERIFY(keysymFromQt(Qt::Key_AltGr, Qt::NoModifier, QString()) != XKB_KEY_NoSymbol);
+    QVERIFY(keysymFromQt(Qt::Key_Mode_switch, Qt::NoModifier, QString()) != XKB_KEY_NoSymbol);
+}
+
+void Ut_WaylandKeysyms::testSpecialKeys_data()
+{
+    QTest::addColumn<int>("key");
+    QTest::addColumn<uint>("keysym");
+
+    QTest::newRow("tab") << int(Qt::Key_Tab) << uint(XKB_KEY_Tab);
+    QTest::newRow("backtab") << int(Qt::Key_Backtab) << uint(XKB_KEY_ISO_Left_Tab);
+    QTest::newRow("escape") << int(Qt::Key_Escape) << uint(XKB_KEY_Escape);
+    QTest::newRow("backspace") << int(Qt::Key_Backspace) << uint(XKB_KEY_BackSpace);
+    QTest::newRow("return") << int(Qt::Key_Return) << uint(XKB_KEY_Return);
+    QTest::newRow("delete") << int(Qt::Key_Delete) << uint(XKB_KEY_Delete);
+    QTest::newRow("home") << int(Qt::Key_Home) << uint(XKB_KEY_Home);
+    QTest::newRow("end") << int(Qt::Key_End) << uint(XKB_KEY_End);
+    QTest::newRow("left") << int(Qt::Key_Left) << uint(XKB_KEY_Left);
+    QTest::newRow("page down") << int(Qt::Key_PageDown) << uint(XKB_KEY_Page_Down);
+    QTest::newRow("F1") << int(Qt::Key_F1) << uint(XKB_KEY_F1);
+    QTest::newRow("F12") << int(Qt::Key_F12) << uint(XKB_KEY_F12);
+    QTest::newRow("F35") << int(Qt::Key_F35) << uint(XKB_KEY_F35);
+    QTest::newRow("volume up") << int(Qt::Key_VolumeUp) << uint(XKB_KEY_XF86AudioRaiseVolume);
+    QTest::newRow("dead acute") << int(Qt::Key_Dead_Acute) << uint(XKB_KEY_dead_acute);
+    QTest::newRow("unknown") << int(Qt::Key_unknown) << uint(XKB_KEY_NoSymbol);
+}
+
+void Ut_WaylandKeysyms::testSpecialKeys()
+{
+    QFETCH(int, key);
+    QFETCH(uint, keysym);
+
+    QCOMPARE(uint(keysymFromQt(key, Qt::NoModifier, QString())), keysym);
+}
+
+void Ut_WaylandKeysyms::testKeypad()
+{
+    QCOMPARE(uint(keysymFromQt(Qt::Key_5, Qt::KeypadModifier, "5")), uint(XKB_KEY_KP_5));
+    QCOMPARE(uint(keysymFromQt(Qt::Key_Plus, Qt::KeypadModifier, "+")), uint(XKB_KEY_KP_Add));
+    QCOMPARE(uint(keysymFromQt(Qt::Key_Enter, Qt::KeypadModifier, QString())), uint(XKB_KEY_KP_Enter));
+    QCOMPARE(uint(keysymFromQt(Qt::Key_5, Qt::NoModifier, "5")), uint(XKB_KEY_5));
+    // Keypad keys without an own keysym fall back to the normal one
+    QCOMPARE(uint(keysymFromQt(Qt::Key_Home, Qt::KeypadModifier, QString())), uint(XKB_KEY_Home));
+}
+
+void Ut_WaylandKeysyms::testText()
+{
+    QCOMPARE(uint(keysymFromQt(Qt::Key_A, Qt::NoModifier, "a")), uint(XKB_KEY_a));
+    QCOMPARE(uint(keysymFromQt(Qt::Key_A, Qt::ShiftModifier, "A")), uint(XKB_KEY_A));
+    QCOMPARE(uint(keysymFromQt(Qt::Key_A, Qt::NoModifier, QString())), uint(XKB_KEY_a));
+    QCOMPARE(uint(keysymFromQt(Qt::Key_A, Qt::ControlModifier, QString(QChar(0x01)))), uint(XKB_KEY_a));
+    QCOMPARE(uint(keysymFromQt(Qt::Key_Space, Qt::NoModifier, " ")), uint(XKB_KEY_space));
+    QCOMPARE(uint(keysymFromQt(0, Qt::NoModifier, QString::fromUtf8("\xc3\xa9"))), uint(XKB_KEY_eacute));
+    QCOMPARE(uint(keysymFromQt(0, Qt::NoModifier, QString::fromUtf8("\xe2\x82\xac"))), 0x010020acu);
+    // More than one character cannot be sent as one key
+    QCOMPARE(uint(keysymFromQt(0, Qt::NoModifier, "ab")), uint(XKB_KEY_NoSymbol));
+}
+
+void Ut_WaylandKeysyms::testUnicode()
+{
+    QCOMPARE(uint(keysymFromUtf32('x')), uint(XKB_KEY_x));
+    QCOMPARE(uint(keysymFromUtf32(0xe9)), uint(XKB_KEY_eacute));
+    QCOMPARE(uint(keysymFromUtf32(0x08)), uint(XKB_KEY_BackSpace));
+    QCOMPARE(uint(keysymFromUtf32(0x0d)), uint(XKB_KEY_Return));
+    QCOMPARE(uint(keysymFromUtf32(0x1f600)), 0x0101f600u);
+    QCOMPARE(uint(keysymFromUtf32(0x01)), uint(XKB_KEY_NoSymbol));
+    QCOMPARE(uint(keysymFromUtf32(0xd800)), uint(XKB_KEY_NoSymbol));
+    QCOMPARE(uint(keysymFromUtf32(0x110000)), uint(XKB_KEY_NoSymbol));
+}
+
+QTEST_MAIN(Ut_WaylandKeysyms)